@@ -0,0 +1,43 @@
+#
+# Benchmarks
+#
+
+# Microbenchmarks are not built by default or installed; build them explicitly, e.g.:
+#   cmake --build <build dir> --target amalgam-integer-set-benchmark
+#   cmake --build <build dir> --target amalgam-opcode-benchmark
+#   cmake --build <build dir> --target amalgam-query-benchmark
+if(NOT IS_WASM)
+
+    set(INTEGER_SET_BENCHMARK_SOURCES
+        "test/benchmark/integer_set_benchmark.cpp"
+        "src/Amalgam/rand/RandomStream.cpp"
+        "src/3rd_party/murmurhash3/MurmurHash3.cpp"
+    )
+    source_group(TREE ${CMAKE_SOURCE_DIR} FILES ${INTEGER_SET_BENCHMARK_SOURCES})
+    add_executable(amalgam-integer-set-benchmark EXCLUDE_FROM_ALL ${INTEGER_SET_BENCHMARK_SOURCES})
+    set_target_properties(amalgam-integer-set-benchmark PROPERTIES FOLDER "Testing")
+
+    # Per-opcode benchmarks link the multithreaded object library so that they run the interpreter
+    # as the app does; see test/benchmark/opcode_benchmark.cpp for usage
+    if(TARGET ${PROJECT_NAME}-mt-objlib)
+        set(OPCODE_BENCHMARK_SOURCES
+            "test/benchmark/benchmark_results.h"
+            "test/benchmark/opcode_benchmark.cpp"
+        )
+        source_group(TREE ${CMAKE_SOURCE_DIR} FILES ${OPCODE_BENCHMARK_SOURCES})
+        add_executable(amalgam-opcode-benchmark EXCLUDE_FROM_ALL ${OPCODE_BENCHMARK_SOURCES})
+        set_target_properties(amalgam-opcode-benchmark PROPERTIES FOLDER "Testing")
+        target_link_libraries(amalgam-opcode-benchmark ${PROJECT_NAME}-mt-objlib)
+
+        # Query engine benchmarks on synthetic datasets across thread counts; see test/benchmark/query_benchmark.cpp for usage
+        set(QUERY_BENCHMARK_SOURCES
+            "test/benchmark/benchmark_results.h"
+            "test/benchmark/query_benchmark.cpp"
+        )
+        source_group(TREE ${CMAKE_SOURCE_DIR} FILES ${QUERY_BENCHMARK_SOURCES})
+        add_executable(amalgam-query-benchmark EXCLUDE_FROM_ALL ${QUERY_BENCHMARK_SOURCES})
+        set_target_properties(amalgam-query-benchmark PROPERTIES FOLDER "Testing")
+        target_link_libraries(amalgam-query-benchmark ${PROJECT_NAME}-mt-objlib)
+    endif()
+
+endif()
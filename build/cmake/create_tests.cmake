@@ -78,7 +78,7 @@ foreach(TEST_TARGET ${ALL_SHAREDLIB_TARGETS})
 
     # Create test exe:
     set(TEST_EXE_NAME "${TEST_TARGET}-tester")
-    set(TEST_SOURCES "test/lib_smoke_test/main.cpp" "test/lib_smoke_test/test.amlg" "test/lib_smoke_test/counter.amlg" "test/lib_smoke_test/cluster.amlg" "test/unit_test/clustering_test.cpp")
+    set(TEST_SOURCES "test/lib_smoke_test/main.cpp" "test/lib_smoke_test/test.amlg" "test/lib_smoke_test/counter.amlg" "test/lib_smoke_test/cluster.amlg" "test/unit_test/clustering_test.cpp" "test/unit_test/binary_packing_test.cpp" "test/unit_test/adaptive_compact_hash_map_test.cpp" "test/unit_test/evaluable_node_manager_test.cpp" "test/unit_test/regex_cache_test.cpp" "test/unit_test/tree_commonality_test.cpp" "test/unit_test/integer_set_test.cpp" "test/unit_test/csv_test.cpp" "test/unit_test/datetime_format_test.cpp" "test/unit_test/random_stream_test.cpp" "test/unit_test/sbfds_column_data_test.cpp" "test/unit_test/weighted_sampling_test.cpp" "test/unit_test/unnamed_entity_id_test.cpp")
     source_group(TREE ${CMAKE_SOURCE_DIR} FILES ${TEST_SOURCES})
     add_executable(${TEST_EXE_NAME} ${TEST_SOURCES})
     set_target_properties(${TEST_EXE_NAME} PROPERTIES FOLDER "Testing")
@@ -63,6 +63,11 @@ extern "C"
 		char *file_type, bool persistent, char *json_file_params,
 		char *write_log_filename, char *print_log_filename);
 
+	//moves the code of the entity specified by handle and its contained entities into immutable memory shared
+	// with any clones made afterward, so that clones copy only what is written to them
+	//returns false if the entity is not found or is currently being executed
+	AMALGAM_EXPORT bool FreezeEntityCode(char *handle);
+
 	//stores the entity specified by handle into path
 	AMALGAM_EXPORT bool StoreEntity(char *handle, char *path, char *file_type, bool persistent, char *json_file_params,
 		const char **entity_path, size_t entity_path_len);
@@ -80,6 +85,23 @@ extern "C"
 	//sets the random seed for the entity specified by handle
 	AMALGAM_EXPORT bool SetRandomSeed(char *handle, char *rand_seed);
 
+	//collects garbage for the entity specified by handle on a background thread whenever the entity
+	// has been idle for idle_milliseconds; 0 stops background collection
+	//returns false if the entity is not found or if the library does not support multithreading
+	AMALGAM_EXPORT bool SetBackgroundGarbageCollection(char *handle, uint64_t idle_milliseconds);
+
+	//returns a json object of the estimated memory in bytes of the entity specified by handle and all of its
+	// contained entities, with the same keys as the mem_usage system command; empty if the entity is not found
+	AMALGAM_EXPORT char *GetEntityMemoryUsage(char *handle);
+
+	//sets a soft limit on the estimated memory of the entity specified by handle; when a call that may allocate
+	// leaves the entity above the limit, garbage is collected, query buffers are released, and then, if the query
+	// caches are the excess, query caches are cleared until it is under the limit; 0 removes the limit
+	//the limit is checked at most once per check_interval_milliseconds, or every 100 milliseconds if 0,
+	// and checks that cannot bring the entity under the limit lengthen the interval until one does
+	//returns false if the entity is not found
+	AMALGAM_EXPORT bool SetEntityMemorySoftLimit(char *handle, uint64_t soft_limit_in_bytes, uint64_t check_interval_milliseconds);
+
 	//sets num_entities to the number of entities and allocates an array of string pointers for the handles loaded
 	AMALGAM_EXPORT char **GetEntities(uint64_t *num_entities);
 
@@ -159,6 +159,12 @@ extern "C"
 		return entint.CloneEntity(h, ch, p, ft, persistent, params, wlfname, plfname);
 	}
 
+	bool FreezeEntityCode(char *handle)
+	{
+		std::string h(handle);
+		return entint.FreezeEntityCode(h);
+	}
+
 	bool StoreEntity(char *handle, char *path, char *file_type, bool persistent, char *json_file_params, const char **entity_path, size_t entity_path_len)
 	{
 		std::string h(handle);
@@ -296,6 +302,25 @@ extern "C"
 		return entint.SetRandomSeed(h, s);
 	}
 
+	bool SetBackgroundGarbageCollection(char *handle, uint64_t idle_milliseconds)
+	{
+		std::string h(handle);
+		return entint.SetBackgroundGarbageCollection(h, idle_milliseconds);
+	}
+
+	char *GetEntityMemoryUsage(char *handle)
+	{
+		std::string h(handle);
+		std::string ret = entint.GetEntityMemoryUsage(h);
+		return StringToCharPtr(ret);
+	}
+
+	bool SetEntityMemorySoftLimit(char *handle, uint64_t soft_limit_in_bytes, uint64_t check_interval_milliseconds)
+	{
+		std::string h(handle);
+		return entint.SetEntityMemorySoftLimit(h, soft_limit_in_bytes, check_interval_milliseconds);
+	}
+
 	char **GetEntities(uint64_t *num_entities)
 	{
 		std::vector<std::string> entities = entint.GetEntities();
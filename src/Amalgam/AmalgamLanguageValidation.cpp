@@ -325,6 +325,85 @@ AmalgamExample{ R"&((seq
 	["EntityNull" "EntityNaN"]
 	["Entity3" "EntityNull" "EntityNaN"]
 ])", "", R"((apply "destroy_entities" (contained_entities)))" },
+AmalgamExample{ R"&((seq
+	(create_entities "SinglePrecisionTest" .null)
+	(map
+		(lambda
+			(create_entities
+				["SinglePrecisionTest" (concat "e" (current_value 1))]
+				{
+					x (* (current_value 1) 1.37)
+					y (mod (* (current_value 1) 0.731) 5)
+				}
+			)
+		)
+		(range 0 199)
+	)
+	(declare
+		{
+			nearest (lambda
+					(compute_on_contained_entities
+						"SinglePrecisionTest"
+						[
+							(query_nearest_generalized_distance
+								10
+								["x" "y"]
+								[50 2]
+								2
+								.null
+								.null
+								.null
+								.null
+								1
+								.null
+								"fixed rand seed"
+								.null
+								precision
+								.true
+							)
+						]
+					)
+				)
+		}
+	)
+	(declare
+		{
+			same_as_recompute_precise (lambda
+					(=
+						(call nearest {precision "recompute_precise"})
+						(call nearest {precision "single_recompute_precise"})
+					)
+				)
+		}
+	)
+	[
+		(call same_as_recompute_precise)
+		(seq
+			(map
+				(lambda
+					(create_entities
+						["SinglePrecisionTest" (concat "new" (current_value 1))]
+						{
+							x (+ 49.5 (* (current_value 1) 0.11))
+							y (* (current_value 1) 0.37)
+						}
+					)
+				)
+				(range 0 9)
+			)
+			(call same_as_recompute_precise)
+		)
+		(seq
+			(assign_to_entities ["SinglePrecisionTest" "e5"] {x 50.01 y 2.02})
+			(assign_to_entities ["SinglePrecisionTest" "new3"] {x 200})
+			(call same_as_recompute_precise)
+		)
+		(seq
+			(destroy_entities ["SinglePrecisionTest" "e5"] ["SinglePrecisionTest" "new4"])
+			(call same_as_recompute_precise)
+		)
+	]
+))&", R"([.true .true .true .true])", "", R"((apply "destroy_entities" (contained_entities)))" },
 AmalgamExample{ R"&((call
 	(set_type
 		[1 0.5 "3"]
@@ -2254,6 +2333,128 @@ AmalgamExample{ R"&((concat
 		[1 2 3 4]
 	)
 ))&", R"("map list : [2 4 6 8]")" },
+AmalgamExample{ R"&((seq
+	(declare {values (range 0 999)})
+	(=
+		||(map
+			(lambda
+				(+
+					(* (current_value) 2)
+					(current_index)
+				)
+			)
+			values
+		)
+		(map
+			(lambda
+				(* (current_value) 3)
+			)
+			values
+		)
+	)
+))&", R"(.true)" },
+
+//sorting by value sorts numbers or strings by key and falls back to comparing every node when the list
+//has other types, nan, or strings that are empty or start with a null
+AmalgamExample{ R"&([
+	(sort [3 (- .infinity .infinity) 1 .infinity -.infinity 2 (- .infinity .infinity)])
+	(sort .false [3 (- .infinity .infinity) 1 .infinity 2])
+	(sort ["b" "" "a10" "a2" "\0x" "a" ""])
+	(sort .false ["b" "" "a10" "\0x" "a"])
+	(sort [3 "b" .null 1 "a" .true 2])
+	(sort .false ["b" 3 "a" .null 1])
+])&", R"([
+	[
+		.null
+		.null
+		-.infinity
+		1
+		2
+		3
+		.infinity
+	]
+	[.infinity 3 2 1 .null]
+	[
+		""
+		""
+		"\0x"
+		"a"
+		"a2"
+		"a10"
+		"b"
+	]
+	["b" "a10" "a" "\0x" ""]
+	[
+		.null
+		1
+		.true
+		2
+		3
+		"a"
+		"b"
+	]
+	["b" "a" 3 1 .null]
+])" },
+
+//a concurrent sort with a consistent custom ordering gives the same result as sorting serially,
+//and with an inconsistent ordering, the result and the random values drawn after it depend only on the seed,
+//so they are the same for any number of threads
+AmalgamExample{ R"&((seq
+	(declare
+		{
+			values
+				(map
+					(lambda
+						(mod
+							(* (current_value) 7919)
+							1000
+						)
+					)
+					(range 0 1999)
+				)
+		}
+	)
+	[
+		(=
+			||(sort
+				(lambda
+					(- (current_value) (current_value 1))
+				)
+				values
+			)
+			(sort
+				(lambda
+					(- (current_value) (current_value 1))
+				)
+				values
+			)
+			(sort values)
+		)
+		(trunc
+			||(sort
+				(lambda
+					(- (rand) (rand))
+				)
+				(range 0 999)
+			)
+			8
+		)
+		(rand)
+	]
+))&", R"([
+	.true
+	[
+		626
+		810
+		873
+		251
+		910
+		503
+		365
+		42
+	]
+	0.7280347799983286
+])" },
 AmalgamExample{ R"&((concat
 	"map assoc : "
 	||(map
@@ -2710,7 +2911,153 @@ AmalgamExample{ R"&((unparse
 	.false
 	.true
 	.true
-))&", R"("[(-) (/) (/ z) (/ z a b) (min) (max) (and) (or)]")" }
+))&", R"("[(-) (/) (/ z) (/ z a b) (min) (max) (and) (or)]")" },
+
+//assignments and accumulations built via apply are applied to the contained entities as one batch,
+//so queries afterward must reflect every entity's new values, including entities listed more than once
+AmalgamExample{ R"&((seq
+	(create_entities "B1" {x 1} "B2" {x 2} "B3" {x 3} "B4" {x 4})
+	(declare {before (contained_entities (query_between "x" 2 3)) })
+	(apply "assign_to_entities" ["B1" {x 3} "B3" {x 10 y 1} "B4" {x 2} "B1" {y 1}])
+	(apply "accum_to_entities" ["B2" {x 8} "B4" {y 2}])
+	[
+		(sort before)
+		(sort (contained_entities (query_between "x" 2 3)))
+		(sort (contained_entities (query_equals "x" 10)))
+		(sort (contained_entities (query_exists "y")))
+	]
+))&", R"([
+	["B2" "B3"]
+	["B1" "B4"]
+	["B2" "B3"]
+	["B1" "B3" "B4"]
+])", "", R"((apply "destroy_entities" (contained_entities)))" },
+
+//a batch stops at the first pair that exceeds the allocation constraint, as when assigning one pair at a time,
+//while the pairs before it, including a label assigned twice, are still reflected in queries
+AmalgamExample{ R"&((seq
+	(create_entities "BL1" {a 0 b 0} "BL2" {a 0 b 0})
+	(declare
+		{
+			before (contained_entities (query_equals "a" 0))
+			pairs ["BL1" {a 1} "BL1" {a 2} "BL1" {b (range 1 1000)} "BL2" {a 3}]
+		}
+	)
+	(declare
+		{
+			result
+				(call
+					(lambda (apply "assign_to_entities" pairs))
+					{pairs pairs}
+					{max_node_allocations 100 read_access .true write_access .true}
+					.true
+				)
+		}
+	)
+	[
+		(first result)
+		(last result)
+		(sort before)
+		(retrieve_from_entity "BL1" "a")
+		(size (retrieve_from_entity "BL1" "b"))
+		(retrieve_from_entity "BL2" "a")
+		(contained_entities (query_equals "a" 2))
+		(contained_entities (query_equals "a" 1))
+		(contained_entities (query_equals "a" 0))
+	]
+))&", R"([
+	.null
+	"Node allocation limit exceeded"
+	["BL1" "BL2"]
+	2
+	1000
+	0
+	["BL1"]
+	[]
+	["BL2"]
+])", "", R"((apply "destroy_entities" (contained_entities)))" },
+
+//cached call_entity results are keyed by the arguments of the call,
+//so changing the argument between queries must change the results, and changing it back must reuse the first results
+AmalgamExample{ R"&((seq
+	(create_entities
+		"C1" (lambda {v 1 f 0 get_f (+ (retrieve_from_entity "v") offset)})
+		"C2" (lambda {v 5 f 0 get_f (+ (retrieve_from_entity "v") offset)})
+		"C3" (lambda {v 9 f 0 get_f (+ (retrieve_from_entity "v") offset)})
+	)
+	(declare
+		{
+			nearest_with_offset
+				(lambda
+					(contained_entities
+						(query_nearest_generalized_distance
+							1
+							["f"]
+							[6]
+							1
+							.null
+							{
+								f {
+										call_entity (set_type [.null "get_f" (assoc "offset" offset)] "call_entity")
+										cache_call_entity .true
+									}
+							}
+						)
+					)
+				)
+		}
+	)
+	[
+		(call nearest_with_offset {offset 0})
+		(call nearest_with_offset {offset 4})
+		(call nearest_with_offset {offset 0})
+	]
+))&", R"([
+	["C2"]
+	["C1"]
+	["C2"]
+])", "", R"((apply "destroy_entities" (contained_entities)))" },
+
+//batch conversions of dates and times must convert each value exactly as it is converted on its own,
+//including nulls, invalid values, and data that is not a list
+AmalgamExample{ R"&((seq
+	(declare
+		{
+			numbers [48164 .null "abc" 37364.5 .infinity -1]
+			dates ["2020-01-02" .null "2020-13-02" "x" 5 "2020-02-29"]
+		}
+	)
+	[
+		(=
+			(format numbers "number" "time:%H:%M:%S" {batch .true})
+			(map (lambda (format (current_value) "number" "time:%H:%M:%S")) numbers)
+		)
+		(=
+			(format dates "date:%Y-%m-%d" "number" {batch .true time_zone "UTC"})
+			(map (lambda (format (current_value) "date:%Y-%m-%d" "number" {time_zone "UTC"})) dates)
+		)
+		(=
+			(format dates "date:%Y-%m-%d" "date:%d/%m/%Y" {batch .true})
+			(map (lambda (format (current_value) "date:%Y-%m-%d" "date:%d/%m/%Y")) dates)
+		)
+		(=
+			(format dates "date:%Y-%m-%d" "string" {batch .true})
+			(map (lambda (format (current_value) "date:%Y-%m-%d" "string")) dates)
+		)
+		(=
+			(format "2020-01-02" "date:%Y-%m-%d" "number" {batch .true time_zone "UTC"})
+			(format "2020-01-02" "date:%Y-%m-%d" "number" {time_zone "UTC"})
+		)
+		(format ["2020-01-02" "2020-01-03"] "date:%Y-%m-%d" "number" {batch .true time_zone "UTC"})
+	]
+))&", R"([
+	.true
+	.true
+	.true
+	.true
+	.true
+	[1577923200 1578009600]
+])" }
 );
 
 //runs a test suite against the language
@@ -198,6 +198,12 @@ int32_t RunAmalgamTrace(std::istream *in_stream, std::ostream *out_stream, std::
 				response = FAILURE_RESPONSE;
 			}
 		}
+		else if(command == "FREEZE_ENTITY_CODE")
+		{
+			handle = StringManipulation::RemoveFirstToken(input);
+			bool result = entint.FreezeEntityCode(handle);
+			response = result ? SUCCESS_RESPONSE : FAILURE_RESPONSE;
+		}
 		else if(command == "STORE_ENTITY")
 		{
 			std::vector<std::string> command_tokens = StringManipulation::SplitArgString(input);
@@ -307,6 +313,53 @@ int32_t RunAmalgamTrace(std::istream *in_stream, std::ostream *out_stream, std::
 			bool result = entint.SetRandomSeed(handle, json_payload);
 			response = result ? SUCCESS_RESPONSE : FAILURE_RESPONSE;
 		}
+		else if(command == "SET_BACKGROUND_GARBAGE_COLLECTION")
+		{
+			std::vector<std::string> command_tokens = StringManipulation::SplitArgString(input);
+			bool result = false;
+			try
+			{
+				if(command_tokens.size() >= 2)
+				{
+					auto idle_milliseconds = std::stoll(command_tokens[1]);
+					if(idle_milliseconds >= 0)
+						result = entint.SetBackgroundGarbageCollection(command_tokens[0], static_cast<uint64_t>(idle_milliseconds));
+				}
+			}
+			catch(...)
+			{
+				result = false;
+			}
+			response = result ? SUCCESS_RESPONSE : FAILURE_RESPONSE;
+		}
+		else if(command == "GET_ENTITY_MEMORY_USAGE")
+		{
+			handle = StringManipulation::RemoveFirstToken(input);
+			response = entint.GetEntityMemoryUsage(handle);
+		}
+		else if(command == "SET_ENTITY_MEMORY_SOFT_LIMIT")
+		{
+			std::vector<std::string> command_tokens = StringManipulation::SplitArgString(input);
+			bool result = false;
+			try
+			{
+				if(command_tokens.size() >= 2)
+				{
+					auto soft_limit = std::stoll(command_tokens[1]);
+					long long check_interval = 0;
+					if(command_tokens.size() >= 3)
+						check_interval = std::stoll(command_tokens[2]);
+					if(soft_limit >= 0 && check_interval >= 0)
+						result = entint.SetEntityMemorySoftLimit(command_tokens[0], static_cast<uint64_t>(soft_limit),
+							static_cast<uint64_t>(check_interval));
+				}
+			}
+			catch(...)
+			{
+				result = false;
+			}
+			response = result ? SUCCESS_RESPONSE : FAILURE_RESPONSE;
+		}
 		else if(command == "VERSION")
 		{
 			response = AMALGAM_VERSION_STRING;
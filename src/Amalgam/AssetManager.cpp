@@ -66,6 +66,7 @@ AssetManager::AssetParameters::AssetParameters(std::string resource_path, std::s
 		executeOnLoad = false;
 		loadExternalFiles = true;
 		requireVersionCompatibility = true;
+		rowsAsEntities = false;
 		toMemory = false;
 	}
 	else if(resourceType == FILE_EXTENSION_JSON || resourceType == FILE_EXTENSION_YAML
@@ -82,6 +83,7 @@ AssetManager::AssetParameters::AssetParameters(std::string resource_path, std::s
 		executeOnLoad = false;
 		loadExternalFiles = false;
 		requireVersionCompatibility = false;
+		rowsAsEntities = false;
 		toMemory = false;
 	}
 	else if(resourceType == FILE_EXTENSION_COMPRESSED_AMALGAM_CODE)
@@ -97,6 +99,7 @@ AssetManager::AssetParameters::AssetParameters(std::string resource_path, std::s
 		executeOnLoad = is_entity;
 		loadExternalFiles = false;
 		requireVersionCompatibility = true;
+		rowsAsEntities = false;
 		toMemory = false;
 	}
 	else
@@ -112,6 +115,7 @@ AssetManager::AssetParameters::AssetParameters(std::string resource_path, std::s
 		executeOnLoad = is_entity;
 		loadExternalFiles = false;
 		requireVersionCompatibility = false;
+		rowsAsEntities = false;
 		toMemory = false;
 	}
 
@@ -131,6 +135,7 @@ void AssetManager::AssetParameters::SetParams(EvaluableNode::AssocType &params)
 	EvaluableNode::GetValueFromMappedChildNodesReference(params, ENBISI_execute_on_load, executeOnLoad);
 	EvaluableNode::GetValueFromMappedChildNodesReference(params, ENBISI_load_external_files, loadExternalFiles);
 	EvaluableNode::GetValueFromMappedChildNodesReference(params, ENBISI_require_version_compatibility, requireVersionCompatibility);
+	EvaluableNode::GetValueFromMappedChildNodesReference(params, ENBISI_rows_as_entities, rowsAsEntities);
 }
 
 void AssetManager::AssetParameters::UpdateResources()
@@ -202,7 +207,8 @@ std::tuple<std::string, std::string, bool> AssetManager::GetFileStatus(std::stri
 			return std::make_tuple("Cannot open file", "", false);
 
 		size_t header_size = 0;
-		auto [error_message, version, success] = FileSupportCAML::ReadHeader(f, header_size);
+		uint32_t payload_version = FileSupportCAML::PAYLOAD_VERSION_BLOCKS;
+		auto [error_message, version, success] = FileSupportCAML::ReadHeader(f, header_size, payload_version);
 		if(!success)
 			return std::make_tuple(error_message, version, false);
 
@@ -312,6 +318,7 @@ EvaluableNodeReference AssetManager::LoadResource(AssetParameters *asset_params,
 	else if(asset_params->resourceType == FILE_EXTENSION_COMPRESSED_AMALGAM_CODE)
 	{
 		BinaryData compressed_data;
+		uint32_t payload_version = FileSupportCAML::PAYLOAD_VERSION_BLOCKS;
 		// LoadStreamToBuffer reads the caml header and we must use it here.
 		std::string error_msg;
 		std::string version;
@@ -319,12 +326,12 @@ EvaluableNodeReference AssetManager::LoadResource(AssetParameters *asset_params,
 		if(asset_params->toMemory)
 		{
 			std::istringstream ins(asset_params->resourceContents);
-			std::tie(error_msg, version, success) = LoadStreamToBuffer(ins, asset_params->resourceType, compressed_data);
+			std::tie(error_msg, version, success) = LoadStreamToBuffer(ins, asset_params->resourceType, compressed_data, &payload_version);
 		}
 		else
 		{
 			std::ifstream inf(asset_params->resourcePath, std::ios::binary);
-			std::tie(error_msg, version, success) = LoadStreamToBuffer<BinaryData>(inf, asset_params->resourceType, compressed_data);
+			std::tie(error_msg, version, success) = LoadStreamToBuffer<BinaryData>(inf, asset_params->resourceType, compressed_data, &payload_version);
 		}
 
 		if(!success)
@@ -333,7 +340,7 @@ EvaluableNodeReference AssetManager::LoadResource(AssetParameters *asset_params,
 			return EvaluableNodeReference::Null();
 		}
 
-		std::string code_string = DecompressString(compressed_data);
+		std::string code_string = FileSupportCAML::DecompressPayload(compressed_data, payload_version, true);
 
 		auto [node, warnings, char_with_error, code_complete]
 			= Parser::Parse(code_string, enm, asset_params->transactional,
@@ -381,23 +388,24 @@ EntityExternalInterface::LoadEntityStatus AssetManager::LoadResourceViaTransacti
 	else if(asset_params->resourceType == FILE_EXTENSION_COMPRESSED_AMALGAM_CODE)
 	{
 		BinaryData compressed_data;
+		uint32_t payload_version = FileSupportCAML::PAYLOAD_VERSION_BLOCKS;
 		std::string error_msg;
 		std::string version;
 		bool success;
 		if(asset_params->toMemory)
 		{
 			std::istringstream ins(asset_params->resourceContents);
-			std::tie(error_msg, version, success) = LoadStreamToBuffer(ins, asset_params->resourceType, compressed_data);
+			std::tie(error_msg, version, success) = LoadStreamToBuffer(ins, asset_params->resourceType, compressed_data, &payload_version);
 		}
 		else
 		{
 			std::ifstream inf(asset_params->resourcePath, std::ios::binary);
-			std::tie(error_msg, version, success) = LoadStreamToBuffer(inf, asset_params->resourceType, compressed_data);
+			std::tie(error_msg, version, success) = LoadStreamToBuffer(inf, asset_params->resourceType, compressed_data, &payload_version);
 		}
 		if(!success)
 			return EntityExternalInterface::LoadEntityStatus(false, error_msg, version);
 
-		code_string = DecompressString(compressed_data);
+		code_string = FileSupportCAML::DecompressPayload(compressed_data, payload_version, true);
 		if(code_string.size() == 0)
 			return EntityExternalInterface::LoadEntityStatus(false, "No data found in file", version);
 	}
@@ -511,20 +519,23 @@ bool AssetManager::StoreResource(EvaluableNode *code, AssetParameters *asset_par
 	else if(asset_params->resourceType == FILE_EXTENSION_COMPRESSED_AMALGAM_CODE)
 	{
 		std::string code_string = Parser::Unparse(code, asset_params->prettyPrint, true, asset_params->sortKeys);
-		auto [compressed_data, huffman_tree] = CompressString(code_string);
+		uint32_t payload_version = (asset_params->parallelCreate
+			? FileSupportCAML::PAYLOAD_VERSION_CHUNKED : FileSupportCAML::PAYLOAD_VERSION_BLOCKS);
+		auto [compressed_data, huffman_tree] = FileSupportCAML::CompressPayload(code_string, payload_version,
+			nullptr, asset_params->parallelCreate);
 		delete huffman_tree;
 		// StoreFileFromBuffer() writes the caml header and we must use it here.
 		if(asset_params->toMemory)
 		{
 			std::ostringstream outs;
-			bool result = StoreFileFromBuffer(outs, asset_params->resourceType, compressed_data);
+			bool result = StoreFileFromBuffer(outs, asset_params->resourceType, compressed_data, payload_version);
 			asset_params->resourceContents = outs.str();
 			return result;
 		}
 		else
 		{
 			std::ofstream outf(asset_params->resourcePath, std::ios::out | std::ios::binary);
-			return StoreFileFromBuffer(outf, asset_params->resourceType, compressed_data);
+			return StoreFileFromBuffer(outf, asset_params->resourceType, compressed_data, payload_version);
 		}
 	}
 	else //binary string
@@ -578,6 +589,19 @@ Entity *AssetManager::LoadEntityFromResource(AssetParametersRef &asset_params, b
 		return new_entity;
 	}
 
+	//create each row of the csv as a contained entity rather than building the whole table as one list
+	if(asset_params->rowsAsEntities && asset_params->resourceType == FILE_EXTENSION_CSV && !asset_params->toMemory)
+	{
+		FileSupportCSV::LoadRowsAsContainedEntities(asset_params->resourcePath, new_entity, status);
+		if(!status.loaded)
+		{
+			delete new_entity;
+			return nullptr;
+		}
+
+		return new_entity;
+	}
+
 	EvaluableNodeReference code = LoadResource(asset_params.get(), &new_entity->evaluableNodeManager, status);
 
 	if(!status.loaded)
@@ -69,6 +69,7 @@ public:
 			flatten(other.flatten),
 			parallelCreate(other.parallelCreate),
 			executeOnLoad(other.executeOnLoad),
+			rowsAsEntities(other.rowsAsEntities),
 			toMemory(other.toMemory)
 		{}
 
@@ -159,6 +160,7 @@ public:
 		bool executeOnLoad;
 		bool loadExternalFiles;
 		bool requireVersionCompatibility;
+		bool rowsAsEntities;
 		bool toMemory;
 	};
 
@@ -197,17 +199,66 @@ public:
 		std::string code_string = Parser::Unparse(top_entity_code, asset_params->prettyPrint, true, asset_params->sortKeys, true);
 		entity->evaluableNodeManager.FreeNodeTree(top_entity_code);
 
-		//loop over contained entities, freeing resources after each entity
-		for(size_t i = 0; i < all_contained_entities->size(); i++)
+		//offsets at which the code for each entity ends, so compressed chunks can begin at entity boundaries
+		std::vector<size_t> entity_end_offsets;
+		entity_end_offsets.reserve(all_contained_entities->size() + 1);
+		entity_end_offsets.push_back(code_string.size());
+
+		size_t num_contained_entities = all_contained_entities->size();
+	#ifdef MULTITHREAD_SUPPORT
+		size_t max_num_threads = Concurrency::GetMaxNumThreads();
+		if(asset_params->parallelCreate && max_num_threads > 1
+			&& num_contained_entities >= 2 * minContainedEntitiesPerStoreTask)
 		{
-			auto &cur_entity = (*all_contained_entities)[i];
-			EvaluableNode *create_entity_code = EntityManipulation::FlattenOnlyOneContainedEntity(
-				&entity->evaluableNodeManager, cur_entity, entity, asset_params->includeRandSeeds, true);
+			//split into contiguous ranges so that the concatenated result is identical to the serial result,
+			// using a few more tasks than threads to balance entities of different sizes
+			size_t num_tasks = std::min(num_contained_entities / minContainedEntitiesPerStoreTask, 4 * max_num_threads);
+			size_t num_per_task = (num_contained_entities + num_tasks - 1) / num_tasks;
+			num_tasks = (num_contained_entities + num_per_task - 1) / num_per_task;
+
+			std::vector<std::string> code_string_segments(num_tasks);
+			std::vector<std::vector<size_t>> segment_entity_end_offsets(num_tasks);
+			auto task_set = Concurrency::urgentThreadPool.CreateCountableTaskSet(num_tasks);
+
+			auto enqueue_task_lock = Concurrency::urgentThreadPool.AcquireTaskLock();
+			for(size_t task_index = 0; task_index < num_tasks; task_index++)
+			{
+				size_t start_index = task_index * num_per_task;
+				size_t end_index = std::min(start_index + num_per_task, num_contained_entities);
+				Concurrency::urgentThreadPool.BatchEnqueueTask(
+					[entity, asset_params, &all_contained_entities, &code_string_segments, &segment_entity_end_offsets,
+						task_index, start_index, end_index, &task_set]()
+					{
+						UnparseContainedEntitiesAndAppend(code_string_segments[task_index], segment_entity_end_offsets[task_index],
+							entity, asset_params, all_contained_entities, start_index, end_index);
+						task_set.MarkTaskCompleted();
+					}
+				);
+			}
 
-			code_string += Parser::Unparse(create_entity_code,
-				asset_params->prettyPrint, true, asset_params->sortKeys, false, 1);
+			task_set.WaitForTasks(&enqueue_task_lock);
 
-			entity->evaluableNodeManager.FreeNodeTree(create_entity_code);
+			size_t total_size = code_string.size();
+			for(auto &segment : code_string_segments)
+				total_size += segment.size();
+			code_string.reserve(total_size + Parser::transactionTermination.size());
+
+			for(size_t task_index = 0; task_index < num_tasks; task_index++)
+			{
+				size_t segment_start = code_string.size();
+				for(size_t offset : segment_entity_end_offsets[task_index])
+					entity_end_offsets.push_back(segment_start + offset);
+
+				code_string += code_string_segments[task_index];
+				//free memory as soon as possible
+				std::string().swap(code_string_segments[task_index]);
+			}
+		}
+		else
+	#endif
+		{
+			UnparseContainedEntitiesAndAppend(code_string, entity_end_offsets,
+				entity, asset_params, all_contained_entities, 0, num_contained_entities);
 		}
 
 		//if persistent, need to keep the file open for appends
@@ -240,11 +291,15 @@ public:
 		}
 		else if(asset_params->resourceType == FILE_EXTENSION_COMPRESSED_AMALGAM_CODE)
 		{
-			auto [compressed_data, huffman_tree] = CompressString(code_string);
+			//only compress in chunks when storing in parallel, otherwise the output is identical to the serial path
+			uint32_t payload_version = (asset_params->parallelCreate
+				? FileSupportCAML::PAYLOAD_VERSION_CHUNKED : FileSupportCAML::PAYLOAD_VERSION_BLOCKS);
+			auto [compressed_data, huffman_tree] = FileSupportCAML::CompressPayload(code_string, payload_version,
+				&entity_end_offsets, asset_params->parallelCreate);
 			if(asset_params->toMemory)
 			{
 				std::ostringstream outs;
-				if(!FileSupportCAML::WriteHeader(outs))
+				if(!FileSupportCAML::WriteHeader(outs, payload_version))
 					return false;
 				outs.write(reinterpret_cast<char *>(compressed_data.data()), compressed_data.size());
 				delete huffman_tree;
@@ -257,7 +312,7 @@ public:
 				if(!outf->good())
 					return false;
 
-				if(!FileSupportCAML::WriteHeader(*outf))
+				if(!FileSupportCAML::WriteHeader(*outf, payload_version))
 					return false;
 
 				outf->write(reinterpret_cast<char *>(compressed_data.data()), compressed_data.size());
@@ -594,10 +649,12 @@ public:
 	}
 
 	//loads filename into the buffer specified by b (of type BufferType of elements BufferElementType)
+	//if the file is caml and caml_payload_version is not nullptr, sets it to the version of the payload loaded into b
 	//if successful, returns no error message, file version (if available), and true
 	//if failure, returns error message, file version (if available) and false
 	template<typename BufferType>
-	static std::tuple<std::string, std::string, bool> LoadStreamToBuffer(std::istream &f, std::string &file_type, BufferType &b)
+	static std::tuple<std::string, std::string, bool> LoadStreamToBuffer(std::istream &f, std::string &file_type, BufferType &b,
+		uint32_t *caml_payload_version = nullptr)
 	{
 		if(!f.good())
 			return std::make_tuple("Cannot open file", "", false);
@@ -606,7 +663,10 @@ public:
 		std::string file_version;
 		if(file_type == FILE_EXTENSION_COMPRESSED_AMALGAM_CODE)
 		{
-			auto [error_string, version, success] = FileSupportCAML::ReadHeader(f, header_size);
+			uint32_t payload_version = FileSupportCAML::PAYLOAD_VERSION_BLOCKS;
+			auto [error_string, version, success] = FileSupportCAML::ReadHeader(f, header_size, payload_version);
+			if(caml_payload_version != nullptr)
+				*caml_payload_version = payload_version;
 			if(!success)
 				return std::make_tuple(error_string, version, false);
 			else
@@ -622,15 +682,17 @@ public:
 	}
 
 	//stores buffer b (of type BufferType of elements BufferElementType) into the filename, returns true if successful, false if not
+	//if the file is caml, b must contain a payload of caml_payload_version
 	template<typename BufferType>
-	static bool StoreFileFromBuffer(std::ostream &f, std::string_view file_type, const BufferType &b)
+	static bool StoreFileFromBuffer(std::ostream &f, std::string_view file_type, const BufferType &b,
+		uint32_t caml_payload_version = FileSupportCAML::PAYLOAD_VERSION_BLOCKS)
 	{
 		if(!f.good())
 			return false;
 
 		if(file_type == FILE_EXTENSION_COMPRESSED_AMALGAM_CODE)
 		{
-			if(!FileSupportCAML::WriteHeader(f))
+			if(!FileSupportCAML::WriteHeader(f, caml_payload_version))
 				return false;
 		}
 
@@ -662,6 +724,32 @@ public:
 
 private:
 
+	//minimum number of contained entities to unparse per task when storing flattened entities concurrently
+	static constexpr size_t minContainedEntitiesPerStoreTask = 64;
+
+	//flattens and unparses the contained entities of entity from all_contained_entities, from start_index up to
+	// but not including end_index, appending the code to code_string and freeing resources after each entity
+	//the offset within code_string where each entity's code ends is appended to entity_end_offsets
+	template<typename EntityReferenceType>
+	static void UnparseContainedEntitiesAndAppend(std::string &code_string, std::vector<size_t> &entity_end_offsets,
+		Entity *entity, AssetParameters *asset_params,
+		Entity::EntityReferenceBufferReference<EntityReferenceType> &all_contained_entities,
+		size_t start_index, size_t end_index)
+	{
+		for(size_t i = start_index; i < end_index; i++)
+		{
+			auto &cur_entity = (*all_contained_entities)[i];
+			EvaluableNode *create_entity_code = EntityManipulation::FlattenOnlyOneContainedEntity(
+				&entity->evaluableNodeManager, cur_entity, entity, asset_params->includeRandSeeds, true);
+
+			code_string += Parser::Unparse(create_entity_code,
+				asset_params->prettyPrint, true, asset_params->sortKeys, false, 1);
+			entity_end_offsets.push_back(code_string.size());
+
+			entity->evaluableNodeManager.FreeNodeTree(create_entity_code);
+		}
+	}
+
 	//sets the entity's persistent path
 	//if asset_params is null, then it will clear persistence
 	//assumes persistentEntitiesMutex is locked
@@ -1,8 +1,12 @@
 //project headers:
 #include "BinaryPacking.h"
 
+#include "Concurrency.h"
+
 //system headers:
+#include <algorithm>
 #include <array>
+#include <deque>
 #include <queue>
 
 constexpr static size_t NUM_UINT8_VALUES = static_cast<size_t>(std::numeric_limits<uint8_t>::max()) + 1;
@@ -90,14 +94,26 @@ size_t ParseCompactIndexToIndexAndAdvance(BinaryData &bd, size_t &bd_offset)
 	return index;
 }
 
-BinaryData EncodeStringFromHuffmanTree(std::string &uncompressed_data, HuffmanTree<uint8_t> *huffman_tree)
+//the code for each possibly representable value
+// for example, if 44 is the boolean vector 10, then it will have 10 at the 44th index
+//codes short enough to fit in packedCodes are also stored there, with the first bit in the least significant bit,
+// so that they can be written to the output several bits at a time
+class HuffmanValueCodes
 {
-	//build lookup table from huffman_tree
+public:
+	//maximum number of bits of a packed code, leaving room for a partially filled byte in a 64-bit accumulator
+	static constexpr size_t maxPackedCodeLength = 56;
 
-	//the code for each possibly representable value
-	// for example, if 44 is the boolean vector 10, then it will have 10 at the 44th index
-	//all valueCodes are initialized to an empty boolean array
 	std::array<std::vector<bool>, NUM_UINT8_VALUES> valueCodes;
+	std::array<uint64_t, NUM_UINT8_VALUES> packedCodes;
+};
+
+//builds lookup table of the code for each value from huffman_tree
+static HuffmanValueCodes BuildValueCodesFromHuffmanTree(HuffmanTree<uint8_t> *huffman_tree)
+{
+	//all valueCodes are initialized to an empty boolean array
+	HuffmanValueCodes codes;
+	auto &valueCodes = codes.valueCodes;
 
 	//keep a double-ended queue to traverse the tree, building up the codes for each part of the tree
 	std::deque<std::pair<HuffmanTree<uint8_t> *, std::vector<bool>>> remaining_nodes;
@@ -132,72 +148,190 @@ BinaryData EncodeStringFromHuffmanTree(std::string &uncompressed_data, HuffmanTr
 		}
 	}
 
-	//encode the data and store in compressed_data
-	BinaryData compressed_data;
-	//reserve some, probably not enough, but enough to get started
-	compressed_data.reserve(1 + uncompressed_data.size() / 4);
+	for(size_t i = 0; i < NUM_UINT8_VALUES; i++)
+	{
+		uint64_t packed_code = 0;
+		auto &code = valueCodes[i];
+		if(code.size() <= HuffmanValueCodes::maxPackedCodeLength)
+		{
+			for(size_t bit_index = 0; bit_index < code.size(); bit_index++)
+			{
+				if(code[bit_index])
+					packed_code |= (1ULL << bit_index);
+			}
+		}
+		codes.packedCodes[i] = packed_code;
+	}
+
+	return codes;
+}
+
+BinaryData EncodeStringFromValueCodes(std::string_view uncompressed_data, HuffmanValueCodes &value_codes)
+{
+	auto &valueCodes = value_codes.valueCodes;
 
 	//the first byte stores the number of extra bits in the last byte, so skip it for encoding
 	size_t ending_bit = 8;
+	for(uint8_t c : uncompressed_data)
+		ending_bit += valueCodes[c].size();
+
+	//encode the data and store in compressed_data
+	// if one extra bit, then need a full extra byte, so add 7 bits to round up
+	BinaryData compressed_data((ending_bit + 7) / 8, 0);
 	size_t cur_byte = 1;
-	size_t cur_bit = 0;
+
+	//accumulate bits, writing out whole bytes as they are filled
+	uint64_t bit_accumulator = 0;
+	size_t num_accumulated_bits = 0;
 
 	for(uint8_t c : uncompressed_data)
 	{
 		auto &value = valueCodes[c];
 		size_t num_bits_to_add = value.size();
 
-		//make sure there are enough bytes to hold everything
-		// if one extra bit, then need a full extra byte, so add 7 bits to round up
-		ending_bit += num_bits_to_add;
-		compressed_data.resize((ending_bit + 7) / 8);
-
-		for(auto bit : value)
+		if(num_bits_to_add <= HuffmanValueCodes::maxPackedCodeLength)
 		{
-			//compressed_data is already initialized to zeros, so only need to set if true
-			if(bit)
-				compressed_data[cur_byte] |= (1 << cur_bit);
-
-			cur_bit++;
-			if(cur_bit == 8)
+			bit_accumulator |= (value_codes.packedCodes[c] << num_accumulated_bits);
+			num_accumulated_bits += num_bits_to_add;
+		}
+		else //code is too long to pack, so write it out a bit at a time
+		{
+			for(auto bit : value)
 			{
-				cur_bit = 0;
-				cur_byte++;
+				if(bit)
+					bit_accumulator |= (1ULL << num_accumulated_bits);
+				num_accumulated_bits++;
+
+				if(num_accumulated_bits == 64)
+				{
+					for(size_t i = 0; i < 8; i++, bit_accumulator >>= 8)
+						compressed_data[cur_byte++] = static_cast<uint8_t>(bit_accumulator & 0xFF);
+					num_accumulated_bits = 0;
+				}
 			}
 		}
+
+		for(; num_accumulated_bits >= 8; num_accumulated_bits -= 8, bit_accumulator >>= 8)
+			compressed_data[cur_byte++] = static_cast<uint8_t>(bit_accumulator & 0xFF);
 	}
 
+	if(num_accumulated_bits > 0)
+		compressed_data[cur_byte] = static_cast<uint8_t>(bit_accumulator & 0xFF);
+
 	//store number of extra bits in first byte
 	compressed_data[0] = (ending_bit % 8);
 
 	return compressed_data;
 }
 
-std::string DecodeStringFromHuffmanTree(BinaryData &compressed_data, HuffmanTree<uint8_t> *huffman_tree)
+BinaryData EncodeStringFromHuffmanTree(std::string_view uncompressed_data, HuffmanTree<uint8_t> *huffman_tree)
+{
+	auto value_codes = BuildValueCodesFromHuffmanTree(huffman_tree);
+	return EncodeStringFromValueCodes(uncompressed_data, value_codes);
+}
+
+HuffmanDecodingTable::HuffmanDecodingTable(HuffmanTree<uint8_t> *huffman_tree)
+	: huffmanTree(huffman_tree)
+{
+	table.resize(static_cast<size_t>(1) << lookupBits);
+
+	//for every possible sequence of lookupBits bits, decode as many complete codes as possible
+	for(size_t bits = 0; bits < table.size(); bits++)
+	{
+		auto &entry = table[bits];
+		entry.numValues = 0;
+		entry.numBits = 0;
+
+		auto node = huffmanTree;
+		size_t num_bits_consumed = 0;
+		while(num_bits_consumed < lookupBits && entry.numValues < maxValuesPerEntry)
+		{
+			if(bits & (static_cast<size_t>(1) << num_bits_consumed))
+				node = node->right;
+			else
+				node = node->left;
+			num_bits_consumed++;
+
+			//if leaf node, then have a complete code
+			if(node->left == nullptr)
+			{
+				entry.values[entry.numValues++] = node->value;
+				entry.numBits = static_cast<uint8_t>(num_bits_consumed);
+				node = huffmanTree;
+			}
+		}
+	}
+}
+
+void HuffmanDecodingTable::DecodeBlock(const uint8_t *data, size_t data_size, std::string &out)
 {
 	//need at least one byte to represent the number of extra bits and another byte of actual value
-	if(compressed_data.size() < 2)
-		return std::string();
+	if(data_size < 2)
+		return;
 
 	//count out all the potentially available bits
-	size_t end_bit = 8 * compressed_data.size();
+	size_t end_bit = 8 * data_size;
 
 	//number of extra bits is stored in the first byte
-	if(compressed_data[0] != 0)
+	if(data[0] != 0)
 	{
 		//if there is any number besides 0, then we need to remove 8 bits and add on whatever remains
 		end_bit -= 8;
-		end_bit += compressed_data[0];
+		end_bit += data[0];
 	}
 	//skip the first byte
 	size_t start_bit = 8;
 
-	//decompress the data
-	std::string uncompressed_data;
+	//fast path: while there are enough whole bytes remaining to read lookupBits bits at any bit offset,
+	// decode as many values as possible with one table lookup
+	constexpr size_t lookup_mask = (static_cast<size_t>(1) << lookupBits) - 1;
+	while(start_bit + 24 <= end_bit)
+	{
+		size_t byte_index = (start_bit / 8);
+		uint32_t window = static_cast<uint32_t>(data[byte_index])
+			| (static_cast<uint32_t>(data[byte_index + 1]) << 8)
+			| (static_cast<uint32_t>(data[byte_index + 2]) << 16);
+		auto &entry = table[(window >> (start_bit % 8)) & lookup_mask];
+
+		if(entry.numValues > 0)
+		{
+			out.append(reinterpret_cast<const char *>(&entry.values[0]), entry.numValues);
+			start_bit += entry.numBits;
+		}
+		else //code is longer than lookupBits, so walk the tree
+		{
+			out.push_back(LookUpCode(data, start_bit, end_bit));
+		}
+	}
+
+	//decode the remainder, checking the end of the data each bit
+	while(start_bit < end_bit)
+		out.push_back(LookUpCode(data, start_bit, end_bit));
+}
+
+uint8_t HuffmanDecodingTable::LookUpCode(const uint8_t *data, size_t &start_bit, size_t end_bit)
+{
+	auto node = huffmanTree;
 	while(start_bit < end_bit)
-		uncompressed_data.push_back(huffman_tree->LookUpCode(compressed_data, start_bit, end_bit));
+	{
+		//if leaf node, then return value
+		if(node->left == nullptr)
+			return node->value;
+
+		if(data[start_bit / 8] & (1 << (start_bit % 8)))
+			node = node->right;
+		else
+			node = node->left;
+
+		start_bit++;
+	}
+
+	//if leaf node, then return value; need this again incase used up last bits
+	if(node->left == nullptr)
+		return node->value;
 
-	return uncompressed_data;
+	//shouldn't make it here -- ran out of bits
+	return 0;
 }
 
 //counts the number of bytes within bd for each value
@@ -224,17 +358,13 @@ static std::array<uint8_t, NUM_UINT8_VALUES> GetByteFrequencies(std::string &str
 	return normalized_value_counts;
 }
 
-std::pair<BinaryData, HuffmanTree<uint8_t> *> CompressString(std::string &string_to_compress)
+//appends the frequency table header for byte_frequencies to bd_out
+static void AppendByteFrequencyHeader(BinaryData &bd_out, std::array<uint8_t, NUM_UINT8_VALUES> &byte_frequencies)
 {
-	BinaryData encoded_string_with_header;
-	encoded_string_with_header.reserve(2 * NUM_UINT8_VALUES);	//reserve enough to two entries for every value in the worst case; this will be expanded later
-
-	//create and store the frequency table for each possible byte value
-	auto byte_frequencies = GetByteFrequencies(string_to_compress);
 	for(size_t i = 0; i < NUM_UINT8_VALUES; i++)
 	{
 		//write value
-		encoded_string_with_header.push_back(byte_frequencies[i]);
+		bd_out.push_back(byte_frequencies[i]);
 
 		//if zero, then run-length encoding compress
 		if(byte_frequencies[i] == 0)
@@ -246,20 +376,172 @@ std::pair<BinaryData, HuffmanTree<uint8_t> *> CompressString(std::string &string
 				num_additional_zeros++;
 				i++;
 			}
-			encoded_string_with_header.push_back(num_additional_zeros);
+			bd_out.push_back(num_additional_zeros);
 			//next loop iteration will increment i and count the first zero
 			continue;
 		}
 	}
+}
+
+//parses the frequency table header from bd starting at cur_offset, advancing cur_offset past it
+static std::array<uint8_t, NUM_UINT8_VALUES> ParseByteFrequencyHeader(BinaryData &bd, size_t &cur_offset)
+{
+	std::array<uint8_t, NUM_UINT8_VALUES> byte_frequencies{};	//initialize to zeros
+	for(size_t i = 0; i < NUM_UINT8_VALUES && cur_offset < bd.size(); i++)
+	{
+		byte_frequencies[i] = bd[cur_offset++];
+
+		//if 0, then run-length encoded
+		if(byte_frequencies[i] == 0 && cur_offset < bd.size())
+		{
+			//fill in that many zeros, but don't write beyond buffer
+			for(uint8_t num_additional_zeros = bd[cur_offset++]; num_additional_zeros > 0 && i < NUM_UINT8_VALUES; num_additional_zeros--, i++)
+				byte_frequencies[i] = 0;
+		}
+	}
+
+	return byte_frequencies;
+}
+
+//appends encoded_string to bd_out prefixed by its size
+static void AppendEncodedBlock(BinaryData &bd_out, BinaryData &encoded_string)
+{
+	UnparseIndexToCompactIndexAndAppend(bd_out, encoded_string.size());
+	bd_out.resize(bd_out.size() + encoded_string.size());
+	std::copy(begin(encoded_string), end(encoded_string), end(bd_out) - encoded_string.size());
+}
+
+//decodes each size-prefixed block in bd from cur_offset to the end of bd, appending the values to out
+static void DecodeEncodedBlocks(BinaryData &bd, size_t cur_offset, HuffmanDecodingTable &decoding_table, std::string &out)
+{
+	while(cur_offset < bd.size())
+	{
+		//read encoded string
+		size_t encoded_string_size = ParseCompactIndexToIndexAndAdvance(bd, cur_offset);
+		//check if size past end of buffer
+		if(encoded_string_size > bd.size() - cur_offset)
+			return;
+
+		decoding_table.DecodeBlock(bd.data() + cur_offset, encoded_string_size, out);
+		cur_offset += encoded_string_size;
+	}
+}
+
+std::pair<BinaryData, HuffmanTree<uint8_t> *> CompressString(std::string &string_to_compress)
+{
+	BinaryData encoded_string_with_header;
+	encoded_string_with_header.reserve(2 * NUM_UINT8_VALUES);	//reserve enough to two entries for every value in the worst case; this will be expanded later
+
+	//create and store the frequency table for each possible byte value
+	auto byte_frequencies = GetByteFrequencies(string_to_compress);
+	AppendByteFrequencyHeader(encoded_string_with_header, byte_frequencies);
 
 	//compress string
 	HuffmanTree<uint8_t> *huffman_tree = BuildTreeFromValueFrequencies<uint8_t>(byte_frequencies);
 	BinaryData encoded_string = EncodeStringFromHuffmanTree(string_to_compress, huffman_tree);
 
 	//write out compressed string
-	UnparseIndexToCompactIndexAndAppend(encoded_string_with_header, encoded_string.size());
-	encoded_string_with_header.resize(encoded_string_with_header.size() + encoded_string.size());
-	std::copy(begin(encoded_string), end(encoded_string), end(encoded_string_with_header) - encoded_string.size());
+	AppendEncodedBlock(encoded_string_with_header, encoded_string);
+
+	return {encoded_string_with_header, huffman_tree};
+}
+
+std::vector<size_t> GetCompressionChunkEnds(size_t total_size, size_t target_chunk_size,
+	std::vector<size_t> *split_offsets)
+{
+	std::vector<size_t> chunk_ends;
+	if(target_chunk_size > 0)
+	{
+		if(split_offsets == nullptr)
+		{
+			for(size_t chunk_end = target_chunk_size; chunk_end < total_size; chunk_end += target_chunk_size)
+				chunk_ends.push_back(chunk_end);
+		}
+		else
+		{
+			//split at the first allowed offset at or beyond each multiple of target_chunk_size
+			size_t cur_chunk_start = 0;
+			for(size_t offset : *split_offsets)
+			{
+				if(offset >= total_size)
+					break;
+
+				if(offset - cur_chunk_start >= target_chunk_size)
+				{
+					chunk_ends.push_back(offset);
+					cur_chunk_start = offset;
+				}
+			}
+		}
+	}
+
+	chunk_ends.push_back(total_size);
+	return chunk_ends;
+}
+
+std::pair<BinaryData, HuffmanTree<uint8_t> *> CompressStringInChunks(std::string &string_to_compress,
+	std::vector<size_t> &chunk_ends, bool run_concurrently)
+{
+	BinaryData encoded_string_with_header;
+	encoded_string_with_header.reserve(2 * NUM_UINT8_VALUES);
+
+	//all chunks share the same frequency table, which also allows for blocks to be appended later
+	auto byte_frequencies = GetByteFrequencies(string_to_compress);
+	AppendByteFrequencyHeader(encoded_string_with_header, byte_frequencies);
+
+	HuffmanTree<uint8_t> *huffman_tree = BuildTreeFromValueFrequencies<uint8_t>(byte_frequencies);
+	auto value_codes = BuildValueCodesFromHuffmanTree(huffman_tree);
+
+	std::string_view to_compress(string_to_compress);
+	size_t num_chunks = chunk_ends.size();
+	std::vector<BinaryData> encoded_chunks(num_chunks);
+
+	auto encode_chunk = [&chunk_ends, &encoded_chunks, &value_codes, &to_compress](size_t chunk_index)
+	{
+		size_t chunk_start = (chunk_index == 0 ? 0 : chunk_ends[chunk_index - 1]);
+		encoded_chunks[chunk_index] = EncodeStringFromValueCodes(
+			to_compress.substr(chunk_start, chunk_ends[chunk_index] - chunk_start), value_codes);
+	};
+
+#ifdef MULTITHREAD_SUPPORT
+	if(run_concurrently && num_chunks > 1 && Concurrency::GetMaxNumThreads() > 1)
+	{
+		auto task_set = Concurrency::urgentThreadPool.CreateCountableTaskSet(num_chunks);
+
+		auto enqueue_task_lock = Concurrency::urgentThreadPool.AcquireTaskLock();
+		for(size_t i = 0; i < num_chunks; i++)
+		{
+			Concurrency::urgentThreadPool.BatchEnqueueTask([&encode_chunk, i, &task_set]()
+			{
+				encode_chunk(i);
+				task_set.MarkTaskCompleted();
+			}
+			);
+		}
+
+		task_set.WaitForTasks(&enqueue_task_lock);
+	}
+	else
+#endif
+	{
+		for(size_t i = 0; i < num_chunks; i++)
+			encode_chunk(i);
+	}
+
+	//write the chunk index of uncompressed and compressed sizes
+	UnparseIndexToCompactIndexAndAppend(encoded_string_with_header, num_chunks);
+	size_t total_encoded_size = 0;
+	for(size_t i = 0; i < num_chunks; i++)
+	{
+		size_t chunk_start = (i == 0 ? 0 : chunk_ends[i - 1]);
+		UnparseIndexToCompactIndexAndAppend(encoded_string_with_header, chunk_ends[i] - chunk_start);
+		UnparseIndexToCompactIndexAndAppend(encoded_string_with_header, encoded_chunks[i].size());
+		total_encoded_size += encoded_chunks[i].size();
+	}
+
+	encoded_string_with_header.reserve(encoded_string_with_header.size() + total_encoded_size);
+	for(auto &chunk : encoded_chunks)
+		encoded_string_with_header.insert(end(encoded_string_with_header), begin(chunk), end(chunk));
 
 	return {encoded_string_with_header, huffman_tree};
 }
@@ -269,48 +551,122 @@ BinaryData CompressStringToAppend(std::string &string_to_compress, HuffmanTree<u
 	BinaryData encoded_string = EncodeStringFromHuffmanTree(string_to_compress, huffman_tree);
 
 	BinaryData encoded_string_with_header;
-	UnparseIndexToCompactIndexAndAppend(encoded_string_with_header, encoded_string.size());
-	encoded_string_with_header.resize(encoded_string_with_header.size() + encoded_string.size());
-	std::copy(begin(encoded_string), end(encoded_string), end(encoded_string_with_header) - encoded_string.size());
+	AppendEncodedBlock(encoded_string_with_header, encoded_string);
 	return encoded_string_with_header;
 }
 
 std::string DecompressString(BinaryData &encoded_string_library)
 {
-	std::string decompressed_string;
 	size_t cur_offset = 0;
 
 	//read the frequency table for each possible byte value
-	std::array<uint8_t, NUM_UINT8_VALUES> byte_frequencies{};	//initialize to zeros
-	for(size_t i = 0; i < NUM_UINT8_VALUES && cur_offset < encoded_string_library.size(); i++)
+	auto byte_frequencies = ParseByteFrequencyHeader(encoded_string_library, cur_offset);
+	std::unique_ptr<HuffmanTree<uint8_t>> huffman_tree(BuildTreeFromValueFrequencies<uint8_t>(byte_frequencies));
+	HuffmanDecodingTable decoding_table(huffman_tree.get());
+
+	//decompress and concatenate all compressed blocks
+	std::string decompressed_string;
+	DecodeEncodedBlocks(encoded_string_library, cur_offset, decoding_table, decompressed_string);
+	return decompressed_string;
+}
+
+ChunkedCompressedData::ChunkedCompressedData(BinaryData &encoded_data)
+	: encodedData(encoded_data), totalUncompressedSize(0), appendedBlocksOffset(encoded_data.size()), valid(false)
+{
+	size_t cur_offset = 0;
+	auto byte_frequencies = ParseByteFrequencyHeader(encodedData, cur_offset);
+	huffmanTree.reset(BuildTreeFromValueFrequencies<uint8_t>(byte_frequencies));
+	decodingTable = std::make_unique<HuffmanDecodingTable>(huffmanTree.get());
+
+	if(cur_offset >= encodedData.size())
+		return;
+
+	size_t num_chunks = ParseCompactIndexToIndexAndAdvance(encodedData, cur_offset);
+	//each chunk needs at least two bytes in the index, so reject anything that couldn't fit
+	if(num_chunks > (encodedData.size() - cur_offset) / 2)
+		return;
+
+	chunks.resize(num_chunks);
+	for(auto &chunk : chunks)
 	{
-		byte_frequencies[i] = encoded_string_library[cur_offset++];
+		chunk.uncompressedSize = ParseCompactIndexToIndexAndAdvance(encodedData, cur_offset);
+		chunk.compressedSize = ParseCompactIndexToIndexAndAdvance(encodedData, cur_offset);
+	}
 
-		//if 0, then run-length encoded
-		if(byte_frequencies[i] == 0)
+	//chunk data immediately follows the index
+	for(auto &chunk : chunks)
+	{
+		chunk.compressedOffset = cur_offset;
+		if(chunk.compressedSize > encodedData.size() - cur_offset)
+			return;
+		cur_offset += chunk.compressedSize;
+
+		//every code is at least one bit and the first byte holds the number of extra bits,
+		// so a chunk can't decode to more than 8 values per byte; reject corrupt sizes rather than allocating them
+		if(chunk.uncompressedSize > 8 * chunk.compressedSize)
+			return;
+		totalUncompressedSize += chunk.uncompressedSize;
+	}
+
+	appendedBlocksOffset = cur_offset;
+	valid = true;
+}
+
+void ChunkedCompressedData::DecompressChunk(size_t chunk_index, std::string &out)
+{
+	auto &chunk = chunks[chunk_index];
+	out.reserve(out.size() + chunk.uncompressedSize);
+	decodingTable->DecodeBlock(encodedData.data() + chunk.compressedOffset, chunk.compressedSize, out);
+}
+
+std::string ChunkedCompressedData::DecompressAll(bool run_concurrently)
+{
+	std::string decompressed_string;
+	if(!valid)
+		return decompressed_string;
+
+	size_t num_chunks = chunks.size();
+
+#ifdef MULTITHREAD_SUPPORT
+	if(run_concurrently && num_chunks > 1 && Concurrency::GetMaxNumThreads() > 1)
+	{
+		std::vector<std::string> decompressed_chunks(num_chunks);
+		auto task_set = Concurrency::urgentThreadPool.CreateCountableTaskSet(num_chunks);
+
+		auto enqueue_task_lock = Concurrency::urgentThreadPool.AcquireTaskLock();
+		for(size_t i = 0; i < num_chunks; i++)
 		{
-			//fill in that many zeros, but don't write beyond buffer
-			for(uint8_t num_additional_zeros = encoded_string_library[cur_offset++]; num_additional_zeros > 0 && i < NUM_UINT8_VALUES; num_additional_zeros--, i++)
-				byte_frequencies[i] = 0;
+			Concurrency::urgentThreadPool.BatchEnqueueTask([this, &decompressed_chunks, i, &task_set]()
+			{
+				DecompressChunk(i, decompressed_chunks[i]);
+				task_set.MarkTaskCompleted();
+			}
+			);
 		}
-	}
 
-	//decompress and concatenate all compressed blocks
-	while(cur_offset < encoded_string_library.size())
+		task_set.WaitForTasks(&enqueue_task_lock);
+
+		decompressed_string.reserve(totalUncompressedSize);
+		for(auto &chunk_string : decompressed_chunks)
+		{
+			decompressed_string += chunk_string;
+			//free memory as soon as possible
+			std::string().swap(chunk_string);
+		}
+	}
+	else
+#endif
 	{
-		//read encoded string
-		size_t encoded_strings_size = ParseCompactIndexToIndexAndAdvance(encoded_string_library, cur_offset);
-		//check if size past end of buffer
-		if(cur_offset + encoded_strings_size > encoded_string_library.size())
-			return decompressed_string;
-		BinaryData encoded_strings(begin(encoded_string_library) + cur_offset, begin(encoded_string_library) + cur_offset + encoded_strings_size);
-		cur_offset += encoded_strings_size;
-
-		//decode compressed string buffer
-		HuffmanTree<uint8_t> *huffman_tree = BuildTreeFromValueFrequencies<uint8_t>(byte_frequencies);
-		std::string cur_decoded = DecodeStringFromHuffmanTree(encoded_strings, huffman_tree);
-		decompressed_string += cur_decoded;
+		decompressed_string.reserve(totalUncompressedSize);
+		for(size_t i = 0; i < num_chunks; i++)
+			DecompressChunk(i, decompressed_string);
 	}
 
+	DecompressAppendedBlocks(decompressed_string);
 	return decompressed_string;
 }
+
+void ChunkedCompressedData::DecompressAppendedBlocks(std::string &out)
+{
+	DecodeEncodedBlocks(encodedData, appendedBlocksOffset, *decodingTable, out);
+}
@@ -2,13 +2,18 @@
 
 //system headers:
 #include <limits>
+#include <memory>
 #include <stdint.h>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
 typedef std::vector<uint8_t> BinaryData;
 
+//default target number of uncompressed bytes per independently encoded chunk when compressing in chunks
+constexpr size_t DEFAULT_COMPRESSION_CHUNK_SIZE = 4 * 1024 * 1024;
+
 //Huffman Encoding implementation for compressing and decompressing data
 template<typename value_type>
 class HuffmanTree
@@ -102,8 +107,104 @@ public:
 //caller is responsible for deleting the huffman tree
 std::pair<BinaryData, HuffmanTree<uint8_t> *> CompressString(std::string &string_to_compress);
 
+//returns the end offsets of chunks of at least target_chunk_size bytes for a string of total_size bytes,
+// the last of which is always total_size
+//if split_offsets is not nullptr, then it will only split chunks at the sorted offsets it contains
+//if target_chunk_size is 0, then there will only be one chunk
+std::vector<size_t> GetCompressionChunkEnds(size_t total_size, size_t target_chunk_size,
+	std::vector<size_t> *split_offsets = nullptr);
+
+//like CompressString, but encodes string_to_compress as independently decodable chunks ending at each offset
+// in chunk_ends, preceded by an index of the chunks, encoding the chunks concurrently if run_concurrently is true
+//all chunks share the same huffman tree so that CompressStringToAppend can be used to append to the data
+//the result can be decompressed via ChunkedCompressedData, but not DecompressString, so the layout must be recorded
+// by whatever stores the data
+std::pair<BinaryData, HuffmanTree<uint8_t> *> CompressStringInChunks(std::string &string_to_compress,
+	std::vector<size_t> &chunk_ends, bool run_concurrently);
+
 //like CompressString, but uses a huffman_tree to generate a string that can be appended to a previous compressed string
 BinaryData CompressStringToAppend(std::string &string_to_compress, HuffmanTree<uint8_t> *huffman_tree);
 
 //given encoded_string returns the decompressed, decoded string
 std::string DecompressString(BinaryData &encoded_string);
+
+//table-driven decoder for data encoded via a HuffmanTree<uint8_t>
+//decodes as many values as fit within lookupBits with one table lookup, and falls back to walking the tree for longer codes
+class HuffmanDecodingTable
+{
+public:
+	//huffman_tree must remain valid for the lifetime of the table
+	HuffmanDecodingTable(HuffmanTree<uint8_t> *huffman_tree);
+
+	//decodes one encoded block of data_size bytes starting at data, as generated by the compression functions,
+	// appending the values to out
+	void DecodeBlock(const uint8_t *data, size_t data_size, std::string &out);
+
+protected:
+	//looks up the next value by walking the tree from the bits in data from start_bit up until end_bit
+	//increments start_bit based on the length of the code consumed
+	uint8_t LookUpCode(const uint8_t *data, size_t &start_bit, size_t end_bit);
+
+	//number of bits used to index the table
+	static constexpr size_t lookupBits = 12;
+
+	//maximum number of values decoded per table entry
+	static constexpr size_t maxValuesPerEntry = 4;
+
+	struct TableEntry
+	{
+		uint8_t values[maxValuesPerEntry];
+		//number of values decoded, 0 if the first code is longer than lookupBits
+		uint8_t numValues;
+		//number of bits consumed by the values
+		uint8_t numBits;
+	};
+
+	std::vector<TableEntry> table;
+	HuffmanTree<uint8_t> *huffmanTree;
+};
+
+//location of an independently decodable chunk within data compressed by CompressStringInChunks
+struct CompressedChunk
+{
+	//size of the chunk when decompressed
+	size_t uncompressedSize;
+	//position of the chunk within the compressed data
+	size_t compressedOffset;
+	size_t compressedSize;
+};
+
+//provides decompression of data compressed by CompressStringInChunks,
+// including any blocks appended afterward via CompressStringToAppend
+class ChunkedCompressedData
+{
+public:
+	//parses the chunk index of encoded_data, which must remain valid for the lifetime of this object
+	ChunkedCompressedData(BinaryData &encoded_data);
+
+	//returns true if the chunk index was parsed successfully and is consistent with the size of the data
+	constexpr bool IsValid()
+	{
+		return valid;
+	}
+
+	//decompresses all of the chunks followed by any appended blocks, decompressing chunks concurrently if run_concurrently
+	std::string DecompressAll(bool run_concurrently);
+
+protected:
+	//decompresses the chunk at chunk_index, appending it to out
+	void DecompressChunk(size_t chunk_index, std::string &out);
+
+	//decompresses any blocks appended after the chunks, appending them to out
+	void DecompressAppendedBlocks(std::string &out);
+
+	BinaryData &encodedData;
+	std::unique_ptr<HuffmanTree<uint8_t>> huffmanTree;
+	std::unique_ptr<HuffmanDecodingTable> decodingTable;
+	std::vector<CompressedChunk> chunks;
+	//sum of the uncompressed sizes of all chunks
+	size_t totalUncompressedSize;
+	//offset where any blocks appended after the chunks begin
+	size_t appendedBlocksOffset;
+	bool valid;
+};
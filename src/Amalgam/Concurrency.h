@@ -12,8 +12,10 @@
 #endif
 
 //system headers:
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
+#include <vector>
 
 #if defined(MULTITHREAD_SUPPORT) || defined(_OPENMP)
 
@@ -123,3 +125,82 @@ inline void IterateOverConcurrentlyIfPossible(ContainerType &container, Function
 		index++;
 	}
 }
+
+//sorts container with the semantics of std::stable_sort using compare
+//if run_concurrently is true and the container is large enough, sorts blocks of the container concurrently
+// and merges them; because the sort is stable, the result is the same regardless of the number of threads
+template<typename ElementType, typename CompareFunction>
+inline void StableSortConcurrentlyIfPossible(std::vector<ElementType> &container, CompareFunction compare,
+	bool run_concurrently = true)
+{
+#ifdef MULTITHREAD_SUPPORT
+	//minimum number of elements to sort per block to make a task worthwhile
+	constexpr size_t min_block_size = 16384;
+
+	size_t num_elements = container.size();
+	size_t num_threads = Concurrency::GetMaxNumThreads();
+	if(run_concurrently && num_threads > 1 && num_elements >= 2 * min_block_size)
+	{
+		size_t num_blocks = std::min(num_threads, num_elements / min_block_size);
+		std::vector<size_t> block_bounds(num_blocks + 1);
+		for(size_t i = 0; i <= num_blocks; i++)
+			block_bounds[i] = num_elements * i / num_blocks;
+
+		{
+			auto task_set = Concurrency::urgentThreadPool.CreateCountableTaskSet(num_blocks);
+			for(size_t i = 0; i < num_blocks; i++)
+				Concurrency::urgentThreadPool.EnqueueTask(
+					[&container, &compare, &block_bounds, &task_set, i]
+					{
+						std::stable_sort(begin(container) + block_bounds[i], begin(container) + block_bounds[i + 1], compare);
+						task_set.MarkTaskCompleted();
+					});
+			task_set.WaitForTasks();
+		}
+
+		//merge pairs of adjacent blocks back and forth between the buffers until one block remains
+		std::vector<ElementType> buffer(num_elements);
+		std::vector<ElementType> *source = &container;
+		std::vector<ElementType> *destination = &buffer;
+		while(num_blocks > 1)
+		{
+			size_t num_merged_blocks = (num_blocks + 1) / 2;
+			auto task_set = Concurrency::urgentThreadPool.CreateCountableTaskSet(num_merged_blocks);
+			for(size_t i = 0; i < num_merged_blocks; i++)
+				Concurrency::urgentThreadPool.EnqueueTask(
+					[source, destination, &compare, &block_bounds, &task_set, num_blocks, i]
+					{
+						size_t start = block_bounds[2 * i];
+						if(2 * i + 1 < num_blocks)
+						{
+							size_t middle = block_bounds[2 * i + 1];
+							size_t end = block_bounds[2 * i + 2];
+							std::merge(begin(*source) + start, begin(*source) + middle,
+								begin(*source) + middle, begin(*source) + end, begin(*destination) + start, compare);
+						}
+						else //odd block out, just copy
+						{
+							std::copy(begin(*source) + start, begin(*source) + block_bounds[num_blocks],
+								begin(*destination) + start);
+						}
+						task_set.MarkTaskCompleted();
+					});
+			task_set.WaitForTasks();
+
+			for(size_t i = 0; i < num_merged_blocks; i++)
+				block_bounds[i] = block_bounds[2 * i];
+			block_bounds[num_merged_blocks] = num_elements;
+			block_bounds.resize(num_merged_blocks + 1);
+
+			num_blocks = num_merged_blocks;
+			std::swap(source, destination);
+		}
+
+		if(source != &container)
+			container.swap(buffer);
+		return;
+	}
+#endif
+
+	std::stable_sort(begin(container), end(container), compare);
+}
@@ -1,9 +1,17 @@
 //project headers:
 #include "Concurrency.h"
 #include "DateTimeFormat.h"
+#include "HashMaps.h"
 
 #include "PlatformSpecific.h"
 
+//system headers:
+#include <cctype>
+#include <cmath>
+#include <memory>
+#include <string_view>
+#include <vector>
+
 //3rd party headers:
 //TODO: remove this library once the C++20 date-time library is fully supported across all platforms
 // (in particular WASM and CLANG)
@@ -215,7 +223,7 @@ std::vector<date::zoned_time<std::common_type_t<Duration, std::chrono::seconds>>
 
 //returns the time_zone corresponding with the string timezone
 // if timezone is an abbreviation, it will only select a timezone if it is a unique timezone corresponding to the abbreviation
-const date::time_zone *GetTimeZoneFromString(std::string timezone)
+const date::time_zone *LookUpTimeZoneFromString(const std::string &timezone)
 {
 	// if timezone wasn't specified, return local timezone
 	if(timezone.empty())
@@ -244,65 +252,569 @@ const date::time_zone *GetTimeZoneFromString(std::string timezone)
 }
 
 
-//don't pass locale by reference so can default it
-double GetNumSecondsSinceEpochFromDateTimeString(std::string &datetime_str,
-	std::string &format, std::string &locale, std::string &timezone)
-{
-	bool has_time_offset = ConstrainDateTimeStringToValidFormat(format);
-
-	std::chrono::system_clock::time_point dt;
-	std::string in_date_timezone = "";
+//maximum number of time zones and format plans cached per thread before the cache is cleared,
+// which bounds memory when the strings are dynamically generated
+constexpr size_t maxCachedDateTimeEntries = 256;
 
+//returns the time_zone corresponding with the string timezone via LookUpTimeZoneFromString, caching the result
+// because looking up a zone, and especially an abbreviation, is expensive
+const date::time_zone *GetTimeZoneFromString(const std::string &timezone)
+{
 #if defined(MULTITHREAD_SUPPORT)
-	thread_local static CachedLocale cached_locale;
+	thread_local static FastHashMap<std::string, const date::time_zone *> time_zones;
 #else
-	static CachedLocale cached_locale;
+	static FastHashMap<std::string, const date::time_zone *> time_zones;
 #endif
 
-	cached_locale.ResetStringStream(datetime_str);
+	auto found = time_zones.find(timezone);
+	if(found != end(time_zones))
+		return found->second;
 
-	if(!locale.empty())
+	if(time_zones.size() >= maxCachedDateTimeEntries)
+		time_zones.clear();
+
+	const date::time_zone *tz = LookUpTimeZoneFromString(timezone);
+	time_zones.emplace(timezone, tz);
+	return tz;
+}
+
+//appends value to s, padded on the left with pad_char to at least num_digits
+inline void AppendPaddedNumber(std::string &s, unsigned value, size_t num_digits, char pad_char = '0')
+{
+	char digits[16];
+	size_t num_value_digits = 0;
+	do
+	{
+		digits[num_value_digits++] = static_cast<char>('0' + value % 10);
+		value /= 10;
+	} while(value > 0);
+
+	for(size_t i = num_value_digits; i < num_digits; i++)
+		s.push_back(pad_char);
+	while(num_value_digits > 0)
+		s.push_back(digits[--num_value_digits]);
+}
+
+//a date or time format string compiled into tokens so that the common format specifiers can be parsed
+// and formatted directly rather than through iostreams
+//formats that have a locale or any other specifiers are handled by the date library
+class DateTimeFormatPlan
+{
+public:
+	//a literal string, or a format specifier if specifier is not '\0'
+	struct Token
+	{
+		char specifier;
+		std::string literal;
+	};
+
+	//compiles format for locale and timezone; if time_only, then the format is for a time of day
+	DateTimeFormatPlan(const std::string &_format, const std::string &locale, const std::string &timezone, bool time_only)
+		: format(_format), hasTimeOffset(false), isMonthAndYearOnly(false),
+		parseTimeZone(nullptr), formatTimeZone(nullptr), canParseDirectly(false), canFormatDirectly(false)
 	{
 		//make sure it's utf-8
-		locale += ".utf-8";
-		//if the locale is valid, use it
-		try
+		if(!locale.empty())
+			localeName = locale + ".utf-8";
+
+		if(!time_only)
 		{
-			cached_locale.UpdateLocaleIfNeeded(locale);
+			hasTimeOffset = ConstrainDateTimeStringToValidFormat(format);
+			isMonthAndYearOnly = IsFormatMonthAndYearOnly(format);
+
+			//if there is no timezone parsed, but the format has a time offset provided via %z, the offset is UTC
+			parseTimeZone = GetTimeZoneFromString(hasTimeOffset ? std::string("UTC") : timezone);
+			//if there is no timezone defined, but the format has a time offset provided via %z, assume the offset is UTC
+			formatTimeZone = GetTimeZoneFromString(timezone.empty() && hasTimeOffset ? std::string("UTC") : timezone);
 		}
-		catch(...)
+
+		//names and symbols are only known for the default locale
+		if(!localeName.empty())
+			return;
+
+		std::string_view parse_specifiers = (time_only ? "" : "%YmdHMSFTRz");
+		std::string_view format_specifiers = (time_only ? "%HMSTRIpnt" : "%YmdeHMSFTRDyCjuwaAbBhIpzZnt");
+		canParseDirectly = !time_only;
+		canFormatDirectly = true;
+
+		std::string literal;
+		for(size_t i = 0; i < format.size(); i++)
 		{
+			if(format[i] != '%')
+			{
+				literal.push_back(format[i]);
+				continue;
+			}
+
+			if(!literal.empty())
+			{
+				tokens.push_back(Token{ '\0', literal });
+				literal.clear();
+			}
+
+			if(i + 1 >= format.size())
+			{
+				canParseDirectly = false;
+				canFormatDirectly = false;
+				break;
+			}
+
+			char specifier = format[++i];
+			if(parse_specifiers.find(specifier) == std::string_view::npos)
+				canParseDirectly = false;
+			if(format_specifiers.find(specifier) == std::string_view::npos)
+				canFormatDirectly = false;
+			tokens.push_back(Token{ specifier, std::string() });
 		}
+
+		if(!literal.empty())
+			tokens.push_back(Token{ '\0', literal });
 	}
 
-	try
+	//parses s into dt with the same semantics as date::parse, returning true on success
+	//returns false if s could not be parsed directly, in which case the date library should be used
+	bool ParseDirectly(std::string_view s, std::chrono::system_clock::time_point &dt)
 	{
-		if(IsFormatMonthAndYearOnly(format))
+		if(!canParseDirectly)
+			return false;
+
+		using clock_duration = std::chrono::system_clock::duration;
+		//the number of characters of seconds read by date::parse, including the decimal point and fraction
+		constexpr unsigned max_seconds_width = (clock_duration::period::den == 1 ? 2
+			: 3 + date::detail::decimal_format_seconds<clock_duration>::width);
+
+		int year = -1;
+		int month = -1;
+		int day = -1;
+		int hour = -1;
+		int minute = -1;
+		clock_duration seconds = clock_duration::min();
+		int offset_minutes = std::numeric_limits<int>::min();
+		size_t pos = 0;
+
+		//reads up to max_digits digits into value, which must not have already been read
+		auto read_number = [&s, &pos](int &value, size_t max_digits)
 		{
-			//month and year only dates must be parsed specifically into year_month 
-			date::year_month ym;
-			cached_locale.stringStream >> date::parse(format, ym, in_date_timezone);
+			if(value != -1)
+				return false;
+
+			size_t start = pos;
+			int x = 0;
+			while(pos < s.size() && pos - start < max_digits && s[pos] >= '0' && s[pos] <= '9')
+			{
+				x = 10 * x + (s[pos] - '0');
+				pos++;
+			}
+
+			if(pos == start)
+				return false;
+
+			value = x;
+			return true;
+		};
+
+		auto read_char = [&s, &pos](char c)
+		{
+			if(pos >= s.size() || s[pos] != c)
+				return false;
+			pos++;
+			return true;
+		};
+
+		auto read_seconds = [&s, &pos, &seconds]()
+		{
+			if(seconds != clock_duration::min())
+				return false;
+
+			unsigned count = 0;
+			unsigned fraction_count = 0;
+			unsigned long long integer_part = 0;
+			unsigned long long fraction_part = 0;
+			bool parsing_fraction = false;
+			while(pos < s.size())
+			{
+				char c = s[pos];
+				if(c == '.' && !parsing_fraction)
+				{
+					parsing_fraction = true;
+				}
+				else if(c >= '0' && c <= '9')
+				{
+					if(parsing_fraction)
+					{
+						fraction_part = 10 * fraction_part + (c - '0');
+						fraction_count++;
+					}
+					else
+					{
+						integer_part = 10 * integer_part + (c - '0');
+					}
+				}
+				else
+				{
+					break;
+				}
+
+				pos++;
+				if(++count == max_seconds_width)
+					break;
+			}
+
+			if(count == 0)
+				return false;
+
+			long double value = static_cast<long double>(integer_part)
+				+ static_cast<long double>(fraction_part) / std::pow(10.L, fraction_count);
+			seconds = date::detail::round_i<clock_duration>(std::chrono::duration<long double>(value));
+			return true;
+		};
+
+		for(auto &token : tokens)
+		{
+			bool success = true;
+			switch(token.specifier)
+			{
+			case '\0':
+				for(char c : token.literal)
+				{
+					//whitespace matches zero or more whitespace characters
+					if(std::isspace(static_cast<unsigned char>(c)))
+					{
+						while(pos < s.size() && std::isspace(static_cast<unsigned char>(s[pos])))
+							pos++;
+					}
+					else if(!read_char(c))
+					{
+						return false;
+					}
+				}
+				break;
+
+			case '%':	success = read_char('%');				break;
+			case 'Y':	success = read_number(year, 4);		break;
+			case 'm':	success = read_number(month, 2);		break;
+			case 'd':	success = read_number(day, 2);		break;
+			case 'H':	success = read_number(hour, 2);		break;
+			case 'M':	success = read_number(minute, 2);		break;
+			case 'S':	success = read_seconds();				break;
+
+			case 'F':
+				success = read_number(year, 4) && read_char('-') && read_number(month, 2)
+					&& read_char('-') && read_number(day, 2);
+				break;
+
+			case 'T':
+				success = read_number(hour, 2) && read_char(':') && read_number(minute, 2)
+					&& read_char(':') && read_seconds();
+				break;
+
+			case 'R':
+				success = read_number(hour, 2) && read_char(':') && read_number(minute, 2);
+				break;
+
+			case 'z':
+			{
+				if(offset_minutes != std::numeric_limits<int>::min())
+					return false;
+
+				//require an explicit sign; anything else is left to the date library
+				if(pos >= s.size() || (s[pos] != '-' && s[pos] != '+'))
+					return false;
+				bool negative = (s[pos] == '-');
+				pos++;
+
+				//hours must be two digits, optionally followed by two digits of minutes
+				int offset_hours = -1;
+				size_t start = pos;
+				if(!read_number(offset_hours, 2) || pos - start != 2)
+					return false;
+
+				int offset_additional_minutes = 0;
+				if(pos < s.size() && s[pos] >= '0' && s[pos] <= '9')
+				{
+					offset_additional_minutes = -1;
+					start = pos;
+					if(!read_number(offset_additional_minutes, 2) || pos - start != 2)
+						return false;
+				}
+
+				offset_minutes = 60 * offset_hours + offset_additional_minutes;
+				if(negative)
+					offset_minutes = -offset_minutes;
+				break;
+			}
+
+			default:
+				return false;
+			}
+
+			if(!success)
+				return false;
+		}
+
+		if(isMonthAndYearOnly)
+		{
+			if(year == -1 || month < 1 || month > 12)
+				return false;
+
 			//convert to time_point by specifying the day to be 1 for the parsed year month
-			dt = date::sys_days{ ym / 1 };
+			dt = date::sys_days{ date::year{ year } / month / 1 };
+			return true;
 		}
-		else
+
+		if(year == -1 || month == -1 || day == -1)
+			return false;
+
+		date::year_month_day ymd = date::year{ year } / month / day;
+		if(!ymd.ok())
+			return false;
+
+		//time must be within the conventional range
+		if(hour > 23 || minute > 59 || (seconds != clock_duration::min() && seconds >= std::chrono::minutes(1)))
+			return false;
+
+		dt = date::sys_days{ ymd };
+		if(hour != -1)
+			dt += std::chrono::hours(hour);
+		if(minute != -1)
+			dt += std::chrono::minutes(minute);
+		if(seconds != clock_duration::min())
+			dt += seconds;
+		if(offset_minutes != std::numeric_limits<int>::min())
+			dt -= std::chrono::minutes(offset_minutes);
+
+		return true;
+	}
+
+	//appends local_time formatted with the same output as date::format to out, returning true on success
+	//info is the time zone information for %z and %Z, and may be nullptr if the plan is for a time of day
+	//returns false if local_time could not be formatted directly, in which case the date library should be used
+	bool FormatDirectly(date::local_seconds local_time, const date::sys_info *info, std::string &out)
+	{
+		if(!canFormatDirectly)
+			return false;
+
+		static const char *weekday_names[] = { "Sunday", "Monday", "Tuesday", "Wednesday", "Thursday", "Friday", "Saturday" };
+		static const char *month_names[] = { "January", "February", "March", "April", "May", "June",
+			"July", "August", "September", "October", "November", "December" };
+
+		auto local_days = date::floor<date::days>(local_time);
+		date::year_month_day ymd(local_days);
+		int year = static_cast<int>(ymd.year());
+		if(year < 0 || year > 9999)
+			return false;
+
+		unsigned y = static_cast<unsigned>(year);
+		unsigned month = static_cast<unsigned>(ymd.month());
+		unsigned day = static_cast<unsigned>(ymd.day());
+		date::weekday weekday(local_days);
+		date::hh_mm_ss<std::chrono::seconds> time_of_day(local_time - local_days);
+		unsigned hours = static_cast<unsigned>(time_of_day.hours().count());
+		unsigned minutes = static_cast<unsigned>(time_of_day.minutes().count());
+		unsigned seconds = static_cast<unsigned>(time_of_day.seconds().count());
+
+		for(auto &token : tokens)
 		{
-			//parse string into dt and if there was a timezone in the string, stores that into in_date_timezone
-			cached_locale.stringStream >> date::parse(format, dt, in_date_timezone);
+			switch(token.specifier)
+			{
+			case '\0':	out.append(token.literal);									break;
+			case '%':	out.push_back('%');											break;
+			case 'n':	out.push_back('\n');										break;
+			case 't':	out.push_back('\t');										break;
+			case 'Y':	AppendPaddedNumber(out, y, 4);								break;
+			case 'C':	AppendPaddedNumber(out, y / 100, 2);						break;
+			case 'y':	AppendPaddedNumber(out, y % 100, 2);						break;
+			case 'm':	AppendPaddedNumber(out, month, 2);							break;
+			case 'd':	AppendPaddedNumber(out, day, 2);							break;
+			case 'e':	AppendPaddedNumber(out, day, 2, ' ');						break;
+			case 'H':	AppendPaddedNumber(out, hours, 2);							break;
+			case 'I':	AppendPaddedNumber(out, hours % 12 == 0 ? 12 : hours % 12, 2);	break;
+			case 'M':	AppendPaddedNumber(out, minutes, 2);						break;
+			case 'S':	AppendPaddedNumber(out, seconds, 2);						break;
+			case 'p':	out.append(hours < 12 ? "AM" : "PM");						break;
+			case 'u':	AppendPaddedNumber(out, weekday.iso_encoding(), 1);			break;
+			case 'w':	AppendPaddedNumber(out, weekday.c_encoding(), 1);			break;
+			case 'a':	out.append(weekday_names[weekday.c_encoding()], 3);			break;
+			case 'A':	out.append(weekday_names[weekday.c_encoding()]);			break;
+			case 'b':
+			case 'h':	out.append(month_names[month - 1], 3);						break;
+			case 'B':	out.append(month_names[month - 1]);							break;
+
+			case 'j':
+			{
+				auto day_of_year = (local_days - date::local_days(ymd.year() / 1 / 1)).count() + 1;
+				AppendPaddedNumber(out, static_cast<unsigned>(day_of_year), 3);
+				break;
+			}
+
+			case 'F':
+				AppendPaddedNumber(out, y, 4);
+				out.push_back('-');
+				AppendPaddedNumber(out, month, 2);
+				out.push_back('-');
+				AppendPaddedNumber(out, day, 2);
+				break;
+
+			case 'D':
+				AppendPaddedNumber(out, month, 2);
+				out.push_back('/');
+				AppendPaddedNumber(out, day, 2);
+				out.push_back('/');
+				AppendPaddedNumber(out, y % 100, 2);
+				break;
+
+			case 'T':
+			case 'R':
+				AppendPaddedNumber(out, hours, 2);
+				out.push_back(':');
+				AppendPaddedNumber(out, minutes, 2);
+				if(token.specifier == 'T')
+				{
+					out.push_back(':');
+					AppendPaddedNumber(out, seconds, 2);
+				}
+				break;
+
+			case 'z':
+			{
+				if(info == nullptr)
+					return false;
+
+				auto offset = std::chrono::duration_cast<std::chrono::minutes>(info->offset).count();
+				out.push_back(offset < 0 ? '-' : '+');
+				offset = std::abs(offset);
+				AppendPaddedNumber(out, static_cast<unsigned>(offset / 60), 2);
+				AppendPaddedNumber(out, static_cast<unsigned>(offset % 60), 2);
+				break;
+			}
+
+			case 'Z':
+				if(info == nullptr)
+					return false;
+				out.append(info->abbrev);
+				break;
+
+			default:
+				return false;
+			}
 		}
+
+		return true;
 	}
-	catch(...)
+
+	//format string, constrained to valid specifiers if the format is for a date
+	std::string format;
+
+	//name of the locale including encoding, empty if the default locale
+	std::string localeName;
+
+	//true if the format is for a date and contains a %z offset
+	bool hasTimeOffset;
+
+	//true if the format is for a date and only contains a year and month
+	bool isMonthAndYearOnly;
+
+	//time zones used when parsing and formatting dates
+	const date::time_zone *parseTimeZone;
+	const date::time_zone *formatTimeZone;
+
+	//the format as literals and specifiers
+	std::vector<Token> tokens;
+
+	//true if all of the tokens can be parsed or formatted directly
+	bool canParseDirectly;
+	bool canFormatDirectly;
+};
+
+//returns the plan for format, locale, and timezone, compiling and caching it per thread if it has not been used
+//the reference is valid until the next call on the same thread
+DateTimeFormatPlan &GetDateTimeFormatPlan(const std::string &format, const std::string &locale,
+	const std::string &timezone, bool time_only)
+{
+#if defined(MULTITHREAD_SUPPORT)
+	thread_local static FastHashMap<std::string, std::unique_ptr<DateTimeFormatPlan>> plans;
+	thread_local static std::string key;
+#else
+	static FastHashMap<std::string, std::unique_ptr<DateTimeFormatPlan>> plans;
+	static std::string key;
+#endif
+
+	key.clear();
+	key.push_back(time_only ? 't' : 'd');
+	key.append(format);
+	key.push_back('\0');
+	key.append(locale);
+	key.push_back('\0');
+	key.append(timezone);
+
+	auto found = plans.find(key);
+	if(found != end(plans))
+		return *found->second;
+
+	if(plans.size() >= maxCachedDateTimeEntries)
+		plans.clear();
+
+	auto [inserted, _] = plans.emplace(key, std::make_unique<DateTimeFormatPlan>(format, locale, timezone, time_only));
+	return *inserted->second;
+}
+
+
+double GetNumSecondsSinceEpochFromDateTimeString(const std::string &datetime_str,
+	const std::string &format, const std::string &locale, const std::string &timezone)
+{
+	auto &plan = GetDateTimeFormatPlan(format, locale, timezone, false);
+
+	std::chrono::system_clock::time_point dt;
+	std::string in_date_timezone = "";
+
+	if(!plan.ParseDirectly(datetime_str, dt))
 	{
+	#if defined(MULTITHREAD_SUPPORT)
+		thread_local static CachedLocale cached_locale;
+	#else
+		static CachedLocale cached_locale;
+	#endif
+
+		cached_locale.ResetStringStream(datetime_str);
+
+		if(!plan.localeName.empty())
+		{
+			//if the locale is valid, use it
+			try
+			{
+				cached_locale.UpdateLocaleIfNeeded(plan.localeName);
+			}
+			catch(...)
+			{
+			}
+		}
+
+		try
+		{
+			if(plan.isMonthAndYearOnly)
+			{
+				//month and year only dates must be parsed specifically into year_month
+				//start at the epoch so a failed parse yields the same as for other formats
+				date::year_month ym{ date::year{ 1970 }, date::January };
+				cached_locale.stringStream >> date::parse(plan.format, ym, in_date_timezone);
+				//convert to time_point by specifying the day to be 1 for the parsed year month
+				dt = date::sys_days{ ym / 1 };
+			}
+			else
+			{
+				//parse string into dt and if there was a timezone in the string, stores that into in_date_timezone
+				cached_locale.stringStream >> date::parse(plan.format, dt, in_date_timezone);
+			}
+		}
+		catch(...)
+		{
+		}
 	}
 
-	//overwrite the passed-in timezone if one was parsed out of the datetime string
+	//use the timezone parsed out of the datetime string if there was one
+	const date::time_zone *t_z = plan.parseTimeZone;
 	if(!in_date_timezone.empty())
-		timezone = in_date_timezone;
-	//if there is no timezone defined, but the format has a time offset provided via %z, assume the offset is UTC
-	else if(has_time_offset)
-		timezone = "UTC";
-
-	const date::time_zone *t_z = GetTimeZoneFromString(timezone);
+		t_z = GetTimeZoneFromString(in_date_timezone);
 
 	// convert parsed date to the specified timezone
 	auto zoned_datetime = date::make_zoned(t_z, dt);
@@ -320,12 +832,10 @@ double GetNumSecondsSinceEpochFromDateTimeString(std::string &datetime_str,
 }
 
 
-//converts a datetime time point into a string specified by format, locale, and time zone t_z
+//converts a datetime time point into a string specified by format, locale name including encoding, and time zone t_z
 // templated so it will properly cast the TimepointType and round to the appropriate number of digits
-// locale is not specified as constant or passed reference because this function may modify the string
-//  and needs to call the copy constructor
 template<typename TimepointType>
-std::string ConvertZonedDateTimeToString(TimepointType datetime, std::string format, std::string locale, const date::time_zone *tz)
+std::string ConvertZonedDateTimeToString(TimepointType datetime, const std::string &format, const std::string &locale_name, const date::time_zone *tz)
 {
 	auto zoned_dt = date::make_zoned(tz, datetime);
 
@@ -336,7 +846,7 @@ std::string ConvertZonedDateTimeToString(TimepointType datetime, std::string for
 #endif
 
 	cached_locale.ResetStringStream();
-	if(locale.empty())
+	if(locale_name.empty())
 	{
 		try
 		{
@@ -349,12 +859,10 @@ std::string ConvertZonedDateTimeToString(TimepointType datetime, std::string for
 	}
 	else
 	{
-		//make sure it's utf-8
-		locale += ".utf-8";
 		//if the locale is valid, use it
 		try
 		{
-			cached_locale.UpdateLocaleIfNeeded(locale);
+			cached_locale.UpdateLocaleIfNeeded(locale_name);
 			cached_locale.stringStream << date::format(cached_locale.locale, format, zoned_dt);
 		}
 		catch(...)
@@ -373,41 +881,50 @@ std::string ConvertZonedDateTimeToString(TimepointType datetime, std::string for
 	return cached_locale.stringStream.str();
 }
 
-//format and locale are not passed by reference because both need a copy
 std::string GetDateTimeStringFromNumSecondsSinceEpoch(double seconds_since_epoch,
-	std::string &format, std::string &locale, std::string &timezone)
+	const std::string &format, const std::string &locale, const std::string &timezone)
 {
 	if(seconds_since_epoch != seconds_since_epoch
 			|| seconds_since_epoch == std::numeric_limits<double>::infinity()
 			|| seconds_since_epoch == -std::numeric_limits<double>::infinity())
 		seconds_since_epoch = 0.0;
 
-	bool has_time_offset = ConstrainDateTimeStringToValidFormat(format);
+	auto &plan = GetDateTimeFormatPlan(format, locale, timezone, false);
 
 	bool has_fractional_seconds = (seconds_since_epoch != static_cast<int64_t>(seconds_since_epoch));
 
 	std::chrono::system_clock::time_point datetime;
 	datetime = std::chrono::system_clock::time_point(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::duration<double>(static_cast<double>(seconds_since_epoch))));
 
-	//if there is no timezone defined, but the format has a time offset provided via %z assume the offset is UTC
-	const date::time_zone *tz = nullptr;
-	if(timezone.empty() && has_time_offset)
-		tz = GetTimeZoneFromString("UTC");
-	else
-		tz = GetTimeZoneFromString(timezone);
+	const date::time_zone *tz = plan.formatTimeZone;
 
 	//round to the appropriate precision for seconds
 	if(has_fractional_seconds)
-		return ConvertZonedDateTimeToString<std::chrono::system_clock::time_point>(datetime, format, locale, tz);
-	else
+		return ConvertZonedDateTimeToString<std::chrono::system_clock::time_point>(datetime, plan.format, plan.localeName, tz);
+
+	auto rounded_timepoint = std::chrono::floor<std::chrono::seconds>(datetime);
+	if(plan.canFormatDirectly)
 	{
-		auto rounded_timepoint = std::chrono::floor<std::chrono::seconds>(datetime);
-		return ConvertZonedDateTimeToString<decltype(rounded_timepoint)>(rounded_timepoint, format, locale, tz);
+		try
+		{
+			auto info = tz->get_info(rounded_timepoint);
+			date::local_seconds local_time(rounded_timepoint.time_since_epoch() + info.offset);
+
+			std::string formatted;
+			if(plan.FormatDirectly(local_time, &info, formatted))
+				return formatted;
+		}
+		catch(...)
+		{
+			//fall back to the date library
+		}
 	}
+
+	return ConvertZonedDateTimeToString<decltype(rounded_timepoint)>(rounded_timepoint, plan.format, plan.localeName, tz);
 }
 
 //parses time_str based on format and locale and returns the number of seconds since midnight
-double GetNumSecondsSinceMidnight(std::string &time_str, std::string &format, std::string &locale)
+double GetNumSecondsSinceMidnight(const std::string &time_str, const std::string &format, const std::string &locale)
 {
 #if defined(MULTITHREAD_SUPPORT)
 	thread_local static CachedLocale cached_locale;
@@ -420,12 +937,11 @@ double GetNumSecondsSinceMidnight(std::string &time_str, std::string &format, st
 
 	if(!locale.empty())
 	{
-		//make sure it's utf-8
-		locale += ".utf-8";
 		//if the locale is valid, use it
 		try
 		{
-			cached_locale.UpdateLocaleIfNeeded(locale);
+			//make sure it's utf-8
+			cached_locale.UpdateLocaleIfNeeded(locale + ".utf-8");
 		}
 		catch(...)
 		{
@@ -455,7 +971,7 @@ double GetNumSecondsSinceMidnight(std::string &time_str, std::string &format, st
 	return 0.0;
 }
 
-std::string GetTimeStringFromNumSecondsSinceMidnight(double seconds_since_midnight, std::string &format, std::string &locale)
+std::string GetTimeStringFromNumSecondsSinceMidnight(double seconds_since_midnight, const std::string &format, const std::string &locale)
 {
 	if(seconds_since_midnight != seconds_since_midnight
 			|| seconds_since_midnight == std::numeric_limits<double>::infinity()
@@ -469,6 +985,14 @@ std::string GetTimeStringFromNumSecondsSinceMidnight(double seconds_since_midnig
 
 	auto tp = std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::duration<double>(seconds_since_midnight));
 
+	auto &plan = GetDateTimeFormatPlan(format, locale, "", true);
+	if(!has_fractional_seconds)
+	{
+		std::string formatted;
+		if(plan.FormatDirectly(date::local_seconds(std::chrono::floor<std::chrono::seconds>(tp)), nullptr, formatted))
+			return formatted;
+	}
+
 #if defined(MULTITHREAD_SUPPORT)
 	thread_local static CachedLocale cached_locale;
 #else
@@ -477,14 +1001,12 @@ std::string GetTimeStringFromNumSecondsSinceMidnight(double seconds_since_midnig
 
 
 	cached_locale.ResetStringStream();
-	if(!locale.empty())
+	if(!plan.localeName.empty())
 	{
-		//make sure it's utf-8
-		locale += ".utf-8";
 		//if the locale is valid, use it
 		try
 		{
-			cached_locale.UpdateLocaleIfNeeded(locale);
+			cached_locale.UpdateLocaleIfNeeded(plan.localeName);
 		}
 		catch(...)
 		{
@@ -8,15 +8,22 @@
 //returns the path used
 std::string SetTimeZoneDatabasePath(std::string path = "");
 
+//the functions below compile each distinct combination of format, locale, and timezone into a plan that is cached
+// per thread, so repeated conversions with the same format are not reparsed
+//when no locale is specified and the format only uses common specifiers, values are parsed and formatted directly
+// without iostreams, otherwise the date library is used
+
 //parses datetime based on format and locale and returns the number of seconds from "Epoch" (January 1, 1970)
-double GetNumSecondsSinceEpochFromDateTimeString(std::string &datetime_str, std::string &format, std::string &locale, std::string &timezone);
+double GetNumSecondsSinceEpochFromDateTimeString(const std::string &datetime_str,
+	const std::string &format, const std::string &locale, const std::string &timezone);
 
 //transforms seconds_since_epoch into the datetime string specified by format and locale based on "Epoch" (January 1, 1970)
 // positive and negative values of num_secs_from_epoch are allowed
-std::string GetDateTimeStringFromNumSecondsSinceEpoch(double seconds_since_epoch, std::string &format, std::string &locale, std::string &timezone);
+std::string GetDateTimeStringFromNumSecondsSinceEpoch(double seconds_since_epoch,
+	const std::string &format, const std::string &locale, const std::string &timezone);
 
 //parses time_str based on format and locale and returns the number of seconds since midnight
-double GetNumSecondsSinceMidnight(std::string &time_str, std::string &format, std::string &locale);
+double GetNumSecondsSinceMidnight(const std::string &time_str, const std::string &format, const std::string &locale);
 
 //transforms seconds_since_midnight into a string representing the time of day
-std::string GetTimeStringFromNumSecondsSinceMidnight(double seconds_since_midnight, std::string &format, std::string &locale);
+std::string GetTimeStringFromNumSecondsSinceMidnight(double seconds_since_midnight, const std::string &format, const std::string &locale);
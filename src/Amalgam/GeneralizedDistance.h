@@ -14,6 +14,9 @@
 //If defined, will use the Laplace LK metric (default).  Otherwise will use Gaussian.
 #define DISTANCE_USE_LAPLACE_LK_METRIC true
 
+//forward declarations:
+class CallEntityResultsCache;
+
 class GeneralizedDistanceEvaluator
 {
 public:
@@ -98,7 +101,7 @@ public:
 			featureDataIndex(std::numeric_limits<size_t>::max()), weight(1.0), deviation(0.0),
 			unknownToUnknownDistanceTerm(std::numeric_limits<double>::quiet_NaN()),
 			knownToUnknownDistanceTerm(std::numeric_limits<double>::quiet_NaN()),
-			callEntityOpcode(nullptr)
+			callEntityOpcode(nullptr), cacheCallEntityResults(false)
 		{
 			typeAttributes.continuous.cycleRange = std::numeric_limits<double>::quiet_NaN();
 		}
@@ -222,6 +225,9 @@ public:
 		//it will use the return value instead of calling the entity label distance, passing in the calling params
 		EvaluableNode *callEntityOpcode;
 
+		//if true, the result of callEntityOpcode for each entity is cached and reused until the entity's labels change
+		bool cacheCallEntityResults;
+
 		//index to the corresponding position value
 		size_t positionValueIndex;
 
@@ -1206,6 +1212,10 @@ public:
 	// if false, will reuse accuracy from estimates
 	bool recomputeAccurateDistances;
 
+	//if true, then estimates may be computed from single precision copies of continuous numeric values,
+	// which should only be used when recomputeAccurateDistances is true so that final results use double precision
+	bool singlePrecisionValues;
+
 	//if true, will populate any omitted feature values
 	bool populateOmittedFeatureValues;
 };
@@ -1229,6 +1239,10 @@ public:
 		EFDT_CONTINUOUS_UNIVERSALLY_NUMERIC,
 		//continuous without cycles, may contain nonnumeric data
 		EFDT_CONTINUOUS_NUMERIC,
+		//like EFDT_CONTINUOUS_UNIVERSALLY_NUMERIC, but uses the single precision copy of the values
+		EFDT_CONTINUOUS_UNIVERSALLY_NUMERIC_SINGLE_PRECISION,
+		//like EFDT_CONTINUOUS_NUMERIC, but uses the single precision copy of the values
+		EFDT_CONTINUOUS_NUMERIC_SINGLE_PRECISION,
 		//like FDT_CONTINUOUS_NUMBER, but has cycles
 		EFDT_CONTINUOUS_NUMERIC_CYCLIC,
 		//continuous or nominal numeric precomputed (cyclic or not), may contain nonnumeric data
@@ -1670,7 +1684,7 @@ public:
 	public:
 
 		FeaturePrecomputedData()
-			: effectiveFeatureType(EFDT_CONTINUOUS_NUMERIC)
+			: effectiveFeatureType(EFDT_CONTINUOUS_NUMERIC), callEntityResultsCache(nullptr)
 		{}
 
 		//clears all the feature data
@@ -1684,6 +1698,7 @@ public:
 			internedDistanceTerms.clear();
 			nominalStringDistanceTerms.clear();
 			nominalNumberDistanceTerms.clear();
+			callEntityResultsCache = nullptr;
 		}
 
 		//sets the value for a precomputed distance term that will apply to the rest of the distance
@@ -1720,6 +1735,9 @@ public:
 		//used to store distance terms for the respective targetValue for the sparse deviation matrix
 		FastHashMap<StringInternPool::StringID, double> nominalStringDistanceTerms;
 		FastHashMap<double, double, FastHasher<double>, DoubleNanHashComparator> nominalNumberDistanceTerms;
+
+		//for EFDT_CALL_ENTITY, the cache of results of the call for each entity if caching is enabled, otherwise nullptr
+		CallEntityResultsCache *callEntityResultsCache;
 	};
 
 	//for each feature, precomputed distance terms for each interned value looked up by intern index
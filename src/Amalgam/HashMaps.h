@@ -50,6 +50,10 @@ using CompactHashSet = std::unordered_set<T, H, E, A>;
 template<typename K, typename V, typename H = FastHasher<K>, typename E = std::equal_to<K>, typename A = std::allocator<std::pair<const K, V> > >
 using CompactHashMap = std::unordered_map<K, V, H, E, A>;
 
+//for debugging, small maps use the same representation as large maps
+template<typename K, typename V, size_t MaxLinearSize = 16>
+using AdaptiveCompactHashMap = CompactHashMap<K, V>;
+
 //wrapper that includes method specializations of _with_hash to enable the use of std::unordered_set with ConcurrentFastHashMap
 template<
 	typename K,
@@ -100,7 +104,11 @@ public:
 #include <array>
 #include <cstddef>
 #include <functional>
+#include <iterator>
+#include <limits>
 #include <mutex>
+#include <new>
+#include <stdexcept>
 #include <type_traits>
 #include <utility>
 #include <vector>
@@ -195,6 +203,497 @@ using CompactHashSet = ska::bytell_hash_set<T, H, E, A>;
 template<typename K, typename V, typename H = FastHasher<K>, typename E = std::equal_to<K>, typename A = std::allocator<std::pair<const K, V> > >
 using CompactHashMap = ska::bytell_hash_map<K, V, H, E, A>;
 
+//A map with the interface of CompactHashMap that stores up to MaxLinearSize entries as a single exactly sized
+// array of key-value pairs in insertion order that is searched linearly, and promotes itself to a CompactHashMap
+// once it grows beyond that size.  Small maps avoid the hash map's control bytes, minimum bucket count, and
+// load factor slack, and the object itself is smaller than a CompactHashMap.
+//Keys and values must be trivially copyable.  Like CompactHashMap, any insertion or erasure may invalidate
+// iterators and references.
+//Iteration order differs from CompactHashMap: while linear, entries are iterated in insertion order and erasure
+// keeps the order of the remaining entries; once promoted, they are iterated in the hash map's order, even if
+// entries are later erased, until clear() returns the map to linear storage.  Callers must not depend on either
+// order; it is only deterministic for a given sequence of operations.
+template<typename K, typename V, size_t MaxLinearSize = 16>
+class AdaptiveCompactHashMap
+{
+public:
+	using key_type = K;
+	using mapped_type = V;
+	using value_type = std::pair<K, V>;
+	using size_type = size_t;
+	using difference_type = std::ptrdiff_t;
+	using MapType = CompactHashMap<K, V>;
+
+	static_assert(std::is_trivially_copyable_v<K> && std::is_trivially_copyable_v<V>,
+		"AdaptiveCompactHashMap requires trivially copyable keys and values");
+
+	//iterates over either the linear entries or the hash map
+	template<typename ValueType, typename MapIterator>
+	class templated_iterator
+	{
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = std::remove_const_t<ValueType>;
+		using difference_type = std::ptrdiff_t;
+		using pointer = ValueType *;
+		using reference = ValueType &;
+
+		templated_iterator() = default;
+
+		inline templated_iterator(ValueType *entry)
+			: linearEntry(entry), mapIterator(), inMap(false)
+		{}
+
+		inline templated_iterator(MapIterator map_iterator)
+			: linearEntry(nullptr), mapIterator(map_iterator), inMap(true)
+		{}
+
+		//allow conversion from iterator to const_iterator
+		template<typename OtherValueType, typename OtherMapIterator,
+			typename = std::enable_if_t<std::is_convertible_v<OtherValueType *, ValueType *>>>
+		inline templated_iterator(const templated_iterator<OtherValueType, OtherMapIterator> &other)
+			: linearEntry(other.linearEntry), mapIterator(other.mapIterator), inMap(other.inMap)
+		{}
+
+		inline reference operator*() const
+		{
+			return inMap ? *mapIterator : *linearEntry;
+		}
+
+		inline pointer operator->() const
+		{
+			return &**this;
+		}
+
+		inline templated_iterator &operator++()
+		{
+			if(inMap)
+				++mapIterator;
+			else
+				++linearEntry;
+			return *this;
+		}
+
+		inline templated_iterator operator++(int)
+		{
+			templated_iterator prev = *this;
+			++*this;
+			return prev;
+		}
+
+		inline friend bool operator==(const templated_iterator &a, const templated_iterator &b)
+		{
+			return a.inMap ? a.mapIterator == b.mapIterator : a.linearEntry == b.linearEntry;
+		}
+
+		inline friend bool operator!=(const templated_iterator &a, const templated_iterator &b)
+		{
+			return !(a == b);
+		}
+
+		ValueType *linearEntry = nullptr;
+		MapIterator mapIterator = MapIterator();
+		bool inMap = false;
+	};
+
+	using iterator = templated_iterator<value_type, typename MapType::iterator>;
+	using const_iterator = templated_iterator<const value_type, typename MapType::const_iterator>;
+
+	inline AdaptiveCompactHashMap()
+		: linearEntries(nullptr), numLinearEntries(0), linearCapacity(0)
+	{}
+
+	inline AdaptiveCompactHashMap(const AdaptiveCompactHashMap &other)
+		: AdaptiveCompactHashMap()
+	{
+		*this = other;
+	}
+
+	inline AdaptiveCompactHashMap(AdaptiveCompactHashMap &&other) noexcept
+		: linearEntries(other.linearEntries), numLinearEntries(other.numLinearEntries), linearCapacity(other.linearCapacity)
+	{
+		other.linearEntries = nullptr;
+		other.numLinearEntries = 0;
+		other.linearCapacity = 0;
+	}
+
+	inline ~AdaptiveCompactHashMap()
+	{
+		Deallocate();
+	}
+
+	inline AdaptiveCompactHashMap &operator=(const AdaptiveCompactHashMap &other)
+	{
+		if(this == &other)
+			return *this;
+
+		if(other.IsHashMap())
+		{
+			if(IsHashMap())
+			{
+				*map = *other.map;
+			}
+			else
+			{
+				MapType *new_map = new MapType(*other.map);
+				Deallocate();
+				map = new_map;
+				linearCapacity = hashMapCapacity;
+			}
+			return *this;
+		}
+
+		//other is linear, so size exactly
+		if(IsHashMap() || linearCapacity < other.numLinearEntries)
+		{
+			Deallocate();
+			if(other.numLinearEntries > 0)
+			{
+				linearEntries = AllocateLinearEntries(other.numLinearEntries);
+				linearCapacity = other.numLinearEntries;
+			}
+		}
+
+		if(other.numLinearEntries > 0)
+			std::copy(other.linearEntries, other.linearEntries + other.numLinearEntries, linearEntries);
+		numLinearEntries = other.numLinearEntries;
+		return *this;
+	}
+
+	inline AdaptiveCompactHashMap &operator=(AdaptiveCompactHashMap &&other) noexcept
+	{
+		if(this != &other)
+		{
+			Deallocate();
+			linearEntries = other.linearEntries;
+			numLinearEntries = other.numLinearEntries;
+			linearCapacity = other.linearCapacity;
+			other.linearEntries = nullptr;
+			other.numLinearEntries = 0;
+			other.linearCapacity = 0;
+		}
+		return *this;
+	}
+
+	inline void swap(AdaptiveCompactHashMap &other) noexcept
+	{
+		std::swap(linearEntries, other.linearEntries);
+		std::swap(numLinearEntries, other.numLinearEntries);
+		std::swap(linearCapacity, other.linearCapacity);
+	}
+
+	inline iterator begin()
+	{
+		if(IsHashMap())
+			return iterator(map->begin());
+		return iterator(linearEntries);
+	}
+
+	inline iterator end()
+	{
+		if(IsHashMap())
+			return iterator(map->end());
+		return iterator(linearEntries + numLinearEntries);
+	}
+
+	inline const_iterator begin() const
+	{
+		if(IsHashMap())
+			return const_iterator(static_cast<const MapType *>(map)->begin());
+		return const_iterator(static_cast<const value_type *>(linearEntries));
+	}
+
+	inline const_iterator end() const
+	{
+		if(IsHashMap())
+			return const_iterator(static_cast<const MapType *>(map)->end());
+		return const_iterator(static_cast<const value_type *>(linearEntries + numLinearEntries));
+	}
+
+	//free functions so that unqualified begin and end are found via argument-dependent lookup like std containers
+	inline friend iterator begin(AdaptiveCompactHashMap &m)
+	{
+		return m.begin();
+	}
+
+	inline friend iterator end(AdaptiveCompactHashMap &m)
+	{
+		return m.end();
+	}
+
+	inline friend const_iterator begin(const AdaptiveCompactHashMap &m)
+	{
+		return m.begin();
+	}
+
+	inline friend const_iterator end(const AdaptiveCompactHashMap &m)
+	{
+		return m.end();
+	}
+
+	inline const_iterator cbegin() const
+	{
+		return begin();
+	}
+
+	inline const_iterator cend() const
+	{
+		return end();
+	}
+
+	inline size_t size() const
+	{
+		if(IsHashMap())
+			return map->size();
+		return numLinearEntries;
+	}
+
+	inline bool empty() const
+	{
+		return size() == 0;
+	}
+
+	//removes all entries, releasing a hash map if one has been allocated
+	inline void clear()
+	{
+		if(IsHashMap())
+			Deallocate();
+		else
+			numLinearEntries = 0;
+	}
+
+	//ensures there is capacity for num_entries, sizing linear storage exactly
+	inline void reserve(size_t num_entries)
+	{
+		if(IsHashMap())
+		{
+			map->reserve(num_entries);
+			return;
+		}
+
+		if(num_entries <= linearCapacity)
+			return;
+
+		if(num_entries > MaxLinearSize)
+			PromoteToHashMap(num_entries);
+		else
+			ResizeLinearEntries(static_cast<uint32_t>(num_entries));
+	}
+
+	inline iterator find(const K &key)
+	{
+		if(IsHashMap())
+			return iterator(map->find(key));
+
+		value_type *cur = linearEntries;
+		value_type *last = linearEntries + numLinearEntries;
+		for(; cur != last; ++cur)
+		{
+			if(cur->first == key)
+				break;
+		}
+		return iterator(cur);
+	}
+
+	inline const_iterator find(const K &key) const
+	{
+		return const_cast<AdaptiveCompactHashMap *>(this)->find(key);
+	}
+
+	inline size_t count(const K &key) const
+	{
+		return (find(key) != end()) ? 1 : 0;
+	}
+
+	inline bool contains(const K &key) const
+	{
+		return find(key) != end();
+	}
+
+	//inserts a new entry constructed from args if key does not already exist
+	//returns an iterator to the entry for key and true if it was inserted
+	template<typename... Args>
+	inline std::pair<iterator, bool> emplace(const K &key, Args &&...args)
+	{
+		if(IsHashMap())
+		{
+			auto [map_iterator, inserted] = map->emplace(key, V(std::forward<Args>(args)...));
+			return std::make_pair(iterator(map_iterator), inserted);
+		}
+
+		auto existing = find(key);
+		if(existing != end())
+			return std::make_pair(existing, false);
+
+		if(numLinearEntries == linearCapacity)
+		{
+			if(numLinearEntries >= MaxLinearSize)
+			{
+				PromoteToHashMap(numLinearEntries + 1);
+				auto [map_iterator, inserted] = map->emplace(key, V(std::forward<Args>(args)...));
+				return std::make_pair(iterator(map_iterator), inserted);
+			}
+
+			//grow geometrically, but never beyond the size at which it would be promoted
+			uint32_t new_capacity = std::max<uint32_t>(2, 2 * linearCapacity);
+			ResizeLinearEntries(std::min<uint32_t>(new_capacity, MaxLinearSize));
+		}
+
+		value_type *entry = linearEntries + numLinearEntries;
+		*entry = value_type(key, V(std::forward<Args>(args)...));
+		numLinearEntries++;
+		return std::make_pair(iterator(entry), true);
+	}
+
+	template<typename... Args>
+	inline std::pair<iterator, bool> try_emplace(const K &key, Args &&...args)
+	{
+		return emplace(key, std::forward<Args>(args)...);
+	}
+
+	inline std::pair<iterator, bool> insert(const value_type &kv)
+	{
+		return emplace(kv.first, kv.second);
+	}
+
+	template<typename InputIterator>
+	inline void insert(InputIterator first, InputIterator last)
+	{
+		for(; first != last; ++first)
+			emplace(first->first, first->second);
+	}
+
+	inline V &operator[](const K &key)
+	{
+		return emplace(key).first->second;
+	}
+
+	inline V &at(const K &key)
+	{
+		auto found = find(key);
+		if(found == end())
+			throw std::out_of_range("AdaptiveCompactHashMap::at");
+		return found->second;
+	}
+
+	//removes the entry at position, preserving the order of remaining linear entries
+	//returns an iterator to the next entry
+	inline iterator erase(const_iterator position)
+	{
+		if(IsHashMap())
+			return iterator(map->erase(position.mapIterator));
+
+		value_type *entry = const_cast<value_type *>(position.linearEntry);
+		std::copy(entry + 1, linearEntries + numLinearEntries, entry);
+		numLinearEntries--;
+		return iterator(entry);
+	}
+
+	inline iterator erase(iterator position)
+	{
+		return erase(const_iterator(position));
+	}
+
+	//removes the entry for key if it exists, returning the number of entries removed
+	inline size_t erase(const K &key)
+	{
+		if(IsHashMap())
+			return map->erase(key);
+
+		auto found = find(key);
+		if(found == end())
+			return 0;
+
+		erase(found);
+		return 1;
+	}
+
+	inline friend bool operator==(const AdaptiveCompactHashMap &a, const AdaptiveCompactHashMap &b)
+	{
+		if(a.size() != b.size())
+			return false;
+
+		for(auto &[key, value] : a)
+		{
+			auto other = b.find(key);
+			if(other == b.end() || !(other->second == value))
+				return false;
+		}
+		return true;
+	}
+
+	inline friend bool operator!=(const AdaptiveCompactHashMap &a, const AdaptiveCompactHashMap &b)
+	{
+		return !(a == b);
+	}
+
+protected:
+	//linearCapacity value indicating that map is in use
+	static constexpr uint32_t hashMapCapacity = std::numeric_limits<uint32_t>::max();
+
+	inline bool IsHashMap() const
+	{
+		return linearCapacity == hashMapCapacity;
+	}
+
+	static inline value_type *AllocateLinearEntries(size_t num_entries)
+	{
+		return static_cast<value_type *>(::operator new(num_entries * sizeof(value_type)));
+	}
+
+	//frees any storage and resets to an empty linear map
+	inline void Deallocate()
+	{
+		if(IsHashMap())
+			delete map;
+		else if(linearEntries != nullptr)
+			::operator delete(linearEntries);
+
+		linearEntries = nullptr;
+		numLinearEntries = 0;
+		linearCapacity = 0;
+	}
+
+	inline void ResizeLinearEntries(uint32_t new_capacity)
+	{
+		value_type *new_entries = AllocateLinearEntries(new_capacity);
+		if(numLinearEntries > 0)
+			std::copy(linearEntries, linearEntries + numLinearEntries, new_entries);
+		if(linearEntries != nullptr)
+			::operator delete(linearEntries);
+
+		linearEntries = new_entries;
+		linearCapacity = new_capacity;
+	}
+
+	//moves all linear entries into a newly allocated hash map with capacity for num_entries
+	inline void PromoteToHashMap(size_t num_entries)
+	{
+		MapType *new_map = new MapType();
+		new_map->reserve(num_entries);
+		for(uint32_t i = 0; i < numLinearEntries; i++)
+			new_map->emplace(linearEntries[i].first, linearEntries[i].second);
+
+		Deallocate();
+		map = new_map;
+		linearCapacity = hashMapCapacity;
+	}
+
+	union
+	{
+		//linear storage when linearCapacity is not hashMapCapacity
+		value_type *linearEntries;
+		//hash map storage when linearCapacity is hashMapCapacity
+		MapType *map;
+	};
+
+	//number of entries in linearEntries
+	uint32_t numLinearEntries;
+
+	//allocated capacity of linearEntries, or hashMapCapacity if map is in use
+	uint32_t linearCapacity;
+};
+
 #endif
 
 #if defined(MULTITHREAD_SUPPORT)
@@ -9,8 +9,14 @@
 #include <algorithm>
 #include <bit>
 #include <cstdint>
+#include <iterator>
+#include <type_traits>
 #include <vector>
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
 //container for holding sparse integers that maximizes efficiency of interoperating
 // with BitArrayIntegerSet
 class SortedIntegerSet
@@ -121,22 +127,44 @@ public:
 	}
 
 	//inserts all elements in collection
-	//assumes that the elements are not in this set, but does not assume elements are sorted
+	//does not assume elements are sorted, but merges them in linear time
 	template<typename Collection>
-	__forceinline void insert(Collection &other)
+	void insert(Collection &other)
 	{
-		for(const size_t element : other)
-			insert(element);
+		if constexpr(std::is_same_v<Collection, SortedIntegerSet>)
+		{
+			UnionSortedIntegers(other.integers.data(), other.integers.size());
+		}
+		else
+		{
+			//inserting one at a time is faster than merging when there are only a few
+			if(other.size() <= maxNumIntegersToInsertIndividually)
+			{
+				for(const size_t element : other)
+					insert(element);
+				return;
+			}
+
+			std::vector<size_t> other_integers;
+			other_integers.reserve(other.size());
+			for(const size_t element : other)
+				other_integers.push_back(element);
+
+			if(!std::is_sorted(std::begin(other_integers), std::end(other_integers)))
+				std::sort(std::begin(other_integers), std::end(other_integers));
+			other_integers.erase(std::unique(std::begin(other_integers), std::end(other_integers)), std::end(other_integers));
+
+			UnionSortedIntegers(other_integers.data(), other_integers.size());
+		}
 	}
 
 	//inserts all elements in collection
-	//assumes that the elements are not in this set, but does not assume elements are sorted
+	//does not assume elements are sorted
 	//functionally identical to insert
 	template<typename Collection>
 	__forceinline void InsertInBatch(Collection &other)
 	{
-		for(const size_t element : other)
-			insert(element);
+		insert(other);
 	}
 
 	//inserts all elements in collection
@@ -144,9 +172,16 @@ public:
 	template<typename Collection>
 	__forceinline void InsertNewSortedIntegers(Collection &other)
 	{
-		integers.reserve(other.size());
-		for(const size_t element : other)
-			integers.emplace_back(element);
+		integers.reserve(integers.size() + other.size());
+
+		//use the container's own iteration when available, as it is faster than its iterator
+		if constexpr(requires { other.IterateOver([](size_t) {}); })
+			other.IterateOver([this](size_t element) { integers.emplace_back(element); });
+		else
+		{
+			for(const size_t element : other)
+				integers.emplace_back(element);
+		}
 	}
 
 	//insert an id is larger than GetEndInteger()
@@ -206,6 +241,9 @@ public:
 				++other_iter;
 			}
 		}
+
+		//remove any elements erased from the end
+		integers.resize(dest_index);
 	}
 
 	//removes all elements contained by other, intended for calling in a batch
@@ -238,72 +276,163 @@ public:
 
 	//sets this to the set that contains all elements of itself or other
 	template<typename Container>
-	void Union(Container &other)
+	__forceinline void Union(Container &other)
 	{
-		auto other_iter = std::begin(other);
-		auto other_end = std::end(other);
-
-		size_t cur_index = 0;
-		while(cur_index != integers.size())
-		{
-			//if other is exhausted, then done
-			if(other_iter == other_end)
-				return;
-
-			//if next integer in other is greater, just continue
-			if(integers[cur_index] < *other_iter)
-			{
-				cur_index++;
-			}
-			else //other is less than or equal
-			{
-				//only insert the next integer if it is different
-				if(integers[cur_index] != *other_iter)
-					integers.insert(std::begin(integers) + cur_index, *other_iter);
-
-				++other_iter;
-			}
-		}
-
-		integers.insert(std::end(integers), other_iter, other_end);
+		insert(other);
 	}
 
 	//sets this to the set that contains only elements that it and another jointly contain
 	template<typename Container>
 	void Intersect(Container &other)
 	{
-		auto other_iter = std::begin(other);
-		auto other_end = std::end(other);
+		if constexpr(std::is_same_v<Container, SortedIntegerSet>)
+		{
+			size_t num_integers = IntersectSortedIntegers(integers.data(), integers.size(),
+				other.integers.data(), other.integers.size(), integers.data());
+			integers.resize(num_integers);
+		}
+		else //other has fast lookup, so keep only the elements it contains
+		{
+			integers.erase(std::remove_if(std::begin(integers), std::end(integers),
+				[&other](size_t id) { return !other.contains(id); }),
+				std::end(integers));
+		}
+	}
 
-		//copies data to the destination instead of erasing
-		// to reduce computational complexity
-		size_t dest_index = 0;
-		size_t cur_index = 0;
-		while(cur_index != integers.size() && other_iter != other_end)
+	//writes the elements common to the sorted arrays a and b into out, returning the number written
+	//out may be the same as a, as elements are never written past the position they are read from
+	//uses galloping search when one array is much larger than the other,
+	// otherwise compares blocks of elements at a time
+	static size_t IntersectSortedIntegers(const size_t *a, size_t a_size, const size_t *b, size_t b_size, size_t *out)
+	{
+		if(a_size == 0 || b_size == 0)
+			return 0;
+
+		//skip the leading and trailing elements of each that are outside of the range of the other
+		const size_t *a_end = std::upper_bound(a, a + a_size, b[b_size - 1]);
+		const size_t *b_end = std::upper_bound(b, b + b_size, a[a_size - 1]);
+		a = std::lower_bound(a, a_end, b[0]);
+		if(a == a_end)
+			return 0;
+
+		b = std::lower_bound(b, b_end, a[0]);
+		if(b == b_end)
+			return 0;
+
+		a_size = a_end - a;
+		b_size = b_end - b;
+
+		size_t num_out = 0;
+
+		//gallop through the larger array for each element of the smaller
+		if(a_size >= gallopingSizeRatio * b_size || b_size >= gallopingSizeRatio * a_size)
 		{
-			//if next integer is greater, skip
-			if(integers[cur_index] < *other_iter)
+			bool a_is_smaller = (a_size < b_size);
+			const size_t *smaller = (a_is_smaller ? a : b);
+			size_t smaller_size = (a_is_smaller ? a_size : b_size);
+			const size_t *larger = (a_is_smaller ? b : a);
+			size_t larger_size = (a_is_smaller ? b_size : a_size);
+
+			size_t larger_index = 0;
+			for(size_t i = 0; i < smaller_size; i++)
 			{
-				cur_index++;
+				size_t value = smaller[i];
+				larger_index = GallopLowerBound(larger, larger_index, larger_size, value);
+				if(larger_index == larger_size)
+					break;
+
+				if(larger[larger_index] == value)
+					out[num_out++] = value;
 			}
-			else //other is less than or equal
+
+			return num_out;
+		}
+
+		size_t a_index = 0;
+		size_t b_index = 0;
+
+	#if defined(__AVX2__)
+		if constexpr(sizeof(size_t) == sizeof(uint64_t))
+		{
+			if(a_size >= 4 && b_size >= 4)
 			{
-				//if next integer is the same, copy and keep
-				if(integers[cur_index] == *other_iter)
+				//compare each block of 4 from a against all rotations of a block of 4 from b,
+				// advancing whichever block has the smaller maximum
+				//the block of a is kept in a register and its matches are written once it is finished,
+				// so that writing into a cannot overwrite elements of the block before they are compared
+				alignas(32) size_t a_block[4];
+				__m256i a_values = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a));
+				_mm256_store_si256(reinterpret_cast<__m256i *>(a_block), a_values);
+				unsigned int block_match_mask = 0;
+
+				while(true)
 				{
-					if(dest_index != cur_index)
-						integers[dest_index] = integers[cur_index];
-
-					dest_index++;
-					cur_index++;
+					__m256i b_values = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + b_index));
+					__m256i matches = _mm256_cmpeq_epi64(a_values, b_values);
+					matches = _mm256_or_si256(matches, _mm256_cmpeq_epi64(a_values, _mm256_permute4x64_epi64(b_values, 0x39)));
+					matches = _mm256_or_si256(matches, _mm256_cmpeq_epi64(a_values, _mm256_permute4x64_epi64(b_values, 0x4E)));
+					matches = _mm256_or_si256(matches, _mm256_cmpeq_epi64(a_values, _mm256_permute4x64_epi64(b_values, 0x93)));
+					block_match_mask |= static_cast<unsigned int>(_mm256_movemask_pd(_mm256_castsi256_pd(matches)));
+
+					size_t a_max = a_block[3];
+					size_t b_max = b[b_index + 3];
+					if(b_max <= a_max)
+						b_index += 4;
+
+					if(a_max <= b_max)
+					{
+						while(block_match_mask != 0)
+						{
+							out[num_out++] = a_block[std::countr_zero(block_match_mask)];
+							block_match_mask &= block_match_mask - 1;
+						}
+
+						a_index += 4;
+						if(a_index + 4 > a_size)
+							break;
+
+						a_values = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + a_index));
+						_mm256_store_si256(reinterpret_cast<__m256i *>(a_block), a_values);
+					}
+
+					if(b_index + 4 > b_size)
+					{
+						//finish the block of a against the remaining elements of b
+						for(size_t i = 0; i < 4; i++)
+						{
+							size_t a_value = a_block[i];
+							if(block_match_mask & (1U << i))
+							{
+								out[num_out++] = a_value;
+								continue;
+							}
+
+							while(b_index < b_size && b[b_index] < a_value)
+								b_index++;
+							if(b_index < b_size && b[b_index] == a_value)
+								out[num_out++] = a_value;
+						}
+
+						a_index += 4;
+						break;
+					}
 				}
-
-				++other_iter;
 			}
 		}
+	#endif
 
-		//cut off anything at the end
-		integers.resize(dest_index);
+		//branchless merge of whatever remains
+		while(a_index < a_size && b_index < b_size)
+		{
+			size_t a_value = a[a_index];
+			size_t b_value = b[b_index];
+			out[num_out] = a_value;
+			num_out += (a_value == b_value);
+			a_index += (a_value <= b_value);
+			b_index += (b_value <= a_value);
+		}
+
+		return num_out;
 	}
 
 	//returns the first offset of the vector returned by GetIntegerVector that is
@@ -320,11 +449,99 @@ public:
 		return integers;
 	}
 
+	//when one set is at least this many times larger than the other,
+	// set operations search the larger set rather than merge
+	static constexpr size_t gallopingSizeRatio = 32;
+
+	//returns the first position at or after start in data of size size whose value is not less than value,
+	// searching exponentially further from start, then binary searching the last step
+	static inline size_t GallopLowerBound(const size_t *data, size_t start, size_t size, size_t value)
+	{
+		size_t step = 1;
+		size_t high = start;
+		while(high < size && data[high] < value)
+		{
+			start = high + 1;
+			high += step;
+			step *= 2;
+		}
+
+		return std::lower_bound(data + start, data + std::min(high, size), value) - data;
+	}
+
+	//returns the estimated number of bytes of memory allocated by the set beyond the object itself
+	inline size_t GetEstimatedSizeInBytes()
+	{
+		return integers.capacity() * sizeof(size_t);
+	}
+
 protected:
+	//number of integers below which insert adds them one at a time rather than merging
+	static constexpr size_t maxNumIntegersToInsertIndividually = 4;
+
+	//sets integers to the union of integers and other, where other is sorted and has no duplicates
+	void UnionSortedIntegers(const size_t *other, size_t other_size)
+	{
+		if(other_size == 0)
+			return;
+
+		size_t cur_size = integers.size();
+
+		//if all come after, can just append
+		if(cur_size == 0 || integers.back() < other[0])
+		{
+			integers.insert(std::end(integers), other, other + other_size);
+			return;
+		}
+
+		//if other is much smaller, count the new elements then merge in place from the back
+		if(cur_size >= gallopingSizeRatio * other_size)
+		{
+			size_t num_new = 0;
+			size_t cur_index = 0;
+			for(size_t i = 0; i < other_size; i++)
+			{
+				cur_index = GallopLowerBound(integers.data(), cur_index, cur_size, other[i]);
+				if(cur_index == cur_size || integers[cur_index] != other[i])
+					num_new++;
+			}
+
+			if(num_new == 0)
+				return;
+
+			integers.resize(cur_size + num_new);
+			size_t dest_index = cur_size + num_new;
+			size_t other_index = other_size;
+			cur_index = cur_size;
+			while(other_index > 0)
+			{
+				if(cur_index > 0 && integers[cur_index - 1] >= other[other_index - 1])
+				{
+					if(integers[cur_index - 1] == other[other_index - 1])
+						other_index--;
+					integers[--dest_index] = integers[--cur_index];
+				}
+				else
+				{
+					integers[--dest_index] = other[--other_index];
+				}
+			}
+
+			return;
+		}
+
+		std::vector<size_t> merged;
+		merged.reserve(cur_size + other_size);
+		std::set_union(std::begin(integers), std::end(integers), other, other + other_size, std::back_inserter(merged));
+		integers.swap(merged);
+	}
+
 	std::vector<size_t> integers;
 };
 
 //uses bit-compression to hash integral key values into a set
+// a second level of summary bits records which buckets are nonempty, so that iteration,
+// intersection, and union can skip over empty regions of sparse sets
 // note that some of the methods follow the STL convention so that
 // this library can be closer to a drop-in replacement for STL sets
 class BitArrayIntegerSet
@@ -395,6 +612,7 @@ public:
 		numElements = other.numElements;
 		curMaxNumIndices = other.curMaxNumIndices;
 		bitBucket = other.bitBucket;
+		summaryBits = other.summaryBits;
 	}
 
 	//std begin (must be lowercase)
@@ -470,76 +688,52 @@ public:
 					func(index);
 			}
 		}
-		else //use the iterator, which is more efficient when sparse
+		else //only visit the nonempty buckets, which is more efficient when sparse
 		{
-			auto iter = begin();
-			size_t index = *iter;
-			while(index < end_index)
+			size_t num_buckets_allocated = bitBucket.size();
+			for(size_t bucket = FindNextNonemptyBucket(0); bucket < num_buckets_allocated;
+				bucket = FindNextNonemptyBucket(bucket + 1))
 			{
-				func(index);
-				++iter;
-				index = *iter;
+				uint64_t bucket_bits = bitBucket[bucket];
+				while(bucket_bits != 0)
+				{
+					size_t index = GetIndexFromBucketAndBit(bucket, std::countr_zero(bucket_bits));
+					if(index >= end_index)
+						return;
+
+					func(index);
+					bucket_bits &= bucket_bits - 1;
+				}
 			}
 		}
 	}
 
-	//iterates over all of the integers as efficiently as possible, passing them into func
+	//iterates over all of the integers in both bais_1 and bais_2 in increasing order, passing them into func
+	//only buckets that are nonempty in both sets are visited
 	template<typename IntegerFunction>
 	static inline void IterateOverIntersection(
 		BitArrayIntegerSet &bais_1, BitArrayIntegerSet &bais_2,
 		IntegerFunction func, size_t up_to_index = std::numeric_limits<size_t>::max())
 	{
-		auto &sparser_bais = (bais_1.size() < bais_2.size() ? bais_1 : bais_2);
-		auto &denser_bais = (bais_1.size() < bais_2.size() ? bais_2 : bais_1);
-
-		size_t sparser_end_integer = sparser_bais.GetEndInteger();
-		size_t sparser_num_buckets = (sparser_end_integer + 63) / 64;
-
-		size_t denser_end_integer = denser_bais.GetEndInteger();
-		size_t denser_num_buckets = (denser_end_integer + 63) / 64;
-
-		size_t end_index = std::min(up_to_index, sparser_end_integer);
-		end_index = std::min(end_index, denser_end_integer);
-
-		size_t num_buckets = std::min(sparser_num_buckets, denser_num_buckets);
-
-		//there are three loops optimized for different densities, high, medium high, and sparse
-		//the heuristics have been tuned by performance testing across a couple of CPU architectures
-		//and different data sets
-		size_t sparser_indices_per_bucket = sparser_num_buckets / sparser_num_buckets;
-		if(sparser_indices_per_bucket >= 48)
+		size_t num_summary_words = std::min(bais_1.summaryBits.size(), bais_2.summaryBits.size());
+		for(size_t word = 0; word < num_summary_words; word++)
 		{
-			for(size_t bucket = 0, index = 0;
-				bucket < num_buckets; bucket++, index++)
+			uint64_t nonempty_buckets = (bais_1.summaryBits[word] & bais_2.summaryBits[word]);
+			while(nonempty_buckets != 0)
 			{
-				uint64_t bucket_bits = (sparser_bais.bitBucket[bucket] & denser_bais.bitBucket[bucket]);
-				for(size_t bit = 0; bit < 64; bit++)
+				size_t bucket = word * numBitsPerBucket + std::countr_zero(nonempty_buckets);
+				nonempty_buckets &= nonempty_buckets - 1;
+
+				uint64_t bucket_bits = (bais_1.bitBucket[bucket] & bais_2.bitBucket[bucket]);
+				while(bucket_bits != 0)
 				{
-					uint64_t mask = (1ULL << bit);
-					if(bucket_bits & mask)
-						func(index);
-				}
-			}
-		}
-		else if(sparser_indices_per_bucket >= 32)
-		{
-			for(size_t index = 0; index < end_index; index++)
-			{
-				if(sparser_bais.ContainsWithoutMaximumIndexCheck(index)
-						&& denser_bais.ContainsWithoutMaximumIndexCheck(index))
-					func(index);
-			}
-		}
-		else //use the iterator, which is more efficient when sparse
-		{
-			auto iter = sparser_bais.begin();
-			size_t index = *iter;
-			while(index < end_index)
-			{
-				if(denser_bais.ContainsWithoutMaximumIndexCheck(index))
+					size_t index = bais_1.GetIndexFromBucketAndBit(bucket, std::countr_zero(bucket_bits));
+					if(index >= up_to_index)
+						return;
+
 					func(index);
-				++iter;
-				index = *iter;
+					bucket_bits &= bucket_bits - 1;
+				}
 			}
 		}
 	}
@@ -575,39 +769,27 @@ public:
 	{
 		bit++;
 
-		//optimized early exit for dense arrays
-		if(bit < numBitsPerBucket && (bitBucket[bucket] & (1ULL << bit)))
-			return;
-
-		//move on to next bucket if out of bits
-		if(bit == numBitsPerBucket || bitBucket[bucket] < (1ULL << bit))
+		if(bit < numBitsPerBucket)
 		{
-			bit = 0;
-			bucket++;
+			uint64_t remaining_bits = (bitBucket[bucket] >> bit);
 
-			//exit out if no more buckets
-			if(bucket == bitBucket.size())
+			//optimized early exit for dense arrays
+			if(remaining_bits & 1)
 				return;
-		}
-
-		//there's leftover bits set, find the next
-		if(bitBucket[bucket] > 0)
-		{
-			while((bitBucket[bucket] & (1ULL << bit)) == 0)
-				bit++;
-			return;
-		}
 
-		//empty bucket, skip until find non-empty or run out of buckets
-		do
-		{
-			bucket++;
-			if(bucket == bitBucket.size())
+			//there's leftover bits set, find the next
+			if(remaining_bits != 0)
+			{
+				bit += std::countr_zero(remaining_bits);
 				return;
-		} while(bitBucket[bucket] == 0);
+			}
+		}
 
-		//if made it here, then there is nonzero value in bitBucket[bucket]
-		bit = std::countr_zero(bitBucket[bucket]);
+		//skip to the next nonempty bucket, if any
+		bit = 0;
+		bucket = FindNextNonemptyBucket(bucket + 1);
+		if(bucket < bitBucket.size())
+			bit = std::countr_zero(bitBucket[bucket]);
 	}
 
 	//returns the next id in the hash
@@ -624,13 +806,13 @@ public:
 	size_t GetNthElement(size_t n)
 	{
 		//if asking for something too big, just return last element (size)
-		if(n > numElements)
+		if(n >= numElements)
 			return GetEndInteger();
 
-		//fast forward using population count to find the bucket
+		//fast forward using population count of the nonempty buckets to find the bucket
 		size_t iteration = 0;
-		size_t bucket = 0;
-		for(; bucket < bitBucket.size(); bucket++)
+		size_t bucket = FindNextNonemptyBucket(0);
+		for(; bucket < bitBucket.size(); bucket = FindNextNonemptyBucket(bucket + 1))
 		{
 			size_t bucket_count = std::popcount(bitBucket[bucket]);
 			//look for where the count exceeds n because the bit hasn't been found yet (e.g., bit 0 is found by the first count of 1)
@@ -700,6 +882,7 @@ public:
 	__forceinline void clear()
 	{
 		bitBucket.clear();
+		summaryBits.clear();
 		curMaxNumIndices = 0;
 		numElements = 0;
 	}
@@ -717,8 +900,23 @@ public:
 		//num_ids is 1-based, need to get the bucket for 0-based,
 		// then get the size, which adds 1 to the bucket
 		size_t total_num_buckets = GetBucket(num_ids - 1) + 1;
+		size_t prev_num_buckets = bitBucket.size();
 		bitBucket.resize(total_num_buckets, fill_value ? 0xFFFFFFFFFFFFFFFFULL : 0);
 		curMaxNumIndices = total_num_buckets * numBitsPerBucket;
+
+		summaryBits.resize(GetNumSummaryWords(total_num_buckets), 0);
+		if(total_num_buckets < prev_num_buckets)
+		{
+			//clear the summary bits of any buckets removed from the last word
+			size_t last_word_bit = GetBit(total_num_buckets);
+			if(last_word_bit > 0)
+				summaryBits.back() &= (0xFFFFFFFFFFFFFFFFULL >> (numBitsPerBucket - last_word_bit));
+		}
+		else if(fill_value)
+		{
+			for(size_t bucket = prev_num_buckets; bucket < total_num_buckets; bucket++)
+				MarkBucketNonempty(bucket);
+		}
 	}
 
 	//reserves space such that num_ids ranging from 0..num_ids-1 could then be directly placed into the hash
@@ -733,16 +931,13 @@ public:
 	}
 
 	//returns one past the maximum index in the container, 0 if empty
-	constexpr size_t GetEndInteger()
+	inline size_t GetEndInteger()
 	{
 		if(numElements == 0)
 			return 0;
 
-		size_t bucket = bitBucket.size() - 1;
-		while(bucket > 0 && bitBucket[bucket] == 0)
-			bucket--;
-
-		if(bitBucket[bucket] == 0)
+		size_t bucket = FindLastNonemptyBucket();
+		if(bucket == bitBucket.size())
 			return 0;
 
 		//return 1 past the max index
@@ -786,6 +981,8 @@ public:
 			return;
 		}
 
+		//clear first so that any buckets retained from before are filled too
+		clear();
 		resize(up_to_id, true);
 
 		//set the last field if applicable
@@ -813,6 +1010,7 @@ public:
 			//set bit to 1
 			bucket |= mask;
 			numElements++;
+			MarkBucketNonempty(GetBucket(id));
 		}
 	}
 
@@ -846,6 +1044,7 @@ public:
 					//set bit to 1
 					bucket |= mask;
 					numElements++;
+					MarkBucketNonempty(GetBucket(id));
 				}
 			}
 		}
@@ -859,6 +1058,7 @@ public:
 				//set bit to 1
 				bucket |= mask;
 				numElements++;
+				MarkBucketNonempty(GetBucket(id));
 			}
 		}
 	}
@@ -901,6 +1101,8 @@ public:
 		//set bit to 0
 		bucket &= ~mask;
 		numElements--;
+		if(bucket == 0)
+			MarkBucketEmpty(GetBucket(id));
 
 		if(trim_back)
 			TrimBack();
@@ -910,15 +1112,21 @@ public:
 	// does NOT update the number of elements, so UpdateNumElements must be called
 	void EraseInBatch(BitArrayIntegerSet &other)
 	{
-		size_t max_index = std::min(curMaxNumIndices, other.curMaxNumIndices);
-		if(max_index == 0)
-			return;
-
-		size_t max_bucket = GetBucket(max_index - 1);
+		//only buckets that are nonempty in both can change
+		size_t num_summary_words = std::min(summaryBits.size(), other.summaryBits.size());
+		for(size_t word = 0; word < num_summary_words; word++)
+		{
+			uint64_t nonempty_buckets = (summaryBits[word] & other.summaryBits[word]);
+			while(nonempty_buckets != 0)
+			{
+				size_t bucket = word * numBitsPerBucket + std::countr_zero(nonempty_buckets);
+				nonempty_buckets &= nonempty_buckets - 1;
 
-		//perform intersection
-		for(size_t i = 0; i <= max_bucket; i++)
-			bitBucket[i] &= ~(other.bitBucket[i]);
+				bitBucket[bucket] &= ~(other.bitBucket[bucket]);
+				if(bitBucket[bucket] == 0)
+					MarkBucketEmpty(bucket);
+			}
+		}
 
 		TrimBack();
 	}
@@ -939,6 +1147,8 @@ public:
 				//set bit to 0
 				bucket &= ~mask;
 				numElements--;
+				if(bucket == 0)
+					MarkBucketEmpty(GetBucket(id));
 			}
 		}
 
@@ -979,6 +1189,8 @@ public:
 		//set bit to 0
 		bucket &= ~mask;
 		numElements--;
+		if(bucket == 0)
+			MarkBucketEmpty(GetBucket(id));
 
 		TrimBack();
 
@@ -1004,6 +1216,8 @@ public:
 			//set bit to 0
 			bucket_from &= ~mask_from;
 			numElements--;
+			if(bucket_from == 0)
+				MarkBucketEmpty(GetBucket(id_from));
 		}
 
 		insert(id_to);
@@ -1014,20 +1228,30 @@ public:
 	// must be called if a Batch operation is used
 	__forceinline void UpdateNumElements()
 	{
-		//update num elements
+		//update num elements, only counting nonempty buckets
 		numElements = 0;
-		for(const auto &bucket : bitBucket)
-			numElements += std::popcount(bucket);
+		size_t num_buckets_allocated = bitBucket.size();
+		for(size_t bucket = FindNextNonemptyBucket(0); bucket < num_buckets_allocated;
+				bucket = FindNextNonemptyBucket(bucket + 1))
+			numElements += std::popcount(bitBucket[bucket]);
 	}
 
 	//trims off trailing empty buckets
 	__forceinline void TrimBack()
 	{
+		size_t last_nonempty_bucket = FindLastNonemptyBucket();
+
 		//always want to leave one bucket left
-		while(bitBucket.size() > 1 && bitBucket.back() == 0)
+		size_t num_buckets_to_keep = 1;
+		if(last_nonempty_bucket < bitBucket.size())
+			num_buckets_to_keep = last_nonempty_bucket + 1;
+
+		if(num_buckets_to_keep < bitBucket.size())
 		{
-			bitBucket.pop_back();
-			curMaxNumIndices -= numBitsPerBucket;
+			//summary bits of the removed buckets are already clear
+			bitBucket.resize(num_buckets_to_keep);
+			summaryBits.resize(GetNumSummaryWords(num_buckets_to_keep));
+			curMaxNumIndices = num_buckets_to_keep * numBitsPerBucket;
 		}
 	}
 
@@ -1041,9 +1265,18 @@ public:
 		//make sure it can hold all of the other
 		ReserveNumIntegers(other.curMaxNumIndices);
 
-		//perform union
-		for(size_t i = 0; i < other.bitBucket.size(); i++)
-			bitBucket[i] |= other.bitBucket[i];
+		//perform union over the nonempty buckets of other
+		for(size_t word = 0; word < other.summaryBits.size(); word++)
+		{
+			uint64_t nonempty_buckets = other.summaryBits[word];
+			summaryBits[word] |= nonempty_buckets;
+			while(nonempty_buckets != 0)
+			{
+				size_t bucket = word * numBitsPerBucket + std::countr_zero(nonempty_buckets);
+				nonempty_buckets &= nonempty_buckets - 1;
+				bitBucket[bucket] |= other.bitBucket[bucket];
+			}
+		}
 
 		UpdateNumElements();
 	}
@@ -1059,16 +1292,38 @@ public:
 			return;
 		}
 
-		size_t this_bucket_end = bitBucket.size();
-		size_t other_bucket_end = other.bitBucket.size();
+		//only visit buckets that are nonempty in this
+		size_t num_other_summary_words = other.summaryBits.size();
+		for(size_t word = 0; word < summaryBits.size(); word++)
+		{
+			uint64_t nonempty_buckets = summaryBits[word];
+			uint64_t other_nonempty_buckets = (word < num_other_summary_words ? other.summaryBits[word] : 0);
+
+			//clear buckets that are empty in the other
+			uint64_t buckets_to_clear = (nonempty_buckets & ~other_nonempty_buckets);
+			while(buckets_to_clear != 0)
+			{
+				size_t bucket = word * numBitsPerBucket + std::countr_zero(buckets_to_clear);
+				buckets_to_clear &= buckets_to_clear - 1;
+				bitBucket[bucket] = 0;
+			}
 
-		//perform intersection on overlap
-		for(size_t i = 0; i < this_bucket_end && i < other_bucket_end; i++)
-			bitBucket[i] &= other.bitBucket[i];
+			//perform intersection on overlap
+			uint64_t buckets_to_intersect = (nonempty_buckets & other_nonempty_buckets);
+			uint64_t remaining_nonempty_buckets = buckets_to_intersect;
+			while(buckets_to_intersect != 0)
+			{
+				size_t bucket_bit = std::countr_zero(buckets_to_intersect);
+				buckets_to_intersect &= buckets_to_intersect - 1;
+
+				size_t bucket = word * numBitsPerBucket + bucket_bit;
+				bitBucket[bucket] &= other.bitBucket[bucket];
+				if(bitBucket[bucket] == 0)
+					remaining_nonempty_buckets &= ~(1ULL << bucket_bit);
+			}
 
-		//clear buckets after the other
-		for(size_t i = other_bucket_end; i < this_bucket_end; i++)
-			bitBucket[i] = 0;
+			summaryBits[word] = remaining_nonempty_buckets;
+		}
 
 		TrimBack();
 	}
@@ -1153,6 +1408,7 @@ public:
 		}
 
 		curMaxNumIndices = (bitBucket.size() * numBitsPerBucket);
+		RebuildSummary();
 		TrimBack();
 	}
 
@@ -1189,6 +1445,7 @@ public:
 			bitBucket[last_bucket] &= last_bucket_bitmask;
 		}
 
+		RebuildSummary();
 		TrimBack();
 		UpdateNumElements();
 	}
@@ -1224,10 +1481,17 @@ public:
 			bitBucket[last_bucket] &= last_bucket_bitmask;
 		}
 
+		RebuildSummary();
 		TrimBack();
 		UpdateNumElements();
 	}
 
+	//returns the estimated number of bytes of memory allocated by the set beyond the object itself
+	inline size_t GetEstimatedSizeInBytes()
+	{
+		return (bitBucket.capacity() + summaryBits.capacity()) * sizeof(uint64_t);
+	}
+
 	//bits per bucket given uint64_t
 	static constexpr size_t numBitsPerBucket = 64;
 
@@ -1250,6 +1514,68 @@ protected:
 		return (bucket * numBitsPerBucket) + bit;
 	}
 
+	//returns the number of summary words needed for num_buckets
+	static constexpr size_t GetNumSummaryWords(size_t num_buckets)
+	{
+		return (num_buckets + numBitsPerBucket - 1) / numBitsPerBucket;
+	}
+
+	//marks bucket as nonempty in the summary
+	__forceinline void MarkBucketNonempty(size_t bucket)
+	{
+		summaryBits[GetBucket(bucket)] |= (1ULL << GetBit(bucket));
+	}
+
+	//marks bucket as empty in the summary
+	__forceinline void MarkBucketEmpty(size_t bucket)
+	{
+		summaryBits[GetBucket(bucket)] &= ~(1ULL << GetBit(bucket));
+	}
+
+	//recomputes the summary from the bit buckets
+	// must be called after bulk operations that modify the buckets directly
+	void RebuildSummary()
+	{
+		summaryBits.assign(GetNumSummaryWords(bitBucket.size()), 0);
+		for(size_t bucket = 0; bucket < bitBucket.size(); bucket++)
+		{
+			if(bitBucket[bucket] != 0)
+				MarkBucketNonempty(bucket);
+		}
+	}
+
+	//returns the first nonempty bucket at or after bucket, or bitBucket.size() if there are none
+	inline size_t FindNextNonemptyBucket(size_t bucket)
+	{
+		if(bucket >= bitBucket.size())
+			return bitBucket.size();
+
+		size_t word = GetBucket(bucket);
+		uint64_t nonempty_buckets = (summaryBits[word] & (0xFFFFFFFFFFFFFFFFULL << GetBit(bucket)));
+		while(nonempty_buckets == 0)
+		{
+			word++;
+			if(word == summaryBits.size())
+				return bitBucket.size();
+			nonempty_buckets = summaryBits[word];
+		}
+
+		return GetIndexFromBucketAndBit(word, std::countr_zero(nonempty_buckets));
+	}
+
+	//returns the last nonempty bucket, or bitBucket.size() if there are none
+	inline size_t FindLastNonemptyBucket()
+	{
+		for(size_t word = summaryBits.size(); word > 0; word--)
+		{
+			uint64_t nonempty_buckets = summaryBits[word - 1];
+			if(nonempty_buckets != 0)
+				return GetIndexFromBucketAndBit(word - 1, std::bit_width(nonempty_buckets) - 1);
+		}
+
+		return bitBucket.size();
+	}
+
 	//num elements that exist as inserted in the hash
 	size_t numElements;
 
@@ -1258,6 +1584,9 @@ protected:
 
 	//buffer of bit buckets
 	std::vector<uint64_t> bitBucket;
+
+	//bit b of summaryBits[w] is set if and only if bitBucket[w * numBitsPerBucket + b] is nonzero
+	std::vector<uint64_t> summaryBits;
 };
 
 class EfficientIntegerSet
@@ -1851,6 +2180,12 @@ public:
 		}
 	}
 
+	//returns the estimated number of bytes of memory allocated by the set beyond the object itself
+	inline size_t GetEstimatedSizeInBytes()
+	{
+		return sisContainer.GetEstimatedSizeInBytes() + baisContainer.GetEstimatedSizeInBytes();
+	}
+
 	//functions for specialized use
 
 	constexpr bool IsSisContainer()
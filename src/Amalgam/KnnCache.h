@@ -197,22 +197,22 @@ protected:
 	std::vector<std::vector<DistanceReferencePair<size_t>>> cachedNeighbors;
 
 	//pointer to datastore used to populate cache
-	SeparableBoxFilterDataStore *sbfDataStore;
+	SeparableBoxFilterDataStore *sbfDataStore = nullptr;
 
 	//distance parameters for the search
-	GeneralizedDistanceEvaluator *distEvaluator;
+	GeneralizedDistanceEvaluator *distEvaluator = nullptr;
 
 	//calling interpreter
-	Interpreter *interpreter;
+	Interpreter *interpreter = nullptr;
 
 	//containing entity being queried
-	Entity *entity;
+	Entity *entity = nullptr;
 
 	//position labels
-	std::vector<StringInternPool::StringID> *positionLabelIds;
+	std::vector<StringInternPool::StringID> *positionLabelIds = nullptr;
 
-	StringInternPool::StringID radiusLabelId;
+	StringInternPool::StringID radiusLabelId = StringInternPool::NOT_A_STRING_ID;
 
 	//pointer to the indices of relevant entities used to populate the cache
-	BitArrayIntegerSet *relevantIndices;
+	BitArrayIntegerSet *relevantIndices = nullptr;
 };
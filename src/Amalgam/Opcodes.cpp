@@ -313,6 +313,7 @@ void StringInternPool::InitializeStaticStrings()
 	EmplaceStaticString(ENBISI_flatten, "flatten");
 	EmplaceStaticString(ENBISI_execute_on_load, "execute_on_load");
 	EmplaceStaticString(ENBISI_load_external_files, "load_external_files");
+	EmplaceStaticString(ENBISI_rows_as_entities, "rows_as_entities");
 
 	//substr parameters
 	EmplaceStaticString(ENBISI_all, "all");
@@ -355,6 +356,7 @@ void StringInternPool::InitializeStaticStrings()
 	EmplaceStaticString(ENBISI_data_type, "data_type");
 	EmplaceStaticString(ENBISI_nominal_count, "nominal_count");
 	EmplaceStaticString(ENBISI_cycle_range, "cycle_range");
+	EmplaceStaticString(ENBISI_cache_call_entity, "cache_call_entity");
 
 	//distance parameter values
 	EmplaceStaticString(ENBISI_surprisal, "surprisal");
@@ -364,6 +366,7 @@ void StringInternPool::InitializeStaticStrings()
 	EmplaceStaticString(ENBISI_precise, "precise");
 	EmplaceStaticString(ENBISI_fast, "fast");
 	EmplaceStaticString(ENBISI_recompute_precise, "recompute_precise");
+	EmplaceStaticString(ENBISI_single_recompute_precise, "single_recompute_precise");
 
 	//format opcode types
 	EmplaceStaticString(ENBISI_code, "code");
@@ -406,6 +409,7 @@ void StringInternPool::InitializeStaticStrings()
 	EmplaceStaticString(ENBISI_sort_keys, "sort_keys");
 	EmplaceStaticString(ENBISI_locale, "locale");
 	EmplaceStaticString(ENBISI_time_zone, "time_zone");
+	EmplaceStaticString(ENBISI_batch, "batch");
 
 	//mutate opcode mutation types
 	EmplaceStaticString(ENBISI_change_type, "change_type");
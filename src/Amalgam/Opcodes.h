@@ -323,6 +323,7 @@ enum EvaluableNodeBuiltInStringId
 	ENBISI_parallel_create,
 	ENBISI_execute_on_load,
 	ENBISI_load_external_files,
+	ENBISI_rows_as_entities,
 
 	//substr parameters
 	ENBISI_all,
@@ -365,6 +366,7 @@ enum EvaluableNodeBuiltInStringId
 	ENBISI_data_type,
 	ENBISI_nominal_count,
 	ENBISI_cycle_range,
+	ENBISI_cache_call_entity,
 
 	//distance parameter values
 	ENBISI_surprisal,
@@ -374,6 +376,7 @@ enum EvaluableNodeBuiltInStringId
 	ENBISI_precise,
 	ENBISI_fast,
 	ENBISI_recompute_precise,
+	ENBISI_single_recompute_precise,
 
 	//format opcode types
 	ENBISI_code,
@@ -416,6 +419,7 @@ enum EvaluableNodeBuiltInStringId
 	ENBISI_sort_keys,
 	ENBISI_locale,
 	ENBISI_time_zone,
+	ENBISI_batch,
 
 	//mutate opcode mutation types
 	ENBISI_change_type,
@@ -1,4 +1,5 @@
 //project headers:
+#include "Concurrency.h"
 #include "SBFDSColumnData.h"
 
 void SBFDSColumnData::InsertIndexValue(EvaluableNodeImmediateValueType value_type,
@@ -7,6 +8,8 @@ void SBFDSColumnData::InsertIndexValue(EvaluableNodeImmediateValueType value_typ
 	if(index >= valueEntries.size())
 		valueEntries.resize(index + 1);
 
+	UpdateSinglePrecisionNumberValue(value_type, value, index);
+
 	if(value_type == ENIVT_NOT_EXIST)
 	{
 		invalidIndices.insert(index);
@@ -176,9 +179,78 @@ void SBFDSColumnData::InsertNextIndexValueExceptNumbers(EvaluableNodeImmediateVa
 	}
 }
 
+void SBFDSColumnData::InsertAllIndexValues(std::vector<EvaluableNodeImmediateValueWithType> &values, bool run_concurrently)
+{
+	valueEntries.resize(values.size());
+
+	//(value, index) pairs, accumulated in increasing index order
+	std::vector<std::pair<double, size_t>> number_values;
+	std::vector<std::pair<StringInternPool::StringID, size_t>> string_id_values;
+
+	for(size_t index = 0; index < values.size(); index++)
+	{
+		auto &value = values[index];
+		//nan is not ordered, so it cannot be grouped with other numbers; it is null wherever else it is stored
+		if(value.nodeType == ENIVT_NUMBER && FastIsNaN(value.nodeValue.number))
+		{
+			InsertNextIndexValueExceptNumbers(ENIVT_NULL, value.nodeValue, index);
+		}
+		else if(value.nodeType == ENIVT_NUMBER)
+		{
+			valueEntries[index] = value.nodeValue;
+			numberIndices.insert(index);
+			number_values.emplace_back(value.nodeValue.number, index);
+		}
+		else if(value.nodeType == ENIVT_STRING_ID)
+		{
+			valueEntries[index] = value.nodeValue;
+			stringIdIndices.insert(index);
+			string_id_values.emplace_back(value.nodeValue.stringID, index);
+		}
+		else
+		{
+			InsertNextIndexValueExceptNumbers(value.nodeType, value.nodeValue, index);
+		}
+	}
+
+	//stable sorts keep the indices of each value in increasing order
+	StableSortConcurrentlyIfPossible(number_values,
+		[](const auto &a, const auto &b) { return a.first < b.first; }, run_concurrently);
+
+	for(size_t i = 0; i < number_values.size(); )
+	{
+		double number = number_values[i].first;
+		auto value_entry_iter = sortedNumberValueEntries.try_emplace(end(sortedNumberValueEntries), number, number);
+		auto &indices_with_value = value_entry_iter->second.indicesWithValue;
+		for(; i < number_values.size() && number_values[i].first == number; i++)
+			indices_with_value.InsertNewLargestInteger(number_values[i].second);
+	}
+
+	//string ids only need to be grouped, so order them by their raw representation
+	StableSortConcurrentlyIfPossible(string_id_values,
+		[](const auto &a, const auto &b)
+		{ return std::less<StringInternStringData *>()(a.first.pointerOrShortString, b.first.pointerOrShortString); },
+		run_concurrently);
+
+	for(size_t i = 0; i < string_id_values.size(); )
+	{
+		auto sid = string_id_values[i].first;
+		auto [id_entry, inserted] = stringIdValueEntries.emplace(sid, nullptr);
+		if(inserted)
+			id_entry->second = std::make_unique<ValueEntry>(sid);
+
+		auto &indices_with_value = id_entry->second->indicesWithValue;
+		UpdateLongestStringOutOfOrder(sid, string_id_values[i].second);
+		for(; i < string_id_values.size() && string_id_values[i].first == sid; i++)
+			indices_with_value.InsertNewLargestInteger(string_id_values[i].second);
+	}
+}
+
 void SBFDSColumnData::ChangeIndexValue(EvaluableNodeImmediateValueType new_value_type,
 		EvaluableNodeImmediateValue new_value, size_t index)
 {
+	UpdateSinglePrecisionNumberValue(new_value_type, new_value, index);
+
 	EvaluableNodeImmediateValue old_value = valueEntries[index];
 	EvaluableNodeImmediateValueType old_value_type = GetIndexValueType(index);
 
@@ -414,6 +486,62 @@ void SBFDSColumnData::ChangeIndexValue(EvaluableNodeImmediateValueType new_value
 	InsertIndexValue(new_value_type_resolved, new_value_resolved, index);
 }
 
+void SBFDSColumnData::ChangeIndicesNumberValues(std::vector<std::pair<size_t, double>> &indices_and_values)
+{
+	//group the indices by the value each is leaving and the value each is joining,
+	// each group remaining sorted because indices_and_values is sorted by index
+	FastHashMap<double, std::vector<size_t>> old_value_to_indices;
+	FastHashMap<double, std::vector<size_t>> new_value_to_indices;
+	for(auto &[index, new_number_value] : indices_and_values)
+	{
+		UpdateSinglePrecisionNumberValue(ENIVT_NUMBER, EvaluableNodeImmediateValue(new_number_value), index);
+
+		double old_number_value = GetResolvedIndexValue(index).number;
+		if(old_number_value == new_number_value)
+			continue;
+
+		old_value_to_indices[old_number_value].push_back(index);
+		new_value_to_indices[new_number_value].push_back(index);
+	}
+
+	//remove from the old values first so that any value entry left empty is removed before new entries are interned
+	for(auto &[old_number_value, indices] : old_value_to_indices)
+	{
+		auto old_value_entry = sortedNumberValueEntries.find(old_number_value);
+		if(old_value_entry == end(sortedNumberValueEntries)) [[unlikely]]
+		{
+			AmlgAssert(false);
+			continue;
+		}
+
+		auto &indices_with_value = old_value_entry->second.indicesWithValue;
+		indices_with_value.erase(indices);
+		if(indices_with_value.size() == 0)
+		{
+			internedNumberValues.DeleteInternIndex(old_value_entry->second.valueInternIndex);
+			sortedNumberValueEntries.erase(old_value_entry);
+		}
+	}
+
+	for(auto &[new_number_value, indices] : new_value_to_indices)
+	{
+		auto [new_value_entry_iter, inserted] = sortedNumberValueEntries.try_emplace(new_number_value, new_number_value);
+		auto &new_value_entry = new_value_entry_iter->second;
+		new_value_entry.indicesWithValue.insert(indices);
+
+		if(inserted)
+			internedNumberValues.InsertValueEntry(new_value_entry, sortedNumberValueEntries.size());
+
+		for(size_t index : indices)
+		{
+			if(internedNumberValues.valueInterningEnabled)
+				valueEntries[index] = EvaluableNodeImmediateValue(new_value_entry.valueInternIndex);
+			else
+				valueEntries[index] = EvaluableNodeImmediateValue(new_number_value);
+		}
+	}
+}
+
 void SBFDSColumnData::RemoveIndexValue(EvaluableNodeImmediateValueType value_type, EvaluableNodeImmediateValue value,
 	size_t index, bool remove_last_entity, bool set_not_exist)
 {
@@ -515,16 +643,42 @@ void SBFDSColumnData::RemoveIndexValue(EvaluableNodeImmediateValueType value_typ
 	if(remove_last_entity)
 	{
 		valueEntries.pop_back();
+		if(singlePrecisionNumberValuesBuilt && singlePrecisionNumberValues.size() > valueEntries.size())
+			singlePrecisionNumberValues.resize(valueEntries.size());
 	}
 	else
 	{
 		valueEntries[index] = std::numeric_limits<double>::quiet_NaN();
+		UpdateSinglePrecisionNumberValue(ENIVT_NOT_EXIST, EvaluableNodeImmediateValue(), index);
 
 		if(set_not_exist)
 			invalidIndices.insert(index);
 	}
 }
 
+void SBFDSColumnData::BuildSinglePrecisionNumberValues()
+{
+	if(singlePrecisionNumberValuesBuilt)
+		return;
+
+#ifdef MULTITHREAD_SUPPORT
+	Concurrency::Lock lock(singlePrecisionNumberValuesMutex);
+	//another thread may have built it while waiting for the lock
+	if(singlePrecisionNumberValuesBuilt)
+		return;
+#endif
+
+	singlePrecisionNumberValues.assign(valueEntries.size(), std::numeric_limits<float>::quiet_NaN());
+	for(auto &[number_value, value_entry] : sortedNumberValueEntries)
+	{
+		float value = static_cast<float>(number_value);
+		for(size_t index : value_entry.indicesWithValue)
+			singlePrecisionNumberValues[index] = value;
+	}
+
+	singlePrecisionNumberValuesBuilt = true;
+}
+
 void SBFDSColumnData::Optimize()
 {
 #ifdef SBFDS_VERIFICATION
@@ -600,6 +754,52 @@ void SBFDSColumnData::Optimize()
 #endif
 }
 
+size_t SBFDSColumnData::GetEstimatedSizeInBytes()
+{
+	//each map node holds its value plus the parent, child, and color fields
+	constexpr size_t map_node_overhead = 4 * sizeof(void *);
+	//each hash map slot holds its value plus metadata
+	constexpr size_t hash_slot_overhead = sizeof(void *);
+
+	size_t total_size = sizeof(SBFDSColumnData);
+	total_size += valueEntries.capacity() * sizeof(EvaluableNodeImmediateValue);
+
+	for(auto &[number_value, value_entry] : sortedNumberValueEntries)
+		total_size += sizeof(std::pair<const double, ValueEntry>) + map_node_overhead
+			+ value_entry.indicesWithValue.GetEstimatedSizeInBytes();
+
+	double string_size = 0.0;
+	total_size += stringIdValueEntries.bucket_count()
+		* (sizeof(std::pair<StringInternPool::StringID, std::unique_ptr<ValueEntry>>) + hash_slot_overhead);
+	for(auto &[sid, value_entry] : stringIdValueEntries)
+	{
+		total_size += sizeof(ValueEntry) + value_entry->indicesWithValue.GetEstimatedSizeInBytes();
+		string_size += StringInternPool::GetEstimatedSizeInBytesPerReference(sid);
+	}
+
+	total_size += valueCodeSizeToIndices.bucket_count()
+		* (sizeof(std::pair<size_t, std::unique_ptr<SortedIntegerSet>>) + hash_slot_overhead);
+	for(auto &[code_size, indices] : valueCodeSizeToIndices)
+		total_size += sizeof(SortedIntegerSet) + indices->GetEstimatedSizeInBytes();
+
+	total_size += invalidIndices.GetEstimatedSizeInBytes();
+	total_size += falseBoolIndices.GetEstimatedSizeInBytes();
+	total_size += trueBoolIndices.GetEstimatedSizeInBytes();
+	total_size += numberIndices.GetEstimatedSizeInBytes();
+	total_size += stringIdIndices.GetEstimatedSizeInBytes();
+	total_size += nullIndices.GetEstimatedSizeInBytes();
+	total_size += codeIndices.GetEstimatedSizeInBytes();
+
+	total_size += singlePrecisionNumberValues.capacity() * sizeof(float);
+
+	total_size += internedNumberValues.internedIndexToValue.capacity() * sizeof(double);
+	total_size += internedNumberValues.unusedValueIndices.size() * sizeof(size_t);
+	total_size += internedStringIdValues.internedIndexToValue.capacity() * sizeof(StringInternPool::StringID);
+	total_size += internedStringIdValues.unusedValueIndices.size() * sizeof(size_t);
+
+	return total_size + static_cast<size_t>(string_size);
+}
+
 void SBFDSColumnData::FindAllIndicesWithinRange(EvaluableNodeImmediateValueType value_type,
 		EvaluableNodeImmediateValue &low, EvaluableNodeImmediateValue &high, BitArrayIntegerSet &out, bool between_values)
 {
@@ -6,8 +6,13 @@
 #include "HashMaps.h"
 #include "IntegerSet.h"
 
+#ifdef MULTITHREAD_SUPPORT
+#include "Concurrency.h"
+#endif
+
 //system headers:
 #include <algorithm>
+#include <atomic>
 #include <memory>
 #include <type_traits>
 #include <vector>
@@ -58,7 +63,7 @@ public:
 	//column needs to be named when it is created
 	inline SBFDSColumnData(StringInternPool::StringID sid)
 		: stringId(sid), indexWithLongestString(0), longestStringLength(0),
-		indexWithLargestCode(0), largestCodeSize(0)
+		indexWithLargestCode(0), largestCodeSize(0), singlePrecisionNumberValuesBuilt(false)
 	{}
 
 	//returns the value type of the given index given the value
@@ -137,6 +142,12 @@ public:
 	void InsertNextIndexValueExceptNumbers(EvaluableNodeImmediateValueType value_type,
 		EvaluableNodeImmediateValue &value, size_t index);
 
+	//like InsertNextIndexValueExceptNumbers, but inserts values[index] for every index into an empty column
+	//numbers and strings are grouped by sorting rather than inserted one at a time, so each distinct value
+	// is only looked up and allocated once and the number entries are appended in order
+	//if run_concurrently is true, then the sorting may use multiple threads
+	void InsertAllIndexValues(std::vector<EvaluableNodeImmediateValueWithType> &values, bool run_concurrently);
+
 	//inserts a particular value based on the value_index
 	//templated to make it efficiently work regardless of the container
 	template<typename StringIdValueEntryIterator>
@@ -152,6 +163,11 @@ public:
 	void ChangeIndexValue(EvaluableNodeImmediateValueType new_value_type,
 		EvaluableNodeImmediateValue new_value, size_t index);
 
+	//like ChangeIndexValue for each pair of index and new number value in indices_and_values,
+	// where indices_and_values is sorted by index and each index currently holds a number
+	//moves the indices between value entries with one sorted merge per value rather than one insert and erase per index
+	void ChangeIndicesNumberValues(std::vector<std::pair<size_t, double>> &indices_and_values);
+
 	//removes everything involving the value at the index
 	//if remove_last_entity is true, then it will remove the last entry (assumes index is the last entry)
 	//if set_not_exist is true, then it will set in the internal indices that the value is nonexistent
@@ -162,6 +178,30 @@ public:
 	//changes column to/from interning as would yield best performance
 	void Optimize();
 
+	//returns the estimated number of bytes of memory used by the column, including its indices
+	// and its share of the memory of the strings it references
+	size_t GetEstimatedSizeInBytes();
+
+	//builds singlePrecisionNumberValues if it has not already been built
+	//may be called concurrently by multiple readers
+	void BuildSinglePrecisionNumberValues();
+
+	//if singlePrecisionNumberValues has been built, sets the value for index
+	inline void UpdateSinglePrecisionNumberValue(EvaluableNodeImmediateValueType value_type,
+		EvaluableNodeImmediateValue value, size_t index)
+	{
+		if(!singlePrecisionNumberValuesBuilt)
+			return;
+
+		if(index >= singlePrecisionNumberValues.size())
+			singlePrecisionNumberValues.resize(index + 1, std::numeric_limits<float>::quiet_NaN());
+
+		if(ResolveValueType(value_type) == ENIVT_NUMBER)
+			singlePrecisionNumberValues[index] = static_cast<float>(ResolveValue(value_type, value).number);
+		else
+			singlePrecisionNumberValues[index] = std::numeric_limits<float>::quiet_NaN();
+	}
+
 	//returns the number of unique values in the column
 	//if value_type is ENIVT_NULL, then it will include all types, otherwise it will only consider
 	//the unique values for the type requested
@@ -527,6 +567,20 @@ protected:
 		}
 	}
 
+	//like UpdateLongestString, but for strings that are not updated in order of index,
+	// so keeps the lowest index among the longest strings, the same as updating them in order
+	inline void UpdateLongestStringOutOfOrder(StringInternPool::StringID sid, size_t index)
+	{
+		auto str = string_intern_pool.GetStringViewFromID(sid);
+		size_t str_size = StringManipulation::GetUTF8CharacterLength(str);
+		if(str_size > longestStringLength
+				|| (str_size == longestStringLength && str_size > 0 && index < indexWithLongestString))
+		{
+			longestStringLength = str_size;
+			indexWithLongestString = index;
+		}
+	}
+
 	//should be called when the longest string is invalidated
 	inline void RecomputeLongestString()
 	{
@@ -606,6 +660,16 @@ public:
 	//the largest code size for this label
 	size_t largestCodeSize;
 
+	//for each index, the number value in single precision or NaN if the value is not a number
+	//only built when first needed and then kept up to date with valueEntries
+	std::vector<float> singlePrecisionNumberValues;
+#ifdef MULTITHREAD_SUPPORT
+	std::atomic<bool> singlePrecisionNumberValuesBuilt;
+	Concurrency::SingleMutex singlePrecisionNumberValuesMutex;
+#else
+	bool singlePrecisionNumberValuesBuilt;
+#endif
+
 	template<typename ValueType>
 	class InternedValues
 	{
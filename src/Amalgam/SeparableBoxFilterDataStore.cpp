@@ -2,10 +2,12 @@
 #include "Entity.h"
 #include "EvaluableNodeReference.h"
 #include "Interpreter.h"
+#include "Parser.h"
 #include "PerformanceProfiler.h"
 #include "SeparableBoxFilterDataStore.h"
 
 //system headers
+#include <algorithm>
 #include <limits>
 
 #if defined(MULTITHREAD_SUPPORT)
@@ -13,7 +15,8 @@ thread_local
 #endif
 SeparableBoxFilterDataStore::SBFDSParametersAndBuffers SeparableBoxFilterDataStore::parametersAndBuffers;
 
-void SeparableBoxFilterDataStore::BuildLabel(size_t column_index, const std::vector<Entity *> &entities)
+void SeparableBoxFilterDataStore::BuildLabel(size_t column_index, const std::vector<Entity *> &entities,
+	bool run_concurrently)
 {
 	auto &column_data = columnData[column_index];
 	auto label_id = column_data->stringId;
@@ -25,17 +28,51 @@ void SeparableBoxFilterDataStore::BuildLabel(size_t column_index, const std::vec
 	//clear value interning if applied
 	column_data->ConvertNumberInternsToValues();
 
-	column_data->valueEntries.resize(entities.size());
+	//retrieve all of the values first so that they can be inserted in bulk
+	std::vector<EvaluableNodeImmediateValueWithType> values(entities.size());
+	auto get_values = [&entities, &values, label_id, is_label_accessible](size_t start_index, size_t end_index)
+	{
+		for(size_t entity_index = start_index; entity_index < end_index; entity_index++)
+			values[entity_index] = entities[entity_index]->GetValueAtLabelAsImmediateValue(label_id, is_label_accessible).first;
+	};
 
-	//populate data
-	// maintaining the order of insertion of the entities from smallest to largest allows for better performance of the insertions
-	// and every function called here assumes that entities are inserted in increasing order
-	for(size_t entity_index = 0; entity_index < entities.size(); entity_index++)
+#ifdef MULTITHREAD_SUPPORT
+	size_t num_blocks = std::min(Concurrency::GetMaxNumThreads(), entities.size() / minEntitiesPerBuildBlock);
+	if(run_concurrently && num_blocks > 1)
+	{
+		auto enqueue_task_lock = Concurrency::urgentThreadPool.AcquireTaskLock();
+		if(Concurrency::urgentThreadPool.AreThreadsAvailable())
+		{
+			auto task_set = Concurrency::urgentThreadPool.CreateCountableTaskSet(num_blocks);
+			for(size_t block_index = 0; block_index < num_blocks; block_index++)
+			{
+				size_t start_index = entities.size() * block_index / num_blocks;
+				size_t end_index = entities.size() * (block_index + 1) / num_blocks;
+				Concurrency::urgentThreadPool.BatchEnqueueTask([&get_values, start_index, end_index, &task_set]()
+				{
+					get_values(start_index, end_index);
+					task_set.MarkTaskCompleted();
+				}
+				);
+			}
+
+			task_set.WaitForTasks(&enqueue_task_lock);
+		}
+		else
+		{
+			enqueue_task_lock.unlock();
+			get_values(0, entities.size());
+		}
+	}
+	else
+#endif
 	{
-		auto [value, found] = entities[entity_index]->GetValueAtLabelAsImmediateValue(label_id, is_label_accessible);
-		column_data->InsertNextIndexValueExceptNumbers(value.nodeType, value.nodeValue, entity_index);
+		get_values(0, entities.size());
 	}
 
+	//populate data
+	column_data->InsertAllIndexValues(values, run_concurrently);
+
 	OptimizeColumn(column_index);
 
 #ifdef SBFDS_VERIFICATION
@@ -43,6 +80,25 @@ void SeparableBoxFilterDataStore::BuildLabel(size_t column_index, const std::vec
 #endif
 }
 
+size_t SeparableBoxFilterDataStore::GetEstimatedSizeInBytes()
+{
+	size_t total_size = columnData.capacity() * sizeof(std::unique_ptr<SBFDSColumnData>);
+	for(auto &column : columnData)
+		total_size += column->GetEstimatedSizeInBytes();
+
+	total_size += labelIdToColumnIndex.bucket_count()
+		* (sizeof(std::pair<StringInternPool::StringID, size_t>) + sizeof(void *));
+
+#if defined(MULTITHREAD_SUPPORT)
+	//caches may be added during concurrent queries
+	Concurrency::ReadLock lock(callEntityResultsCachesMutex);
+#endif
+	for(auto &[call_key, results_cache] : callEntityResultsCaches)
+		total_size += call_key.capacity() + results_cache->GetEstimatedSizeInBytes();
+
+	return total_size;
+}
+
 void SeparableBoxFilterDataStore::AddLabels(std::vector<StringInternPool::StringID> &label_sids,
 	const std::vector<Entity *> &entities)
 {
@@ -60,7 +116,11 @@ void SeparableBoxFilterDataStore::AddLabels(std::vector<StringInternPool::String
 
 #ifdef MULTITHREAD_SUPPORT
 	//if big enough (enough entities and/or enough columns), try to use multithreading
-	if(num_columns_added > 1 && (numEntities > 10000 || (numEntities > 200 && num_columns_added > 10)))
+	bool run_concurrently = (numEntities > 10000 || (numEntities > 200 && num_columns_added > 10));
+
+	//if there are enough columns to keep the threads busy, build the columns concurrently,
+	// otherwise build each column one at a time using multiple threads within each column
+	if(run_concurrently && num_columns_added > 1 && num_columns_added >= Concurrency::GetMaxNumThreads())
 	{
 		auto task_set = Concurrency::urgentThreadPool.CreateCountableTaskSet(num_columns_added);
 
@@ -69,7 +129,7 @@ void SeparableBoxFilterDataStore::AddLabels(std::vector<StringInternPool::String
 		{
 			Concurrency::urgentThreadPool.BatchEnqueueTask([this, &entities, i, &task_set]()
 			{
-				BuildLabel(i, entities);
+				BuildLabel(i, entities, false);
 				task_set.MarkTaskCompleted();
 			}
 			);
@@ -78,11 +138,12 @@ void SeparableBoxFilterDataStore::AddLabels(std::vector<StringInternPool::String
 		task_set.WaitForTasks(&enqueue_task_lock);
 		return;
 	}
-	//not running concurrently
+#else
+	bool run_concurrently = false;
 #endif
 
 	for(size_t i = num_previous_columns; i < num_columns; i++)
-		BuildLabel(i, entities);
+		BuildLabel(i, entities, run_concurrently);
 
 	//remove any that have no values in case an invalid query was done
 	RemoveAnyUnusedLabels();
@@ -124,6 +185,8 @@ void SeparableBoxFilterDataStore::AddEntity(Entity *entity, size_t entity_index)
 	VerifyAllEntitiesForAllColumns();
 #endif
 
+	InvalidateCallEntityResults(entity_index);
+
 	for(auto &column_data : columnData)
 	{
 		auto [value, found] = entity->GetValueAtLabelAsImmediateValue(column_data->stringId);
@@ -143,6 +206,9 @@ void SeparableBoxFilterDataStore::AddEntity(Entity *entity, size_t entity_index)
 
 void SeparableBoxFilterDataStore::RemoveEntity(Entity *entity, size_t entity_index, size_t entity_index_to_reassign)
 {
+	InvalidateCallEntityResults(entity_index);
+	InvalidateCallEntityResults(entity_index_to_reassign);
+
 	if(entity_index >= numEntities || columnData.size() == 0)
 		return;
 
@@ -225,6 +291,8 @@ void SeparableBoxFilterDataStore::UpdateAllEntityLabels(Entity *entity, size_t e
 	VerifyAllEntitiesForAllColumns();
 #endif
 
+	InvalidateCallEntityResults(entity_index);
+
 	for(size_t column_index = 0; column_index < columnData.size(); column_index++)
 	{
 		auto &column_data = columnData[column_index];
@@ -264,6 +332,9 @@ void SeparableBoxFilterDataStore::UpdateEntityLabel(Entity *entity,
 	if(entity_index >= numEntities)
 		return;
 
+	//any label may be used by a call, so invalidate even if the label is not cached
+	InvalidateCallEntityResults(entity_index);
+
 	//find the column
 	auto column = labelIdToColumnIndex.find(label_id);
 	if(column == end(labelIdToColumnIndex))
@@ -293,6 +364,64 @@ void SeparableBoxFilterDataStore::UpdateEntityLabel(Entity *entity,
 #endif
 }
 
+void SeparableBoxFilterDataStore::UpdateEntityLabelForEntities(StringInternPool::StringID label_id,
+	std::vector<std::pair<Entity *, size_t>> &entities_and_indices)
+{
+	//any label may be used by a call, so invalidate even if the label is not cached
+	for(auto &[entity, entity_index] : entities_and_indices)
+		InvalidateCallEntityResults(entity_index);
+
+	//find the column
+	auto column = labelIdToColumnIndex.find(label_id);
+	if(column == end(labelIdToColumnIndex))
+		return;
+	size_t column_index = column->second;
+	auto column_data = columnData[column_index].get();
+
+#ifdef SBFDS_VERIFICATION
+	VerifyAllEntitiesForColumn(column_index);
+#endif
+
+	//update in order of entity index, skipping any entity listed more than once
+	std::sort(begin(entities_and_indices), end(entities_and_indices),
+		[](auto &a, auto &b) { return a.second < b.second; });
+	auto new_end = std::unique(begin(entities_and_indices), end(entities_and_indices),
+		[](auto &a, auto &b) { return a.second == b.second; });
+	entities_and_indices.erase(new_end, end(entities_and_indices));
+
+	//numbers replacing numbers are the common case and are moved between values in bulk,
+	// any other change is applied individually
+	std::vector<std::pair<size_t, double>> indices_and_numbers;
+	for(auto &[entity, entity_index] : entities_and_indices)
+	{
+		if(entity_index >= numEntities)
+			continue;
+
+		auto [value, found] = entity->GetValueAtLabelAsImmediateValue(label_id);
+
+		if(found && value.nodeType == ENIVT_NUMBER && !FastIsNaN(value.nodeValue.number)
+				&& column_data->numberIndices.contains(entity_index))
+			indices_and_numbers.emplace_back(entity_index, value.nodeValue.number);
+		else if(found)
+			column_data->ChangeIndexValue(value.nodeType, value.nodeValue, entity_index);
+		else
+			column_data->ChangeIndexValue(ENIVT_NOT_EXIST, EvaluableNodeImmediateValue(), entity_index);
+	}
+
+	if(!indices_and_numbers.empty())
+		column_data->ChangeIndicesNumberValues(indices_and_numbers);
+
+	//remove the label if no longer relevant
+	if(IsColumnIndexRemovable(column_index))
+		RemoveColumnIndex(column_index);
+	else
+		OptimizeColumn(column_index);
+
+#ifdef SBFDS_VERIFICATION
+	VerifyAllEntitiesForColumn(column_index);
+#endif
+}
+
 //removes the entity's value for the specified label
 void SeparableBoxFilterDataStore::RemoveEntityIndexValueFromLabelId(
 	EvaluableNodeImmediateValueType value_type, EvaluableNodeImmediateValue value,
@@ -301,6 +430,9 @@ void SeparableBoxFilterDataStore::RemoveEntityIndexValueFromLabelId(
 	if(entity_index >= numEntities)
 		return;
 
+	//any label may be used by a call, so invalidate even if the label is not cached
+	InvalidateCallEntityResults(entity_index);
+
 	//find the column
 	auto column = labelIdToColumnIndex.find(label_id);
 	if(column == end(labelIdToColumnIndex))
@@ -655,7 +787,7 @@ void SeparableBoxFilterDataStore::FindNearestEntities(RepeatedGeneralizedDistanc
 		end_index = enabled_indices.GetEndInteger();
 
 		//pick up where left off, already have top_k in sorted_results or are out of entities
-	#ifdef _OPENMP
+	#if defined(_OPENMP) || defined(MULTITHREAD_SUPPORT)
 		bool any_call_entity_features = false;
 		for(size_t i = 0; i < num_enabled_features; i++)
 		{
@@ -666,6 +798,19 @@ void SeparableBoxFilterDataStore::FindNearestEntities(RepeatedGeneralizedDistanc
 			}
 		}
 	#endif
+
+	#ifdef MULTITHREAD_SUPPORT
+		//call_entity features must be evaluated by the calling interpreter,
+		// and expanding to the first nonzero distance depends on the order entities are resolved
+		if(!expand_to_first_nonzero_distance && !any_call_entity_features && GetNumResolveBlocks(end_index) > 1)
+		{
+			ResolveRemainingNearestEntitiesConcurrently<compute_surprisal>(r_dist_eval, partial_sums, enabled_indices, end_index,
+				top_k, min_distance_by_unpopulated_count, min_unpopulated_distances, high_accuracy, sorted_results);
+			ConvertSortedDistanceSumsToDistancesAndCacheResults(sorted_results, r_dist_eval, radius_column_index, distances_out);
+			return;
+		}
+	#endif
+
 		#pragma omp parallel shared(worst_candidate_distance) if(!any_call_entity_features && end_index > 500)
 		{
 			//iterate over all indices
@@ -727,6 +872,103 @@ template void SeparableBoxFilterDataStore::FindNearestEntities<false, false>(Rep
 	size_t top_k, StringInternPool::StringID radius_label, BitArrayIntegerSet &enabled_indices,
 	std::vector<DistanceReferencePair<size_t>> &distances_out, size_t ignore_index, RandomStream rand_stream);
 
+#ifdef MULTITHREAD_SUPPORT
+template<bool compute_surprisal>
+void SeparableBoxFilterDataStore::ResolveRemainingNearestEntitiesConcurrently(RepeatedGeneralizedDistanceEvaluator &r_dist_eval,
+	PartialSumCollection &partial_sums, BitArrayIntegerSet &enabled_indices, size_t end_index, size_t top_k,
+	std::vector<double> &min_distance_by_unpopulated_count, std::vector<double> &min_unpopulated_distances,
+	bool high_accuracy, StochasticTieBreakingPriorityQueue<DistanceReferencePair<size_t>, double> &sorted_results)
+{
+	size_t num_enabled_features = r_dist_eval.featurePrecomputedData.size();
+	size_t num_blocks = GetNumResolveBlocks(end_index);
+
+	//distances of the current results, which are not in enabled_indices
+	std::vector<double> result_distances;
+	result_distances.reserve(top_k);
+	auto sorted_results_copy = sorted_results;
+	while(sorted_results_copy.Size() > 0)
+	{
+		result_distances.push_back(sorted_results_copy.Top().distance);
+		sorted_results_copy.Pop();
+	}
+
+	//every block tightens its reject distance when it has found top_k entities closer than it,
+	// which later blocks use to reject entities sooner
+	//a block only uses the reject distances of earlier blocks, which are never less than the distance the serial loop
+	// would reject at, so every entity the serial loop would push is a candidate
+	std::vector<std::atomic<double>> block_reject_distances(num_blocks);
+	for(auto &block_reject_distance : block_reject_distances)
+		block_reject_distance.store(sorted_results.Top().distance, std::memory_order_relaxed);
+	std::vector<std::vector<DistanceReferencePair<size_t>>> block_candidates(num_blocks);
+
+	auto resolve_block = [&](size_t block_index)
+	{
+		size_t start_index = end_index * block_index / num_blocks;
+		size_t block_end_index = end_index * (block_index + 1) / num_blocks;
+		auto &candidates = block_candidates[block_index];
+
+		//the top_k smallest distances of the current results and those accepted in this block, with the largest on top
+		FlexiblePriorityQueue<double> block_top_k(begin(result_distances), end(result_distances));
+
+		double block_reject_distance = block_reject_distances[block_index].load(std::memory_order_relaxed);
+		double reject_distance = block_reject_distance;
+		for(size_t entity_index = start_index; entity_index < block_end_index; entity_index++)
+		{
+			//don't need to check maximum index, because already checked in loop
+			if(!enabled_indices.ContainsWithoutMaximumIndexCheck(entity_index))
+				continue;
+
+			auto [accept, distance] = ResolveDistanceToNonMatchTargetValuesUnlessRejected<compute_surprisal>(r_dist_eval,
+				partial_sums, entity_index, min_distance_by_unpopulated_count, num_enabled_features,
+				reject_distance, min_unpopulated_distances, high_accuracy);
+
+			if(!accept)
+				continue;
+
+			candidates.emplace_back(distance, entity_index);
+
+			block_top_k.push(distance);
+			if(block_top_k.size() > top_k)
+				block_top_k.pop();
+
+			//the top_k smallest distances of any subset of entities bound the final results
+			if(block_top_k.top() < block_reject_distance)
+			{
+				block_reject_distance = block_top_k.top();
+				block_reject_distances[block_index].store(block_reject_distance, std::memory_order_relaxed);
+			}
+
+			reject_distance = block_reject_distance;
+			for(size_t i = 0; i < block_index; i++)
+				reject_distance = std::min(reject_distance, block_reject_distances[i].load(std::memory_order_relaxed));
+		}
+	};
+
+	auto task_set = Concurrency::urgentThreadPool.CreateCountableTaskSet(num_blocks);
+
+	auto enqueue_task_lock = Concurrency::urgentThreadPool.AcquireTaskLock();
+	for(size_t i = 0; i < num_blocks; i++)
+	{
+		Concurrency::urgentThreadPool.BatchEnqueueTask([&resolve_block, i, &task_set]()
+		{
+			resolve_block(i);
+			task_set.MarkTaskCompleted();
+		}
+		);
+	}
+
+	task_set.WaitForTasks(&enqueue_task_lock);
+
+	//push the candidates in order of entity index, the same as the serial loop, so that ties are broken the same way;
+	// any candidate the serial loop would have rejected is at least as far as the current worst result, so is not kept
+	for(auto &candidates : block_candidates)
+	{
+		for(auto &candidate : candidates)
+			sorted_results.PushAndPop(candidate);
+	}
+}
+#endif
+
 void SeparableBoxFilterDataStore::RemoveEntityIndexFromColumns(size_t entity_index, bool remove_last_entity, bool set_not_exist)
 {
 	for(size_t i = 0; i < columnData.size(); i++)
@@ -1406,6 +1648,8 @@ void SeparableBoxFilterDataStore::InitializeRepeatedDistanceEvaluatorForFeature(
 	if(feature_attribs.callEntityOpcode != nullptr)
 	{
 		effective_feature_type = RepeatedGeneralizedDistanceEvaluator::EFDT_CALL_ENTITY;
+		if(feature_attribs.cacheCallEntityResults)
+			feature_precomp_data.callEntityResultsCache = GetCallEntityResultsCache(feature_attribs.callEntityOpcode);
 		return;
 	}
 
@@ -1481,6 +1725,18 @@ void SeparableBoxFilterDataStore::InitializeRepeatedDistanceEvaluatorForFeature(
 			effective_feature_type = RepeatedGeneralizedDistanceEvaluator::EFDT_CONTINUOUS_NUMERIC_CYCLIC;
 		else
 			effective_feature_type = RepeatedGeneralizedDistanceEvaluator::EFDT_CONTINUOUS_NUMERIC;
+
+		//if only estimates need to be computed from the values, use the single precision copy to halve the memory read
+		if(r_dist_eval.distEvaluator->singlePrecisionValues && r_dist_eval.distEvaluator->recomputeAccurateDistances
+			&& !r_dist_eval.distEvaluator->highAccuracyDistances
+			&& effective_feature_type != RepeatedGeneralizedDistanceEvaluator::EFDT_CONTINUOUS_NUMERIC_CYCLIC)
+		{
+			column_data->BuildSinglePrecisionNumberValues();
+			if(effective_feature_type == RepeatedGeneralizedDistanceEvaluator::EFDT_CONTINUOUS_UNIVERSALLY_NUMERIC)
+				effective_feature_type = RepeatedGeneralizedDistanceEvaluator::EFDT_CONTINUOUS_UNIVERSALLY_NUMERIC_SINGLE_PRECISION;
+			else
+				effective_feature_type = RepeatedGeneralizedDistanceEvaluator::EFDT_CONTINUOUS_NUMERIC_SINGLE_PRECISION;
+		}
 	}
 }
 
@@ -1501,6 +1757,14 @@ double SeparableBoxFilterDataStore::ComputeDistanceTermFromEvaluatingOnEntity(
 	auto &feature_attribs = r_dist_eval.distEvaluator->featureAttribs[query_feature_index];
 	auto &calling_interpreter = *r_dist_eval.callingInterpreter;
 
+	auto results_cache = r_dist_eval.featurePrecomputedData[query_feature_index].callEntityResultsCache;
+	if(results_cache != nullptr)
+	{
+		EvaluableNodeImmediateValueWithType cached_result;
+		if(results_cache->GetResult(entity_index, cached_result))
+			return r_dist_eval.ComputeDistanceTerm<compute_surprisal>(cached_result, query_feature_index, high_accuracy);
+	}
+
 	auto &ocn = feature_attribs.callEntityOpcode->GetOrderedChildNodes();
 
 	InterpreterConstraints interpreter_constraints;
@@ -1595,6 +1859,10 @@ double SeparableBoxFilterDataStore::ComputeDistanceTermFromEvaluatingOnEntity(
 	else
 		value_as_immediate_if_possible = EvaluableNodeImmediateValueWithType::CreateValueFromEvaluableNode(result);
 
+	//cache before the result is freed
+	if(results_cache != nullptr)
+		results_cache->SetResult(entity_index, value_as_immediate_if_possible);
+
 	double distance = r_dist_eval.ComputeDistanceTerm<compute_surprisal>(
 		value_as_immediate_if_possible, query_feature_index, high_accuracy);
 
@@ -1611,3 +1879,34 @@ template double SeparableBoxFilterDataStore::ComputeDistanceTermFromEvaluatingOn
 template double SeparableBoxFilterDataStore::ComputeDistanceTermFromEvaluatingOnEntity<false>(
 	RepeatedGeneralizedDistanceEvaluator &r_dist_eval, size_t entity_index,
 	size_t query_feature_index, bool high_accuracy);
+
+CallEntityResultsCache *SeparableBoxFilterDataStore::GetCallEntityResultsCache(EvaluableNode *call_entity_opcode)
+{
+	//the cache is keyed by the code of the call, so only cache when everything passed to the called entity is constant
+	//the function of call_on_entity is executed within each entity rather than passed, so it is part of what is cached
+	auto &ocn = call_entity_opcode->GetOrderedChildNodesReference();
+	for(size_t i = 1; i < ocn.size(); i++)
+	{
+		if(i == 1 && call_entity_opcode->GetType() == ENT_CALL_ON_ENTITY)
+			continue;
+
+		if(ocn[i] != nullptr && !ocn[i]->GetIsIdempotent())
+			return nullptr;
+	}
+
+	std::string call_key = Parser::UnparseToKeyString(call_entity_opcode);
+
+#if defined(MULTITHREAD_SUPPORT)
+	Concurrency::WriteLock lock(callEntityResultsCachesMutex);
+#endif
+
+	auto found = callEntityResultsCaches.find(call_key);
+	if(found != end(callEntityResultsCaches))
+		return found->second.get();
+
+	if(callEntityResultsCaches.size() >= maxCallEntityResultsCaches)
+		return nullptr;
+
+	auto [inserted, _] = callEntityResultsCaches.emplace(std::move(call_key), std::make_unique<CallEntityResultsCache>());
+	return inserted->second.get();
+}
@@ -16,6 +16,7 @@
 #include "SBFDSColumnData.h"
 
 //system headers:
+#include <atomic>
 #include <cstdint>
 #include <limits>
 #include <vector>
@@ -24,6 +25,92 @@
 class Entity;
 class Interpreter;
 
+//caches the result of a call_entity feature for each entity index so that the call is evaluated
+// once per entity rather than once per query; results are invalidated when the entity's labels change
+class CallEntityResultsCache
+{
+public:
+	inline ~CallEntityResultsCache()
+	{
+		for(size_t entity_index = 0; entity_index < results.size(); entity_index++)
+			ClearResult(entity_index);
+	}
+
+	//returns true and sets value to the cached result for entity_index if it has been computed
+	inline bool GetResult(size_t entity_index, EvaluableNodeImmediateValueWithType &value)
+	{
+	#ifdef MULTITHREAD_SUPPORT
+		Concurrency::ReadLock lock(mutex);
+	#endif
+
+		if(entity_index >= results.size() || results[entity_index].nodeType == ENIVT_NOT_EXIST)
+			return false;
+
+		value = results[entity_index];
+		return true;
+	}
+
+	//caches value as the result for entity_index
+	//code is not cached because it is not retained after the call
+	inline void SetResult(size_t entity_index, EvaluableNodeImmediateValueWithType value)
+	{
+		if(value.nodeType == ENIVT_CODE)
+			return;
+
+	#ifdef MULTITHREAD_SUPPORT
+		Concurrency::WriteLock lock(mutex);
+	#endif
+
+		if(entity_index >= results.size())
+			results.resize(entity_index + 1, EvaluableNodeImmediateValueWithType(EvaluableNodeImmediateValue(), ENIVT_NOT_EXIST));
+
+		ClearResult(entity_index);
+		if(value.nodeType == ENIVT_STRING_ID)
+			string_intern_pool.CreateStringReference(value.nodeValue.stringID);
+		results[entity_index] = value;
+	}
+
+	//removes any cached result for entity_index
+	inline void InvalidateResult(size_t entity_index)
+	{
+	#ifdef MULTITHREAD_SUPPORT
+		Concurrency::WriteLock lock(mutex);
+	#endif
+
+		ClearResult(entity_index);
+	}
+
+	//returns the estimated number of bytes of memory used by the cached results
+	inline size_t GetEstimatedSizeInBytes()
+	{
+	#ifdef MULTITHREAD_SUPPORT
+		Concurrency::ReadLock lock(mutex);
+	#endif
+
+		return sizeof(CallEntityResultsCache) + results.capacity() * sizeof(EvaluableNodeImmediateValueWithType);
+	}
+
+protected:
+	//removes any cached result for entity_index, assumes any lock is already held
+	inline void ClearResult(size_t entity_index)
+	{
+		if(entity_index >= results.size())
+			return;
+
+		auto &result = results[entity_index];
+		if(result.nodeType == ENIVT_STRING_ID)
+			string_intern_pool.DestroyStringReference(result.nodeValue.stringID);
+		result = EvaluableNodeImmediateValueWithType(EvaluableNodeImmediateValue(), ENIVT_NOT_EXIST);
+	}
+
+	//result for each entity index, ENIVT_NOT_EXIST if not computed
+	std::vector<EvaluableNodeImmediateValueWithType> results;
+
+#ifdef MULTITHREAD_SUPPORT
+	Concurrency::ReadWriteMutex mutex;
+#endif
+};
+
 //supports cheap modification of:
 //p-value, nominals, weights, distance accuracy, feature selections, case sub-selections
 //requires minor updates for adding cases and features beyond initial dimensions
@@ -100,7 +187,8 @@ public:
 
 	//populates the column with the label data
 	// assumes column data is empty
-	void BuildLabel(size_t column_index, const std::vector<Entity *> &entities);
+	//if run_concurrently is true, then the values are retrieved and sorted using multiple threads when large enough
+	void BuildLabel(size_t column_index, const std::vector<Entity *> &entities, bool run_concurrently);
 
 	//changes column to/from interning as would yield best performance
 	inline void OptimizeColumn(size_t column_index)
@@ -115,6 +203,34 @@ public:
 			column->Optimize();
 	}
 
+	//returns the estimated number of bytes of memory used by the columns and caches of the data store
+	size_t GetEstimatedSizeInBytes();
+
+	//requests that every thread release the memory held by its query buffers before its next query
+	static inline void RequestBufferRelease()
+	{
+		bufferReleaseGeneration++;
+	}
+
+	//returns the number of buffer releases that have been requested, so that other per-thread buffers
+	// can determine whether they should also be released
+	static inline size_t GetBufferReleaseGeneration()
+	{
+		return bufferReleaseGeneration;
+	}
+
+	//releases the memory of the calling thread's parametersAndBuffers if a release has been requested
+	// since they were last released
+	static inline void ReleaseBuffersIfRequested()
+	{
+		size_t release_generation = bufferReleaseGeneration;
+		if(parametersAndBuffersReleaseGeneration == release_generation)
+			return;
+
+		parametersAndBuffersReleaseGeneration = release_generation;
+		parametersAndBuffers = SBFDSParametersAndBuffers();
+	}
+
 	//expand the structure by adding a new column/label/feature and populating with data from entities
 	void AddLabels(std::vector<StringInternPool::StringID> &label_sids, const std::vector<Entity *> &entities);
 
@@ -165,6 +281,12 @@ public:
 	//updates the given label for the given entity
 	void UpdateEntityLabel(Entity *entity, size_t entity_index, StringInternPool::StringID label_id);
 
+	//like UpdateEntityLabel, but updates the label for each entity and entity index pair in entities_and_indices
+	// in one pass over the column, sorting entities_and_indices by entity index so the column's index sets are
+	// modified in order, and only optimizing or removing the column once at the end
+	void UpdateEntityLabelForEntities(StringInternPool::StringID label_id,
+		std::vector<std::pair<Entity *, size_t>> &entities_and_indices);
+
 	//removes the entity's value for the specified label
 	void RemoveEntityIndexValueFromLabelId(EvaluableNodeImmediateValueType value_type, EvaluableNodeImmediateValue value,
 		size_t entity_index, StringInternPool::StringID label_id);
@@ -528,6 +650,8 @@ public:
 		Interpreter *interpreter, Entity *entity,
 		std::vector<DistanceReferencePair<size_t>> &distances_out)
 	{
+		ReleaseBuffersIfRequested();
+
 		auto &r_dist_eval = parametersAndBuffers.rDistEvaluator;
 		if(dist_eval.computeSurprisal)
 			PopulateTargetValuesAndInitializeRepeatedDistanceEvaluator<true>(r_dist_eval,
@@ -565,6 +689,8 @@ public:
 		Interpreter *interpreter, Entity *entity,
 		std::vector<DistanceReferencePair<size_t>> &distances_out)
 	{
+		ReleaseBuffersIfRequested();
+
 		auto &r_dist_eval = parametersAndBuffers.rDistEvaluator;
 		if(dist_eval.computeSurprisal)
 			InitializeRepeatedDistanceEvaluator<true>(r_dist_eval,
@@ -600,6 +726,8 @@ public:
 		std::vector<DistanceReferencePair<size_t>> &distances_out,
 		size_t ignore_index = std::numeric_limits<size_t>::max(), RandomStream rand_stream = RandomStream())
 	{
+		ReleaseBuffersIfRequested();
+
 		auto &r_dist_eval = parametersAndBuffers.rDistEvaluator;
 		if(dist_eval.computeSurprisal)
 			PopulateTargetValuesAndInitializeRepeatedDistanceEvaluator<true>(r_dist_eval,
@@ -653,6 +781,8 @@ public:
 		Interpreter *interpreter, Entity *entity,
 		std::vector<DistanceReferencePair<size_t>> &distances_out, RandomStream rand_stream = RandomStream())
 	{
+		ReleaseBuffersIfRequested();
+
 		auto &r_dist_eval = parametersAndBuffers.rDistEvaluator;
 		if(dist_eval.computeSurprisal)
 			InitializeRepeatedDistanceEvaluator<true>(r_dist_eval,
@@ -1120,6 +1250,29 @@ protected:
 				return r_dist_eval.distEvaluator->ComputeDistanceTermKnownToUnknown(query_feature_index);
 		}
 
+		case RepeatedGeneralizedDistanceEvaluator::EFDT_CONTINUOUS_UNIVERSALLY_NUMERIC_SINGLE_PRECISION:
+		{
+			auto &feature_attribs = r_dist_eval.distEvaluator->featureAttribs[query_feature_index];
+			auto &column_data = columnData[feature_attribs.featureDataIndex];
+			return r_dist_eval.distEvaluator->ComputeDistanceTermContinuousNonCyclicOneNonNullRegular<compute_surprisal>(
+				feature_precomp_data.targetValue.nodeValue.number - column_data->singlePrecisionNumberValues[entity_index],
+				query_feature_index, feature_precomp_data.fastApproxDeviation, high_accuracy);
+		}
+
+		case RepeatedGeneralizedDistanceEvaluator::EFDT_CONTINUOUS_NUMERIC_SINGLE_PRECISION:
+		{
+			auto &feature_attribs = r_dist_eval.distEvaluator->featureAttribs[query_feature_index];
+			auto &column_data = columnData[feature_attribs.featureDataIndex];
+			//NaN for any value that is not a number
+			float value = column_data->singlePrecisionNumberValues[entity_index];
+			if(!FastIsNaN(value))
+				return r_dist_eval.distEvaluator->ComputeDistanceTermContinuousNonCyclicOneNonNullRegular<compute_surprisal>(
+					feature_precomp_data.targetValue.nodeValue.number - value,
+					query_feature_index, feature_precomp_data.fastApproxDeviation, high_accuracy);
+			else
+				return r_dist_eval.distEvaluator->ComputeDistanceTermKnownToUnknown(query_feature_index);
+		}
+
 		case RepeatedGeneralizedDistanceEvaluator::EFDT_CONTINUOUS_NUMERIC_CYCLIC:
 		{
 			auto &feature_attribs = r_dist_eval.distEvaluator->featureAttribs[query_feature_index];
@@ -1343,6 +1496,36 @@ protected:
 		return {true, distance};
 	}
 
+#ifdef MULTITHREAD_SUPPORT
+	//resolves the distances of all entities in enabled_indices below end_index, pushing any that may be
+	// in the top_k nearest into sorted_results, which must already contain top_k results
+	//the entities are divided into blocks that are resolved concurrently, each rejecting entities using the distances
+	// found by earlier blocks, and then the candidates are pushed in order of entity index, so the results, including
+	// how ties are broken, are the same as resolving the entities serially
+	//if compute_surprisal is true, it will use a faster execution path
+	template<bool compute_surprisal = false>
+	void ResolveRemainingNearestEntitiesConcurrently(RepeatedGeneralizedDistanceEvaluator &r_dist_eval,
+		PartialSumCollection &partial_sums, BitArrayIntegerSet &enabled_indices, size_t end_index, size_t top_k,
+		std::vector<double> &min_distance_by_unpopulated_count, std::vector<double> &min_unpopulated_distances,
+		bool high_accuracy, StochasticTieBreakingPriorityQueue<DistanceReferencePair<size_t>, double> &sorted_results);
+
+	//minimum number of entities for each block when resolving distances concurrently
+	static constexpr size_t minEntitiesPerResolveBlock = 16384;
+
+	//returns the number of blocks to resolve the entities below end_index in concurrently,
+	// which is 1 if there are too few entities or threads for it to be worthwhile
+	static inline size_t GetNumResolveBlocks(size_t end_index)
+	{
+		size_t max_num_blocks = 4 * Concurrency::GetMaxNumThreads();
+		if(max_num_blocks <= 4 || end_index < 2 * minEntitiesPerResolveBlock)
+			return 1;
+		return std::min(max_num_blocks, end_index / minEntitiesPerResolveBlock);
+	}
+
+	//minimum number of entities for each block when retrieving label values concurrently
+	static constexpr size_t minEntitiesPerBuildBlock = 16384;
+#endif
+
 public:
 
 	//initializes everything needed to quickly compute the distance to position_value for query_feature_index
@@ -1498,14 +1681,47 @@ public:
 		std::sort(begin(distances_out), end(distances_out));
 	}
 
+	//returns the cache of results for call_entity_opcode, creating it if needed
+	//returns nullptr if the label, arguments, or constraints of the call are not constant, since the same code
+	// could then yield different results for different queries, or if too many distinct call opcodes have already been cached
+	CallEntityResultsCache *GetCallEntityResultsCache(EvaluableNode *call_entity_opcode);
+
+	//removes the cached call_entity results for entity_index from all caches
+	inline void InvalidateCallEntityResults(size_t entity_index)
+	{
+	#if defined(MULTITHREAD_SUPPORT)
+		//caches may be added during concurrent queries, and each cache locks its own results
+		Concurrency::ReadLock lock(callEntityResultsCachesMutex);
+	#endif
+
+		for(auto &[call_key, results_cache] : callEntityResultsCaches)
+			results_cache->InvalidateResult(entity_index);
+	}
+
 	//contains entity lookups for each of the values for each of the columns
 	std::vector<std::unique_ptr<SBFDSColumnData>> columnData;
 
+	//maximum number of distinct call opcodes to cache results for, to bound memory used by dynamically generated calls
+	static constexpr size_t maxCallEntityResultsCaches = 64;
+
+	//caches of call_entity feature results, keyed by the key string of the call opcode
+	FastHashMap<std::string, std::unique_ptr<CallEntityResultsCache>> callEntityResultsCaches;
+
+#if defined(MULTITHREAD_SUPPORT)
+	//mutex for adding to callEntityResultsCaches, which may happen during concurrent queries,
+	// while reading existing caches only needs a read lock
+	Concurrency::ReadWriteMutex callEntityResultsCachesMutex;
+#endif
+
 	//for multithreading, there should be one of these per thread
 #if defined(MULTITHREAD_SUPPORT)
 	thread_local static SBFDSParametersAndBuffers parametersAndBuffers;
+	thread_local inline static size_t parametersAndBuffersReleaseGeneration = 0;
+	inline static std::atomic<size_t> bufferReleaseGeneration = 0;
 #else
 	static SBFDSParametersAndBuffers parametersAndBuffers;
+	inline static size_t parametersAndBuffersReleaseGeneration = 0;
+	inline static size_t bufferReleaseGeneration = 0;
 #endif
 
 	//map from label id to column index
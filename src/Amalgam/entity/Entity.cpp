@@ -61,7 +61,17 @@ Entity::Entity(Entity *t)
 	entityRelationships.container = nullptr;
 	evaluableNodeManager.rootNode = nullptr;
 
-	SetRoot(EvaluableNodeReference(t->evaluableNodeManager.rootNode, false, false), false);
+	EvaluableNode *t_root = t->evaluableNodeManager.rootNode;
+	if(t->evaluableNodeManager.HasSharedSegments() && t_root != nullptr && !t_root->GetNeedCycleCheck())
+	{
+		//reference the shared segments and only copy the nodes that are not shared
+		evaluableNodeManager.AddSharedSegmentReferences(t->evaluableNodeManager);
+		SetRoot(evaluableNodeManager.DeepAllocCopyExceptShared(t_root), true);
+	}
+	else
+	{
+		SetRoot(EvaluableNodeReference(t_root, false, false), false);
+	}
 
 	idStringId = StringInternPool::NOT_A_STRING_ID;
 
@@ -91,6 +101,11 @@ Entity::Entity(Entity *t)
 
 Entity::~Entity()
 {
+#ifdef MULTITHREAD_SUPPORT
+	//don't collect garbage while the entity is being torn down
+	evaluableNodeManager.StopBackgroundGarbageCollection();
+#endif
+
 #ifdef AMALGAM_FAST_MEMORY_INTEGRITY
 	VerifyEvaluableNodeIntegrity();
 #endif
@@ -237,7 +252,8 @@ std::pair<EvaluableNodeImmediateValueWithType, bool> Entity::GetValueAtLabelAsIm
 
 //like SetValuesAtLabels, except accumulates each value at each label instead
 std::pair<bool, bool> Entity::SetValuesAtLabels(EvaluableNodeReference new_label_values, bool accum_values,
-	std::vector<EntityWriteListener *> *write_listeners, size_t *num_new_nodes_allocated, bool on_self)
+	std::vector<EntityWriteListener *> *write_listeners, size_t *num_new_nodes_allocated, bool on_self,
+	bool batch_call)
 {
 	//can only work with assoc arrays
 	if(!EvaluableNode::IsAssociativeArray(new_label_values))
@@ -335,14 +351,17 @@ std::pair<bool, bool> Entity::SetValuesAtLabels(EvaluableNodeReference new_label
 
 	if(any_successful_assignment)
 	{
-		EntityQueryCaches *container_caches = GetContainerQueryCaches();
-		if(container_caches != nullptr)
-			container_caches->UpdateEntityLabels(this, GetEntityIndexOfContainer(), new_label_values_mcn);
-
-		if(write_listeners != nullptr)
+		if(!batch_call)
 		{
-			for(auto &wl : *write_listeners)
-				wl->LogWriteLabelValuesToEntity(this, new_label_values, accum_values);
+			EntityQueryCaches *container_caches = GetContainerQueryCaches();
+			if(container_caches != nullptr)
+				container_caches->UpdateEntityLabels(this, GetEntityIndexOfContainer(), new_label_values_mcn);
+
+			if(write_listeners != nullptr)
+			{
+				for(auto &wl : *write_listeners)
+					wl->LogWriteLabelValuesToEntity(this, new_label_values, accum_values);
+			}
 		}
 
 		asset_manager.UpdateEntityLabelValues(this, new_label_values, accum_values);
@@ -359,6 +378,78 @@ std::pair<bool, bool> Entity::SetValuesAtLabels(EvaluableNodeReference new_label
 	return {any_successful_assignment, all_successful_assignments};
 }
 
+std::pair<bool, bool> Entity::SetValuesAtLabelsOfContainedEntities(
+	std::vector<std::pair<Entity *, EvaluableNodeReference>> &entities_and_label_values, bool accum_values,
+	std::vector<EntityWriteListener *> *write_listeners, size_t *num_new_nodes_allocated,
+	const std::function<bool(size_t)> &stop_after_assignment)
+{
+	bool any_successful_assignment = false;
+	bool all_successful_assignments = true;
+	size_t total_new_nodes_allocated = 0;
+
+	//entities whose values were written, along with the values, and the updated entities for each label
+	std::vector<std::pair<Entity *, EvaluableNode *>> written_entities_and_label_values;
+	FastHashMap<StringInternPool::StringID, std::vector<std::pair<Entity *, size_t>>> label_sids_to_entities;
+
+	EntityQueryCaches *caches = GetQueryCaches();
+
+	for(size_t i = 0; i < entities_and_label_values.size(); i++)
+	{
+		auto &[entity, label_values] = entities_and_label_values[i];
+		if(entity == nullptr || entity->GetContainer() != this)
+		{
+			all_successful_assignments = false;
+			continue;
+		}
+
+		EntityWriteReference entity_reference(entity);
+
+		size_t entity_new_nodes_allocated = 0;
+		auto [any_success, all_success] = entity->SetValuesAtLabels(label_values, accum_values, nullptr,
+			num_new_nodes_allocated != nullptr ? &entity_new_nodes_allocated : nullptr, false, true);
+
+		if(!all_success)
+			all_successful_assignments = false;
+
+		if(any_success)
+		{
+			any_successful_assignment = true;
+			total_new_nodes_allocated += entity_new_nodes_allocated;
+			written_entities_and_label_values.emplace_back(entity, label_values);
+
+			if(caches != nullptr)
+			{
+				size_t entity_index = entity->GetEntityIndexOfContainer();
+				for(auto &label_sid : label_values->GetMappedChildNodesReference() | std::views::keys)
+					label_sids_to_entities[label_sid].emplace_back(entity, entity_index);
+			}
+
+			entity->CollectGarbageWithEntityWriteReference();
+		}
+
+		if(stop_after_assignment != nullptr && stop_after_assignment(entity_new_nodes_allocated))
+		{
+			if(i + 1 < entities_and_label_values.size())
+				all_successful_assignments = false;
+			break;
+		}
+	}
+
+	if(caches != nullptr && !label_sids_to_entities.empty())
+		caches->UpdateEntitiesLabels(label_sids_to_entities);
+
+	if(write_listeners != nullptr)
+	{
+		for(auto &wl : *write_listeners)
+			wl->LogWriteLabelValuesToEntities(written_entities_and_label_values, accum_values);
+	}
+
+	if(num_new_nodes_allocated != nullptr)
+		*num_new_nodes_allocated = total_new_nodes_allocated;
+
+	return {any_successful_assignment, all_successful_assignments};
+}
+
 std::pair<bool, bool> Entity::RemoveLabels(EvaluableNodeReference labels_to_remove,
 		std::vector<EntityWriteListener *> *write_listeners, size_t *num_new_nodes_allocated, bool on_self)
 {
@@ -525,11 +616,103 @@ size_t Entity::GetEstimatedUsedDeepSizeInBytes()
 	size_t total_size = evaluableNodeManager.GetEstimatedTotalUsedSizeInBytes();
 
 	for(auto entity : GetContainedEntities())
-		total_size += entity->GetEstimatedReservedDeepSizeInBytes();
+		total_size += entity->GetEstimatedUsedDeepSizeInBytes();
 
 	return total_size;
 }
 
+Entity::MemoryUsage Entity::GetEstimatedDeepMemoryUsage()
+{
+	auto all_entities = GetAllDeeplyContainedEntityReferencesGroupedByDepth<EntityReadReference>(true);
+	return GetEstimatedMemoryUsage(*all_entities);
+}
+
+Entity::MemoryUsage Entity::GetEstimatedMemoryUsage(std::vector<EntityReadReference> &entities)
+{
+	MemoryUsage usage;
+	for(auto &e : entities)
+	{
+		usage.nodesUsed += e->evaluableNodeManager.GetEstimatedTotalUsedSizeInBytes();
+		usage.nodesReserved += e->evaluableNodeManager.GetEstimatedTotalReservedSizeInBytes();
+		usage.strings += e->evaluableNodeManager.GetEstimatedStringSizeInBytes();
+
+		if(e->HasQueryCaches())
+		{
+			auto query_caches = e->GetQueryCaches();
+		#ifdef MULTITHREAD_SUPPORT
+			Concurrency::ReadLock lock(query_caches->mutex);
+		#endif
+			usage.queryCaches += query_caches->GetEstimatedSizeInBytes();
+		}
+	}
+
+	return usage;
+}
+
+Entity::MemoryUsage Entity::ReduceMemoryUsageToSoftLimit(size_t soft_limit_in_bytes)
+{
+	MemoryUsage usage;
+	{
+		//read references keep other threads from writing to the entities, and therefore allocating,
+		// while they are measured and their garbage is collected
+		auto all_entities = GetAllDeeplyContainedEntityReferencesGroupedByDepth<EntityReadReference>(true);
+		usage = GetEstimatedMemoryUsage(*all_entities);
+		if(usage.GetTotal() <= soft_limit_in_bytes)
+			return usage;
+
+		for(auto &e : *all_entities)
+			e->evaluableNodeManager.CollectGarbageIfIdle();
+
+		usage = GetEstimatedMemoryUsage(*all_entities);
+		if(usage.GetTotal() <= soft_limit_in_bytes)
+			return usage;
+	}
+
+	//per-thread query buffers are not part of the measured usage, so releasing them does not change it
+	//other threads release their buffers when they next query
+	SeparableBoxFilterDataStore::RequestBufferRelease();
+	SeparableBoxFilterDataStore::ReleaseBuffersIfRequested();
+	EntityQueryCaches::ReleaseBuffersIfRequested();
+
+	//only clear query caches if they are the excess, otherwise clearing them cannot bring the usage
+	// under the limit and they would just be rebuilt by the next query
+	if(usage.GetTotal() - usage.queryCaches > soft_limit_in_bytes)
+		return usage;
+
+	auto all_entities = GetAllDeeplyContainedEntityReferencesGroupedByDepth<EntityWriteReference>(true);
+
+	//measure the caches again now that nothing can query, then clear the largest first,
+	// subtracting each from the usage rather than measuring everything again, until the usage is under the limit
+	usage.queryCaches = 0;
+	std::vector<std::pair<size_t, size_t>> cache_sizes_and_indices;
+	for(size_t i = 0; i < all_entities->size(); i++)
+	{
+		auto &e = (*all_entities)[i];
+		if(!e->HasQueryCaches())
+			continue;
+
+		auto query_caches = e->GetQueryCaches();
+	#ifdef MULTITHREAD_SUPPORT
+		Concurrency::ReadLock lock(query_caches->mutex);
+	#endif
+		size_t cache_size = query_caches->GetEstimatedSizeInBytes();
+		usage.queryCaches += cache_size;
+		cache_sizes_and_indices.emplace_back(cache_size, i);
+	}
+	std::sort(begin(cache_sizes_and_indices), end(cache_sizes_and_indices), std::greater<>());
+
+	for(auto [cache_size, index] : cache_sizes_and_indices)
+	{
+		if(usage.GetTotal() <= soft_limit_in_bytes)
+			break;
+
+		(*all_entities)[index]->ClearQueryCaches();
+		usage.queryCaches -= std::min(usage.queryCaches, cache_size);
+	}
+
+	return usage;
+}
+
 //digits for 62-base encoding
 static constexpr std::array<char, 62> _base_62_digits = [] {
 	std::array<char, 62> a{};
@@ -543,38 +726,44 @@ static constexpr std::array<char, 62> _base_62_digits = [] {
 	return a;
 	}();
 
-//powers of 62 for 62-base encoding
-static constexpr std::array<uint64_t, 11> _powers_of_62 = [] {
-	std::array<uint64_t, 11> powers{};
-	powers[0] = 1;
-	for(std::size_t i = 1; i < powers.size(); i++)
-		powers[i] = powers[i - 1] * 62ULL;
-	return powers;
-	}();
+//number of base 62 digits in compact ids for unnamed entities; with the leading underscore, compact ids
+// are short enough to be stored inline within a string id rather than interned
+static constexpr size_t _num_compact_id_digits = 6;
+
+//number of base 62 digits needed to encode 64 bits
+static constexpr size_t _num_full_id_digits = 11;
+
+//number of attempts at finding an unused compact id before falling back to full length ids,
+// which is only reached when a container holds a sizable fraction of all possible compact ids
+static constexpr size_t _max_compact_id_attempts = 4;
 
-//encodes high_and low into a base 62 string starting with an underscore
+//encodes the lowest num_digits base 62 digits of value into a string starting with an underscore
 //this encoding uses only characters that are available across all major file systems and thus do not need escaping
-static std::string EncodeBase62(uint32_t high, uint32_t low)
+static std::string EncodeBase62(uint64_t value, size_t num_digits)
 {
-	uint64_t combined_value = (static_cast<uint64_t>(high) << 32) | static_cast<uint64_t>(low);
-
-	std::string buffer(12, _base_62_digits[0]);
+	std::string buffer(num_digits + 1, _base_62_digits[0]);
 	//begin with leading underscore
 	buffer[0] = '_';
 
-	//convert to digits from most significant to least significant, starting with highest power of 62
-	for(int i = 10; i >= 0; i--)
+	//convert to digits from least significant to most significant
+	for(size_t i = num_digits; i > 0; i--)
 	{
-		uint64_t divisor = _powers_of_62[i];
-		uint64_t digit = combined_value / divisor;
-		//skip over leading underscore
-		buffer[1 + (10 - i)] = _base_62_digits[static_cast<std::size_t>(digit)];
-		combined_value -= digit * divisor;
+		buffer[i] = _base_62_digits[static_cast<std::size_t>(value % 62)];
+		value /= 62;
 	}
 
 	return buffer;
 }
 
+//returns a candidate id for an unnamed entity, where attempt is the number of candidates already found to be in use
+static std::string GenerateUnnamedEntityId(RandomStream &random_stream, size_t attempt)
+{
+	uint64_t high = random_stream.RandUInt32();
+	uint64_t low = random_stream.RandUInt32();
+	uint64_t value = (high << 32) | low;
+	return EncodeBase62(value, attempt < _max_compact_id_attempts ? _num_compact_id_digits : _num_full_id_digits);
+}
+
 StringInternPool::StringID Entity::AddContainedEntity(Entity *t, StringInternPool::StringID id_sid, std::vector<EntityWriteListener *> *write_listeners)
 {
 	if(t == nullptr)
@@ -593,12 +782,9 @@ StringInternPool::StringID Entity::AddContainedEntity(Entity *t, StringInternPoo
 	//autoassign an ID if not specified
 	if(id_sid == StringInternPool::NOT_A_STRING_ID)
 	{
-		std::string new_id;
-		for(;;)
+		for(size_t attempt = 0; ; attempt++)
 		{
-			new_id = EncodeBase62(randomStream.RandUInt32(), randomStream.RandUInt32());
-
-			t->idStringId = string_intern_pool.CreateStringReference(new_id);
+			t->idStringId = string_intern_pool.CreateStringReference(GenerateUnnamedEntityId(randomStream, attempt));
 
 			//if not currently in use, then use it and stop searching
 			if(id_to_index_lookup.emplace(t->idStringId, t_index).second == true)
@@ -658,9 +844,9 @@ StringInternPool::StringID Entity::AddContainedEntity(Entity *t, std::string id_
 	//autoassign an ID if not specified
 	if(id_string.empty())
 	{
-		for(;;)
+		for(size_t attempt = 0; ; attempt++)
 		{
-			id_string = EncodeBase62(randomStream.RandUInt32(), randomStream.RandUInt32());
+			id_string = GenerateUnnamedEntityId(randomStream, attempt);
 
 			t->idStringId = string_intern_pool.CreateStringReference(id_string);
 
@@ -941,6 +1127,23 @@ void Entity::SetRoot(std::string &code_string, std::vector<EntityWriteListener *
 	SetRoot(node, true, write_listeners);
 }
 
+void Entity::FreezeCodeAsShared()
+{
+	auto segment = std::make_shared<EvaluableNodeManager>();
+	segment->rootNode = nullptr;
+	MoveCodeToSharedSegment(segment);
+}
+
+void Entity::MoveCodeToSharedSegment(std::shared_ptr<EvaluableNodeManager> &segment)
+{
+	//the nodes are moved rather than copied, so the root and caches still refer to the same nodes
+	if(evaluableNodeManager.MoveNodesBeneathRootToSharedSegment(*segment))
+		evaluableNodeManager.AddSharedSegmentReference(segment);
+
+	for(Entity *e : GetContainedEntities())
+		e->MoveCodeToSharedSegment(segment);
+}
+
 void Entity::VerifyEvaluableNodeIntegrityAndAllContainedEntities()
 {
 	VerifyEvaluableNodeIntegrity();
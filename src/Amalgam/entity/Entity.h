@@ -8,6 +8,7 @@
 #include "RandomStream.h"
 
 //system headers:
+#include <functional>
 #include <string>
 #include <type_traits>
 #include <vector>
@@ -295,6 +296,44 @@ public:
 	size_t GetEstimatedReservedDeepSizeInBytes();
 	size_t GetEstimatedUsedDeepSizeInBytes();
 
+	//estimated memory of an entity and all contained entities, broken down by where it is held
+	struct MemoryUsage
+	{
+		//the total reserved by the node managers is nodesReserved, of which nodesUsed is in use
+		size_t nodesUsed = 0;
+		size_t nodesReserved = 0;
+
+		//share of the interned strings referenced by the nodes
+		size_t strings = 0;
+
+		//memory of the query caches, including their share of the strings they reference
+		size_t queryCaches = 0;
+
+		inline size_t GetTotal()
+		{
+			return nodesReserved + strings + queryCaches;
+		}
+	};
+
+	//returns the estimated memory of this entity and all contained entities
+	// only an estimate for the same reasons as GetEstimatedReservedDeepSizeInBytes
+	//per-thread query buffers are shared by all entities and so are not included
+	//measures while holding read references to this entity and all contained entities,
+	// so the calling thread must not already hold a lock on any of them
+	MemoryUsage GetEstimatedDeepMemoryUsage();
+
+	//returns the estimated memory of each of the entities, not including the entities they contain,
+	// which must be held by the references for the duration of the call
+	static MemoryUsage GetEstimatedMemoryUsage(std::vector<EntityReadReference> &entities);
+
+	//if the estimated memory of this entity and all contained entities exceeds soft_limit_in_bytes,
+	// reclaims memory in order of increasing cost until it no longer does: collecting garbage on entities that
+	// are idle, releasing the memory of per-thread query buffers, then, only if the query caches are the excess,
+	// clearing the largest query caches of entities that are not executing
+	//must not be called while holding a reference or memory lock on this entity or any contained entity
+	//returns the estimated memory usage after any reclamation
+	MemoryUsage ReduceMemoryUsageToSoftLimit(size_t soft_limit_in_bytes);
+
 	//Returns the EvaluableNode and true at the specified label_sid if the label is found
 	// Returns nullptr and false if the label does not exist
 	// Uses the EvaluableNodeManager destination_temp_enm to make a deep copy of the value.
@@ -392,8 +431,25 @@ public:
 	// if accum_values is true, then it will accumulate the values to the labels rather than setting them
 	// if num_new_nodes_allocated is not null, then it will be set to the total amount of new memory taken up by the entity at the end of the call
 	// other parameters match those of SetValueAtLabel, and will call SetValueAtLabel with batch_call = true
+	// if batch_call is true, then it will neither update the container's query caches nor log to write_listeners,
+	//  leaving both to the caller, as SetValuesAtLabelsOfContainedEntities does for the whole batch
 	std::pair<bool, bool> SetValuesAtLabels(EvaluableNodeReference new_label_values, bool accum_values,
-		std::vector<EntityWriteListener *> *write_listeners, size_t *num_new_nodes_allocated, bool on_self);
+		std::vector<EntityWriteListener *> *write_listeners, size_t *num_new_nodes_allocated, bool on_self,
+		bool batch_call = false);
+
+	//like SetValuesAtLabels, but for each pair in entities_and_label_values, sets or accumulates the label values
+	// of the assoc to its entity, each of which must be directly contained by this entity
+	// assumes there is a write lock on this entity, and obtains a write lock on each contained entity while writing to it
+	// the query caches of this entity are updated once for the whole batch and the writes are logged as a single entry
+	// if num_new_nodes_allocated is not null, then it will be set to the total amount of new memory taken up by the entities
+	// if stop_after_assignment is not null, it is called after each pair is assigned with the new memory taken up by
+	//  that entity, or 0 if num_new_nodes_allocated is null, and if it returns true, the remaining pairs are not assigned,
+	//  though the query caches and write listeners are still updated for the pairs that were
+	// returns a pair of values; the first is true if any assignment was successful, the second is only true if all assignments were successful
+	std::pair<bool, bool> SetValuesAtLabelsOfContainedEntities(
+		std::vector<std::pair<Entity *, EvaluableNodeReference>> &entities_and_label_values, bool accum_values,
+		std::vector<EntityWriteListener *> *write_listeners, size_t *num_new_nodes_allocated,
+		const std::function<bool(size_t)> &stop_after_assignment = nullptr);
 
 	//for each label in the ordered child nodes of labels_to_remove, attempts to remove each label
 	// returns a pair of values; the first is true if any assignment was successful, the second is only true if all assignments were successful
@@ -761,6 +817,13 @@ public:
 	void SetRoot(std::string &code_string,
 		std::vector<EntityWriteListener *> *write_listeners = nullptr);
 
+	//moves the label values of the entity and all of its contained entities that are not already shared
+	// into a single new immutable segment without copying them, so that clones of the entity made afterward
+	// reference the code instead of copying it, and the first write to shared code copies only what is written
+	//the code is semantically unchanged, so write listeners are not notified
+	//assumes write references are held on the entity and all contained entities and that none are being executed
+	void FreezeCodeAsShared();
+
 	//collects garbage on evaluableNodeManager, assuming it has a write reference
 #ifdef MULTITHREAD_SUPPORT
 	__forceinline void CollectGarbageWithEntityWriteReference()
@@ -886,6 +949,10 @@ public:
 
 protected:
 
+	//helper function for FreezeCodeAsShared
+	//moves the nodes of this entity and its contained entities that are not already shared into segment
+	void MoveCodeToSharedSegment(std::shared_ptr<EvaluableNodeManager> &segment);
+
 	//helper function for GetAllDeeplyContainedEntityReadReferencesGroupedByDepth
 	template<typename EntityReferenceType>
 	bool GetAllDeeplyContainedEntityReferencesGroupedByDepthRecurse(
@@ -171,6 +171,10 @@ std::string EntityExternalInterface::GetEntityPermissions(std::string &handle)
 	if(entity == nullptr)
 		return "null";
 
+#ifdef MULTITHREAD_SUPPORT
+	//lock memory before allocating so a background garbage collection cannot free the new nodes
+	Concurrency::ReadLock enm_lock(entity->evaluableNodeManager.GetMemoryModificationMutex());
+#endif
 	auto permissions = asset_manager.GetEntityPermissions(entity);
 	auto permissions_en = permissions.GetPermissionsAsEvaluableNode(&entity->evaluableNodeManager);
 
@@ -192,6 +196,10 @@ bool EntityExternalInterface::SetEntityPermissions(std::string &handle, std::str
 	if(entity == nullptr)
 		return false;
 
+#ifdef MULTITHREAD_SUPPORT
+	//lock memory before allocating so a background garbage collection cannot free the new nodes
+	Concurrency::ReadLock enm_lock(entity->evaluableNodeManager.GetMemoryModificationMutex());
+#endif
 	EvaluableNode *permissions_en = EvaluableNodeJSONTranslation::JsonToEvaluableNode(
 		&entity->evaluableNodeManager, json_permissions);
 
@@ -220,6 +228,9 @@ bool EntityExternalInterface::CloneEntity(std::string &handle, std::string &clon
 	if(json_file_params.size() > 0)
 	{
 		auto &enm = bundle->entity->evaluableNodeManager;
+	#ifdef MULTITHREAD_SUPPORT
+		Concurrency::ReadLock enm_lock(enm.GetMemoryModificationMutex());
+	#endif
 		EvaluableNode *file_params = EvaluableNodeJSONTranslation::JsonToEvaluableNode(&enm, json_file_params);
 
 		if(EvaluableNode::IsAssociativeArray(file_params))
@@ -249,6 +260,23 @@ bool EntityExternalInterface::CloneEntity(std::string &handle, std::string &clon
 	return true;
 }
 
+bool EntityExternalInterface::FreezeEntityCode(std::string &handle)
+{
+	auto bundle = FindEntityBundle(handle);
+	if(bundle == nullptr || bundle->entity == nullptr)
+		return false;
+
+	EntityWriteReference entity(bundle->entity);
+	auto contained_entities = entity->GetAllDeeplyContainedEntityReferencesGroupedByDepth<EntityWriteReference>();
+
+	//code that is being executed may be referenced from outside of the entity
+	if(entity->IsEntityCurrentlyBeingExecuted())
+		return false;
+
+	entity->FreezeCodeAsShared();
+	return true;
+}
+
 bool EntityExternalInterface::StoreEntity(std::string &handle, const EntityExternalInterface::StoreSource &source,
 	std::string file_type, bool persistent, std::string_view json_file_params, const std::vector<std::string> &entity_path)
 {
@@ -256,6 +284,10 @@ bool EntityExternalInterface::StoreEntity(std::string &handle, const EntityExter
 	if(bundle == nullptr || bundle->entity == nullptr)
 		return false;
 
+#ifdef MULTITHREAD_SUPPORT
+	//lock memory before allocating so a background garbage collection cannot free the new nodes
+	Concurrency::ReadLock enm_lock(bundle->entity->evaluableNodeManager.GetMemoryModificationMutex());
+#endif
 	EntityReadReference entity(bundle->entity);
 	if(entity_path.empty())
 		entity = bundle->entity;
@@ -306,6 +338,7 @@ void EntityExternalInterface::ExecuteEntity(std::string &handle, std::string &la
 		return;
 
 	bundle->entity->Execute(label, nullptr, false, nullptr, &bundle->writeListeners, bundle->printListener);
+	bundle->EnforceMemorySoftLimit();
 }
 
 void EntityExternalInterface::DestroyEntity(std::string &handle)
@@ -326,6 +359,59 @@ bool EntityExternalInterface::SetRandomSeed(std::string &handle, std::string &ra
 	return true;
 }
 
+bool EntityExternalInterface::SetBackgroundGarbageCollection(std::string &handle, uint64_t idle_milliseconds)
+{
+#ifdef MULTITHREAD_SUPPORT
+	auto bundle = FindEntityBundle(handle);
+	if(bundle == nullptr || bundle->entity == nullptr)
+		return false;
+
+	auto &enm = bundle->entity->evaluableNodeManager;
+	if(idle_milliseconds == 0)
+		enm.StopBackgroundGarbageCollection();
+	else
+		enm.StartBackgroundGarbageCollection(std::chrono::milliseconds(idle_milliseconds));
+	return true;
+#else
+	return false;
+#endif
+}
+
+std::string EntityExternalInterface::GetEntityMemoryUsage(std::string &handle)
+{
+	auto bundle = FindEntityBundle(handle);
+	if(bundle == nullptr || bundle->entity == nullptr)
+		return "";
+
+	Entity::MemoryUsage usage = bundle->entity->GetEstimatedDeepMemoryUsage();
+
+	return "{\"nodes_used\":" + std::to_string(usage.nodesUsed)
+		+ ",\"nodes_reserved\":" + std::to_string(usage.nodesReserved)
+		+ ",\"strings\":" + std::to_string(usage.strings)
+		+ ",\"query_caches\":" + std::to_string(usage.queryCaches)
+		+ ",\"total\":" + std::to_string(usage.GetTotal()) + "}";
+}
+
+bool EntityExternalInterface::SetEntityMemorySoftLimit(std::string &handle, uint64_t soft_limit_in_bytes,
+	uint64_t check_interval_milliseconds)
+{
+	auto bundle = FindEntityBundle(handle);
+	if(bundle == nullptr || bundle->entity == nullptr)
+		return false;
+
+	std::chrono::nanoseconds check_interval = EntityListenerBundle::defaultMemorySoftLimitCheckInterval;
+	if(check_interval_milliseconds > 0)
+		check_interval = std::chrono::milliseconds(check_interval_milliseconds);
+
+	bundle->memorySoftLimit = soft_limit_in_bytes;
+	bundle->memorySoftLimitCheckInterval = check_interval.count();
+	//check at the next opportunity
+	bundle->memorySoftLimitBackoff = 1;
+	bundle->nextMemorySoftLimitCheckTime = 0;
+	bundle->EnforceMemorySoftLimit();
+	return true;
+}
+
 std::vector<std::string> EntityExternalInterface::GetEntities()
 {
 	std::vector<std::string> entities;
@@ -346,14 +432,22 @@ bool EntityExternalInterface::SetJSONToLabel(std::string &handle, std::string &l
 	if(bundle == nullptr)
 		return false;
 
-	EntityWriteReference entity(bundle->entity);
+	bool all_success = false;
+	{
+	#ifdef MULTITHREAD_SUPPORT
+		//lock memory before allocating so a background garbage collection cannot free the new nodes
+		Concurrency::ReadLock enm_lock(bundle->entity->evaluableNodeManager.GetMemoryModificationMutex());
+	#endif
+		EntityWriteReference entity(bundle->entity);
 
-	EvaluableNode *node = EvaluableNodeJSONTranslation::JsonToEvaluableNode(&entity->evaluableNodeManager, json);
-	EvaluableNodeReference new_values(entity->evaluableNodeManager.AllocNode(ENT_ASSOC), true);
-	new_values->SetMappedChildNode(label, node);
+		EvaluableNode *node = EvaluableNodeJSONTranslation::JsonToEvaluableNode(&entity->evaluableNodeManager, json);
+		EvaluableNodeReference new_values(entity->evaluableNodeManager.AllocNode(ENT_ASSOC), true);
+		new_values->SetMappedChildNode(label, node);
 
-	auto [any_success, all_success] = entity->SetValuesAtLabels(new_values, false, &bundle->writeListeners, nullptr, true);
+		all_success = entity->SetValuesAtLabels(new_values, false, &bundle->writeListeners, nullptr, true).second;
+	}
 
+	bundle->EnforceMemorySoftLimit();
 	return all_success;
 }
 
@@ -363,6 +457,10 @@ std::string EntityExternalInterface::GetJSONFromLabel(std::string &handle, std::
 	if(bundle == nullptr)
 		return "";
 
+#ifdef MULTITHREAD_SUPPORT
+	//keep the value from being collected while it is converted
+	Concurrency::ReadLock enm_lock(bundle->entity->evaluableNodeManager.GetMemoryModificationMutex());
+#endif
 	EvaluableNode *label_val = bundle->entity->GetValueAtLabel(label, nullptr, false).first;
 	auto [result, converted] = EvaluableNodeJSONTranslation::EvaluableNodeToJson(label_val);
 	return (converted ? result : string_intern_pool.GetStringFromID(string_intern_pool.NOT_A_STRING_ID));
@@ -394,6 +492,13 @@ std::string EntityExternalInterface::ExecuteEntityJSON(std::string &handle, std:
 
 	auto [result, converted] = EvaluableNodeJSONTranslation::EvaluableNodeToJson(returned_value);
 	enm.FreeNodeTreeIfPossible(returned_value);
+
+#ifdef MULTITHREAD_SUPPORT
+	if(enm_lock.owns_lock())
+		enm_lock.unlock();
+#endif
+	bundle->EnforceMemorySoftLimit();
+
 	return (converted ? result : string_intern_pool.GetStringFromID(string_intern_pool.NOT_A_STRING_ID));
 }
 
@@ -430,6 +535,12 @@ std::pair<std::string, std::string> EntityExternalInterface::ExecuteEntityJSONLo
 
 	std::string log = Parser::Unparse(logger.GetWrites(), false);
 
+#ifdef MULTITHREAD_SUPPORT
+	if(enm_lock.owns_lock())
+		enm_lock.unlock();
+#endif
+	bundle->EnforceMemorySoftLimit();
+
 	return std::pair(json_out, log);
 }
 
@@ -466,6 +577,13 @@ std::string EntityExternalInterface::EvalOnEntity(const std::string &handle, con
 
 	auto [result, converted] = EvaluableNodeJSONTranslation::EvaluableNodeToJson(returned_value);
 	enm.FreeNodeTreeIfPossible(returned_value);
+
+#ifdef MULTITHREAD_SUPPORT
+	if(enm_lock.owns_lock())
+		enm_lock.unlock();
+#endif
+	bundle->EnforceMemorySoftLimit();
+
 	return (converted ? result : string_intern_pool.GetStringFromID(string_intern_pool.NOT_A_STRING_ID));
 }
 
@@ -482,3 +600,61 @@ EntityExternalInterface::EntityListenerBundle::~EntityListenerBundle()
 	if(writeListeners.size() > 0 && writeListeners[0] != nullptr)
 		delete writeListeners[0];
 }
+
+void EntityExternalInterface::EntityListenerBundle::EnforceMemorySoftLimit()
+{
+	uint64_t soft_limit = memorySoftLimit;
+	if(soft_limit == 0 || entity == nullptr)
+		return;
+
+	int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+	int64_t next_check_time = nextMemorySoftLimitCheckTime;
+	if(now < next_check_time)
+		return;
+
+	int64_t check_interval = memorySoftLimitCheckInterval;
+	int64_t backoff = memorySoftLimitBackoff;
+	int64_t new_next_check_time = now + check_interval * backoff;
+#ifdef MULTITHREAD_SUPPORT
+	//only one thread needs to check per interval
+	if(!nextMemorySoftLimitCheckTime.compare_exchange_strong(next_check_time, new_next_check_time))
+		return;
+#else
+	nextMemorySoftLimitCheckTime = new_next_check_time;
+#endif
+
+	auto usage = entity->ReduceMemoryUsageToSoftLimit(static_cast<size_t>(soft_limit));
+
+	//if reclaiming memory did not bring the entity under the limit, wait longer before trying again,
+	// since until enough of its data is freed, every check would find the same
+	if(usage.GetTotal() > soft_limit)
+	{
+	#ifdef MULTITHREAD_SUPPORT
+		//double whatever the backoff currently is, since the limit may have been set again during the check
+		backoff = memorySoftLimitBackoff;
+		int64_t new_backoff;
+		do
+		{
+			if(backoff >= maxMemorySoftLimitBackoff)
+				return;
+			new_backoff = backoff * 2;
+		} while(!memorySoftLimitBackoff.compare_exchange_weak(backoff, new_backoff));
+
+		//only delay the next check if it is still the one claimed above,
+		// otherwise the limit was set again or another thread has already rescheduled it
+		nextMemorySoftLimitCheckTime.compare_exchange_strong(new_next_check_time, now + check_interval * new_backoff);
+	#else
+		if(backoff < maxMemorySoftLimitBackoff)
+		{
+			backoff *= 2;
+			memorySoftLimitBackoff = backoff;
+			nextMemorySoftLimitCheckTime = now + check_interval * backoff;
+		}
+	#endif
+	}
+	else if(backoff > 1)
+	{
+		memorySoftLimitBackoff = 1;
+	}
+}
@@ -7,6 +7,8 @@
 #include "PrintListener.h"
 
 //system headers:
+#include <atomic>
+#include <chrono>
 #include <string>
 #include <variant>
 #include <vector>
@@ -83,6 +85,11 @@ public:
 		std::string file_type, bool persistent, std::string_view json_file_params,
 		std::string &write_log_filename, std::string &print_log_filename);
 
+	//moves the code of the entity specified by handle and its contained entities into immutable memory shared
+	// with any clones made afterward
+	//returns false if the handle is not found or the entity is currently being executed
+	bool FreezeEntityCode(std::string &handle);
+
 	// Store an entity from a handle into some source.
 	//
 	// If entity_path is non-empty, then store the entity at that path within the entity
@@ -96,6 +103,22 @@ public:
 
 	void DestroyEntity(std::string &handle);
 	bool SetRandomSeed(std::string &handle, std::string &rand_seed);
+
+	//collects garbage on a background thread for the entity specified by handle whenever it has been idle
+	// for idle_milliseconds; 0 stops background collection
+	//returns false if the handle is not found or if multithreading is not supported
+	bool SetBackgroundGarbageCollection(std::string &handle, uint64_t idle_milliseconds);
+
+	//returns a json object of the estimated memory in bytes of the entity specified by handle and all of its
+	// contained entities, with the same breakdown as the mem_usage system command; empty string if the handle is not found
+	std::string GetEntityMemoryUsage(std::string &handle);
+
+	//sets a soft limit on the estimated memory of the entity specified by handle; when calls that may allocate
+	// leave the entity above the limit, memory is reclaimed as described in Entity::ReduceMemoryUsageToSoftLimit
+	//the limit is checked at most once per check_interval_milliseconds, or the default interval if 0
+	//0 removes the limit; returns false if the handle is not found
+	bool SetEntityMemorySoftLimit(std::string &handle, uint64_t soft_limit_in_bytes, uint64_t check_interval_milliseconds = 0);
+
 	std::vector<std::string> GetEntities();
 
 	bool SetJSONToLabel(std::string &handle, std::string &label, std::string_view json);
@@ -120,6 +143,11 @@ protected:
 
 		~EntityListenerBundle();
 
+		//if a memory soft limit is set and has not been checked within the check interval,
+		// reclaims memory as needed to bring the entity under it
+		//must not be called while holding a reference or memory lock on the entity
+		void EnforceMemorySoftLimit();
+
 		//the type of mutex is dependent on whether individual entities can be accessed concurrently
 	#ifdef MULTITHREAD_SUPPORT
 		Concurrency::ReadWriteMutex mutex;
@@ -128,6 +156,30 @@ protected:
 		Entity *entity;
 		std::vector<EntityWriteListener *> writeListeners;
 		PrintListener *printListener;
+
+		//measuring memory visits every node, so by default the soft limit is checked at most once per interval
+		static constexpr std::chrono::milliseconds defaultMemorySoftLimitCheckInterval = std::chrono::milliseconds(100);
+
+		//each check that leaves the entity above the soft limit doubles the time until the next check,
+		// up to this many check intervals, so an entity whose data alone exceeds the limit is not measured constantly
+		static constexpr int64_t maxMemorySoftLimitBackoff = 64;
+
+		//soft limit on the estimated memory of the entity in bytes, 0 if none, the interval between checks
+		// in nanoseconds, the number of intervals to wait after the last check, and the steady clock time
+		// in nanoseconds before which it should not be checked again
+	#ifdef MULTITHREAD_SUPPORT
+		std::atomic<uint64_t> memorySoftLimit = 0;
+		std::atomic<int64_t> memorySoftLimitCheckInterval
+			= std::chrono::duration_cast<std::chrono::nanoseconds>(defaultMemorySoftLimitCheckInterval).count();
+		std::atomic<int64_t> memorySoftLimitBackoff = 1;
+		std::atomic<int64_t> nextMemorySoftLimitCheckTime = 0;
+	#else
+		uint64_t memorySoftLimit = 0;
+		int64_t memorySoftLimitCheckInterval
+			= std::chrono::duration_cast<std::chrono::nanoseconds>(defaultMemorySoftLimitCheckInterval).count();
+		int64_t memorySoftLimitBackoff = 1;
+		int64_t nextMemorySoftLimitCheckTime = 0;
+	#endif
 	};
 
 	class EntityListenerBundleReadReference
@@ -416,6 +416,8 @@ namespace EntityQueryBuilder
 										|| found_value->second->GetType() == ENT_CALL_ON_ENTITY))
 								feature_attribs.callEntityOpcode = found_value->second;
 						}
+						feature_attribs.cacheCallEntityResults = false;
+						EvaluableNode::GetValueFromMappedChildNodesReference(mcn, ENBISI_cache_call_entity, feature_attribs.cacheCallEntityResults);
 
 						auto feature_type = GeneralizedDistanceEvaluator::FDT_CONTINUOUS_NUMBER;
 						if(difference_type == GetStringIdFromBuiltInStringId(ENBISI_nominal))
@@ -795,6 +797,7 @@ namespace EntityQueryBuilder
 		//set numerical precision
 		cur_condition->distEvaluator.highAccuracyDistances = false;
 		cur_condition->distEvaluator.recomputeAccurateDistances = true;
+		cur_condition->distEvaluator.singlePrecisionValues = false;
 		if(ocn.size() > NUMERICAL_PRECISION)
 		{
 			StringInternPool::StringID np_sid = EvaluableNode::ToStringIDIfExists(ocn[NUMERICAL_PRECISION]);
@@ -808,6 +811,10 @@ namespace EntityQueryBuilder
 				cur_condition->distEvaluator.highAccuracyDistances = false;
 				cur_condition->distEvaluator.recomputeAccurateDistances = false;
 			}
+			else if(np_sid == GetStringIdFromBuiltInStringId(ENBISI_single_recompute_precise))
+			{
+				cur_condition->distEvaluator.singlePrecisionValues = true;
+			}
 			//don't need to do anything for np_sid == ENBISI_recompute_precise because it's default
 		}
 
@@ -848,7 +848,8 @@ void EntityQueryCaches::ComputeValuesFromMatchingEntities(EntityQueryCondition *
 	}
 }
 
-void EntityQueryCaches::GetMatchingEntitiesViaSamplingWithReplacement(EntityQueryCondition *cond, BitArrayIntegerSet &matching_entities, std::vector<size_t> &entity_indices_sampled, bool is_first, bool update_matching_entities)
+void EntityQueryCaches::GetMatchingEntitiesViaSamplingWithReplacement(EntityQueryCondition *cond, BitArrayIntegerSet &matching_entities, std::vector<size_t> &entity_indices_sampled,
+	bool is_first, bool update_matching_entities, bool use_weighted_sampling_cache)
 {
 #if defined(MULTITHREAD_SUPPORT)
 	Concurrency::ReadLock lock(mutex);
@@ -859,6 +860,93 @@ void EntityQueryCaches::GetMatchingEntitiesViaSamplingWithReplacement(EntityQuer
 
 	size_t num_to_sample = cond->maxToRetrieve;
 
+	//if sampling many, an alias table is faster, otherwise a binary search of the cumulative probabilities is used
+	// in both cases, the same entities are selected as when sampling from freshly gathered weights
+	constexpr size_t min_num_samples_for_alias_table = 10;
+	bool use_alias_table = (num_to_sample >= min_num_samples_for_alias_table);
+
+	WeightedSamplingCache *cache = nullptr;
+	if(use_weighted_sampling_cache)
+		cache = GetWeightedSamplingCache(cond->singleLabel, use_alias_table);
+	if(cache != nullptr)
+	{
+		auto &cached_entity_indices = cache->entityIndices;
+		auto &cumulative_probabilities = cache->cumulativeProbabilities;
+
+		auto sample_entity = [cache, use_alias_table, cond, &cached_entity_indices, &cumulative_probabilities]()
+		{
+			if(use_alias_table)
+				return cache->aliasTable->WeightedDiscreteRand(cond->randomStream);
+
+			double r = cond->randomStream.Rand();
+			size_t selected_index = std::lower_bound(begin(cumulative_probabilities), end(cumulative_probabilities), r)
+				- begin(cumulative_probabilities);
+			//if past the end due to numerical precision, use the last one
+			if(selected_index == cumulative_probabilities.size())
+				selected_index--;
+			return cached_entity_indices[selected_index];
+		};
+
+		if(is_first)
+		{
+			if(update_matching_entities)
+				matching_entities.clear();
+
+			for(size_t i = 0; i < num_to_sample; i++)
+			{
+				size_t eid = sample_entity();
+
+				if(update_matching_entities)
+					matching_entities.insert(eid);
+
+				entity_indices_sampled.push_back(eid);
+			}
+			return;
+		}
+
+		//find the probability mass of the entities that are still matching
+		double matching_probability = 0.0;
+		size_t index = 0;
+		for(auto eid : matching_entities)
+		{
+			index = SortedIntegerSet::GallopLowerBound(cached_entity_indices.data(), index, cached_entity_indices.size(), eid);
+			if(index == cached_entity_indices.size())
+				break;
+
+			if(cached_entity_indices[index] == eid)
+			{
+				matching_probability += cumulative_probabilities[index]
+					- (index > 0 ? cumulative_probabilities[index - 1] : 0.0);
+			}
+		}
+
+		//if the expected number of draws to sample from all of the entities and reject those not matching
+		// is small relative to gathering and normalizing the weights of the matching entities, use rejection sampling
+		constexpr double max_rejection_draws_per_matching_entity = 4.0;
+		if(matching_probability > 0.0
+			&& num_to_sample <= max_rejection_draws_per_matching_entity * matching_probability * matching_entities.size())
+		{
+			size_t first_sampled = entity_indices_sampled.size();
+			for(size_t num_sampled = 0; num_sampled < num_to_sample; )
+			{
+				size_t eid = sample_entity();
+				if(matching_entities.contains(eid))
+				{
+					entity_indices_sampled.push_back(eid);
+					num_sampled++;
+				}
+			}
+
+			if(update_matching_entities)
+			{
+				matching_entities.clear();
+				for(size_t i = first_sampled; i < entity_indices_sampled.size(); i++)
+					matching_entities.insert(entity_indices_sampled[i]);
+			}
+			return;
+		}
+	}
+
 	auto &probabilities = EntityQueryCaches::buffers.doubleVector;
 	auto &entity_indices = EntityQueryCaches::buffers.entityIndices;
 
@@ -909,10 +997,95 @@ void EntityQueryCaches::GetMatchingEntitiesViaSamplingWithReplacement(EntityQuer
 	}
 }
 
+EntityQueryCaches::WeightedSamplingCache *EntityQueryCaches::GetWeightedSamplingCache(
+	StringInternPool::StringID weight_label_sid, bool need_alias_table)
+{
+#if defined(MULTITHREAD_SUPPORT)
+	Concurrency::Lock lock(weightedSamplingCachesMutex);
+#endif
+
+	auto &probabilities = EntityQueryCaches::buffers.doubleVector;
+	auto &entity_indices = EntityQueryCaches::buffers.entityIndices;
+
+	auto [cache_iter, inserted] = weightedSamplingCaches.emplace(weight_label_sid, nullptr);
+	if(!inserted)
+	{
+		WeightedSamplingCache *cache = cache_iter->second.get();
+		if(cache != nullptr && need_alias_table && cache->aliasTable == nullptr)
+		{
+			//gather the weights the same way as when building the cache so the alias table is identical
+			sbfds.FindAllEntitiesWithValidNumbers(weight_label_sid, buffers.tempMatchingEntityIndices, entity_indices, probabilities);
+			NormalizeVector(probabilities, 1.0);
+			cache->aliasTable = std::make_unique<WeightedDiscreteRandomStreamTransform<size_t>>(entity_indices, probabilities, false);
+		}
+		return cache;
+	}
+
+	sbfds.FindAllEntitiesWithValidNumbers(weight_label_sid, buffers.tempMatchingEntityIndices, entity_indices, probabilities);
+	if(entity_indices.size() == 0)
+		return nullptr;
+
+	NormalizeVector(probabilities, 1.0);
+
+	auto cache = std::make_unique<WeightedSamplingCache>();
+
+	//accumulate in the same order as WeightedDiscreteRandomSample
+	//negative weights would make the cumulative probabilities not monotonic, so leave those uncached
+	cache->cumulativeProbabilities.resize(probabilities.size());
+	double probability_mass = 0.0;
+	for(size_t i = 0; i < probabilities.size(); i++)
+	{
+		if(!(probabilities[i] >= 0.0))
+			return nullptr;
+
+		probability_mass += probabilities[i];
+		cache->cumulativeProbabilities[i] = probability_mass;
+	}
+
+	if(probability_mass <= 0.0)
+		return nullptr;
+
+	cache->entityIndices = entity_indices;
+	if(need_alias_table)
+		cache->aliasTable = std::make_unique<WeightedDiscreteRandomStreamTransform<size_t>>(entity_indices, probabilities, false);
+
+	cache_iter->second = std::move(cache);
+	return cache_iter->second.get();
+}
+
+size_t EntityQueryCaches::GetEstimatedSizeInBytes()
+{
+	size_t total_size = sizeof(EntityQueryCaches) + sbfds.GetEstimatedSizeInBytes();
+
+#if defined(MULTITHREAD_SUPPORT)
+	//caches may be built while holding a read lock on mutex
+	Concurrency::Lock lock(weightedSamplingCachesMutex);
+#endif
+	total_size += weightedSamplingCaches.bucket_count()
+		* (sizeof(std::pair<StringInternPool::StringID, std::unique_ptr<WeightedSamplingCache>>) + sizeof(void *));
+	for(auto &[label_sid, sampling_cache] : weightedSamplingCaches)
+	{
+		if(sampling_cache == nullptr)
+			continue;
+
+		total_size += sizeof(WeightedSamplingCache);
+		total_size += sampling_cache->entityIndices.capacity() * sizeof(size_t);
+		total_size += sampling_cache->cumulativeProbabilities.capacity() * sizeof(double);
+		//the alias table stores a probability and an alias for each entity
+		if(sampling_cache->aliasTable != nullptr)
+			total_size += sampling_cache->entityIndices.size() * (sizeof(double) + sizeof(size_t));
+	}
+
+	return total_size;
+}
+
 EvaluableNodeReference EntityQueryCaches::GetMatchingEntitiesFromQueryCaches(Entity *container,
 	std::vector<EntityQueryCondition> &conditions, EvaluableNodeManager *enm,
 	bool return_query_value, EvaluableNodeRequestedValueTypes immediate_result)
 {
+	//release any buffer memory requested before references to the buffers are taken
+	ReleaseBuffersIfRequested();
+
 	//get the cache associated with this container
 	// use the first condition as an heuristic for building it if it doesn't exist
 	EntityQueryCaches *entity_caches = container->GetQueryCaches();
@@ -1221,8 +1394,9 @@ EvaluableNodeReference EntityQueryCaches::GetMatchingEntitiesFromQueryCaches(Ent
 			if(immediate_result.Allows(EvaluableNodeRequestedValueTypes::Type::SIZE_AS_NUMBER))
 				return EvaluableNodeReference(static_cast<double>(compute_results.size()));
 
+			//if only an aggregate of the values is requested, it can be computed without building the list
 			return CreateListOfNumbersFromIteratorAndFunction(compute_results, enm,
-				[](auto &result) { return result.distance; });
+				[](auto &result) { return result.distance; }, immediate_result);
 		}
 		else if(last_query_type == ENT_QUERY_WITHIN_GENERALIZED_DISTANCE
 			|| last_query_type == ENT_QUERY_NEAREST_GENERALIZED_DISTANCE
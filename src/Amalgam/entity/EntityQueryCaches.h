@@ -7,11 +7,13 @@
 #include "IntegerSet.h"
 #include "KnnCache.h"
 #include "SeparableBoxFilterDataStore.h"
+#include "WeightedDiscreteRandomStream.h"
 #include <EvaluableNodeManagement.h>
 #include <EvaluableNodeReference.h>
 #include <StringInternPool.h>
 
 //system headers:
+#include <memory>
 #include <vector>
 
 //forward declarations:
@@ -40,6 +42,7 @@ public:
 	#endif
 
 		sbfds.AddEntity(e, entity_index);
+		weightedSamplingCaches.clear();
 	}
 
 	//like AddEntity, but removes the entity from the cache and reassigns entity_index_to_reassign to use the old
@@ -55,6 +58,7 @@ public:
 	#endif
 
 		sbfds.RemoveEntity(e, entity_index, entity_index_to_reassign);
+		weightedSamplingCaches.clear();
 	}
 
 	//updates all of the label values for entity e with index entity_index
@@ -65,6 +69,7 @@ public:
 	#endif
 
 		sbfds.UpdateAllEntityLabels(entity, entity_index);
+		weightedSamplingCaches.clear();
 	}
 
 	//updates the labels for the entity to the new_values specified based on the keys in new_values
@@ -76,7 +81,26 @@ public:
 	#endif
 
 		for(auto &label_id : new_values | std::views::keys)
+		{
 			sbfds.UpdateEntityLabel(entity, entity_index, label_id);
+			weightedSamplingCaches.erase(label_id);
+		}
+	}
+
+	//like UpdateEntityLabels, but for a batch of entities, where label_sids_to_entities maps each label
+	// to the entities and their indices that have had the label updated, all updated under one lock
+	inline void UpdateEntitiesLabels(
+		FastHashMap<StringInternPool::StringID, std::vector<std::pair<Entity *, size_t>>> &label_sids_to_entities)
+	{
+	#if defined(MULTITHREAD_SUPPORT)
+		Concurrency::WriteLock write_lock(mutex);
+	#endif
+
+		for(auto &[label_sid, entities_and_indices] : label_sids_to_entities)
+		{
+			sbfds.UpdateEntityLabelForEntities(label_sid, entities_and_indices);
+			weightedSamplingCaches.erase(label_sid);
+		}
 	}
 
 	//removes all entity labels specified
@@ -92,9 +116,26 @@ public:
 			EvaluableNodeImmediateValue imm_val;
 			auto value_type = imm_val.CopyValueFromEvaluableNode(prev_node);
 			sbfds.RemoveEntityIndexValueFromLabelId(value_type, imm_val, entity_index, label_sid);
+			weightedSamplingCaches.erase(label_sid);
 		}
 	}
 
+	//returns the estimated number of bytes of memory used by the caches
+	//requires at least a read lock on mutex
+	size_t GetEstimatedSizeInBytes();
+
+	//releases the memory of the calling thread's buffers if a release has been requested
+	// via SeparableBoxFilterDataStore::RequestBufferRelease since they were last released
+	static inline void ReleaseBuffersIfRequested()
+	{
+		size_t release_generation = SeparableBoxFilterDataStore::GetBufferReleaseGeneration();
+		if(buffersReleaseGeneration == release_generation)
+			return;
+
+		buffersReleaseGeneration = release_generation;
+		buffers = QueryCachesBuffers();
+	}
+
 	//specifies that this cache can be used for the input condition
 	static bool DoesCachedConditionMatch(EntityQueryCondition *cond, bool last_condition);
 
@@ -118,6 +159,7 @@ public:
 		Concurrency::WriteLock write_lock(mutex);
 	#endif
 		sbfds.RemoveLabel(label_sid);
+		weightedSamplingCaches.erase(label_sid);
 	}
 
 	//returns the set matching_entities of entity ids in the cache that match the provided query condition cond, will fill compute_results with numeric results if KNN query
@@ -132,7 +174,30 @@ public:
 	void ComputeValuesFromMatchingEntities(EntityQueryCondition *cond, BitArrayIntegerSet &matching_entities, FastHashMap<StringInternPool::StringID, double> &compute_results, bool is_first);
 
 	//like GetMatchingEntities, but returns entity_indices_sampled
-	void GetMatchingEntitiesViaSamplingWithReplacement(EntityQueryCondition *cond, BitArrayIntegerSet &matching_entities, std::vector<size_t> &entity_indices_sampled, bool is_first, bool update_matching_entities);
+	//if use_weighted_sampling_cache is false, the weights are always gathered and normalized rather than sampled
+	// from weightedSamplingCaches, which yields the same samples when is_first is true
+	void GetMatchingEntitiesViaSamplingWithReplacement(EntityQueryCondition *cond, BitArrayIntegerSet &matching_entities, std::vector<size_t> &entity_indices_sampled,
+		bool is_first, bool update_matching_entities, bool use_weighted_sampling_cache = true);
+
+	//cached data for sampling entities weighted by the number values of a label
+	struct WeightedSamplingCache
+	{
+		//entities with a number value for the label, in ascending order
+		std::vector<size_t> entityIndices;
+
+		//normalized weights of entityIndices summed in order, so that a sample via binary search
+		// selects the same entity as WeightedDiscreteRandomSample
+		std::vector<double> cumulativeProbabilities;
+
+		//alias table for entityIndices, built when a sample size warrants it
+		std::unique_ptr<WeightedDiscreteRandomStreamTransform<size_t>> aliasTable;
+	};
+
+	//returns the weighted sampling cache for weight_label_sid, building it if needed
+	//returns nullptr if the weights cannot be sampled from the cache, such as if there are negative weights
+	// or no positive weights, in which case the weights should be gathered and sampled directly
+	//requires at least a read lock on mutex
+	WeightedSamplingCache *GetWeightedSamplingCache(StringInternPool::StringID weight_label_sid, bool need_alias_table);
 
 	//searches container for contained entities matching query.
 	// if return_query_value is false, then returns a list of all IDs of matching contained entities
@@ -186,11 +251,23 @@ public:
 	Concurrency::ReadWriteMutex mutex;
 #endif
 
+	//weighted sampling caches indexed by the label of the weights
+	//entries are invalidated whenever values of the label change, and an entry of nullptr
+	// indicates the weights cannot be sampled from a cache
+	FastHashMap<StringInternPool::StringID, std::unique_ptr<WeightedSamplingCache>> weightedSamplingCaches;
+
+#if defined(MULTITHREAD_SUPPORT)
+	//mutex for building weightedSamplingCaches while holding a read lock on mutex
+	Concurrency::SingleMutex weightedSamplingCachesMutex;
+#endif
+
 	//buffers that can be used for less memory churn (per-thread if multithreaded)
 	//for multithreading, there should be one of these per thread
 #if defined(MULTITHREAD_SUPPORT)
 	thread_local static QueryCachesBuffers buffers;
+	thread_local inline static size_t buffersReleaseGeneration = 0;
 #else
 	static QueryCachesBuffers buffers;
+	inline static size_t buffersReleaseGeneration = 0;
 #endif
 };
@@ -129,6 +129,37 @@ void EntityWriteListener::LogWriteLabelValuesToEntity(Entity *entity,
 	LogNewEntry(new_write);
 }
 
+void EntityWriteListener::LogWriteLabelValuesToEntities(
+	std::vector<std::pair<Entity *, EvaluableNode *>> &entities_and_label_value_pairs, bool accum_values)
+{
+	if(entities_and_label_value_pairs.empty())
+		return;
+
+#ifdef MULTITHREAD_SUPPORT
+	Concurrency::Lock lock(mutex);
+#endif
+
+	auto node_type = ENT_ASSIGN_TO_ENTITIES;
+	if(accum_values)
+		node_type = ENT_ACCUM_TO_ENTITIES;
+
+	//(assign_to_entities *id list 1* *assoc 1* *id list 2* *assoc 2* ...)
+	EvaluableNode *new_write = listenerStorage.AllocNode(node_type);
+	new_write->ReserveOrderedChildNodes(2 * entities_and_label_value_pairs.size());
+
+	for(auto &[entity, label_value_pairs] : entities_and_label_value_pairs)
+	{
+		if(entity != listeningEntity)
+			new_write->AppendOrderedChildNode(GetTraversalIDPathFromAToB(&listenerStorage, listeningEntity, entity));
+		else
+			new_write->AppendOrderedChildNode(nullptr);
+
+		new_write->AppendOrderedChildNode(listenerStorage.DeepAllocCopy(label_value_pairs));
+	}
+
+	LogNewEntry(new_write);
+}
+
 void EntityWriteListener::LogRemoveLabelsFromEntity(Entity *entity, EvaluableNode *labels)
 {
 	//can only work with ordered child nodes
@@ -40,6 +40,11 @@ public:
 	// in the assoc specified by label_value_pairs
 	void LogWriteLabelValuesToEntity(Entity *entity, EvaluableNode *label_value_pairs, bool accum_values);
 
+	//like LogWriteLabelValuesToEntity, but logs the writes to all of the entities as a single entry,
+	// where each entity is paired with the assoc of label values written to it
+	void LogWriteLabelValuesToEntities(std::vector<std::pair<Entity *, EvaluableNode *>> &entities_and_label_value_pairs,
+		bool accum_values);
+
 	void LogRemoveLabelsFromEntity(Entity *entity, EvaluableNode *labels);
 
 	//logs the new entity root, assuming it has already been set
@@ -373,6 +373,7 @@ bool EvaluableNode::IsNodeValid()
 
 void EvaluableNode::InitializeType(EvaluableNode *n, bool copy_metadata)
 {
+	//start without any attributes, including SHARED, so that the copy is modifiable
 	attributes = static_cast<AttributeStorageType>(Attribute::NONE);
 	if(n == nullptr)
 	{
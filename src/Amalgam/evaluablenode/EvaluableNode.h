@@ -40,7 +40,8 @@ public:
 	using KeywordLookupType = FastHashMap<std::string, EvaluableNodeType>;
 
 	//EvaluableNode assoc storage
-	using AssocType = CompactHashMap<StringInternPool::StringID, EvaluableNode *>;
+	//small assocs iterate in insertion order and larger ones in hash order, so iteration order is never guaranteed
+	using AssocType = AdaptiveCompactHashMap<StringInternPool::StringID, EvaluableNode *>;
 
 	//EvaluableNode ordered storage
 	using OrderedType = std::vector<EvaluableNode *>;
@@ -68,8 +69,11 @@ public:
 		FREEABLE_TOP_NODE = 1 << 5,
 		//if true, then known to be in use with regard to garbage collection
 		KNOWN_TO_BE_IN_USE = 1 << 6,
+		//if true, then the node belongs to an immutable segment shared across EvaluableNodeManagers
+		// and must not be modified, freed, or marked by garbage collection
+		SHARED = 1 << 7,
 		ALL = HAS_EXTENDED_VALUE | NEED_CYCLE_CHECK | IDEMPOTENT | CONCURRENT
-				| FREEABLE | FREEABLE_TOP_NODE | KNOWN_TO_BE_IN_USE
+				| FREEABLE | FREEABLE_TOP_NODE | KNOWN_TO_BE_IN_USE | SHARED
 	};
 
 	//constructors
@@ -294,6 +298,8 @@ public:
 	}
 
 	//sets the value of the node to that of n and copies metadata if copy_metadata is true
+	//the node is never shared even if n is, since this is how a private copy of a shared node is made,
+	// though any shared child nodes of n remain shared and are referenced rather than copied
 	void InitializeType(EvaluableNode *n, bool copy_metadata = true);
 
 	//copies the EvaluableNode n into this.  Does not overwrite labels or comments.
@@ -1111,6 +1117,26 @@ public:
 	}
 #endif
 
+	//returns true if the node belongs to an immutable shared segment
+	__forceinline bool GetIsShared()
+	{
+		return HasAttribute(Attribute::SHARED);
+	}
+
+	//sets whether the node belongs to an immutable shared segment
+	__forceinline void SetIsShared(bool is_shared)
+	{
+		SetAttribute(Attribute::SHARED, is_shared);
+	}
+
+	//returns true if garbage collection does not need to mark this node,
+	// either because it has already been marked or because it is shared
+	__forceinline bool GetKnownToBeInUseOrIsShared()
+	{
+		return (attributes & (static_cast<AttributeStorageType>(Attribute::KNOWN_TO_BE_IN_USE)
+			| static_cast<AttributeStorageType>(Attribute::SHARED))) != 0;
+	}
+
 	//returns true if value contains an extended type
 	__forceinline bool HasExtendedValue()
 	{
@@ -21,6 +21,8 @@ constexpr size_t _invalidate_nodes_task_size = 4000;
 EvaluableNodeManager::~EvaluableNodeManager()
 {
 #ifdef MULTITHREAD_SUPPORT
+	StopBackgroundGarbageCollection();
+
 	Concurrency::WriteLock lock(managerAttributesMutex);
 
 	//clear from any threads
@@ -169,6 +171,113 @@ void EvaluableNodeManager::CollectGarbageWithConcurrentAccess(Concurrency::ReadL
 }
 #endif
 
+#ifdef MULTITHREAD_SUPPORT
+void EvaluableNodeManager::StartBackgroundGarbageCollection(std::chrono::milliseconds idle_interval)
+{
+	Concurrency::SingleLock lock(backgroundGarbageCollectorMutex);
+	StopBackgroundGarbageCollectionWithLock();
+
+	//make sure the memory modification mutex exists before the thread uses it
+	GetMemoryModificationMutex();
+
+	backgroundGarbageCollector = std::make_unique<BackgroundGarbageCollector>();
+	backgroundGarbageCollector->idleInterval = std::max(idle_interval, std::chrono::milliseconds(1));
+	backgroundGarbageCollector->thread = std::thread(
+		[this, bgc = backgroundGarbageCollector.get()]() { RunBackgroundGarbageCollection(*bgc); });
+}
+
+void EvaluableNodeManager::StopBackgroundGarbageCollection()
+{
+	Concurrency::SingleLock lock(backgroundGarbageCollectorMutex);
+	StopBackgroundGarbageCollectionWithLock();
+}
+
+void EvaluableNodeManager::StopBackgroundGarbageCollectionWithLock()
+{
+	if(backgroundGarbageCollector == nullptr)
+		return;
+
+	{
+		Concurrency::SingleLock lock(backgroundGarbageCollector->mutex);
+		backgroundGarbageCollector->stopRequested = true;
+	}
+	backgroundGarbageCollector->stopConditionVar.notify_all();
+
+	if(backgroundGarbageCollector->thread.joinable())
+		backgroundGarbageCollector->thread.join();
+
+	backgroundGarbageCollector.reset();
+}
+
+void EvaluableNodeManager::RunBackgroundGarbageCollection(BackgroundGarbageCollector &bgc)
+{
+	size_t prev_num_used_nodes = GetNumberOfUsedNodes();
+	bool collected_since_last_activity = false;
+
+	Concurrency::SingleLock lock(bgc.mutex);
+	while(!bgc.stopConditionVar.wait_for(lock, bgc.idleInterval, [&bgc]() { return bgc.stopRequested; }))
+	{
+		//any allocation or collection since the last check means the manager was not idle
+		size_t num_used_nodes = GetNumberOfUsedNodes();
+		if(num_used_nodes != prev_num_used_nodes || AreAnyInterpretersRunning())
+		{
+			prev_num_used_nodes = num_used_nodes;
+			collected_since_last_activity = false;
+			continue;
+		}
+
+		if(collected_since_last_activity || num_used_nodes < minNodesToCollectGarbage)
+			continue;
+
+		//don't hold the stop mutex while collecting so a stop request doesn't block on it
+		lock.unlock();
+		if(CollectGarbageIfIdle())
+		{
+			collected_since_last_activity = true;
+			prev_num_used_nodes = GetNumberOfUsedNodes();
+		}
+		lock.lock();
+	}
+}
+#endif
+
+bool EvaluableNodeManager::CollectGarbageIfIdle()
+{
+#ifdef MULTITHREAD_SUPPORT
+	//if any thread is accessing memory, it isn't idle, so try again later rather than block it
+	Concurrency::WriteLock write_lock(GetMemoryModificationMutex(), std::try_to_lock);
+	if(!write_lock.owns_lock() || AreAnyInterpretersRunning())
+		return false;
+
+	//if another thread has been selected to collect garbage, let it
+	if(activeInterpreters->garbageCollectionThreadSelectionFlag.test_and_set(std::memory_order_acquire))
+		return false;
+
+	{
+		Concurrency::SingleLock lock(activeInterpreters->garbageCollectionNotificationMutex);
+		activeInterpreters->garbageCollectionInProgress.store(true, std::memory_order_release);
+	}
+
+	CollectGarbage();
+	ShrinkMemoryToCurrentUtilization();
+
+	{
+		Concurrency::SingleLock lock(activeInterpreters->garbageCollectionNotificationMutex);
+		activeInterpreters->garbageCollectionInProgress.store(false, std::memory_order_release);
+		activeInterpreters->garbageCollectionThreadSelectionFlag.clear(std::memory_order_release);
+	}
+	activeInterpreters->garbageCollectionConditionVar.notify_all();
+#else
+	if(AreAnyInterpretersRunning())
+		return false;
+
+	CollectGarbage();
+	ShrinkMemoryToCurrentUtilization();
+#endif
+
+	return true;
+}
+
 void EvaluableNodeManager::FreeAllNodes()
 {
 #ifdef MULTITHREAD_SUPPORT
@@ -256,7 +365,8 @@ EvaluableNode *EvaluableNodeManager::AllocUninitializedNode()
 		//ran out, so need another node; push a bunch on the heap so don't need to reallocate as often and slow down garbage collection
 		//add extra node at the end in case of rounding down
 		//preallocate additional resources, making sure to at least add one block
-		size_t new_num_nodes = static_cast<size_t>(allocExpansionFactor * (num_nodes + labBlockAllocationSize)) + 1;
+		//size from the end of this block, since concurrent allocations may have claimed indices far past the end
+		size_t new_num_nodes = static_cast<size_t>(allocExpansionFactor * (last_index_to_allocate + labBlockAllocationSize)) + 1;
 
 		//fill new EvaluableNode slots with nullptr
 		nodes.resize(new_num_nodes, nullptr);
@@ -277,6 +387,73 @@ EvaluableNode *EvaluableNodeManager::AllocUninitializedNode()
 	return AllocNodeFromLocalAllocationBufferIfAvailable();
 }
 
+void EvaluableNodeManager::AllocUninitializedNodes(EvaluableNode **dest, size_t num_nodes)
+{
+	//use up whatever is in the local allocation buffer first
+	size_t num_allocated = 0;
+	for(; num_allocated < num_nodes; num_allocated++)
+	{
+		EvaluableNode *lab_node = AllocNodeFromLocalAllocationBufferIfAvailable();
+		if(lab_node == nullptr)
+			break;
+		dest[num_allocated] = lab_node;
+	}
+
+	size_t num_to_allocate = num_nodes - num_allocated;
+	if(num_to_allocate == 0)
+		return;
+
+	//small requests are no better than refilling the local allocation buffer
+	if(num_to_allocate < labBlockAllocationSize)
+	{
+		for(; num_allocated < num_nodes; num_allocated++)
+			dest[num_allocated] = AllocUninitializedNode();
+		return;
+	}
+
+	//claim all of the remaining nodes in one block
+#ifdef MULTITHREAD_SUPPORT
+	Concurrency::ReadLock read_lock(managerAttributesMutex);
+
+	size_t first_index_to_allocate = firstUnusedNodeIndex.fetch_add(num_to_allocate);
+#else
+	size_t first_index_to_allocate = firstUnusedNodeIndex;
+	firstUnusedNodeIndex += num_to_allocate;
+#endif
+
+	size_t last_index_to_allocate = first_index_to_allocate + num_to_allocate;
+
+	if(last_index_to_allocate >= nodes.size())
+	{
+	#ifdef MULTITHREAD_SUPPORT
+		read_lock.unlock();
+		Concurrency::WriteLock write_lock(managerAttributesMutex);
+	#endif
+
+		size_t num_nodes_total = nodes.size();
+		if(last_index_to_allocate >= num_nodes_total)
+		{
+			size_t new_num_nodes = static_cast<size_t>(allocExpansionFactor * (last_index_to_allocate + labBlockAllocationSize)) + 1;
+			nodes.resize(new_num_nodes, nullptr);
+		}
+
+		for(size_t i = first_index_to_allocate; i < last_index_to_allocate; i++)
+		{
+			if(nodes[i] == nullptr)
+				nodes[i] = new EvaluableNode(ENT_DEALLOCATED);
+			dest[num_allocated++] = nodes[i];
+		}
+		return;
+	}
+
+	for(size_t i = first_index_to_allocate; i < last_index_to_allocate; i++)
+	{
+		if(nodes[i] == nullptr)
+			nodes[i] = new EvaluableNode(ENT_DEALLOCATED);
+		dest[num_allocated++] = nodes[i];
+	}
+}
+
 void EvaluableNodeManager::FreeAllNodesExceptReferencedNodes(size_t cur_first_unused_node_index)
 {
 	//move all nodes in use to the front and unused ones to the back
@@ -368,6 +545,85 @@ void EvaluableNodeManager::FreeAllNodesExceptReferencedNodes(size_t cur_first_un
 		ShrinkMemoryToCurrentUtilizationWithLock();
 }
 
+bool EvaluableNodeManager::MoveNodesBeneathRootToSharedSegment(EvaluableNodeManager &segment)
+{
+	EvaluableNode *root = rootNode;
+	if(root == nullptr || root->IsTerminal() || root->GetNeedCycleCheck())
+		return false;
+
+#ifdef MULTITHREAD_SUPPORT
+	Concurrency::WriteLock lock(managerAttributesMutex);
+
+	LocalAllocationBuffer::IterateFunctionOverRegisteredLabs(
+		[this](LocalAllocationBuffer *lab)
+	{
+		lab->Clear(this);
+	});
+#else
+	localAllocationBuffer.Clear(this);
+#endif
+
+	//mark the nodes beneath the root, leaving any already shared
+	size_t num_newly_shared = 0;
+	auto &node_stack = EvaluableNode::reusableBuffer;
+	node_stack.clear();
+	node_stack.push_back(root);
+	while(!node_stack.empty())
+	{
+		EvaluableNode *cur = node_stack.back();
+		node_stack.pop_back();
+
+		auto mark_child = [&node_stack, &num_newly_shared](EvaluableNode *child)
+		{
+			if(child == nullptr || child->GetIsShared())
+				return;
+
+			//shared nodes are referenced from many places, so they can never be freeable
+			child->SetIsFreeableAndIsFreeableTopNode(false);
+			child->SetIsShared(true);
+			num_newly_shared++;
+
+			if(!child->IsTerminal())
+				node_stack.push_back(child);
+		};
+
+		if(cur->IsAssociativeArray())
+		{
+			for(auto &child : cur->GetMappedChildNodesReference() | std::views::values)
+				mark_child(child);
+		}
+		else
+		{
+			for(auto &child : cur->GetOrderedChildNodesReference())
+				mark_child(child);
+		}
+	}
+
+	if(num_newly_shared == 0)
+		return false;
+
+	//any shared nodes held by this manager were just marked, so hand them to the segment
+	// and compact the remaining nodes to the front
+	segment.nodes.reserve(segment.nodes.size() + num_newly_shared);
+	size_t next_write_index = 0;
+	for(size_t i = 0; i < firstUnusedNodeIndex; i++)
+	{
+		EvaluableNode *en = nodes[i];
+		if(en->GetIsShared())
+			segment.nodes.push_back(en);
+		else
+			nodes[next_write_index++] = en;
+	}
+
+	//the vacated slots are refilled on allocation
+	for(size_t i = next_write_index; i < firstUnusedNodeIndex; i++)
+		nodes[i] = nullptr;
+
+	firstUnusedNodeIndex = next_write_index;
+	segment.firstUnusedNodeIndex = segment.nodes.size();
+	return true;
+}
+
 void EvaluableNodeManager::ShrinkMemoryToCurrentUtilizationWithLock()
 {
 	size_t new_size = std::min(nodes.size(), firstUnusedNodeIndex * extraMemoryCapacityFactor + 1);
@@ -410,6 +666,31 @@ size_t EvaluableNodeManager::GetEstimatedTotalUsedSizeInBytes()
 	return total_size;
 }
 
+size_t EvaluableNodeManager::GetEstimatedStringSizeInBytes()
+{
+#ifdef MULTITHREAD_SUPPORT
+	Concurrency::ReadLock lock(managerAttributesMutex);
+#endif
+
+	double total_size = 0.0;
+	for(size_t i = 0; i < firstUnusedNodeIndex; i++)
+	{
+		EvaluableNode *n = nodes[i];
+		if(n == nullptr)
+			continue;
+
+		if(DoesEvaluableNodeTypeUseStringData(n->GetType()))
+			total_size += StringInternPool::GetEstimatedSizeInBytesPerReference(n->GetStringIDReference());
+		else if(n->IsAssociativeArray())
+		{
+			for(auto &key_sid : n->GetMappedChildNodesReference() | std::views::keys)
+				total_size += StringInternPool::GetEstimatedSizeInBytesPerReference(key_sid);
+		}
+	}
+
+	return static_cast<size_t>(total_size);
+}
+
 void EvaluableNodeManager::ValidateEvaluableNodeTreeMemoryIntegrity(EvaluableNode *en,
 	EvaluableNodeManager *ensure_nodes_in_enm, bool check_cycle_flag_consistency)
 {
@@ -518,6 +799,52 @@ EvaluableNodeReference EvaluableNodeManager::DeepAllocCopy(EvaluableNode *en, bo
 	return EvaluableNodeReference(copy, true);
 }
 
+EvaluableNodeReference EvaluableNodeManager::DeepAllocCopyExceptShared(EvaluableNode *tree)
+{
+	if(tree == nullptr)
+		return EvaluableNodeReference::Null();
+
+	if(tree->GetIsShared())
+		return EvaluableNodeReference(tree, false);
+
+	auto &node_stack = EvaluableNode::reusableBuffer;
+	node_stack.clear();
+
+	EvaluableNode *root_copy = AllocNode(tree);
+	if(!root_copy->IsTerminal())
+		node_stack.push_back(root_copy);
+
+	while(!node_stack.empty())
+	{
+		EvaluableNode *cur = node_stack.back();
+		node_stack.pop_back();
+
+		auto copy_child = [this, &node_stack](EvaluableNode *&child)
+		{
+			if(child == nullptr || child->GetIsShared())
+				return;
+
+			child = AllocNode(child);
+			if(!child->IsTerminal())
+				node_stack.push_back(child);
+		};
+
+		if(cur->IsAssociativeArray())
+		{
+			for(auto &child : cur->GetMappedChildNodesReference() | std::views::values)
+				copy_child(child);
+		}
+		else
+		{
+			for(auto &child : cur->GetOrderedChildNodesReference())
+				copy_child(child);
+		}
+	}
+
+	//shared nodes are never freed or modified in place, so the copy can still be treated as unique
+	return EvaluableNodeReference(root_copy, true);
+}
+
 std::pair<EvaluableNode *, bool> EvaluableNodeManager::DeepAllocCopyRecurse(EvaluableNode *tree,
 	DeepAllocCopyParams &dacp)
 {
@@ -587,8 +914,12 @@ std::pair<EvaluableNode *, bool> EvaluableNodeManager::DeepAllocCopyRecurse(Eval
 //sets or clears all referenced nodes' in use flags
 //if set_in_use is true, then it will set the value, if false, it will clear the value
 //note that tree cannot be nullptr and it should already be inserted into the references prior to calling
+//shared nodes are owned by their segment and are skipped
 static void MarkAllReferencedNodesInUseForNode(EvaluableNode *tree)
 {
+	if(tree->GetIsShared())
+		return;
+
 	tree->SetKnownToBeInUse(true);
 	auto &node_stack = EvaluableNode::reusableBuffer;
 	node_stack.push_back(tree);
@@ -606,7 +937,7 @@ static void MarkAllReferencedNodesInUseForNode(EvaluableNode *tree)
 		{
 			for(auto &cn : node->GetMappedChildNodesReference() | std::views::values)
 			{
-				if(cn != nullptr && !cn->GetKnownToBeInUse())
+				if(cn != nullptr && !cn->GetKnownToBeInUseOrIsShared())
 				{
 					cn->SetKnownToBeInUse(true);
 					node_stack.push_back(cn);
@@ -617,7 +948,7 @@ static void MarkAllReferencedNodesInUseForNode(EvaluableNode *tree)
 		{
 			for(auto &cn : node->GetOrderedChildNodesReference())
 			{
-				if(cn != nullptr && !cn->GetKnownToBeInUse())
+				if(cn != nullptr && !cn->GetKnownToBeInUseOrIsShared())
 				{
 					cn->SetKnownToBeInUse(true);
 					node_stack.push_back(cn);
@@ -635,6 +966,9 @@ static void MarkAllReferencedNodesInUseConcurrentForNode(EvaluableNode *tree)
 	AmlgAssert(tree->IsNodeValid());
 #endif
 
+	if(tree->GetIsShared())
+		return;
+
 	tree->SetKnownToBeInUseAtomic(true);
 	auto &node_stack = EvaluableNode::reusableBuffer;
 	node_stack.push_back(tree);
@@ -652,7 +986,7 @@ static void MarkAllReferencedNodesInUseConcurrentForNode(EvaluableNode *tree)
 		{
 			for(auto &cn : node->GetMappedChildNodesReference() | std::views::values)
 			{
-				if(cn != nullptr && cn->TrySetKnownToBeInUseAtomic())
+				if(cn != nullptr && !cn->GetIsShared() && cn->TrySetKnownToBeInUseAtomic())
 					node_stack.push_back(cn);
 			}
 		}
@@ -660,7 +994,7 @@ static void MarkAllReferencedNodesInUseConcurrentForNode(EvaluableNode *tree)
 		{
 			for(auto &cn : node->GetOrderedChildNodesReference())
 			{
-				if(cn != nullptr && cn->TrySetKnownToBeInUseAtomic())
+				if(cn != nullptr && !cn->GetIsShared() && cn->TrySetKnownToBeInUseAtomic())
 					node_stack.push_back(cn);
 			}
 		}
@@ -787,6 +1121,10 @@ std::pair<bool, bool> EvaluableNodeManager::UpdateFlagsForNodeTreeRecurse(Evalua
 	auto [existing_record, inserted] = checked_to_parent.emplace(tree, parent);
 	if(inserted)
 	{
+		//shared nodes are immutable and their flags are already up to date
+		if(tree->GetIsShared())
+			return {tree->GetNeedCycleCheck(), tree->GetIsIdempotent()};
+
 		tree->SetNeedCycleCheck(false);
 	}
 	else //this node has already been checked
@@ -890,7 +1228,8 @@ std::pair<bool, bool> EvaluableNodeManager::ValidateEvaluableNodeTreeMemoryInteg
 	if(!en->IsNodeValid() || en->GetKnownToBeInUse()) [[unlikely]]
 		AmlgAssert(false);
 
-	if(existing_nodes != nullptr)
+	//shared nodes are owned by their segment rather than the manager being validated
+	if(existing_nodes != nullptr && !en->GetIsShared())
 	{
 		if(existing_nodes->find(en) == end(*existing_nodes)) [[unlikely]]
 			AmlgAssert(false);
@@ -5,6 +5,7 @@
 #include "EvaluableNodeReference.h"
 
 //system headers:
+#include <chrono>
 #include <memory>
 #include <ranges>
 
@@ -281,14 +282,38 @@ public:
 		return n;
 	}
 
+	//allocates num_nodes nodes into dest with a single request to the manager,
+	// then calls init_function(node, index) for each node to initialize it
+	//this is considerably cheaper than calling AllocNode repeatedly when building large results
+	template<typename InitFunction>
+	inline void AllocNodes(EvaluableNode **dest, size_t num_nodes, InitFunction init_function)
+	{
+		AllocUninitializedNodes(dest, num_nodes);
+		for(size_t i = 0; i < num_nodes; i++)
+			init_function(dest[i], i);
+	}
+
+	//allocates a list node with num_child_nodes child nodes, each initialized by init_function(node, index),
+	// allocating all of the child nodes with a single request to the manager
+	template<typename InitFunction>
+	inline EvaluableNode *AllocListNodeWithChildNodes(size_t num_child_nodes, InitFunction init_function)
+	{
+		EvaluableNode *list = AllocNode(ENT_LIST);
+		auto &ocn = list->GetOrderedChildNodesReference();
+		ocn.resize(num_child_nodes);
+		AllocNodes(ocn.data(), num_child_nodes, init_function);
+		return list;
+	}
+
 	//ensures that the top node is modifiable -- will allocate the node if necessary,
 	// and if the result and any child nodes are all unique, then it will return an EvaluableNodeReference that is unique
 	//if ensure_copy_if_top_node_in_cycle, then it will also allocate a new node if the top node is in a cycle
 	//in case the top node is referenced by any of its node tree and it needs to ensure that structure is maintained
+	//shared nodes are always copied, which is how shared segments are copied on first write
 	inline void EnsureNodeIsModifiable(EvaluableNodeReference &original, bool ensure_copy_if_top_node_in_cycle = false,
 		bool copy_metadata = true)
 	{
-		if(original != nullptr
+		if(original != nullptr && !original->GetIsShared()
 				&& (original.uniqueUnreferencedTopNode || (original.unique && !ensure_copy_if_top_node_in_cycle)))
 		{
 			//clear the freeable bit in case it is on the stack
@@ -317,6 +342,11 @@ public:
 	//Copies the data structure and everything underneath it, modifying labels as specified
 	EvaluableNodeReference DeepAllocCopy(EvaluableNode *tree, bool copy_metadata = true);
 
+	//like DeepAllocCopy, but references shared nodes rather than copying them, so the copy is only valid
+	// for a manager that holds references to the same shared segments as the manager of tree
+	//tree must not need a cycle check
+	EvaluableNodeReference DeepAllocCopyExceptShared(EvaluableNode *tree);
+
 	//used to hold all of the references for DeepAllocCopy calls
 	struct DeepAllocCopyParams
 	{
@@ -408,11 +438,29 @@ public:
 	//collects garbage
 	void CollectGarbage();
 
+	//collects garbage and shrinks memory if no interpreters are running and, if multithreaded, no other thread
+	// holds the memory modification mutex; returns true if garbage was collected
+	bool CollectGarbageIfIdle();
+
 #ifdef MULTITHREAD_SUPPORT
 	//if multithreaded, then memory_modification_lock is the lock used for memoryModificationMutex if not nullptr
 	void CollectGarbageWithConcurrentAccess(Concurrency::ReadLock &memory_modification_lock);
 #endif
 
+#ifdef MULTITHREAD_SUPPORT
+	//starts a background thread that collects garbage and shrinks memory when this manager is idle,
+	// replacing any background collector that is already running
+	//the manager is considered idle when no interpreters are running and the number of nodes in use
+	// has not changed over idle_interval, and garbage is collected at most once per idle period
+	//while the collector is running, any code that accesses this manager's nodes outside of an interpreter
+	// must hold a read lock on the memory modification mutex, otherwise its unreferenced nodes may be freed
+	void StartBackgroundGarbageCollection(std::chrono::milliseconds idle_interval);
+
+	//stops and joins the background garbage collection thread if it is running
+	//may be called concurrently with itself and StartBackgroundGarbageCollection
+	void StopBackgroundGarbageCollection();
+#endif
+
 	//frees any extra EvaluableNodes and shrinks memory to be appropriate for current use
 	inline void ShrinkMemoryToCurrentUtilization()
 	{
@@ -427,7 +475,7 @@ public:
 	// if place_nodes_in_lab is true, then it will update the local allocation buffer and place nodes in it
 	inline void FreeNode(EvaluableNode *en, bool place_nodes_in_lab = true)
 	{
-		if(en == nullptr)
+		if(en == nullptr || en->GetIsShared())
 			return;
 
 	#ifdef AMALGAM_FAST_MEMORY_INTEGRITY
@@ -464,9 +512,10 @@ public:
 
 	//frees the entire tree in the respective ways for the corresponding permanence types allowed
 	// if place_nodes_in_lab is true, then it will update the local allocation buffer and place nodes in it
+	//nodes in shared segments are left intact
 	inline void FreeNodeTree(EvaluableNode *en, bool place_nodes_in_lab = true)
 	{
-		if(en == nullptr)
+		if(en == nullptr || en->GetIsShared())
 			return;
 
 	#ifdef AMALGAM_FAST_MEMORY_INTEGRITY
@@ -501,7 +550,7 @@ public:
 				{
 					for(auto &child : cur->GetMappedChildNodesReference() | std::views::values)
 					{
-						if(child != nullptr)
+						if(child != nullptr && !child->GetIsShared())
 							node_stack.push_back(child);
 					}
 				}
@@ -509,7 +558,7 @@ public:
 				{
 					for(auto &child : cur->GetOrderedChildNodesReference())
 					{
-						if(child != nullptr)
+						if(child != nullptr && !child->GetIsShared())
 							node_stack.push_back(child);
 					}
 				}
@@ -543,7 +592,7 @@ public:
 				{
 					for(auto &e : cur->GetMappedChildNodesReference() | std::views::values)
 					{
-						if(e != nullptr && !e->IsNodeDeallocated())
+						if(e != nullptr && !e->IsNodeDeallocated() && !e->GetIsShared())
 							node_stack.push_back(e);
 					}
 				}
@@ -551,7 +600,7 @@ public:
 				{
 					for(auto &e : cur->GetOrderedChildNodesReference())
 					{
-						if(e != nullptr && !e->IsNodeDeallocated())
+						if(e != nullptr && !e->IsNodeDeallocated() && !e->GetIsShared())
 							node_stack.push_back(e);
 					}
 				}
@@ -586,7 +635,7 @@ public:
 		{
 			for(auto &e : tree->GetMappedChildNodesReference() | std::views::values)
 			{
-				if(e != nullptr)
+				if(e != nullptr && !e->GetIsShared())
 					node_stack.push_back(e);
 			}
 		}
@@ -594,7 +643,7 @@ public:
 		{
 			for(auto &e : tree->GetOrderedChildNodesReference())
 			{
-				if(e != nullptr)
+				if(e != nullptr && !e->GetIsShared())
 					node_stack.push_back(e);
 			}
 		}
@@ -614,7 +663,7 @@ public:
 			{
 				for(auto &child : cur->GetMappedChildNodesReference() | std::views::values)
 				{
-					if(child != nullptr)
+					if(child != nullptr && !child->GetIsShared())
 						node_stack.push_back(child);
 				}
 			}
@@ -622,7 +671,7 @@ public:
 			{
 				for(auto &child : cur->GetOrderedChildNodesReference())
 				{
-					if(child != nullptr)
+					if(child != nullptr && !child->GetIsShared())
 						node_stack.push_back(child);
 				}
 			}
@@ -644,6 +693,35 @@ public:
 	#endif
 	}
 
+	//marks every node beneath rootNode that is not already shared as shared and moves ownership of those nodes
+	// into segment without copying them, so that segment becomes an immutable set of nodes that may be referenced
+	// by other EvaluableNodeManagers; rootNode itself remains owned by this manager
+	//shared nodes are never modified in place, freed, or marked by garbage collection, and any
+	// EvaluableNodeManager with nodes referencing the segment must hold a reference to it via AddSharedSegmentReference
+	//does nothing if rootNode needs a cycle check, and assumes nothing else holds references to nodes beneath rootNode
+	//returns true if any nodes were moved into segment
+	bool MoveNodesBeneathRootToSharedSegment(EvaluableNodeManager &segment);
+
+	//retains a reference to segment so that its nodes remain valid for the lifetime of this manager
+	inline void AddSharedSegmentReference(const std::shared_ptr<EvaluableNodeManager> &segment)
+	{
+		if(std::find(begin(sharedSegments), end(sharedSegments), segment) == end(sharedSegments))
+			sharedSegments.push_back(segment);
+	}
+
+	//retains references to all of the shared segments that enm references
+	inline void AddSharedSegmentReferences(EvaluableNodeManager &enm)
+	{
+		for(auto &segment : enm.sharedSegments)
+			AddSharedSegmentReference(segment);
+	}
+
+	//returns true if this manager references any shared segments
+	inline bool HasSharedSegments()
+	{
+		return !sharedSegments.empty();
+	}
+
 #ifdef MULTITHREAD_SUPPORT
 	//returns the memory modification mutex for garbage collection, etc.
 	inline Concurrency::ReadWriteMutex &GetMemoryModificationMutex()
@@ -748,6 +826,10 @@ public:
 	size_t GetEstimatedTotalReservedSizeInBytes();
 	size_t GetEstimatedTotalUsedSizeInBytes();
 
+	//returns an estimate of the share of interned string memory referenced by the nodes in use,
+	// where each string's memory is divided evenly among all of its references
+	size_t GetEstimatedStringSizeInBytes();
+
 	//makes sure that the evaluable node and everything referenced by it has not been deallocated
 	// if ensure_nodes_in_enm is passed in, it will ensure all nodes are contained within this EvaluableNodeManager
 	// if check_cycle_flag_consistency is set, it will ensure that all cycle flags are consistent
@@ -832,6 +914,10 @@ protected:
 	// returns an uninitialized EvaluableNode -- care must be taken to set fields properly
 	EvaluableNode *AllocUninitializedNode();
 
+	//like AllocUninitializedNode, but allocates num_nodes nodes into dest, first from the local allocation buffer
+	// and then in one contiguous block from the manager
+	void AllocUninitializedNodes(EvaluableNode **dest, size_t num_nodes);
+
 	//frees everything except those nodes referenced by rootNode and activeInterpreters
 	//cur_first_unused_node_index represents the first unused index and will set firstUnusedNodeIndex
 	//to the reduced value
@@ -842,6 +928,29 @@ protected:
 	//helper function to ShrinkMemoryToCurrentUtilization() but assumes has the lock
 	void ShrinkMemoryToCurrentUtilizationWithLock();
 
+#ifdef MULTITHREAD_SUPPORT
+	//state for a thread that collects garbage while the manager is idle
+	struct BackgroundGarbageCollector
+	{
+		std::thread thread;
+
+		//guards stopRequested and is used to wake the thread when stopping
+		Concurrency::SingleMutex mutex;
+		std::condition_variable_any stopConditionVar;
+		bool stopRequested = false;
+
+		//amount of time the manager must be idle before collecting
+		std::chrono::milliseconds idleInterval;
+	};
+
+	//helper function to StopBackgroundGarbageCollection() but assumes has the lock on backgroundGarbageCollectorMutex
+	void StopBackgroundGarbageCollectionWithLock();
+
+	//loop run by the background garbage collection thread until a stop is requested on bgc
+	void RunBackgroundGarbageCollection(BackgroundGarbageCollector &bgc);
+
+#endif
+
 	//implemented as a recursive method because the extra complexity of an iterative implementation
 	// is not worth the very small performance benefit
 	//returns a pair of the copy and true if the copy needs cycle check
@@ -904,6 +1013,18 @@ protected:
 	//only allocated if needed
 	std::unique_ptr<ActiveInterpreters> activeInterpreters;
 
+#ifdef MULTITHREAD_SUPPORT
+	//only allocated if background garbage collection has been started
+	std::unique_ptr<BackgroundGarbageCollector> backgroundGarbageCollector;
+
+	//serializes starting and stopping the background garbage collector
+	Concurrency::SingleMutex backgroundGarbageCollectorMutex;
+#endif
+
+	//immutable segments of shared nodes that may be referenced by nodes in this manager
+	//released when this manager is destroyed
+	std::vector<std::shared_ptr<EvaluableNodeManager>> sharedSegments;
+
 	//minimum number of nodes before which garbage collection can be triggered
 	static const size_t minNodesToCollectGarbage;
 
@@ -2,8 +2,10 @@
 #include "EvaluableNodeTreeFunctions.h"
 #include "FastMath.h"
 #include "Interpreter.h"
+#include "StringManipulation.h"
 
 //system headers:
+#include <string_view>
 #include <tuple>
 
 bool CustomEvaluableNodeComparator::operator()(EvaluableNode *a, EvaluableNode *b)
@@ -25,7 +27,7 @@ bool CustomEvaluableNodeComparator::operator()(EvaluableNode *a, EvaluableNode *
 
 //performs a top-down stable merge on the sub-lists from start_index to middle_index and middle_index to _end_index
 //  from source into destination using cenc
-static void CustomEvaluableNodeOrderedChildNodesTopDownMerge(EvaluableNode::OrderedType &source,
+void CustomEvaluableNodeOrderedChildNodesMerge(EvaluableNode::OrderedType &source,
 	size_t start_index, size_t middle_index, size_t end_index, EvaluableNode::OrderedType &destination, CustomEvaluableNodeComparator &cenc)
 {
 	size_t left_pos = start_index;
@@ -65,7 +67,7 @@ static void CustomEvaluableNodeOrderedChildNodesSort(EvaluableNode::OrderedType
 	CustomEvaluableNodeOrderedChildNodesSort(destination, middle_index, end_index, source, cenc);
 
 	//merge buffers back into buffer
-	CustomEvaluableNodeOrderedChildNodesTopDownMerge(source, start_index, middle_index, end_index, destination, cenc);
+	CustomEvaluableNodeOrderedChildNodesMerge(source, start_index, middle_index, end_index, destination, cenc);
 }
 
 EvaluableNode::OrderedType CustomEvaluableNodeOrderedChildNodesSort(EvaluableNode::OrderedType &list, CustomEvaluableNodeComparator &cenc)
@@ -78,6 +80,102 @@ EvaluableNode::OrderedType CustomEvaluableNodeOrderedChildNodesSort(EvaluableNod
 	return list_copy_2;
 }
 
+void CustomEvaluableNodeOrderedChildNodesSort(EvaluableNode::OrderedType &list,
+	size_t start_index, size_t end_index, CustomEvaluableNodeComparator &cenc)
+{
+	EvaluableNode::OrderedType list_copy_1(begin(list) + start_index, begin(list) + end_index);
+	EvaluableNode::OrderedType list_copy_2(list_copy_1);
+	CustomEvaluableNodeOrderedChildNodesSort(list_copy_1, 0, list_copy_1.size(), list_copy_2, cenc);
+	std::copy(begin(list_copy_2), end(list_copy_2), begin(list) + start_index);
+}
+
+//sorts list by the values extracted into keys with compare, which compares the keys
+template<typename KeyType, typename CompareFunction>
+static void EvaluableNodeOrderedChildNodesSortByKey(EvaluableNode::OrderedType &list,
+	std::vector<std::pair<KeyType, EvaluableNode *>> &keys, CompareFunction compare)
+{
+	StableSortConcurrentlyIfPossible(keys,
+		[&compare](const std::pair<KeyType, EvaluableNode *> &a, const std::pair<KeyType, EvaluableNode *> &b)
+		{
+			return compare(a.first, b.first);
+		});
+
+	for(size_t i = 0; i < keys.size(); i++)
+		list[i] = keys[i].second;
+}
+
+bool EvaluableNodeOrderedChildNodesSortByValue(EvaluableNode::OrderedType &list, bool ascending)
+{
+	if(list.size() == 0)
+		return true;
+
+	if(EvaluableNode::CanRepresentValueAsANumber(list[0]))
+	{
+		std::vector<std::pair<double, EvaluableNode *>> keys;
+		keys.reserve(list.size());
+		for(EvaluableNode *en : list)
+		{
+			if(!EvaluableNode::CanRepresentValueAsANumber(en))
+				return false;
+			keys.emplace_back(EvaluableNode::ToNumber(en), en);
+		}
+
+		//same as EvaluableNode::Compare, where nan is less than all other numbers
+		if(ascending)
+			EvaluableNodeOrderedChildNodesSortByKey(list, keys,
+				[](double a, double b)
+				{
+					if(FastIsNaN(a))
+						return !FastIsNaN(b);
+					return a < b;
+				});
+		else
+			EvaluableNodeOrderedChildNodesSortByKey(list, keys,
+				[](double a, double b)
+				{
+					if(FastIsNaN(b))
+						return !FastIsNaN(a);
+					return b < a;
+				});
+
+		return true;
+	}
+
+	if(list[0] != nullptr && list[0]->GetType() == ENT_STRING)
+	{
+		std::vector<std::pair<std::string_view, EvaluableNode *>> keys;
+		keys.reserve(list.size());
+		for(EvaluableNode *en : list)
+		{
+			if(en == nullptr || en->GetType() != ENT_STRING)
+				return false;
+
+			//strings that are empty or start with a null are compared via their escaped key strings
+			auto str = en->GetStringView();
+			if(str.size() == 0 || str[0] == '\0')
+				return false;
+			keys.emplace_back(str, en);
+		}
+
+		if(ascending)
+			EvaluableNodeOrderedChildNodesSortByKey(list, keys,
+				[](std::string_view a, std::string_view b)
+				{
+					return StringManipulation::StringNaturalCompare(a, b) < 0;
+				});
+		else
+			EvaluableNodeOrderedChildNodesSortByKey(list, keys,
+				[](std::string_view a, std::string_view b)
+				{
+					return StringManipulation::StringNaturalCompare(a, b) > 0;
+				});
+
+		return true;
+	}
+
+	return false;
+}
+
 std::tuple<Entity *, Entity *, Entity::EntityReferenceBufferReference<EntityReadReference>>
 TraverseToDeeplyContainedEntityReadReferencesViaEvaluableNodeIDPath(Entity *from_entity,
 EvaluableNode *id_path_1, EvaluableNode *id_path_2)
@@ -40,6 +40,21 @@ private:
 //returns a newly sorted list
 EvaluableNode::OrderedType CustomEvaluableNodeOrderedChildNodesSort(EvaluableNode::OrderedType &list, CustomEvaluableNodeComparator &cenc);
 
+//like CustomEvaluableNodeOrderedChildNodesSort, but sorts the elements of list from start_index up to end_index in place
+void CustomEvaluableNodeOrderedChildNodesSort(EvaluableNode::OrderedType &list,
+	size_t start_index, size_t end_index, CustomEvaluableNodeComparator &cenc);
+
+//performs a stable merge of the sorted sub-lists of source from start_index to middle_index and middle_index to end_index
+// into the same positions of destination using cenc
+void CustomEvaluableNodeOrderedChildNodesMerge(EvaluableNode::OrderedType &source,
+	size_t start_index, size_t middle_index, size_t end_index, EvaluableNode::OrderedType &destination, CustomEvaluableNodeComparator &cenc);
+
+//sorts list in ascending or descending order with the same ordering as EvaluableNode::Compare, keeping equal elements
+// in their original order
+//if the elements are all numbers or all strings, extracts their values once and sorts concurrently if possible
+//returns false and leaves list unchanged if the elements are not all numbers or all strings
+bool EvaluableNodeOrderedChildNodesSortByValue(EvaluableNode::OrderedType &list, bool ascending);
+
 class EvaluableNodeIDPathTraverser
 {
 public:
@@ -406,60 +421,141 @@ inline EvaluableNodeReference CreateAssocOfNumbersFromIteratorAndFunctions(IDVal
 	StringFunction get_string, ValueFunction get_number, EvaluableNodeManager *enm)
 {
 	EvaluableNode *assoc = enm->AllocNode(ENT_ASSOC);
-	assoc->ReserveMappedChildNodes(id_value_container.size());
+	size_t num_entries = id_value_container.size();
+	assoc->ReserveMappedChildNodes(num_entries);
+
+	//allocate all of the number nodes at once, reusing the buffer across calls on the same thread
+#if defined(MULTITHREAD_SUPPORT)
+	thread_local
+#endif
+		static std::vector<EvaluableNode *> value_nodes;
+	value_nodes.resize(num_entries);
+
+	auto id_value_iterator = std::begin(id_value_container);
+	enm->AllocNodes(value_nodes.data(), num_entries,
+		[&id_value_iterator, &get_number](EvaluableNode *n, size_t /*index*/)
+		{
+			n->InitializeType(static_cast<double>(get_number(*id_value_iterator)));
+			++id_value_iterator;
+		});
+
+	size_t index = 0;
+	for(auto &id_value_element : id_value_container)
+		assoc->SetMappedChildNode(get_string(id_value_element), value_nodes[index++]);
+
+	return EvaluableNodeReference(assoc, true);
+}
 
-	for(auto &id_value_iterator : id_value_container)
+//if immediate_result requests that a list of numbers be reduced to a single number, such as via
+// SUM_AS_NUMBER or MIN_AS_NUMBER, then computes that value from value_container via get_number and
+// returns true along with the reduced value without building the list, otherwise returns false
+template<typename ValueContainer, typename GetNumberFunction>
+inline std::pair<bool, EvaluableNodeReference> ReduceNumbersToImmediateValueIfRequested(ValueContainer &value_container,
+	EvaluableNodeRequestedValueTypes immediate_result, GetNumberFunction get_number)
+{
+	//only a single reduction may be requested, matching the specialized interpretations of apply
+	switch(immediate_result.requestedValueTypes)
+	{
+	case EvaluableNodeRequestedValueTypes::Type::SIZE_AS_NUMBER:
+		return std::make_pair(true, EvaluableNodeReference(static_cast<double>(value_container.size())));
+
+	case EvaluableNodeRequestedValueTypes::Type::SUM_AS_NUMBER:
 	{
-		auto entity_sid = get_string(id_value_iterator);
-		assoc->SetMappedChildNode(entity_sid, enm->AllocNode(get_number(id_value_iterator)));
+		double sum = 0.0;
+		for(auto &value_element : value_container)
+			sum += get_number(value_element);
+		return std::make_pair(true, EvaluableNodeReference(sum));
 	}
 
-	return EvaluableNodeReference(assoc, true);
+	case EvaluableNodeRequestedValueTypes::Type::PRODUCT_AS_NUMBER:
+	{
+		double product = 1.0;
+		for(auto &value_element : value_container)
+			product *= get_number(value_element);
+		return std::make_pair(true, EvaluableNodeReference(product));
+	}
+
+	case EvaluableNodeRequestedValueTypes::Type::MIN_AS_NUMBER:
+	case EvaluableNodeRequestedValueTypes::Type::MAX_AS_NUMBER:
+	{
+		bool is_min = (immediate_result.requestedValueTypes == EvaluableNodeRequestedValueTypes::Type::MIN_AS_NUMBER);
+		bool value_found = false;
+		double extreme = is_min ? std::numeric_limits<double>::infinity() : -std::numeric_limits<double>::infinity();
+		for(auto &value_element : value_container)
+		{
+			double value = get_number(value_element);
+			if(FastIsNaN(value))
+				continue;
+
+			value_found = true;
+			extreme = is_min ? std::min(value, extreme) : std::max(value, extreme);
+		}
+
+		if(!value_found)
+			return std::make_pair(true, EvaluableNodeReference::Null());
+		return std::make_pair(true, EvaluableNodeReference(extreme));
+	}
+
+	default:
+		return std::make_pair(false, EvaluableNodeReference::Null());
+	}
 }
 
-//using enm, builds a list from value_container using get_string_id and get_number to get the id and number of each entry
+//using enm, builds a list from value_container using get_number to get the number of each entry
+//if immediate_result requests a reduction of the numbers, returns the immediate value without building the list
 template<typename ValueContainer, typename GetNumberFunction>
 inline EvaluableNodeReference CreateListOfNumbersFromIteratorAndFunction(ValueContainer &value_container,
-	EvaluableNodeManager *enm, GetNumberFunction get_number)
+	EvaluableNodeManager *enm, GetNumberFunction get_number,
+	EvaluableNodeRequestedValueTypes immediate_result = EvaluableNodeRequestedValueTypes())
 {
-	EvaluableNode *list = enm->AllocNode(ENT_LIST);
-	auto &ocn = list->GetOrderedChildNodesReference();
-	ocn.reserve(value_container.size());
+	if(immediate_result.AnyComplexImmediateType())
+	{
+		auto [reduced, reduced_value] = ReduceNumbersToImmediateValueIfRequested(value_container, immediate_result, get_number);
+		if(reduced)
+			return reduced_value;
+	}
 
-	for(auto value_element : value_container)
-		ocn.push_back(enm->AllocNode(get_number(value_element)));
+	auto value_iterator = std::begin(value_container);
+	EvaluableNode *list = enm->AllocListNodeWithChildNodes(value_container.size(),
+		[&value_iterator, &get_number](EvaluableNode *n, size_t /*index*/)
+		{
+			n->InitializeType(static_cast<double>(get_number(*value_iterator)));
+			++value_iterator;
+		});
 
 	return EvaluableNodeReference(list, true);
 }
 
-//using enm, builds a list from string_container to id_value_iterator_end using get_string_id and get_number to get the id and number of each entry
+//using enm, builds a list from string_container using get_string_id to get the string id of each entry
 //note that get_string_id will be called twice and will be called under locks in multithreading, so it should be a very simple function
 template<typename StringContainer, typename GetStringFunction>
 inline EvaluableNodeReference CreateListOfStringsIdsFromIteratorAndFunction(StringContainer &string_container,
 	EvaluableNodeManager *enm, GetStringFunction get_string_id)
 {
-	EvaluableNode *list = enm->AllocNode(ENT_LIST);
-	auto &ocn = list->GetOrderedChildNodesReference();
-	ocn.reserve(string_container.size());
-
-	for(auto string_element : string_container)
-		ocn.push_back(enm->AllocNode(ENT_STRING, get_string_id(string_element)));
+	auto string_iterator = std::begin(string_container);
+	EvaluableNode *list = enm->AllocListNodeWithChildNodes(string_container.size(),
+		[&string_iterator, &get_string_id](EvaluableNode *n, size_t /*index*/)
+		{
+			n->InitializeType(ENT_STRING, get_string_id(*string_iterator));
+			++string_iterator;
+		});
 
 	return EvaluableNodeReference(list, true);
 }
 
-//using enm, builds a list from string_container to id_value_iterator_end using get_string_id and get_number to get the id and number of each entry
-//note that get_string_id will be called twice and will be called under locks in multithreading, so it should be a very simple function
+//using enm, builds a list from string_container using get_string to get the string of each entry
+//note that get_string will be called twice and will be called under locks in multithreading, so it should be a very simple function
 template<typename StringContainer, typename GetStringFunction>
 inline EvaluableNodeReference CreateListOfStringsFromIteratorAndFunction(StringContainer &string_container,
 	EvaluableNodeManager *enm, GetStringFunction get_string)
 {
-	EvaluableNode *list = enm->AllocNode(ENT_LIST);
-	auto &ocn = list->GetOrderedChildNodesReference();
-	ocn.reserve(string_container.size());
-
-	for(auto string_element : string_container)
-		ocn.push_back(enm->AllocNode(ENT_STRING, get_string(string_element)));
+	auto string_iterator = std::begin(string_container);
+	EvaluableNode *list = enm->AllocListNodeWithChildNodes(string_container.size(),
+		[&string_iterator, &get_string](EvaluableNode *n, size_t /*index*/)
+		{
+			n->InitializeType(ENT_STRING, get_string(*string_iterator));
+			++string_iterator;
+		});
 
 	return EvaluableNodeReference(list, true);
 }
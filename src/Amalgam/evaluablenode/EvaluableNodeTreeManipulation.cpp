@@ -303,6 +303,74 @@ static std::string MergeMultilineStrings(EvaluableNodeTreeManipulation::NodesMer
 	return merged_string;
 }
 
+//combines the hash value into seed
+static inline size_t CombineSubtreeHash(size_t seed, size_t value)
+{
+	return seed ^ (value + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2));
+}
+
+std::pair<size_t, size_t> EvaluableNodeTreeManipulation::GetSubtreeHashAndSize(EvaluableNode *tree, MergeMetricResultsParams &mmrp)
+{
+	//nullptr compares equal to a null node
+	if(tree == nullptr)
+		return std::make_pair(std::hash<size_t>{}(ENT_NULL), 1);
+
+	//a size of zero marks the tree as in progress, so if it is found again before it is finished, there is a cycle
+	auto [found, inserted] = mmrp.subtreeHashesAndSizes.emplace(tree, std::make_pair(0, 0));
+	if(!inserted)
+		return found->second;
+
+	auto type = tree->GetType();
+	size_t hash = std::hash<size_t>{}(type);
+	size_t size = 1;
+	bool has_cycle = false;
+
+	if(DoesEvaluableNodeTypeUseStringData(type))
+		hash = CombineSubtreeHash(hash, std::hash<StringInternPool::StringID>{}(tree->GetStringIDReference()));
+	else if(DoesEvaluableNodeTypeUseNumberData(type))
+		hash = CombineSubtreeHash(hash, std::hash<double>{}(tree->GetNumberValueReference()));
+	else if(DoesEvaluableNodeTypeUseBoolData(type))
+		hash = CombineSubtreeHash(hash, tree->GetBoolValueReference() ? 1 : 0);
+	else if(tree->IsAssociativeArray())
+	{
+		//combine the entries commutatively since the order of iteration is not significant
+		size_t mapped_hash = 0;
+		for(auto &[cn_id, cn] : tree->GetMappedChildNodesReference())
+		{
+			auto [cn_hash, cn_size] = GetSubtreeHashAndSize(cn, mmrp);
+			if(cn_size == 0)
+			{
+				has_cycle = true;
+				break;
+			}
+
+			mapped_hash += CombineSubtreeHash(std::hash<StringInternPool::StringID>{}(cn_id), cn_hash);
+			size += cn_size;
+		}
+		hash = CombineSubtreeHash(hash, mapped_hash);
+	}
+	else if(tree->IsOrderedArray())
+	{
+		for(auto cn : tree->GetOrderedChildNodesReference())
+		{
+			auto [cn_hash, cn_size] = GetSubtreeHashAndSize(cn, mmrp);
+			if(cn_size == 0)
+			{
+				has_cycle = true;
+				break;
+			}
+
+			hash = CombineSubtreeHash(hash, cn_hash);
+			size += cn_size;
+		}
+	}
+
+	//look up again, since recursing may have invalidated references into the map
+	auto hash_and_size = (has_cycle ? std::make_pair<size_t, size_t>(0, 0) : std::make_pair(hash, size));
+	mmrp.subtreeHashesAndSizes.insert_or_assign(tree, hash_and_size);
+	return hash_and_size;
+}
+
 EvaluableNode *EvaluableNodeTreeManipulation::CreateGeneralizedNode(NodesMergeMethod *mm, EvaluableNode *n1, EvaluableNode *n2)
 {
 	if(n1 == nullptr && n2 == nullptr)
@@ -677,6 +745,15 @@ MergeMetricResults<EvaluableNode *> EvaluableNodeTreeManipulation::NumberOfShare
 		return results;
 	}
 
+	//if the trees are identical, then they match completely without needing to align their child nodes
+	if(mmrp.matchIdenticalSubtrees && AreIdenticalSubtrees(tree1, tree2, mmrp))
+	{
+		MergeMetricResults results(static_cast<double>(GetSubtreeHashAndSize(tree1, mmrp).second),
+			tree1, tree2, mmrp.typesMustMatch, true);
+		memoized_entry->second = results;
+		return results;
+	}
+
 	//check current top nodes
 	auto commonality = CommonalityBetweenNodes(tree1, tree2, mmrp.typesMustMatch, mmrp.nominalNumbers, mmrp.nominalStrings);
 
@@ -757,6 +834,19 @@ MergeMetricResults<EvaluableNode *> EvaluableNodeTreeManipulation::NumberOfShare
 			{
 				auto &a1_current = ocn1[i];
 
+				//an identical node is the best possible match, so take it without comparing against the rest
+				if(mmrp.matchIdenticalSubtrees)
+				{
+					auto identical = std::find_if(begin(a2), end(a2),
+						[a1_current, &mmrp](EvaluableNode *n) { return AreIdenticalSubtrees(a1_current, n, mmrp); });
+					if(identical != end(a2))
+					{
+						commonality += NumberOfSharedNodes(a1_current, *identical, mmrp);
+						a2.erase(identical);
+						continue;
+					}
+				}
+
 				//find the node that best matches this one, greedily
 				bool best_match_found = false;
 				size_t best_match_index = 0;
@@ -809,15 +899,56 @@ MergeMetricResults<EvaluableNode *> EvaluableNodeTreeManipulation::NumberOfShare
 				starting_index = 1;
 			}
 
-			FlatMatrix<MergeMetricResults<EvaluableNode *>> sequence_commonality;
-			ComputeSequenceCommonalityMatrix(sequence_commonality, ocn1, ocn2,
-				[&mmrp]
+			auto node_commonality_function = [&mmrp]
 				(EvaluableNode *a, EvaluableNode *b)
 				{
 					return EvaluableNodeTreeManipulation::NumberOfSharedNodes(a, b, mmrp);
-				}, starting_index);
+				};
+
+			//identical leading and trailing child nodes are always part of the best alignment,
+			// so count them directly and only align the child nodes between them
+			size_t num_leading_identical = 0;
+			size_t num_trailing_identical = 0;
+			if(mmrp.matchIdenticalSubtrees)
+			{
+				size_t max_identical = std::min(size1, size2) - starting_index;
+				while(num_leading_identical < max_identical
+						&& AreIdenticalSubtrees(ocn1[starting_index + num_leading_identical],
+							ocn2[starting_index + num_leading_identical], mmrp))
+					num_leading_identical++;
+
+				max_identical -= num_leading_identical;
+				while(num_trailing_identical < max_identical
+						&& AreIdenticalSubtrees(ocn1[size1 - 1 - num_trailing_identical],
+							ocn2[size2 - 1 - num_trailing_identical], mmrp))
+					num_trailing_identical++;
+
+				for(size_t i = starting_index; i < starting_index + num_leading_identical; i++)
+					commonality += MergeMetricResults(static_cast<double>(GetSubtreeHashAndSize(ocn1[i], mmrp).second),
+						ocn1[i], ocn2[i], mmrp.typesMustMatch, true);
+
+				for(size_t i = 0; i < num_trailing_identical; i++)
+					commonality += MergeMetricResults(static_cast<double>(GetSubtreeHashAndSize(ocn1[size1 - 1 - i], mmrp).second),
+						ocn1[size1 - 1 - i], ocn2[size2 - 1 - i], mmrp.typesMustMatch, true);
+			}
 
-			commonality += sequence_commonality.At(size1, size2);
+			FlatMatrix<MergeMetricResults<EvaluableNode *>> sequence_commonality;
+			if(num_leading_identical == 0 && num_trailing_identical == 0)
+			{
+				ComputeSequenceCommonalityMatrix(sequence_commonality, ocn1, ocn2,
+					node_commonality_function, starting_index);
+				commonality += sequence_commonality.At(size1, size2);
+			}
+			else
+			{
+				EvaluableNode::OrderedType a1(begin(ocn1) + starting_index + num_leading_identical, end(ocn1) - num_trailing_identical);
+				EvaluableNode::OrderedType a2(begin(ocn2) + starting_index + num_leading_identical, end(ocn2) - num_trailing_identical);
+				if(a1.size() > 0 && a2.size() > 0)
+				{
+					ComputeSequenceCommonalityMatrix(sequence_commonality, a1, a2, node_commonality_function);
+					commonality += sequence_commonality.At(a1.size(), a2.size());
+				}
+			}
 			break;
 		}
 
@@ -38,10 +38,17 @@ struct MergeMetricResultsParams
 {
 	EvaluableNode::ReferenceSetType *checked;
 	CompactHashMap<std::pair<EvaluableNode *, EvaluableNode *>, MergeMetricResults<EvaluableNode *>> memoizedNodeMergePairs;
+	//structural hash and number of comparable nodes of each subtree, so identical subtrees can be matched
+	// without aligning their child nodes; subtrees containing cycles have a size of zero and are not matched this way
+	CompactHashMap<EvaluableNode *, std::pair<size_t, size_t>> subtreeHashesAndSizes;
 	bool typesMustMatch;
 	bool nominalNumbers;
 	bool nominalStrings;
 	bool recursiveMatching;
+	//if true, identical subtrees are matched by their structural hashes without aligning their child nodes
+	//only valid when not checking for cycles and not matching recursively, since recursive matching replaces
+	// memoized results as it finds better submatches and skipping comparisons would change which are found
+	bool matchIdenticalSubtrees;
 };
 
 class EvaluableNodeTreeManipulation
@@ -565,11 +572,13 @@ public:
 		{
 			EvaluableNode::ReferenceSetType checked;
 			mmrp.checked = &checked;
+			mmrp.matchIdenticalSubtrees = false;
 			return NumberOfSharedNodes(tree1, tree2, mmrp);
 		}
 		else //don't need to check for cycles
 		{
 			mmrp.checked = nullptr;
+			mmrp.matchIdenticalSubtrees = !recursive_matching;
 			return NumberOfSharedNodes(tree1, tree2, mmrp);
 		}
 	}
@@ -579,6 +588,21 @@ public:
 	static MergeMetricResults<EvaluableNode *> NumberOfSharedNodes(EvaluableNode *tree1, EvaluableNode *tree2,
 		MergeMetricResultsParams &mmrp);
 
+	//returns a pair of the structural hash of tree, which ignores labels and comments, and the number of nodes
+	// NumberOfSharedNodes would count if tree were compared to an identical tree, where null child nodes count as one
+	//if tree contains a cycle, then the size returned is zero
+	//the results are memoized in mmrp
+	static std::pair<size_t, size_t> GetSubtreeHashAndSize(EvaluableNode *tree, MergeMetricResultsParams &mmrp);
+
+	//returns true if tree1 and tree2 are identical as determined by their structural hashes and then by verifying equality
+	//tree1 and tree2 must not contain cycles
+	static inline bool AreIdenticalSubtrees(EvaluableNode *tree1, EvaluableNode *tree2, MergeMetricResultsParams &mmrp)
+	{
+		auto tree1_hash_and_size = GetSubtreeHashAndSize(tree1, mmrp);
+		auto tree2_hash_and_size = GetSubtreeHashAndSize(tree2, mmrp);
+		return (tree1_hash_and_size == tree2_hash_and_size && EvaluableNode::AreDeepEqual(tree1, tree2));
+	}
+
 	//If the nodes, n1 and n2 can be generalized, then returns a new (allocated) node that is preferable to use (usually the more specific one)
 	// If the nodes are not equivalent, then returns null
 	// Only extra data (labels, comments, etc.) that is common to both is kept, unless KeepAllNonMergeableValues is true.  Then everything from both is kept. If 
@@ -15,6 +15,10 @@
 //magic number written at beginning of CAML file
 static const uint8_t s_magic_number[] = { 'c', 'a', 'm', 'l' };
 
+//magic number written at the beginning of CAML files whose header also contains a payload version
+//readers from before payload versions reject it as an invalid header instead of misreading the payload
+static const uint8_t s_versioned_magic_number[] = { 'c', 'a', 'm', 'v' };
+
 static bool ReadBigEndian(std::istream &stream, uint32_t &val)
 {
 	uint8_t buffer[4] = { 0 };
@@ -66,7 +70,8 @@ static bool WriteVersion(std::ostream &stream)
 	return true;
 }
 
-std::tuple<std::string, std::string, bool> FileSupportCAML::ReadHeader(std::istream &stream, size_t &header_size)
+std::tuple<std::string, std::string, bool> FileSupportCAML::ReadHeader(std::istream &stream, size_t &header_size,
+	uint32_t &payload_version)
 {
 	uint8_t magic[4] = { 0 };
 	if(!stream.read(reinterpret_cast<char *>(magic), sizeof(magic)))
@@ -75,35 +80,85 @@ std::tuple<std::string, std::string, bool> FileSupportCAML::ReadHeader(std::istr
 
 	auto num_bytes_read = stream.gcount();
 	std::string version;
+	bool versioned_payload = false;
 	if(num_bytes_read != sizeof(magic))
 	{
 		return std::make_tuple("Cannot read CAML header", version, false);
 	}
+	else if(std::memcmp(&magic[0], &s_versioned_magic_number[0], sizeof(magic)) == 0)
+	{
+		versioned_payload = true;
+	}
 	else if(std::memcmp(&magic[0], &s_magic_number[0], sizeof(magic)) != 0)
 	{
 		return std::make_tuple("CAML does not contain a valid header", version, false);
 	}
-	else
+
+	uint32_t major = 0, minor = 0, patch = 0;
+	if(!ReadVersion(stream, major, minor, patch))
+		return std::make_tuple("Cannot read CAML version", version, false);
+	header_size += sizeof(major) * 3;
+	version = std::to_string(major) + "." + std::to_string(minor) + "." + std::to_string(patch);
+
+	payload_version = PAYLOAD_VERSION_BLOCKS;
+	if(versioned_payload)
 	{
-		uint32_t major = 0, minor = 0, patch = 0;
-		if(!ReadVersion(stream, major, minor, patch))
-			return std::make_tuple("Cannot read CAML version", version, false);
-		header_size += sizeof(major) * 3;
-		version = std::to_string(major) + "." + std::to_string(minor) + "." + std::to_string(patch);
-
-		//validate version
-		auto [error_message, success] = AssetManager::ValidateVersionAgainstAmalgam(version);
-		if(!success)
-			return std::make_tuple(error_message, version, false);
+		if(!ReadBigEndian(stream, payload_version))
+			return std::make_tuple("Cannot read CAML payload version", version, false);
+		header_size += sizeof(payload_version);
+
+		if(payload_version > LATEST_PAYLOAD_VERSION)
+			return std::make_tuple("CAML payload version " + std::to_string(payload_version) + " is not supported", version, false);
 	}
 
+	//validate version
+	auto [error_message, success] = AssetManager::ValidateVersionAgainstAmalgam(version);
+	if(!success)
+		return std::make_tuple(error_message, version, false);
+
 	return std::make_tuple("", version, true);
 }
 
-bool FileSupportCAML::WriteHeader(std::ostream &stream)
+bool FileSupportCAML::WriteHeader(std::ostream &stream, uint32_t payload_version)
 {
-	if(!stream.write(reinterpret_cast<const char *>(s_magic_number), sizeof(s_magic_number)))
+	//the original header is kept for the original payload so that earlier versions can still read it
+	if(payload_version == PAYLOAD_VERSION_BLOCKS)
+	{
+		if(!stream.write(reinterpret_cast<const char *>(s_magic_number), sizeof(s_magic_number)))
+			return false;
+
+		return WriteVersion(stream);
+	}
+
+	if(!stream.write(reinterpret_cast<const char *>(s_versioned_magic_number), sizeof(s_versioned_magic_number)))
+		return false;
+
+	if(!WriteVersion(stream))
 		return false;
 
-	return WriteVersion(stream);
+	return WriteBigEndian(stream, payload_version);
+}
+
+std::pair<BinaryData, HuffmanTree<uint8_t> *> FileSupportCAML::CompressPayload(std::string &code_string,
+	uint32_t payload_version, std::vector<size_t> *split_offsets, bool run_concurrently)
+{
+	if(payload_version == PAYLOAD_VERSION_BLOCKS)
+		return CompressString(code_string);
+
+	auto chunk_ends = GetCompressionChunkEnds(code_string.size(), DEFAULT_COMPRESSION_CHUNK_SIZE, split_offsets);
+	return CompressStringInChunks(code_string, chunk_ends, run_concurrently);
+}
+
+std::string FileSupportCAML::DecompressPayload(BinaryData &payload, uint32_t payload_version, bool run_concurrently)
+{
+	if(payload_version == PAYLOAD_VERSION_BLOCKS)
+		return DecompressString(payload);
+
+	if(payload_version == PAYLOAD_VERSION_CHUNKED)
+	{
+		ChunkedCompressedData chunked_data(payload);
+		return chunked_data.DecompressAll(run_concurrently);
+	}
+
+	return std::string();
 }
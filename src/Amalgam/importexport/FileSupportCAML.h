@@ -1,19 +1,42 @@
 #pragma once
 
+//project headers:
+#include "BinaryPacking.h"
+
 //system headers:
 #include <istream>
 #include <ostream>
 #include <string>
 #include <tuple>
 #include <utility>
+#include <vector>
 
 namespace FileSupportCAML
 {
-	//read the header from the stream
+	//layouts of the payload following the header
+	//a stream of blocks, as written by all earlier versions, which is stored with the original header
+	constexpr uint32_t PAYLOAD_VERSION_BLOCKS = 0;
+	//an index of independently decodable chunks followed by the chunks and any appended blocks
+	constexpr uint32_t PAYLOAD_VERSION_CHUNKED = 1;
+	//newest payload version that can be read; files with a newer payload version are rejected
+	constexpr uint32_t LATEST_PAYLOAD_VERSION = PAYLOAD_VERSION_CHUNKED;
+
+	//read the header from the stream, setting payload_version to the layout of the payload that follows
 	//if success: returns an empty string indicating no error, file version, and true
 	//if failure: returns error message, file version, and false
-	std::tuple<std::string, std::string, bool> ReadHeader(std::istream &stream, size_t &header_size);
+	std::tuple<std::string, std::string, bool> ReadHeader(std::istream &stream, size_t &header_size, uint32_t &payload_version);
+
+	//write the header to the stream for a payload of payload_version
+	bool WriteHeader(std::ostream &stream, uint32_t payload_version = PAYLOAD_VERSION_BLOCKS);
+
+	//compresses code_string into a payload of payload_version, compressing chunks concurrently if run_concurrently
+	//if split_offsets is not nullptr, chunks will only be split at the sorted offsets it contains,
+	// which allows chunks to begin at the start of separately parsable code
+	//returns the payload and the huffman tree, which the caller is responsible for deleting
+	std::pair<BinaryData, HuffmanTree<uint8_t> *> CompressPayload(std::string &code_string, uint32_t payload_version,
+		std::vector<size_t> *split_offsets = nullptr, bool run_concurrently = false);
 
-	//write the header to the stream
-	bool WriteHeader(std::ostream &stream);
+	//decompresses payload of payload_version, decompressing chunks concurrently if run_concurrently
+	//returns an empty string if the payload is not valid
+	std::string DecompressPayload(BinaryData &payload, uint32_t payload_version, bool run_concurrently = false);
 };
@@ -1,130 +1,408 @@
 //project headers:
 #include "FileSupportCSV.h"
+#include "Concurrency.h"
+#include "Entity.h"
 
 //system headers:
+#include <deque>
 #include <iostream>
 #include <string>
+#include <string_view>
+#include <vector>
 
-EvaluableNode *FileSupportCSV::Load(const std::string &resource_path, EvaluableNodeManager *enm, EntityExternalInterface::LoadEntityStatus &status)
+//minimum number of bytes of a file to parse per chunk to make parsing chunks concurrently worthwhile
+constexpr size_t minBytesPerParseChunk = 1 << 20;
+
+//minimum number of rows per block to make creating entities concurrently worthwhile
+constexpr size_t minRowsPerEntityBlock = 1024;
+
+//a field of a row of a csv file
+struct CSVField
 {
-	auto [data, data_success] = Platform_OpenFileAsString(resource_path);
-	if(!data_success)
+	//characters of the field, referencing either the file data or CSVChunk::unescapedValues
+	std::string_view value;
+	//the value as a number, valid if isNumber is true
+	double number;
+	bool isNumber;
+};
+
+//the rows of a row-aligned range of a csv file
+struct CSVChunk
+{
+	//returns the number of rows in the chunk
+	inline size_t GetNumRows()
 	{
-		status.SetStatus(false, data);
-		std::cerr << data << std::endl;
-		return EvaluableNodeReference::Null();
+		return rowStarts.size();
 	}
 
-	StringManipulation::RemoveBOMFromUTF8String(data);
-	size_t file_size = data.size();
+	//returns a pointer to the first field of the row at row_index and the number of fields in the row
+	inline std::pair<CSVField *, size_t> GetRow(size_t row_index)
+	{
+		size_t start = rowStarts[row_index];
+		size_t end = (row_index + 1 < rowStarts.size() ? rowStarts[row_index + 1] : fields.size());
+		return std::make_pair(fields.data() + start, end - start);
+	}
 
-	EvaluableNode *data_top_node = enm->AllocNode(ENT_LIST);
+	//fields of every row, one row after another
+	std::vector<CSVField> fields;
 
-	//position in the input
-	size_t cur_position = 0;
+	//index into fields of the first field of each row
+	std::vector<size_t> rowStarts;
 
-	//for each row
-	while(cur_position < file_size)
+	//values of quoted fields after removing the quotes
+	//a deque is used so the strings are not moved as more values are added
+	std::deque<std::string> unescapedValues;
+};
+
+//calls func(block_index) for each block_index from 0 up to num_blocks, concurrently if possible
+template<typename BlockFunction>
+static void ProcessBlocksConcurrentlyIfPossible(size_t num_blocks, BlockFunction func)
+{
+#ifdef MULTITHREAD_SUPPORT
+	if(num_blocks > 1)
 	{
-		EvaluableNode *cur_row = enm->AllocNode(ENT_LIST);
-		auto &cur_row_ocn = cur_row->GetOrderedChildNodesReference();
-		data_top_node->GetOrderedChildNodesReference().push_back(cur_row);
+		auto enqueue_task_lock = Concurrency::urgentThreadPool.AcquireTaskLock();
+		if(Concurrency::urgentThreadPool.AreThreadsAvailable())
+		{
+			auto task_set = Concurrency::urgentThreadPool.CreateCountableTaskSet(num_blocks);
+			for(size_t block_index = 0; block_index < num_blocks; block_index++)
+			{
+				Concurrency::urgentThreadPool.BatchEnqueueTask([&func, block_index, &task_set]()
+				{
+					func(block_index);
+					task_set.MarkTaskCompleted();
+				}
+				);
+			}
 
-		//instantiate this once so the memory can be reused and start with a reasonable string size
-		std::string value;
-		value.reserve(64);
+			task_set.WaitForTasks(&enqueue_task_lock);
+			return;
+		}
+	}
+#endif
+
+	for(size_t block_index = 0; block_index < num_blocks; block_index++)
+		func(block_index);
+}
+
+//parses the rows of data from start_position up to end_position into chunk
+//start_position must be the beginning of a row, and end_position must be the beginning of a row or the end of data
+static void ParseRows(std::string_view data, size_t start_position, size_t end_position, CSVChunk &chunk)
+{
+	size_t cur_position = start_position;
+
+	//for each row
+	while(cur_position < end_position)
+	{
+		chunk.rowStarts.push_back(chunk.fields.size());
 
 		//for each column
-		while(cur_position < file_size)
+		while(cur_position < end_position)
 		{
-			//get this column's characters and value
-			size_t end_position = cur_position;
-			bool end_of_row = false;
-			value.clear();
-
-			//while in this column
-			while(end_position < file_size)
+			//find the end of this column, skipping over any delimiters within quotes
+			size_t field_end = cur_position;
+			bool in_quotes = false;
+			bool has_quotes = false;
+			for(; field_end < end_position; field_end++)
 			{
-				//if quoted string, get the rest of the quote
-				if(data[end_position] == '"')
+				char c = data[field_end];
+				if(c == '"')
 				{
-					//advance past quote
-					cur_position++;
-					end_position++;
+					in_quotes = !in_quotes;
+					has_quotes = true;
+				}
+				else if(!in_quotes && (c == ',' || c == '\n' || c == '\r'))
+				{
+					break;
+				}
+			}
+
+			CSVField field;
+			field.value = data.substr(cur_position, field_end - cur_position);
 
-					while(end_position < file_size)
+			if(has_quotes)
+			{
+				//remove the quotes, where two quotes in a row within a quote is an escaped quote
+				std::string &value = chunk.unescapedValues.emplace_back();
+				value.reserve(field.value.size());
+				bool in_quoted_value = false;
+				for(size_t i = 0; i < field.value.size(); i++)
+				{
+					char c = field.value[i];
+					if(c != '"')
 					{
-						//scan through everything that isn't a quote
-						if(data[end_position] != '"')
-						{
-							value.push_back(data[end_position]);
-							end_position++;
-							continue;
-						}
-
-						//must be a quote, check for two in a row
-						if(end_position + 1 < file_size && data[end_position + 1] == '"')
-						{
-							value.push_back('"');
-							//skip both quotes
-							end_position += 2;
-							continue;
-						}
-
-						//must be a quote
-						end_position++;
-						break;
+						value.push_back(c);
+						continue;
 					}
 
-					//catch up the the cur_position because these characters have already been accounted for
-					cur_position = end_position;
-				}
-
-				if(data[end_position] == ',')
-					break;
+					if(in_quoted_value && i + 1 < field.value.size() && field.value[i + 1] == '"')
+					{
+						value.push_back('"');
+						i++;
+						continue;
+					}
 
-				if(data[end_position] == '\n' || data[end_position] == '\r')
-				{
-					end_of_row = true;
-					break;
+					in_quoted_value = !in_quoted_value;
 				}
-
-				//keep accumulating this column
-				end_position++;
+				field.value = value;
 			}
 
-			//accumulate any remaining value
-			value.append(std::string(&data[cur_position], &data[end_position]));
+			field.number = 0.0;
+			field.isNumber = false;
+			if(field.value.size() > 0)
+				std::tie(field.number, field.isNumber) = Platform_StringToNumber(field.value);
+			chunk.fields.push_back(field);
+
+			bool end_of_row = (field_end >= end_position || data[field_end] != ',');
 
 			//move past extra terminating character if applicable
-			if(end_position + 1 < file_size && data[end_position] == '\r' && data[end_position + 1] == '\n')
-				end_position++;
+			if(field_end + 1 < end_position && data[field_end] == '\r' && data[field_end + 1] == '\n')
+				field_end++;
 			//move past terminating character
-			end_position++;
+			cur_position = field_end + 1;
+
+			if(end_of_row)
+				break;
+		}
+	}
+}
 
-			//create the value
-			EvaluableNode *element = nullptr;
-			if(value.size() > 0)
+//returns the positions that split data into num_chunks ranges of rows of roughly equal size,
+// followed by the size of data
+//splits are only made after newlines that are not within quotes
+static std::vector<size_t> FindChunkStarts(std::string_view data, size_t num_chunks)
+{
+	std::vector<size_t> chunk_starts{ 0 };
+
+	if(num_chunks > 1)
+	{
+		size_t chunk_size = data.size() / num_chunks;
+		size_t next_chunk_start = chunk_size;
+		bool in_quotes = false;
+		for(size_t i = 0; i < data.size(); i++)
+		{
+			if(data[i] == '"')
+			{
+				in_quotes = !in_quotes;
+			}
+			else if(data[i] == '\n' && !in_quotes && i + 1 >= next_chunk_start && i + 1 < data.size())
 			{
-				auto [float_value, success] = Platform_StringToNumber(value);
-				if(success)
-					element = enm->AllocNode(float_value);
-				else
-					element = enm->AllocNode(ENT_STRING, value);
+				chunk_starts.push_back(i + 1);
+				next_chunk_start = i + 1 + chunk_size;
 			}
-			cur_row_ocn.push_back(element);
+		}
+	}
 
-			//start at next field
-			cur_position = end_position;
+	chunk_starts.push_back(data.size());
+	return chunk_starts;
+}
 
-			if(end_of_row)
-				break;
+//parses the chunks of data from first_chunk up to end_chunk as split by chunk_starts, concurrently if possible
+static std::vector<CSVChunk> ParseChunks(std::string_view data, const std::vector<size_t> &chunk_starts, size_t first_chunk, size_t end_chunk)
+{
+	std::vector<CSVChunk> chunks(end_chunk - first_chunk);
+	ProcessBlocksConcurrentlyIfPossible(chunks.size(),
+		[&data, &chunk_starts, &chunks, first_chunk](size_t chunk_index)
+		{
+			ParseRows(data, chunk_starts[first_chunk + chunk_index], chunk_starts[first_chunk + chunk_index + 1], chunks[chunk_index]);
+		});
+
+	return chunks;
+}
+
+//parses all of data into chunks of rows
+//if the data is large enough, it is split into one chunk per thread and the chunks are parsed concurrently
+static std::vector<CSVChunk> ParseChunks(std::string_view data)
+{
+	size_t num_chunks = 1;
+#ifdef MULTITHREAD_SUPPORT
+	num_chunks = std::min(Concurrency::GetMaxNumThreads(), data.size() / minBytesPerParseChunk);
+#endif
+
+	std::vector<size_t> chunk_starts = FindChunkStarts(data, num_chunks);
+	return ParseChunks(data, chunk_starts, 0, chunk_starts.size() - 1);
+}
+
+//reads the file at resource_path into data, returning false and setting status if it could not be read
+static bool ReadFile(const std::string &resource_path, std::string &data, EntityExternalInterface::LoadEntityStatus &status)
+{
+	bool data_success;
+	std::tie(data, data_success) = Platform_OpenFileAsString(resource_path);
+	if(!data_success)
+	{
+		status.SetStatus(false, data);
+		std::cerr << data << std::endl;
+		return false;
+	}
+
+	StringManipulation::RemoveBOMFromUTF8String(data);
+	return true;
+}
+
+EvaluableNode *FileSupportCSV::Load(const std::string &resource_path, EvaluableNodeManager *enm, EntityExternalInterface::LoadEntityStatus &status)
+{
+	std::string data;
+	if(!ReadFile(resource_path, data, status))
+		return EvaluableNodeReference::Null();
+
+	EvaluableNode *data_top_node = enm->AllocNode(ENT_LIST);
+	auto &data_top_node_ocn = data_top_node->GetOrderedChildNodesReference();
+
+	//parse the file in chunks of a bounded size, at most one chunk per thread at a time,
+	// and create the nodes for those chunks before parsing more, so that the parsed fields
+	// of only a few chunks are held at once rather than those of the whole file
+	std::vector<size_t> chunk_starts = FindChunkStarts(data, data.size() / minBytesPerParseChunk);
+	size_t num_chunks = chunk_starts.size() - 1;
+	size_t num_chunks_per_round = 1;
+#ifdef MULTITHREAD_SUPPORT
+	num_chunks_per_round = std::max<size_t>(1, Concurrency::GetMaxNumThreads());
+#endif
+
+	for(size_t first_chunk = 0; first_chunk < num_chunks; first_chunk += num_chunks_per_round)
+	{
+		std::vector<CSVChunk> chunks = ParseChunks(data, chunk_starts,
+			first_chunk, std::min(first_chunk + num_chunks_per_round, num_chunks));
+
+		for(auto &chunk : chunks)
+		{
+			for(size_t row_index = 0; row_index < chunk.GetNumRows(); row_index++)
+			{
+				auto [fields, num_fields] = chunk.GetRow(row_index);
+
+				EvaluableNode *cur_row = enm->AllocNode(ENT_LIST);
+				auto &cur_row_ocn = cur_row->GetOrderedChildNodesReference();
+				cur_row_ocn.reserve(num_fields);
+				data_top_node_ocn.push_back(cur_row);
+
+				for(size_t i = 0; i < num_fields; i++)
+				{
+					EvaluableNode *element = nullptr;
+					if(fields[i].isNumber)
+						element = enm->AllocNode(fields[i].number);
+					else if(fields[i].value.size() > 0)
+						element = enm->AllocNode(fields[i].value);
+					cur_row_ocn.push_back(element);
+				}
+			}
 		}
 	}
 
 	return data_top_node;
 }
 
+void FileSupportCSV::LoadRowsAsContainedEntities(const std::string &resource_path, Entity *container, EntityExternalInterface::LoadEntityStatus &status)
+{
+	std::string data;
+	if(!ReadFile(resource_path, data, status))
+		return;
+
+	std::vector<CSVChunk> chunks = ParseChunks(data);
+
+	std::vector<std::pair<CSVChunk *, size_t>> rows;
+	for(auto &chunk : chunks)
+	{
+		for(size_t row_index = 0; row_index < chunk.GetNumRows(); row_index++)
+			rows.emplace_back(&chunk, row_index);
+	}
+
+	if(rows.size() == 0)
+		return;
+
+	//the first row contains the labels, skipping any columns without a label
+	auto [header_fields, num_columns] = rows[0].first->GetRow(rows[0].second);
+	std::vector<StringInternPool::StringID> column_label_sids(num_columns, StringInternPool::NOT_A_STRING_ID);
+	for(size_t i = 0; i < num_columns; i++)
+	{
+		if(header_fields[i].value.size() > 0)
+			column_label_sids[i] = string_intern_pool.CreateStringReference(header_fields[i].value);
+	}
+
+	size_t num_entities = rows.size() - 1;
+	size_t num_blocks = 1;
+#ifdef MULTITHREAD_SUPPORT
+	num_blocks = std::max<size_t>(1, std::min(Concurrency::GetMaxNumThreads(), num_entities / minRowsPerEntityBlock));
+#endif
+
+	//a column is numeric if all of its nonempty values are numbers
+	std::vector<std::vector<uint8_t>> block_column_is_numeric(num_blocks, std::vector<uint8_t>(num_columns, true));
+	ProcessBlocksConcurrentlyIfPossible(num_blocks,
+		[&rows, &block_column_is_numeric, num_columns, num_entities, num_blocks](size_t block_index)
+		{
+			auto &column_is_numeric = block_column_is_numeric[block_index];
+			size_t start_index = num_entities * block_index / num_blocks;
+			size_t end_index = num_entities * (block_index + 1) / num_blocks;
+			for(size_t entity_index = start_index; entity_index < end_index; entity_index++)
+			{
+				auto [row, row_index] = rows[entity_index + 1];
+				auto [fields, num_fields] = row->GetRow(row_index);
+				for(size_t i = 0; i < std::min(num_fields, num_columns); i++)
+				{
+					if(!fields[i].isNumber && fields[i].value.size() > 0)
+						column_is_numeric[i] = false;
+				}
+			}
+		});
+
+	std::vector<uint8_t> column_is_numeric(num_columns, true);
+	for(auto &block_is_numeric : block_column_is_numeric)
+	{
+		for(size_t i = 0; i < num_columns; i++)
+			column_is_numeric[i] = column_is_numeric[i] && block_is_numeric[i];
+	}
+
+	//random states are drawn in order so that the result does not depend on the concurrency
+	std::vector<std::string> rand_states(num_entities);
+	for(auto &rand_state : rand_states)
+		rand_state = container->CreateRandomStreamFromStringAndRand("");
+
+	//create the entities, each with its own node manager
+	std::vector<Entity *> new_entities(num_entities);
+	ProcessBlocksConcurrentlyIfPossible(num_blocks,
+		[&rows, &column_label_sids, &column_is_numeric, &rand_states, &new_entities,
+			num_columns, num_entities, num_blocks](size_t block_index)
+		{
+			size_t start_index = num_entities * block_index / num_blocks;
+			size_t end_index = num_entities * (block_index + 1) / num_blocks;
+			for(size_t entity_index = start_index; entity_index < end_index; entity_index++)
+			{
+				auto [row, row_index] = rows[entity_index + 1];
+				auto [fields, num_fields] = row->GetRow(row_index);
+
+				Entity *new_entity = new Entity();
+				new_entity->SetRandomState(rand_states[entity_index], false);
+
+				auto &enm = new_entity->evaluableNodeManager;
+				EvaluableNode *root = enm.AllocNode(ENT_ASSOC);
+				root->ReserveMappedChildNodes(num_columns);
+				for(size_t i = 0; i < num_columns; i++)
+				{
+					if(column_label_sids[i] == StringInternPool::NOT_A_STRING_ID)
+						continue;
+
+					EvaluableNode *value = nullptr;
+					if(i < num_fields && fields[i].value.size() > 0)
+					{
+						if(column_is_numeric[i])
+							value = enm.AllocNode(fields[i].number);
+						else
+							value = enm.AllocNode(fields[i].value);
+					}
+					root->SetMappedChildNode(column_label_sids[i], value);
+				}
+
+				new_entity->SetRoot(EvaluableNodeReference(root, true), true);
+				new_entities[entity_index] = new_entity;
+			}
+		});
+
+	//query caches for the container are built in bulk when first queried
+	for(auto new_entity : new_entities)
+		container->AddContainedEntity(new_entity, StringInternPool::NOT_A_STRING_ID);
+
+	for(auto label_sid : column_label_sids)
+		string_intern_pool.DestroyStringReference(label_sid);
+}
+
 //escapes a string per the CSV standard
 // may return the original string
 std::string EscapeCSVStringIfNeeded(std::string &s)
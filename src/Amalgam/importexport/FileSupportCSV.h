@@ -5,8 +5,18 @@
 #include "EvaluableNode.h"
 #include "EvaluableNodeManagement.h"
 
+//forward declarations:
+class Entity;
+
 namespace FileSupportCSV
 {
 	EvaluableNode *Load(const std::string &resource_path, EvaluableNodeManager *enm, EntityExternalInterface::LoadEntityStatus &status);
+
+	//loads the csv file at resource_path, using the first row as labels and creating each subsequent row
+	// as a contained entity of container whose root is an assoc of label to value
+	//each column is typed as a whole: if every nonempty value in the column is a number, the values are numbers,
+	// otherwise the values are strings; empty values are null
+	void LoadRowsAsContainedEntities(const std::string &resource_path, Entity *container, EntityExternalInterface::LoadEntityStatus &status);
+
 	bool Store(EvaluableNode *code, const std::string &resource_path, EvaluableNodeManager *enm);
 };
@@ -761,6 +761,13 @@ protected:
 	EvaluableNodeReference RewriteByFunction(EvaluableNodeReference function,
 		EvaluableNode *tree, FastHashMap<EvaluableNode *, EvaluableNode *> &original_node_to_new_node);
 
+	//converts value from the format from_type to the format to_type as described for the format opcode,
+	// using from_params and to_params if they are assocs
+	//frees value unless it is returned
+	EvaluableNodeReference ConvertValueFormat(EvaluableNodeReference value,
+		StringInternPool::StringID from_type, StringInternPool::StringID to_type,
+		EvaluableNode *from_params, EvaluableNode *to_params, EvaluableNodeRequestedValueTypes immediate_result);
+
 	//populates interpreter_constraints from params starting at the offset perf_constraint_param_offset
 	void PopulateInterpreterConstraintsFromParams(EvaluableNode::OrderedType &params,
 		size_t perf_constraint_param_offset, InterpreterConstraints &interpreter_constraints, bool calling_entity = false);
@@ -778,6 +785,16 @@ protected:
 		EvaluableNode::OrderedType &nodes, std::vector<EvaluableNodeReference> &interpreted_nodes,
 		EvaluableNodeRequestedValueTypes immediate_results = EvaluableNodeRequestedValueTypes());
 
+	//sorts the ordered child nodes of list into sorted using the custom comparison function
+	// by sorting blocks of the list concurrently and merging them
+	//sets side_effects to true if any comparison had execution side effects
+	//returns true if it is able to sort concurrently
+	bool SortConcurrentlyWithCustomComparator(EvaluableNodeReference &list, EvaluableNode *function,
+		EvaluableNode::OrderedType &sorted, bool &side_effects);
+
+	//minimum number of elements per block when sorting concurrently with a custom comparison function
+	static constexpr size_t minConcurrentCustomSortBlockSize = 256;
+
 	//returns true if this Interpreter shares the stack with others
 	inline bool HasSharedScopeStackTop()
 	{
@@ -2,6 +2,9 @@
 //project headers:
 #include "Interpreter.h"
 
+//system headers:
+#include <functional>
+
 #ifdef MULTITHREAD_SUPPORT
 //class to manage the data for concurrent execution by an interpreter
 class InterpreterConcurrencyManager
@@ -11,7 +14,7 @@ public:
 	//constructs the concurrency manager.  Assumes parent_interpreter is NOT null
 	InterpreterConcurrencyManager(Interpreter *parent_interpreter, size_t num_tasks,
 		ThreadPool::TaskLock &task_enqueue_lock)
-		: taskSet(&Concurrency::threadPool, num_tasks)
+		: taskSet(&Concurrency::threadPool)
 	{
 		resultsUnique = true;
 		resultsUniqueUnreferencedTopNode = true;
@@ -21,7 +24,11 @@ public:
 
 		parentInterpreter = parent_interpreter;
 		numTasks = num_tasks;
-		curNumTasksEnqueued = 0;
+		numTasksPerChunk = GetNumTasksPerChunk(num_tasks);
+		numTasksDispatched = 0;
+		//the number of threads may change, so the number of chunks must be derived from the same chunk size
+		// as is used to dispatch them, otherwise WaitForTasks would wait for chunks that are never dispatched
+		taskSet.AddTask(GetNumTaskChunks(num_tasks, numTasksPerChunk));
 		taskEnqueueLock = &task_enqueue_lock;
 
 		//create space to store all of these nodes on the stack, but won't copy these over to the other interpreters
@@ -30,9 +37,13 @@ public:
 		resultsSaverCurrentTaskOffset = resultsSaverFirstTaskOffset;
 		resultsSaver.ReserveNodes(num_tasks);
 
-		randomSeeds.reserve(numTasks);
-		for(size_t element_index = 0; element_index < numTasks; element_index++)
-			randomSeeds.emplace_back(parentInterpreter->randomStream.CreateOtherStreamViaRand());
+		//tasks are read by other threads while later tasks are being added,
+		// so the buffer must never be reallocated
+		tasks.reserve(numTasks);
+
+		//each task's random stream is derived from its index, so the parent's stream is advanced the same
+		// regardless of the number of tasks and the results do not depend on which thread runs each task
+		taskRandomStreamBase = parentInterpreter->randomStream.CreateOtherStreamViaRand();
 
 		//since each thread has a copy of the constructionStack, it's possible that more than one of the threads
 		//obtains previous_results, so they must all be marked as not unique
@@ -53,59 +64,19 @@ public:
 		EvaluableNode *current_value,
 		EvaluableNodeRefType &result)
 	{
-		size_t results_saver_location = resultsSaverCurrentTaskOffset++;
-		RandomStream rand_seed = randomSeeds[curNumTasksEnqueued++];
-
-		Concurrency::threadPool.BatchEnqueueTask(
-			[this, rand_seed, node_to_execute, target_origin, target, current_index,
-			current_value, &result, results_saver_location]
-		{
-			EvaluableNodeManager *enm = parentInterpreter->evaluableNodeManager;
-
-			Interpreter interpreter(parentInterpreter->evaluableNodeManager, rand_seed,
-				parentInterpreter->writeListeners, parentInterpreter->printListener,
-				parentInterpreter->interpreterConstraints, parentInterpreter->curEntity, parentInterpreter);
-
-			interpreter.memoryModificationLock = Concurrency::ReadLock(enm->GetMemoryModificationMutex());
-
-			//build new construction stack
-			std::vector<ConstructionStackEntry> construction_stack(parentInterpreter->constructionStack);
-			construction_stack.emplace_back(target_origin, target, current_index, current_value, EvaluableNodeReference::Null());
-
-			std::vector<EvaluableNode *> opcode_stack(begin(parentInterpreter->opcodeStackNodes),
-				begin(parentInterpreter->opcodeStackNodes) + resultsSaverFirstTaskOffset);
-
-			auto result_ref = interpreter.ExecuteNode(node_to_execute,
-				nullptr, &opcode_stack, &construction_stack, EvaluableNodeRequestedValueTypes::Type::NONE, false);
-
-			if(interpreter.PopConstructionContextAndGetExecutionSideEffectFlag())
-			{
-				resultsSideEffect = true;
-				resultsUnique = false;
-				resultsUniqueUnreferencedTopNode = false;
-			}
-
-			if(result_ref.unique)
-			{
-				if(result_ref.GetNeedCycleCheck())
-					resultsNeedCycleCheck = true;
-			}
-			else
-			{
-				resultsUnique = false;
-				resultsNeedCycleCheck = true;
-			}
-
-			if(!result_ref.GetIsIdempotent())
-				resultsIdempotent = false;
-
-			result = result_ref;
-			resultsSaver.SetStackElement(results_saver_location, result);
-
-			interpreter.memoryModificationLock.unlock();
-			taskSet.MarkTaskCompleted();
-		}
-		);
+		auto &task = tasks.emplace_back();
+		task.taskType = TaskType::CONSTRUCTION_STACK_WITH_RESULT;
+		task.nodeToExecute = node_to_execute;
+		task.targetOrigin = target_origin;
+		task.target = target;
+		task.currentIndex = current_index;
+		task.currentValue = current_value;
+		task.result = &result;
+		task.setResult = &SetTaskResult<EvaluableNodeRefType>;
+		task.immediateResults = EvaluableNodeRequestedValueTypes::Type::NONE;
+		task.resultsSaverLocation = resultsSaverCurrentTaskOffset++;
+
+		DispatchFullTaskChunks();
 	}
 
 	//like the previous definition of EnqueueTaskWithConstructionStack,
@@ -115,36 +86,19 @@ public:
 		EvaluableNodeImmediateValueWithType current_index,
 		EvaluableNode *current_value)
 	{
-		RandomStream rand_seed = randomSeeds[curNumTasksEnqueued++];
-
-		Concurrency::threadPool.BatchEnqueueTask(
-			[this, rand_seed, node_to_execute, current_index, current_value]
-		{
-			EvaluableNodeManager *enm = parentInterpreter->evaluableNodeManager;
-
-			Interpreter interpreter(parentInterpreter->evaluableNodeManager, rand_seed,
-				parentInterpreter->writeListeners, parentInterpreter->printListener,
-				parentInterpreter->interpreterConstraints, parentInterpreter->curEntity, parentInterpreter);
-
-			interpreter.memoryModificationLock = Concurrency::ReadLock(enm->GetMemoryModificationMutex());
-
-			//build new construction stack
-			std::vector<ConstructionStackEntry> construction_stack(parentInterpreter->constructionStack);
-			construction_stack.emplace_back(nullptr, &Interpreter::_null_reference, current_index, current_value, EvaluableNodeReference::Null());
-
-			std::vector<EvaluableNode *> opcode_stack(begin(parentInterpreter->opcodeStackNodes),
-				begin(parentInterpreter->opcodeStackNodes) + resultsSaverFirstTaskOffset);
-
-			auto result = interpreter.ExecuteNode(node_to_execute, nullptr, &opcode_stack, &construction_stack,
-				EvaluableNodeRequestedValueTypes::Type::NULL_VALUE, false);
-
-			interpreter.PopConstructionContextAndGetExecutionSideEffectFlag();
-			enm->FreeNodeTreeIfPossible(result);
-
-			interpreter.memoryModificationLock.unlock();
-			taskSet.MarkTaskCompleted();
-		}
-		);
+		auto &task = tasks.emplace_back();
+		task.taskType = TaskType::CONSTRUCTION_STACK_WITHOUT_RESULT;
+		task.nodeToExecute = node_to_execute;
+		task.targetOrigin = nullptr;
+		task.target = &Interpreter::_null_reference;
+		task.currentIndex = current_index;
+		task.currentValue = current_value;
+		task.result = nullptr;
+		task.setResult = nullptr;
+		task.immediateResults = EvaluableNodeRequestedValueTypes::Type::NULL_VALUE;
+		task.resultsSaverLocation = 0;
+
+		DispatchFullTaskChunks();
 	}
 
 	//Enqueues a concurrent task using the relative interpreter, executing node_to_execute
@@ -153,69 +107,45 @@ public:
 	void EnqueueTask(EvaluableNode *node_to_execute,
 		EvaluableNodeRefType *result = nullptr, EvaluableNodeRequestedValueTypes immediate_results = false)
 	{
-		//save the node to execute, but also save the location
-		//so the location can be used later to save the result
-		size_t results_saver_location = resultsSaverCurrentTaskOffset++;
-
-		RandomStream rand_seed = randomSeeds[curNumTasksEnqueued++];
-
-		Concurrency::threadPool.BatchEnqueueTask(
-			[this, rand_seed, node_to_execute, result, immediate_results, results_saver_location]
-		{
-			EvaluableNodeManager *enm = parentInterpreter->evaluableNodeManager;
-
-			Interpreter interpreter(parentInterpreter->evaluableNodeManager, rand_seed,
-				parentInterpreter->writeListeners, parentInterpreter->printListener,
-				parentInterpreter->interpreterConstraints, parentInterpreter->curEntity, parentInterpreter);
-
-			interpreter.memoryModificationLock = Concurrency::ReadLock(enm->GetMemoryModificationMutex());
-
-			std::vector<EvaluableNode *> opcode_stack(begin(parentInterpreter->opcodeStackNodes),
-				begin(parentInterpreter->opcodeStackNodes) + resultsSaverFirstTaskOffset);
-			std::vector<ConstructionStackEntry> construction_stack(parentInterpreter->constructionStack);
-
-			auto result_ref = interpreter.ExecuteNode(node_to_execute, nullptr, &opcode_stack,
-				&construction_stack, immediate_results, false);
-
-			if(interpreter.DoesConstructionStackHaveExecutionSideEffects())
-				resultsSideEffect = true;
-
-			if(result == nullptr)
-			{
-				enm->FreeNodeTreeIfPossible(result_ref);
-			}
-			else //want result
-			{
-				if(result_ref.unique)
-				{
-					if(result_ref.GetNeedCycleCheck())
-						resultsNeedCycleCheck = true;
-				}
-				else
-				{
-					resultsUnique = false;
-					resultsNeedCycleCheck = true;
-				}
-
-				if(!result_ref.GetIsIdempotent())
-					resultsIdempotent = false;
-
-				*result = result_ref;
-
-				//only save the result if it's not immediate
-				if(!result_ref.IsImmediateValue())
-					resultsSaver.SetStackElement(results_saver_location, *result);
-			}
+		auto &task = tasks.emplace_back();
+		task.taskType = TaskType::WITHOUT_CONSTRUCTION_STACK;
+		task.nodeToExecute = node_to_execute;
+		task.targetOrigin = nullptr;
+		task.target = nullptr;
+		task.currentValue = nullptr;
+		task.result = result;
+		task.setResult = (result == nullptr ? nullptr : &SetTaskResult<EvaluableNodeRefType>);
+		task.immediateResults = immediate_results;
+		//save the location so it can be used later to save the result
+		task.resultsSaverLocation = resultsSaverCurrentTaskOffset++;
+
+		DispatchFullTaskChunks();
+	}
 
-			interpreter.memoryModificationLock.unlock();
-			taskSet.MarkTaskCompleted();
-		}
-		);
+	//Enqueues a concurrent task that calls function with an interpreter that has the same
+	// context as the relative interpreter, for operations that need to evaluate code repeatedly
+	void EnqueueTaskWithInterpreter(std::function<void(Interpreter &)> &&function)
+	{
+		auto &task = tasks.emplace_back();
+		task.taskType = TaskType::CALL_FUNCTION;
+		task.nodeToExecute = nullptr;
+		task.targetOrigin = nullptr;
+		task.target = nullptr;
+		task.currentValue = nullptr;
+		task.result = nullptr;
+		task.setResult = nullptr;
+		task.resultsSaverLocation = 0;
+		task.function = std::move(function);
+
+		DispatchFullTaskChunks();
 	}
 
 	//ends concurrency from all interpreters and waits for them to finish
 	inline void EndConcurrency()
 	{
+		//dispatch any remaining tasks
+		DispatchTaskChunk(tasks.size());
+
 		//allow other threads to perform garbage collection
 		parentInterpreter->memoryModificationLock.unlock();
 		taskSet.WaitForTasks(taskEnqueueLock);
@@ -251,8 +181,184 @@ public:
 	}
 
 protected:
-	//random seed for each task, the size of numTasks
-	std::vector<RandomStream> randomSeeds;
+	//the kind of work a task performs, corresponding to the Enqueue methods
+	enum class TaskType : uint8_t
+	{
+		CONSTRUCTION_STACK_WITH_RESULT,
+		CONSTRUCTION_STACK_WITHOUT_RESULT,
+		WITHOUT_CONSTRUCTION_STACK,
+		CALL_FUNCTION
+	};
+
+	//parameters of an enqueued task
+	struct Task
+	{
+		TaskType taskType;
+		EvaluableNode *nodeToExecute;
+		EvaluableNode *targetOrigin;
+		EvaluableNodeReference *target;
+		EvaluableNodeImmediateValueWithType currentIndex;
+		EvaluableNode *currentValue;
+		//location to store the result and the function to store it with the appropriate type
+		void *result;
+		void (*setResult)(void *, EvaluableNodeReference &);
+		EvaluableNodeRequestedValueTypes immediateResults;
+		size_t resultsSaverLocation;
+		//function to call for CALL_FUNCTION
+		std::function<void(Interpreter &)> function;
+	};
+
+	//stores value into result, which points to a EvaluableNodeRefType
+	template<typename EvaluableNodeRefType>
+	static void SetTaskResult(void *result, EvaluableNodeReference &value)
+	{
+		*static_cast<EvaluableNodeRefType *>(result) = value;
+	}
+
+	//each thread is given about this many chunks of tasks, so that many small tasks are
+	// run in larger batches while still balancing uneven work across threads
+	static constexpr size_t numTaskChunksPerThread = 4;
+
+	//returns the number of consecutive tasks that will be run together by one interpreter
+	static inline size_t GetNumTasksPerChunk(size_t num_tasks)
+	{
+		size_t max_num_chunks = numTaskChunksPerThread
+			* std::max<size_t>(1, static_cast<size_t>(Concurrency::threadPool.GetMaxNumActiveThreads()));
+		return std::max<size_t>(1, num_tasks / max_num_chunks);
+	}
+
+	//returns the number of chunks that num_tasks will be run in when dispatched num_tasks_per_chunk at a time
+	static inline size_t GetNumTaskChunks(size_t num_tasks, size_t num_tasks_per_chunk)
+	{
+		return (num_tasks + num_tasks_per_chunk - 1) / num_tasks_per_chunk;
+	}
+
+	//dispatches a chunk if enough tasks have been enqueued to fill it
+	inline void DispatchFullTaskChunks()
+	{
+		if(tasks.size() - numTasksDispatched >= numTasksPerChunk)
+			DispatchTaskChunk(tasks.size());
+	}
+
+	//dispatches all tasks that have not yet been dispatched up to but not including end_task as one chunk
+	inline void DispatchTaskChunk(size_t end_task)
+	{
+		size_t first_task = numTasksDispatched;
+		if(first_task >= end_task)
+			return;
+		numTasksDispatched = end_task;
+
+		Concurrency::threadPool.BatchEnqueueTask(
+			[this, first_task, end_task]
+			{
+				ExecuteTaskChunk(first_task, end_task);
+				taskSet.MarkTaskCompleted();
+			}
+		);
+	}
+
+	//executes the tasks from first_task up to but not including end_task,
+	// reusing one interpreter and one copy of the parent's stacks for all of them
+	void ExecuteTaskChunk(size_t first_task, size_t end_task)
+	{
+		EvaluableNodeManager *enm = parentInterpreter->evaluableNodeManager;
+
+		Interpreter interpreter(parentInterpreter->evaluableNodeManager, taskRandomStreamBase.CreateSubstream(first_task),
+			parentInterpreter->writeListeners, parentInterpreter->printListener,
+			parentInterpreter->interpreterConstraints, parentInterpreter->curEntity, parentInterpreter);
+
+		interpreter.memoryModificationLock = Concurrency::ReadLock(enm->GetMemoryModificationMutex());
+
+		//scope stack lookups go to the parent interpreter
+		interpreter.bottomOfScopeStack = false;
+		interpreter.constructionStack = parentInterpreter->constructionStack;
+		interpreter.opcodeStackNodes.assign(begin(parentInterpreter->opcodeStackNodes),
+			begin(parentInterpreter->opcodeStackNodes) + resultsSaverFirstTaskOffset);
+
+		enm->AddActiveInterpreter(&interpreter);
+
+		for(size_t task_index = first_task; task_index < end_task; task_index++)
+		{
+			Task &task = tasks[task_index];
+			interpreter.randomStream = taskRandomStreamBase.CreateSubstream(task_index);
+
+			if(task.taskType == TaskType::CALL_FUNCTION)
+			{
+				task.function(interpreter);
+				if(interpreter.DoesConstructionStackHaveExecutionSideEffects())
+					resultsSideEffect = true;
+				continue;
+			}
+
+			if(task.taskType == TaskType::WITHOUT_CONSTRUCTION_STACK)
+			{
+				auto result_ref = interpreter.InterpretNode(task.nodeToExecute, task.immediateResults);
+
+				if(interpreter.DoesConstructionStackHaveExecutionSideEffects())
+					resultsSideEffect = true;
+
+				if(task.result == nullptr)
+					enm->FreeNodeTreeIfPossible(result_ref);
+				else
+					SaveTaskResult(task, result_ref, !result_ref.IsImmediateValue());
+				continue;
+			}
+
+			interpreter.constructionStack.emplace_back(task.targetOrigin, task.target,
+				task.currentIndex, task.currentValue, EvaluableNodeReference::Null());
+
+			auto result_ref = interpreter.InterpretNode(task.nodeToExecute, task.immediateResults);
+
+			if(task.taskType == TaskType::CONSTRUCTION_STACK_WITHOUT_RESULT)
+			{
+				interpreter.PopConstructionContextAndGetExecutionSideEffectFlag();
+				enm->FreeNodeTreeIfPossible(result_ref);
+				continue;
+			}
+
+			if(interpreter.PopConstructionContextAndGetExecutionSideEffectFlag())
+			{
+				resultsSideEffect = true;
+				resultsUnique = false;
+				resultsUniqueUnreferencedTopNode = false;
+			}
+
+			SaveTaskResult(task, result_ref, true);
+		}
+
+		enm->RemoveActiveInterpreter(&interpreter);
+		interpreter.memoryModificationLock.unlock();
+	}
+
+	//accumulates the properties of result_ref into the results and stores it in task's result
+	//if save_on_stack is true, keeps the result on the stack to prevent it from being garbage collected
+	inline void SaveTaskResult(Task &task, EvaluableNodeReference &result_ref, bool save_on_stack)
+	{
+		if(result_ref.unique)
+		{
+			if(result_ref.GetNeedCycleCheck())
+				resultsNeedCycleCheck = true;
+		}
+		else
+		{
+			resultsUnique = false;
+			resultsNeedCycleCheck = true;
+		}
+
+		if(!result_ref.GetIsIdempotent())
+			resultsIdempotent = false;
+
+		task.setResult(task.result, result_ref);
+
+		if(save_on_stack)
+			resultsSaver.SetStackElement(task.resultsSaverLocation, result_ref);
+	}
+
+	//all tasks enqueued, which has capacity for numTasks
+	std::vector<Task> tasks;
+
+	//random stream from which the stream for each task is created by task index
+	RandomStream taskRandomStreamBase;
 
 	//a barrier to wait for the tasks being run
 	ThreadPool::CountableTaskSet taskSet;
@@ -288,8 +394,11 @@ protected:
 	//current task offset, which started at resultsSaverFirstTaskOffset
 	size_t resultsSaverCurrentTaskOffset;
 
-	//number of tasks enqueued so far
-	size_t curNumTasksEnqueued;
+	//number of consecutive tasks run together by one interpreter
+	size_t numTasksPerChunk;
+
+	//number of tasks that have been handed to the thread pool so far
+	size_t numTasksDispatched;
 
 	//lock for enqueueing tasks
 	ThreadPool::TaskLock *taskEnqueueLock;
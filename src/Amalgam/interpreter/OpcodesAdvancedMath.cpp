@@ -1927,6 +1927,7 @@ EvaluableNodeReference Interpreter::InterpretNode_ENT_GENERALIZED_DISTANCE(Evalu
 
 	dist_eval.highAccuracyDistances = true;
 	dist_eval.recomputeAccurateDistances = false;
+	dist_eval.singlePrecisionValues = false;
 	dist_eval.InitializeParametersAndFeatureParams();
 
 	double value = dist_eval.ComputeMinkowskiDistance(location, origin, false, true);
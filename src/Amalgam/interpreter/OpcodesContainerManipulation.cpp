@@ -1,9 +1,7 @@
 //project headers:
 #include "Interpreter.h"
 #include "OpcodeDetails.h"
-
-//system headers:
-#include <regex>
+#include "RegexCache.h"
 
 static std::string _opcode_group = "Container Manipulation";
 
@@ -2070,19 +2068,9 @@ EvaluableNodeReference Interpreter::InterpretNode_ENT_CONTAINS_VALUE(EvaluableNo
 
 		std::string value_as_str = EvaluableNode::ToString(value);
 
-		//use nosubs to prevent unnecessary memory allocations since this is just matching
-		std::regex rx;
-		bool valid_rx = true;
-		try
-		{
-			rx.assign(value_as_str, std::regex::ECMAScript | std::regex::nosubs);
-		}
-		catch(...)
-		{
-			valid_rx = false;
-		}
-
-		if(valid_rx && std::regex_match(s.data(), s.data() + s.size(), rx))
+		//an invalid regex never matches
+		auto rx = RegexCache::GetCompiledRegex(value_as_str);
+		if(rx->FullMatch(s))
 			found = true;
 	}
 
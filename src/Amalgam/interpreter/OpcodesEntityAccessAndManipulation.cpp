@@ -78,7 +78,7 @@ static OpcodeInitializer _ENT_ASSIGN_TO_ENTITIES(ENT_ASSIGN_TO_ENTITIES, &Interp
 			{"label_value_pairs", OpcodeDetails::DataType::ASSOC, true}, true, 2)
 	});
 	d.returns = OpcodeDetails::DataType::BOOL;
-	d.description = R"(For each index-value pair of `label_value_pairs`, assigns the value to the label on the contained entity represented by the respective `entity`, itself if `entity` is not specified or is null.  If the label is not found, it will create it.  Returns true if all assignments were successful, false if not.)";
+	d.description = R"(For each index-value pair of `label_value_pairs`, assigns the value to the label on the contained entity represented by the respective `entity`, itself if `entity` is not specified or is null.  If the label is not found, it will create it.  Returns true if all assignments were successful, false if not.  If every `entity` is the id of a contained entity given as a literal string and every `label_value_pairs` is a literal assoc, such as when the call is built with `apply`, then all of the assignments are applied as one batch, updating the query caches once and recording a single write.)";
 	d.examples = MakeAmalgamExamples({
 		{R"&((seq
 	(create_entities
@@ -119,7 +119,7 @@ static OpcodeInitializer _ENT_ACCUM_TO_ENTITIES(ENT_ACCUM_TO_ENTITIES, &Interpre
 			{"label_value_pairs", OpcodeDetails::DataType::ASSOC, true}, true, 2)
 	});
 	d.returns = OpcodeDetails::DataType::BOOL;
-	d.description = R"(For each index-value pair of `label_value_pairs`, it accumulates the value to the label on the contained entity represented by the respective `entity`, itself if `entity` is not specified or is null.  If the label is not found, it will create it.  Returns true if all assignments were successful, false if not.  Accumulation is performed differently based on the type: for numeric values it adds, for strings, it concatenates, for lists it appends, and for assocs it appends based on the pair.)";
+	d.description = R"(For each index-value pair of `label_value_pairs`, it accumulates the value to the label on the contained entity represented by the respective `entity`, itself if `entity` is not specified or is null.  If the label is not found, it will create it.  Returns true if all assignments were successful, false if not.  Accumulation is performed differently based on the type: for numeric values it adds, for strings, it concatenates, for lists it appends, and for assocs it appends based on the pair.  If every `entity` is the id of a contained entity given as a literal string and every `label_value_pairs` is a literal assoc, such as when the call is built with `apply`, then all of the assignments are applied as one batch, updating the query caches once and recording a single write.)";
 	d.examples = MakeAmalgamExamples({
 		{R"&((seq
 	(create_entities
@@ -195,6 +195,64 @@ EvaluableNodeReference Interpreter::InterpretNode_ENT_ASSIGN_TO_ENTITIES_and_REM
 	bool remove_from_entities = (en->GetType() == ENT_REMOVE_FROM_ENTITIES);
 	bool accum_to_entities = (en->GetType() == ENT_ACCUM_TO_ENTITIES);
 
+	//if every pair is the literal id of a contained entity and a literal assoc, such as when the call is built via apply,
+	// then no code can run between the assignments, so apply them as one batch to update the query caches once
+	if(!remove_from_entities && ocn.size() >= 4 && ocn.size() % 2 == 0)
+	{
+		bool batchable = true;
+		for(size_t i = 0; i < ocn.size(); i += 2)
+		{
+			if(ocn[i] == nullptr || ocn[i]->GetType() != ENT_STRING
+				|| ocn[i + 1] == nullptr || ocn[i + 1]->GetType() != ENT_ASSOC || !ocn[i + 1]->GetIsIdempotent())
+			{
+				batchable = false;
+				break;
+			}
+		}
+
+		if(batchable)
+		{
+			std::vector<std::pair<Entity *, EvaluableNodeReference>> entities_and_label_values;
+			entities_and_label_values.reserve(ocn.size() / 2);
+
+			size_t num_new_nodes_allocated = 0;
+			bool all_success = false;
+			bool resources_exhausted = false;
+
+			//check after each pair, as when assigning them one at a time, so that a batch cannot exceed the constraints
+			// by more than one pair
+			auto count_allocations_and_check_resources = [this, &resources_exhausted](size_t entity_new_nodes_allocated)
+			{
+				if(ConstrainedAllocatedNodes())
+					interpreterConstraints->curNumAllocatedNodesAllocatedToEntities += entity_new_nodes_allocated;
+
+				resources_exhausted = AreExecutionResourcesExhausted();
+				return resources_exhausted;
+			};
+
+			{
+				EntityWriteReference container(curEntity);
+				for(size_t i = 0; i < ocn.size(); i += 2)
+				{
+					StringInternPool::StringID entity_sid = EvaluableNode::ToStringIDIfExists(ocn[i]);
+					entities_and_label_values.emplace_back(curEntity->GetContainedEntity(entity_sid),
+						EvaluableNodeReference(ocn[i + 1], false));
+				}
+
+				auto lab_pause = evaluableNodeManager->PauseLocalAllocationBuffer();
+				all_success = curEntity->SetValuesAtLabelsOfContainedEntities(
+					entities_and_label_values, accum_to_entities, writeListeners,
+					(ConstrainedAllocatedNodes() ? &num_new_nodes_allocated : nullptr),
+					count_allocations_and_check_resources).second;
+			}
+
+			if(resources_exhausted || AreExecutionResourcesExhausted()) [[unlikely]]
+				return EvaluableNodeReference::Null();
+
+			return AllocReturn(all_success, immediate_result);
+		}
+	}
+
 	bool all_assignments_successful = true;
 	for(size_t i = 0; i < ocn.size(); i += 2)
 	{
@@ -614,7 +614,7 @@ static OpcodeInitializer _ENT_INTERSECT_ENTITIES(ENT_INTERSECT_ENTITIES, &Interp
 	)
 ))&", R"([
 	{b 4 c .null}
-	["MergeEntityChild1" "MergeEntityChild2" "_2bW5faQkVxs" "_ldZa276M1io"]
+	["MergeEntityChild1" "MergeEntityChild2" "_TURzKx" "_wrZdTk"]
 ])", "", R"((destroy_entities "MergeEntity1" "MergeEntity2" "IntersectedEntity")"}
 		});
 	d.retrievesData = true;
@@ -782,7 +782,7 @@ static OpcodeInitializer _ENT_UNION_ENTITIES(ENT_UNION_ENTITIES, &Interpreter::I
 	)
 ))&", R"([
 	{a 3 b 4 c .null}
-	["MergeEntityChild1" "MergeEntityChild2" "_2bW5faQkVxs" "_ldZa276M1io"]
+	["MergeEntityChild1" "MergeEntityChild2" "_TURzKx" "_wrZdTk"]
 ])", "", R"((destroy_entities "MergeEntity1" "MergeEntity2" "UnionedEntity")"}
 		});
 	d.retrievesData = true;
@@ -1126,7 +1126,7 @@ static OpcodeInitializer _ENT_MIX_ENTITIES(ENT_MIX_ENTITIES, &Interpreter::Inter
 	]
 ))&", R"([
 	{b 4 c "c1"}
-	["MergeEntityChild1" "MergeEntityChild2" "_2bW5faQkVxs" "_ldZa276M1io"]
+	["MergeEntityChild1" "MergeEntityChild2" "_TURzKx" "_wrZdTk"]
 ])", ".*", R"((apply "destroy_entities" (contained_entities)))"},
 		});
 	d.retrievesData = true;
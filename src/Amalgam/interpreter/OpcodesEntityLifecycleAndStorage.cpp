@@ -44,7 +44,7 @@ static OpcodeInitializer _ENT_CREATE_ENTITIES(ENT_CREATE_ENTITIES, &Interpreter:
 		{m 3 n 4}
 	)
 	(contained_entities "EntityWithContainedEntities")
-))&", R"(["NamedEntity1" "NamedEntity2" "_hIcoPxJ8LiS"])", "", R"((destroy_entities "EntityWithContainedEntities"))"}
+))&", R"(["NamedEntity1" "NamedEntity2" "_idQMhP"])", "", R"((destroy_entities "EntityWithContainedEntities"))"}
 		});
 	d.requiresEntity = true;
 	d.retrievesData = true;
@@ -156,7 +156,36 @@ static OpcodeInitializer _ENT_CLONE_ENTITIES(ENT_CLONE_ENTITIES, &Interpreter::I
 	)
 	(clone_entities "Entity1" "Entity2")
 	(contained_entities "Entity2")
-))&", R"(["NamedEntity1" "NamedEntity2" "_539JylCpbqn"])", "", R"((destroy_entities "Entity1" "Entity2"))"}
+))&", R"(["NamedEntity1" "NamedEntity2" "_VRhAw1"])", "", R"((destroy_entities "Entity1" "Entity2"))"},
+			{R"&((seq
+	(create_entities
+		"Entity1"
+		{a [1 2 3] b 4}
+	)
+	(clone_entities "Entity1" "Entity2")
+	(accum_to_entities "Entity2" {a [7]})
+	(clone_entities "Entity2" "Entity3")
+	(accum_to_entities "Entity1" {a [0]})
+	(assign_to_entities "Entity3" {b 5})
+	[
+		(retrieve_from_entity "Entity1" ["a" "b"])
+		(retrieve_from_entity "Entity2" ["a" "b"])
+		(retrieve_from_entity "Entity3" ["a" "b"])
+	]
+))&", R"([
+	[
+		[1 2 3 0]
+		4
+	]
+	[
+		[1 2 3 7]
+		4
+	]
+	[
+		[1 2 3 7]
+		5
+	]
+])", "", R"((destroy_entities "Entity1" "Entity2" "Entity3"))"}
 		});
 	d.requiresEntity = true;
 	d.valueNewness = OpcodeDetails::OpcodeReturnNewnessType::NEW;
@@ -267,7 +296,7 @@ static OpcodeInitializer _ENT_MOVE_ENTITIES(ENT_MOVE_ENTITIES, &Interpreter::Int
 	)
 	(move_entities "Entity1" "Entity2")
 	(contained_entities "Entity2")
-))&", R"(["NamedEntity1" "NamedEntity2" "_539JylCpbqn"])", "", R"((destroy_entities "Entity2"))"}
+))&", R"(["NamedEntity1" "NamedEntity2" "_VRhAw1"])", "", R"((destroy_entities "Entity2"))"}
 		});
 	d.requiresEntity = true;
 	d.valueNewness = OpcodeDetails::OpcodeReturnNewnessType::NEW;
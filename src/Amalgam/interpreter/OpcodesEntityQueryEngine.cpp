@@ -37,7 +37,7 @@ static OpcodeInitializer _ENT_CONTAINED_ENTITIES(ENT_CONTAINED_ENTITIES, &Interp
 	]
 ))&", R"([
 	["Entity1" "Entity2"]
-	["A" "_3SaCTguSSie"]
+	["A" "_z3dYQQ"]
 	["Entity1"]
 ])", "", R"((destroy_entities "Entity1" "Entity2"))"}
 		});
@@ -207,14 +207,9 @@ EvaluableNodeReference Interpreter::InterpretNode_ENT_CONTAINED_ENTITIES_and_COM
 		if(immediate_result.Allows(EvaluableNodeRequestedValueTypes::Type::SIZE_AS_NUMBER))
 			return EvaluableNodeReference(static_cast<double>(contained_entities.size()));
 
-		//new list containing the contained entity ids to return
-		EvaluableNodeReference result(evaluableNodeManager->AllocNode(ENT_LIST), true);
-		auto &result_ocn = result->GetOrderedChildNodesReference();
-		result_ocn.resize(contained_entities.size());
-
-		//create the string references all at once and hand off
-		for(size_t i = 0; i < contained_entities.size(); i++)
-			result_ocn[i] = evaluableNodeManager->AllocNode(ENT_STRING, contained_entities[i]->GetIdStringId());
+		//new list containing the contained entity ids to return, allocating all id nodes at once
+		EvaluableNodeReference result = CreateListOfStringsIdsFromIteratorAndFunction(contained_entities, evaluableNodeManager,
+			[](Entity *e) { return e->GetIdStringId(); });
 
 		//if not using SBFDS, make sure always return in the same order for consistency, regardless of cashing, hashing, etc.
 		//if using SBFDS, then the order is assumed to not matter for other queries, so don't pay the cost of sorting here
@@ -1737,7 +1732,42 @@ static OpcodeInitializer _ENT_QUERY_DISTANCE_CONTRIBUTIONS(ENT_QUERY_DISTANCE_CO
 			"random seed 1234"
 		)
 	)
-))&", R"([1.17157287525381])", "", R"((apply "destroy_entities" (contained_entities)))"}
+))&", R"([1.17157287525381])", "", R"((apply "destroy_entities" (contained_entities)))"},
+		{R"&((seq
+	(create_entities
+		"vert0"
+		{object 1 x 0 y 0}
+	)
+	(create_entities
+		"vert1"
+		{object 1 x 1 y 0}
+	)
+	(create_entities
+		"vert2"
+		{object 2 x 2 y 1}
+	)
+	(apply "max"
+		(compute_on_contained_entities
+			(query_distance_contributions
+				2
+				["x" "y"]
+				[
+					[1 2]
+					[0 0]
+					[3 3]
+				]
+				2
+				.null
+				.null
+				.null
+				.null
+				-1
+				.null
+				"random seed 1234"
+			)
+		)
+	)
+))&", R"(2.7602818325443295)", "", R"((apply "destroy_entities" (contained_entities)))"}
 		});
 	d.valueNewness = OpcodeDetails::OpcodeReturnNewnessType::PARTIAL;
 	d.isQuery = true;
@@ -2437,7 +2437,8 @@ static OpcodeInitializer _ENT_SORT(ENT_SORT, &Interpreter::InterpretNode_ENT_SOR
 		OpcodeDetails::ParameterGroup({"k", OpcodeDetails::DataType::NUMBER, true})
 	});
 	d.returns = OpcodeDetails::DataType::LIST;
-	d.description = "Returns a new list containing the elements from `collection` sorted in increasing order, regardless of whether `collection` is an assoc or list.  If `function` is null or true it sorts ascending, if false it sorts descending, and if any other value it pushes a pair of new scope onto the stack with `(current_value)` and `(current_value 1)` accessing a pair of elements from the list, and evaluates `function`.  The function should return a number, positive if `(current_value)` is greater meaning that `(current_value)` should come after `(current_value 1)`, negative if `(current_value 1)` is greater and should come after `(current_value)`, or 0 if equal.  If `k` is specified in addition to `function` and not null, then it will only return the `k` smallest values sorted in order, or, if `k` is negative, it will return the highest `k` values using the absolute value of `k`.";
+	d.allowsConcurrency = true;
+	d.description = "Returns a new list containing the elements from `collection` sorted in increasing order, regardless of whether `collection` is an assoc or list.  If `function` is null or true it sorts ascending, if false it sorts descending, and if any other value it pushes a pair of new scope onto the stack with `(current_value)` and `(current_value 1)` accessing a pair of elements from the list, and evaluates `function`.  The function should return a number, positive if `(current_value)` is greater meaning that `(current_value)` should come after `(current_value 1)`, negative if `(current_value 1)` is greater and should come after `(current_value)`, or 0 if equal.  If `k` is specified in addition to `function` and not null, then it will only return the `k` smallest values sorted in order, or, if `k` is negative, it will return the highest `k` values using the absolute value of `k`.  If `||` is specified with a custom `function` and `collection` is large, blocks of `collection` are sorted concurrently and then merged, which gives the same result as sorting serially when `function` is a consistent ordering, and otherwise depends only on `collection` and the random seed, not on the number of threads.";
 	d.examples = MakeAmalgamExamples({
 		{R"&((sort
 	[4 9 3 5 1]
@@ -2720,7 +2721,7 @@ EvaluableNodeReference Interpreter::InterpretNode_ENT_SORT(EvaluableNode *en, Ev
 
 			list_ocn.erase(begin(list_ocn) + lowest_k, end(list_ocn));
 		}
-		else
+		else if(!EvaluableNodeOrderedChildNodesSortByValue(list_ocn, ascending))
 		{
 			if(ascending)
 				std::sort(begin(list_ocn), end(list_ocn), EvaluableNode::IsStrictlyLessThan);
@@ -2745,11 +2746,25 @@ EvaluableNodeReference Interpreter::InterpretNode_ENT_SORT(EvaluableNode *en, Ev
 		if(list->IsAssociativeArray())
 			list->ConvertAssocToList();
 
-		CustomEvaluableNodeComparator comparator(this, function, list);
+		node_stack.PushEvaluableNode(list);
+
+		EvaluableNode::OrderedType sorted;
+		bool side_effects = false;
+		bool sorted_concurrently = false;
+	#ifdef MULTITHREAD_SUPPORT
+		if(en->GetConcurrency())
+			sorted_concurrently = SortConcurrentlyWithCustomComparator(list, function, sorted, side_effects);
+	#endif
+
+		if(!sorted_concurrently)
+		{
+			CustomEvaluableNodeComparator comparator(this, function, list);
 
-		//sort list; can't use the C++ sort function because it requires weak ordering and will crash otherwise
-		// the custom comparator does not guarantee this
-		EvaluableNode::OrderedType sorted = CustomEvaluableNodeOrderedChildNodesSort(list->GetOrderedChildNodes(), comparator);
+			//sort list; can't use the C++ sort function because it requires weak ordering and will crash otherwise
+			// the custom comparator does not guarantee this
+			sorted = CustomEvaluableNodeOrderedChildNodesSort(list->GetOrderedChildNodes(), comparator);
+			side_effects = comparator.DidAnyComparisonHaveExecutionSideEffects();
+		}
 
 		if(highest_k > 0 && highest_k < sorted.size())
 		{
@@ -2763,7 +2778,7 @@ EvaluableNodeReference Interpreter::InterpretNode_ENT_SORT(EvaluableNode *en, Ev
 
 		list->SetOrderedChildNodes(std::move(sorted), list->GetNeedCycleCheck(), list->GetIsIdempotent());
 
-		if(comparator.DidAnyComparisonHaveExecutionSideEffects())
+		if(side_effects)
 		{
 			list.unique = false;
 			list.uniqueUnreferencedTopNode = false;
@@ -2773,6 +2788,100 @@ EvaluableNodeReference Interpreter::InterpretNode_ENT_SORT(EvaluableNode *en, Ev
 	}
 }
 
+#ifdef MULTITHREAD_SUPPORT
+bool Interpreter::SortConcurrentlyWithCustomComparator(EvaluableNodeReference &list, EvaluableNode *function,
+	EvaluableNode::OrderedType &sorted, bool &side_effects)
+{
+	auto &list_ocn = list->GetOrderedChildNodesReference();
+	size_t num_elements = list_ocn.size();
+	if(num_elements < 2 * minConcurrentCustomSortBlockSize)
+		return false;
+
+	//the blocks depend only on the number of elements so that the comparisons made,
+	// and therefore the result, do not depend on the number of threads
+	constexpr size_t max_num_blocks = 64;
+	size_t num_blocks = std::min<size_t>(max_num_blocks, num_elements / minConcurrentCustomSortBlockSize);
+	std::vector<size_t> block_bounds(num_blocks + 1);
+	for(size_t i = 0; i <= num_blocks; i++)
+		block_bounds[i] = num_elements * i / num_blocks;
+
+	//each sort or merge of blocks uses a random stream determined by its round and position rather than
+	// by the interpreter that runs it, and this interpreter's stream is advanced the same however they are run
+	RandomStream sort_random_stream = randomStream.CreateOtherStreamViaRand();
+	RandomStream random_stream_after_sort = randomStream;
+
+	//sort into a copy, because the list may be modified by the comparisons
+	sorted = list_ocn;
+	EvaluableNode::OrderedType buffer(num_elements);
+	EvaluableNode::OrderedType *source = &sorted;
+	EvaluableNode::OrderedType *destination = &buffer;
+
+	std::atomic_bool any_side_effects = false;
+
+	//the first round sorts each block, each later round merges pairs of adjacent blocks
+	auto sort_or_merge_blocks = [function, &source, &destination, &block_bounds, &any_side_effects, &sort_random_stream]
+		(Interpreter &interpreter, size_t round, size_t num_blocks, size_t i)
+		{
+			interpreter.randomStream = sort_random_stream.CreateSubstream(round * max_num_blocks + i);
+
+			//list is not used as the target because its attributes cannot be updated concurrently
+			CustomEvaluableNodeComparator comparator(&interpreter, function, _null_reference);
+			if(round == 0)
+				CustomEvaluableNodeOrderedChildNodesSort(*source, block_bounds[i], block_bounds[i + 1], comparator);
+			else if(2 * i + 1 < num_blocks)
+				CustomEvaluableNodeOrderedChildNodesMerge(*source, block_bounds[2 * i], block_bounds[2 * i + 1],
+					block_bounds[2 * i + 2], *destination, comparator);
+			else
+				std::copy(begin(*source) + block_bounds[2 * i], end(*source), begin(*destination) + block_bounds[2 * i]);
+
+			if(comparator.DidAnyComparisonHaveExecutionSideEffects())
+				any_side_effects = true;
+		};
+
+	for(size_t round = 0; round == 0 || num_blocks > 1; round++)
+	{
+		size_t num_tasks = (round == 0 ? num_blocks : (num_blocks + 1) / 2);
+
+		auto enqueue_task_lock = Concurrency::threadPool.AcquireTaskLock();
+		if(Concurrency::threadPool.AreThreadsAvailable())
+		{
+			InterpreterConcurrencyManager concurrency_manager(this, num_tasks, enqueue_task_lock);
+			for(size_t i = 0; i < num_tasks; i++)
+			{
+				concurrency_manager.EnqueueTaskWithInterpreter(
+					[&sort_or_merge_blocks, round, num_blocks, i](Interpreter &interpreter)
+					{
+						sort_or_merge_blocks(interpreter, round, num_blocks, i);
+					});
+			}
+			concurrency_manager.EndConcurrency();
+		}
+		else //run the same sorts and merges on this thread so the result is the same
+		{
+			enqueue_task_lock.unlock();
+			for(size_t i = 0; i < num_tasks; i++)
+				sort_or_merge_blocks(*this, round, num_blocks, i);
+		}
+
+		if(round == 0)
+			continue;
+
+		for(size_t i = 0; i < num_tasks; i++)
+			block_bounds[i] = block_bounds[2 * i];
+		num_blocks = num_tasks;
+		block_bounds[num_blocks] = num_elements;
+		std::swap(source, destination);
+	}
+
+	if(source != &sorted)
+		sorted.swap(buffer);
+
+	randomStream = random_stream_after_sort;
+	side_effects = any_side_effects;
+	return true;
+}
+#endif
+
 static OpcodeInitializer _ENT_CURRENT_INDEX(ENT_CURRENT_INDEX, &Interpreter::InterpretNode_ENT_CURRENT_INDEX, []() {
 	OpcodeDetails d;
 	d.parameters = OpcodeDetails::ParameterSchema{
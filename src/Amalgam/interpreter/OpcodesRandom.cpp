@@ -4,6 +4,9 @@
 
 static std::string _opcode_group = "Random";
 
+//minimum number of values generated by each block when rand generates a list of numbers concurrently
+constexpr size_t minRandValuesPerBlock = 16384;
+
 static OpcodeInitializer _ENT_RAND(ENT_RAND, &Interpreter::InterpretNode_ENT_RAND, []() {
 	OpcodeDetails d;
 	d.parameters = OpcodeDetails::ParameterSchema{
@@ -12,7 +15,8 @@ static OpcodeInitializer _ENT_RAND(ENT_RAND, &Interpreter::InterpretNode_ENT_RAN
 		OpcodeDetails::ParameterGroup({"unique", OpcodeDetails::DataType::BOOL, true})
 	};
 	d.returns = OpcodeDetails::DataType::ANY_BASIC;
-	d.description = R"(Generates random values based on the parameters.  The random values are drawn from a random stream specific to each execution flow for each entity.  When `range` is not specified, it evaluates to a random number between 0.0 and 1.0.  If `range` is a list, it will uniformly randomly choose and evaluate to one element of the list.  If `range` is a number, it will evaluate to a value greater than or equal to zero and less than the number specified.  If `range` is an assoc, then it will randomly evaluate to one of the keys using the values as the weights for the probabilities.  If  `number_to_generate` is specified, it will generate a list of multiple values (even if `number_to_generate` is 1).  If `unique` is true (it defaults to false), then it will only return unique values, the same as selecting from the list or assoc without replacement.  Note that the `unique` parameter only applies when `range` is a list or assoc.  If `unique` is true and there are not enough values in a list or assoc, it will only generate the number of elements in `range`.)";
+	d.allowsConcurrency = true;
+	d.description = R"(Generates random values based on the parameters.  The random values are drawn from a random stream specific to each execution flow for each entity.  When `range` is not specified, it evaluates to a random number between 0.0 and 1.0.  If `range` is a list, it will uniformly randomly choose and evaluate to one element of the list.  If `range` is a number, it will evaluate to a value greater than or equal to zero and less than the number specified.  If `range` is an assoc, then it will randomly evaluate to one of the keys using the values as the weights for the probabilities.  If  `number_to_generate` is specified, it will generate a list of multiple values (even if `number_to_generate` is 1).  If `unique` is true (it defaults to false), then it will only return unique values, the same as selecting from the list or assoc without replacement.  Note that the `unique` parameter only applies when `range` is a list or assoc.  If `unique` is true and there are not enough values in a list or assoc, it will only generate the number of elements in `range`.  If `range` is null or a number and `||` is specified, large lists are generated concurrently with the same values as if they were generated serially.)";
 	d.examples = MakeAmalgamExamples({
 		{R"&((rand))&", R"(0.4153759082605256)"},
 		{R"&((rand 50))&", R"(20.768795413026282)"},
@@ -382,6 +386,43 @@ EvaluableNodeReference Interpreter::InterpretNode_ENT_RAND(EvaluableNode *en, Ev
 		return retval;
 	}
 
+	//numbers are generated in bulk, in blocks that can be generated concurrently, where each block's stream starts
+	// where it would be if the values were generated serially so that the values do not depend on the number of threads
+	if(EvaluableNode::IsNull(param) || DoesEvaluableNodeTypeUseNumberData(param->GetType()))
+	{
+		double range = (EvaluableNode::IsNull(param) ? 1.0 : param->GetNumberValueReference());
+		evaluableNodeManager->FreeNodeTreeIfPossible(param);
+
+		std::vector<double> values(number_to_generate);
+		size_t num_blocks = 1;
+	#ifdef MULTITHREAD_SUPPORT
+		if(en->GetConcurrency())
+			num_blocks = std::max<size_t>(1, std::min(Concurrency::GetMaxNumThreads(), number_to_generate / minRandValuesPerBlock));
+	#endif
+		std::vector<size_t> block_indices(num_blocks);
+		for(size_t i = 0; i < num_blocks; i++)
+			block_indices[i] = i;
+
+		IterateOverConcurrentlyIfPossible(block_indices,
+			[this, &values, num_blocks](size_t, size_t block_index)
+			{
+				size_t start_index = values.size() * block_index / num_blocks;
+				size_t end_index = values.size() * (block_index + 1) / num_blocks;
+				RandomStream block_stream(randomStream);
+				block_stream.Advance(start_index * RandomStream::numValuesPerRandFull);
+				block_stream.FillRandFull(values.data() + start_index, end_index - start_index);
+			}, num_blocks > 1);
+		randomStream.Advance(number_to_generate * RandomStream::numValuesPerRandFull);
+
+		EvaluableNodeReference retval(evaluableNodeManager->AllocNode(ENT_LIST), true);
+		auto &retval_ocn = retval->GetOrderedChildNodesReference();
+		retval_ocn.resize(number_to_generate);
+		for(size_t i = 0; i < number_to_generate; i++)
+			retval_ocn[i] = evaluableNodeManager->AllocNode(values[i] * range);
+
+		return retval;
+	}
+
 	//want to generate multiple values, so return a list
 	EvaluableNodeReference retval(evaluableNodeManager->AllocNode(ENT_LIST), true);
 
@@ -1,6 +1,7 @@
 //project headers:
 #include "Interpreter.h"
 #include "OpcodeDetails.h"
+#include "RegexCache.h"
 
 //system headers:
 #include <regex>
@@ -195,38 +196,34 @@ EvaluableNodeReference Interpreter::InterpretNode_ENT_SPLIT(EvaluableNode *en, E
 	//if stride is 0, then use regex
 	if(stride == 0)
 	{
-		//use nosubs to prevent unnecessary memory allocations since this is just matching
-		std::regex rx;
-		try
-		{
-			rx.assign(split_value, std::regex::ECMAScript | std::regex::nosubs);
-		}
-		catch(...)
-		{
+		auto rx = RegexCache::GetCompiledRegex(split_value);
+		if(!rx->IsValid())
 			return retval;
-		}
-
-		//-1 argument indicates splitting rather than matching
-		std::sregex_token_iterator iter(begin(string_to_split), end(string_to_split), rx, -1);
-		std::sregex_token_iterator rx_end;
 
-		//split the string
+		//split the string on each match, with the same segments as std::sregex_token_iterator with -1
+		std::string_view to_split(string_to_split);
 		size_t num_split = 0;
-		for(; iter != rx_end && num_split < max_split_count; ++iter, num_split++)
-		{
-			std::string value = *iter;
-			retval->AppendOrderedChildNode(evaluableNodeManager->AllocNode(ENT_STRING, value));
-		}
+		size_t segment_start = 0;
+		bool ran_out_of_split_count = false;
+		rx->ForEachMatch(to_split, [&](size_t match_start, size_t match_end)
+			{
+				if(num_split >= max_split_count)
+				{
+					ran_out_of_split_count = true;
+					return false;
+				}
 
-		//ran out of split count, need to include the last bit
-		if(num_split == max_split_count && iter != rx_end)
-		{
-			//determine offset of the beginning of the leftover part of the string not matched
-			//do this separately because it's nontrivial to get types to match
-			auto pos = (*iter).first - begin(string_to_split);
-			std::string value(begin(string_to_split) + pos, end(string_to_split));
-			retval->AppendOrderedChildNode(evaluableNodeManager->AllocNode(ENT_STRING, value));
-		}
+				retval->AppendOrderedChildNode(evaluableNodeManager->AllocNode(
+					to_split.substr(segment_start, match_start - segment_start)));
+				num_split++;
+				segment_start = match_end;
+				return true;
+			});
+
+		//include the remainder, which, if ran out of split count, is the leftover part of the string not matched,
+		// and if there were no matches, is the whole string even if empty
+		if(ran_out_of_split_count || segment_start < to_split.size() || num_split == 0)
+			retval->AppendOrderedChildNode(evaluableNodeManager->AllocNode(to_split.substr(segment_start)));
 	}
 	else //not regex
 	{
@@ -463,9 +460,8 @@ EvaluableNodeReference Interpreter::InterpretNode_ENT_SUBSTR(EvaluableNode *en,
 	}
 	else if(substr_node->GetType() == ENT_STRING)
 	{
-		//make a copy of the string so the node can be freed
-		//(if this is a performance cost found in profiling, it can be fixed with more logic)
-		auto regex_str = substr_node->GetStringView();
+		//look up the compiled regex before the node can be freed
+		auto compiled_rx = RegexCache::GetCompiledRegex(substr_node->GetStringView());
 		evaluableNodeManager->FreeNodeTreeIfPossible(substr_node);
 
 		if(replace_string)
@@ -479,16 +475,13 @@ EvaluableNodeReference Interpreter::InterpretNode_ENT_SUBSTR(EvaluableNode *en,
 					max_match_count = max_match_count_value;
 			}
 
-			std::regex rx;
-			try
-			{
-				rx.assign(regex_str.data(), regex_str.data() + regex_str.size(), std::regex::ECMAScript);
-			}
-			catch(...)
+			const std::regex *rx_ptr = compiled_rx->GetRegexWithSubmatches();
+			if(rx_ptr == nullptr)
 			{
 				//bad regex, so nothing was replaced, just return original
 				return AllocReturn(string_to_substr, immediate_result);
 			}
+			const std::regex &rx = *rx_ptr;
 
 			std::string updated_string;
 			if(max_match_count == std::numeric_limits<double>::infinity())
@@ -572,56 +565,31 @@ EvaluableNodeReference Interpreter::InterpretNode_ENT_SUBSTR(EvaluableNode *en,
 
 			if(first_match_only)
 			{
-				//find first match, don't need submatches
-				std::regex rx;
-				try
-				{
-					rx.assign(regex_str.data(), regex_str.data() + regex_str.size(),
-						std::regex::ECMAScript | std::regex::nosubs);
-				}
-				catch(...)
-				{
-					//bad regex, return same as not found
+				//find first match, don't need submatches; a bad regex returns the same as not found
+				size_t match_start = 0, match_end = 0;
+				if(!compiled_rx->FindFirstMatch(string_to_substr, match_start, match_end))
 					return AllocReturn(string_intern_pool.NOT_A_STRING_ID, immediate_result);
-				}
 
-				std::sregex_token_iterator iter(begin(string_to_substr), end(string_to_substr), rx);
-				std::sregex_token_iterator rx_end;
-				if(iter == rx_end)
-				{
-					//not found
-					return AllocReturn(string_intern_pool.NOT_A_STRING_ID, immediate_result);
-				}
-				else
-				{
-					std::string value = *iter;
-					return AllocReturn(value, immediate_result);
-				}
+				std::string value = string_to_substr.substr(match_start, match_end - match_start);
+				return AllocReturn(value, immediate_result);
 			}
 			else if(full_matches)
 			{
 				EvaluableNodeReference retval(evaluableNodeManager->AllocNode(ENT_LIST), true);
 
 				//find all the matches, don't need submatches
-				std::regex rx;
-				try
-				{
-					rx.assign(regex_str.data(), regex_str.data() + regex_str.size(),
-						std::regex::ECMAScript | std::regex::nosubs);
-				}
-				catch(...)
-				{
-					return retval;
-				}
-
+				std::string_view to_match(string_to_substr);
 				size_t num_split = 0;
-				std::sregex_token_iterator iter(begin(string_to_substr), end(string_to_substr), rx);
-				std::sregex_token_iterator rx_end;
-				for(; iter != rx_end && num_split < max_match_count; ++iter, num_split++)
-				{
-					std::string value = *iter;
-					retval->AppendOrderedChildNode(evaluableNodeManager->AllocNode(ENT_STRING, value));
-				}
+				compiled_rx->ForEachMatch(to_match, [&](size_t match_start, size_t match_end)
+					{
+						if(num_split >= max_match_count)
+							return false;
+
+						retval->AppendOrderedChildNode(evaluableNodeManager->AllocNode(
+							to_match.substr(match_start, match_end - match_start)));
+						num_split++;
+						return true;
+					});
 
 				return retval;
 			}
@@ -629,17 +597,11 @@ EvaluableNodeReference Interpreter::InterpretNode_ENT_SUBSTR(EvaluableNode *en,
 			{
 				EvaluableNodeReference retval(evaluableNodeManager->AllocNode(ENT_LIST), true);
 
-				std::regex rx;
-				try
-				{
-					rx.assign(regex_str.data(), regex_str.data() + regex_str.size(), std::regex::ECMAScript);
-				}
-				catch(...)
-				{
+				const std::regex *rx = compiled_rx->GetRegexWithSubmatches();
+				if(rx == nullptr)
 					return retval;
-				}
 
-				std::sregex_iterator iter(begin(string_to_substr), end(string_to_substr), rx);
+				std::sregex_iterator iter(begin(string_to_substr), end(string_to_substr), *rx);
 				std::sregex_iterator rx_end;
 
 				//find all the matches
@@ -1599,7 +1599,7 @@ static OpcodeInitializer _ENT_FORMAT(ENT_FORMAT, &Interpreter::InterpretNode_ENT
 		OpcodeDetails::ParameterGroup({"to_params", OpcodeDetails::DataType::ASSOC, true})
 	};
 	d.returns = OpcodeDetails::DataType::ANY_BASIC;
-	d.description = R"(Converts data from `from_format` into `to_format`.  Supported language types are "number", "string", and "code", where code represents everything beyond number and string.  Beyond the supported language types, additional formats that are stored in a binary string.  The additional formats are "base16", "base64", "int8", "uint8", "int16", "uint16", "int32", "uint32", "int64", "uint64", "float32", "float64", ">int8", ">uint8", ">int16", ">uint16", ">int32", ">uint32", ">int64", ">uint64", ">float32", ">float64", "<int8", "<uint8", "<int16", "<uint16", "<int32", "<uint32", "<int64", "<uint64", "<float32", "<float64", "json", "yaml", "date", and "time" (though date and time are special cases).  Binary types starting with a "<" represent little endian, binary types starting with a ">" represent big endian, and binary types without either will be the endianness of the machine.  Binary types will be handled as strings.  The "date" type requires additional information.  Following "date" or "time" is a colon, followed by a standard strftime date or time format string.  If `from_params` or `to_params` are specified, then it will apply the appropriate from or to as appropriate.  If the format is either "string", "json", or "yaml", then the key "sort_keys" can be used to specify a boolean value, if true, then it will sort the keys, otherwise the default behavior is to emit the keys based on memory layout.  If the format is date or time, then the to or from params can be an assoc with "locale" as an optional key.  If date then "time_zone" is also allowed.  The locale is provided, then it will leverage operating system support to apply appropriate formatting, such as en_US.  Note that UTF-8 is assumed and automatically added to the locale.  If no locale is specified, then the default will be used.  If converting to or from dates, if "time_zone" is specified, it will use the standard time_zone name, if unspecified or empty string, it will assume the current time zone.)";
+	d.description = R"(Converts data from `from_format` into `to_format`.  Supported language types are "number", "string", and "code", where code represents everything beyond number and string.  Beyond the supported language types, additional formats that are stored in a binary string.  The additional formats are "base16", "base64", "int8", "uint8", "int16", "uint16", "int32", "uint32", "int64", "uint64", "float32", "float64", ">int8", ">uint8", ">int16", ">uint16", ">int32", ">uint32", ">int64", ">uint64", ">float32", ">float64", "<int8", "<uint8", "<int16", "<uint16", "<int32", "<uint32", "<int64", "<uint64", "<float32", "<float64", "json", "yaml", "date", and "time" (though date and time are special cases).  Binary types starting with a "<" represent little endian, binary types starting with a ">" represent big endian, and binary types without either will be the endianness of the machine.  Binary types will be handled as strings.  The "date" type requires additional information.  Following "date" or "time" is a colon, followed by a standard strftime date or time format string.  If `from_params` or `to_params` are specified, then it will apply the appropriate from or to as appropriate.  If the format is either "string", "json", or "yaml", then the key "sort_keys" can be used to specify a boolean value, if true, then it will sort the keys, otherwise the default behavior is to emit the keys based on memory layout.  If the format is date or time, then the to or from params can be an assoc with "locale" as an optional key.  If date then "time_zone" is also allowed.  The locale is provided, then it will leverage operating system support to apply appropriate formatting, such as en_US.  Note that UTF-8 is assumed and automatically added to the locale.  If no locale is specified, then the default will be used.  If converting to or from dates, if "time_zone" is specified, it will use the standard time_zone name, if unspecified or empty string, it will assume the current time zone.  If either format is date or time and the other format is number, string, date, or time, then `from_params` may contain the key "batch" with a value of true, in which case `data` is treated as a list of values and a list of each of the values converted is returned, reusing the same compiled format for every value.  Each value is converted exactly as it would be on its own, and if `data` is not a list, it is converted as a single value.)";
 	d.examples = MakeAmalgamExamples({
 		{R"&((map
 	(lambda
@@ -1773,7 +1773,19 @@ static OpcodeInitializer _ENT_FORMAT(ENT_FORMAT, &Interpreter::InterpretNode_ENT
 			{R"&((format 37364.33 "number" "time:%I:%M:%S%p"))&", R"("10:22:44.3300000AM")", R"("10:22:44.330+AM")" },
 			{R"&((format 0 "number" "time:%I:%M:%S%p"))&", R"("12:00:00AM")"},
 			{R"&((format .null "number" "time:%I:%M:%S%p"))&", R"("12:00:00AM")"},
-			{R"&((format .infinity "number" "time:%I:%M:%S%p"))&", R"("12:00:00AM")"}
+			{R"&((format .infinity "number" "time:%I:%M:%S%p"))&", R"("12:00:00AM")"},
+			{R"&((format
+	[48164 0 37364]
+	"number"
+	"time:%I:%M:%S%p"
+	{batch .true}
+))&", R"(["01:22:44PM" "12:00:00AM" "10:22:44AM"])"},
+			{R"&((format
+	["13:22:44" "10:22:44"]
+	"time:%H:%M:%S"
+	"number"
+	{batch .true}
+))&", R"([48164 37364])"}
 		});
 	d.valueNewness = OpcodeDetails::OpcodeReturnNewnessType::NEW;
 	d.frequencyPer10000Opcodes = 2.0;
@@ -1799,16 +1811,80 @@ EvaluableNodeReference Interpreter::InterpretNode_ENT_FORMAT(EvaluableNode *en,
 	to_type.SetIDWithReferenceHandoff(InterpretNodeIntoStringIDValueWithReference(ocn[2]));
 
 	auto node_stack = CreateOpcodeStackStateSaver();
-	bool node_stack_needs_popping = false;
 
 	EvaluableNodeReference from_params = EvaluableNodeReference::Null();
 	if(ocn.size() > 3)
 	{
 		from_params = InterpretNodeForImmediateUse(ocn[3]);
 		node_stack.PushEvaluableNode(from_params);
-		node_stack_needs_popping = true;
 	}
 
+	//batches are only supported for conversions between numbers, strings, dates, and times,
+	// where the format plan is reused across all of the values
+	bool batch = false;
+	if(EvaluableNode::IsAssociativeArray(from_params))
+	{
+		auto &mcn = from_params->GetMappedChildNodesReference();
+		EvaluableNode::GetValueFromMappedChildNodesReference(mcn, ENBISI_batch, batch);
+	}
+
+	if(batch)
+	{
+		const std::string date_string("date:");
+		const std::string time_string("time:");
+		auto from_type_str = string_intern_pool.GetStringViewFromID(from_type);
+		auto to_type_str = string_intern_pool.GetStringViewFromID(to_type);
+		bool from_date_or_time = (from_type_str.compare(0, date_string.size(), date_string) == 0
+			|| from_type_str.compare(0, time_string.size(), time_string) == 0);
+		bool to_date_or_time = (to_type_str.compare(0, date_string.size(), date_string) == 0
+			|| to_type_str.compare(0, time_string.size(), time_string) == 0);
+
+		batch = ((from_date_or_time || to_date_or_time)
+			&& (from_date_or_time || from_type == GetStringIdFromNodeType(ENT_NUMBER) || from_type == GetStringIdFromNodeType(ENT_STRING))
+			&& (to_date_or_time || to_type == GetStringIdFromNodeType(ENT_NUMBER) || to_type == GetStringIdFromNodeType(ENT_STRING)));
+	}
+
+	auto value = InterpretNodeForImmediateUse(ocn[0]);
+	node_stack.PushEvaluableNode(value);
+
+	EvaluableNodeReference to_params = EvaluableNodeReference::Null();
+	if(ocn.size() > 4)
+	{
+		to_params = InterpretNodeForImmediateUse(ocn[4]);
+		node_stack.PushEvaluableNode(to_params);
+	}
+
+	EvaluableNodeReference result;
+	if(batch && value != nullptr && value->IsOrderedArray())
+	{
+		//convert each value exactly as it would be converted on its own
+		result = EvaluableNodeReference(evaluableNodeManager->AllocNode(ENT_LIST), true);
+		auto &values_ocn = value->GetOrderedChildNodesReference();
+		auto &result_ocn = result->GetOrderedChildNodesReference();
+		result_ocn.reserve(values_ocn.size());
+		for(auto element : values_ocn)
+			result_ocn.push_back(ConvertValueFormat(EvaluableNodeReference(element, false),
+				from_type, to_type, from_params, to_params, EvaluableNodeRequestedValueTypes()));
+
+		evaluableNodeManager->FreeNodeTreeIfPossible(value);
+	}
+	else
+	{
+		result = ConvertValueFormat(value, from_type, to_type, from_params, to_params, immediate_result);
+	}
+
+	evaluableNodeManager->FreeNodeTreeIfPossible(to_params);
+	evaluableNodeManager->FreeNodeTreeIfPossible(from_params);
+	return result;
+}
+
+EvaluableNodeReference Interpreter::ConvertValueFormat(EvaluableNodeReference value,
+	StringInternPool::StringID from_type, StringInternPool::StringID to_type,
+	EvaluableNode *from_params, EvaluableNode *to_params, EvaluableNodeRequestedValueTypes immediate_result)
+{
+	const std::string date_string("date:");
+	const std::string time_string("time:");
+
 	bool use_code = false;
 	EvaluableNodeReference code_value = EvaluableNodeReference::Null();
 
@@ -1825,24 +1901,25 @@ EvaluableNodeReference Interpreter::InterpretNode_ENT_FORMAT(EvaluableNode *en,
 	std::string string_value = "";
 	bool valid_string_value = true;
 
-	const std::string date_string("date:");
-	const std::string time_string("time:");
-
 	static constexpr bool big_endian = (std::endian::native == std::endian::big);
 
 	if(from_type == GetStringIdFromNodeType(ENT_NUMBER))
 	{
 		use_number = true;
-		number_value = InterpretNodeIntoNumberValue(ocn[0]);
+		number_value = value.GetValue().GetValueAsNumber();
+		evaluableNodeManager->FreeNodeTreeIfPossible(value);
 	}
 	else if(from_type == GetStringIdFromBuiltInStringId(ENBISI_code))
 	{
 		use_code = true;
-		code_value = InterpretNodeForImmediateUse(ocn[0]);
+		code_value = value;
 	}
 	else //base on string type
 	{
-		string_value = InterpretNodeIntoStringValueEmptyNull(ocn[0]);
+		auto [valid_value_string, value_string] = value.GetValue().GetValueAsString();
+		if(valid_value_string)
+			string_value = std::move(value_string);
+		evaluableNodeManager->FreeNodeTreeIfPossible(value);
 
 		if(from_type == GetStringIdFromNodeType(ENT_STRING))
 		{
@@ -2081,15 +2158,6 @@ EvaluableNodeReference Interpreter::InterpretNode_ENT_FORMAT(EvaluableNode *en,
 		}
 	}
 
-	//have everything from from_type, so no longer need the reference
-	if(node_stack_needs_popping)
-		node_stack.PopEvaluableNode();
-	evaluableNodeManager->FreeNodeTreeIfPossible(from_params);
-
-	EvaluableNodeReference to_params = EvaluableNodeReference::Null();
-	if(ocn.size() > 4)
-		to_params = InterpretNodeForImmediateUse(ocn[4]);
-
 	//convert
 	if(to_type == GetStringIdFromNodeType(ENT_NUMBER))
 	{
@@ -2107,13 +2175,11 @@ EvaluableNodeReference Interpreter::InterpretNode_ENT_FORMAT(EvaluableNode *en,
 		else if(use_code)
 			number_value = EvaluableNode::ToNumber(code_value);
 
-		evaluableNodeManager->FreeNodeTreeIfPossible(to_params);
 		evaluableNodeManager->FreeNodeTreeIfPossible(code_value);
 		return AllocReturn(number_value, immediate_result);
 	}
 	else if(to_type == GetStringIdFromBuiltInStringId(ENBISI_code))
 	{
-		evaluableNodeManager->FreeNodeTreeIfPossible(to_params);
 		return code_value;
 	}
 	else if(to_type == GetStringIdFromNodeType(ENT_STRING))
@@ -2430,7 +2496,6 @@ EvaluableNodeReference Interpreter::InterpretNode_ENT_FORMAT(EvaluableNode *en,
 		}
 	}
 
-	evaluableNodeManager->FreeNodeTreeIfPossible(to_params);
 	evaluableNodeManager->FreeNodeTreeIfPossible(code_value);
 	if(!valid_string_value)
 		return AllocReturn(string_intern_pool.NOT_A_STRING_ID, immediate_result);
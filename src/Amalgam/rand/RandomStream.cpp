@@ -131,21 +131,46 @@ RandomStream RandomStream::CreateOtherStreamViaRand()
 	return new_stream;
 }
 
-uint32_t RandomStream::RandUInt32()
+RandomStream RandomStream::CreateSubstream(uint64_t index) const
 {
-	//perform PCG random number generation
-	//based on this: www.pcg-random.org/download.html
-	uint64_t multiplier_64 = 6364136223846793005ULL;
-	uint64_t old_value = state;
-	state = old_value * multiplier_64 + (increment | 1);
-
-	//DXSM permutation: double xor shift multiply
-	uint32_t hi = static_cast<uint32_t>(state >> 32);
-	uint32_t lo = static_cast<uint32_t>(state | 1);
-	hi ^= hi >> 16;
-	uint32_t multiplier_32 = 747796405U;
-	hi *= multiplier_32;
-	hi ^= hi >> 24;
-	hi *= lo;
-	return hi;
+	//splitmix64 finalizer to decorrelate nearby indices
+	auto mix = [](uint64_t x)
+	{
+		x += 0x9E3779B97F4A7C15ULL;
+		x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+		x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+		return x ^ (x >> 31);
+	};
+
+	//streams with different increments produce different sequences, so derive both from the index
+	RandomStream new_stream;
+	uint64_t index_hash = mix(index);
+	new_stream.state = mix(state ^ index_hash);
+	new_stream.increment = mix(increment + index_hash);
+	new_stream.BurnIn();
+
+	return new_stream;
+}
+
+void RandomStream::Advance(uint64_t num_values)
+{
+	//jump ahead by composing the affine step of the generator with itself by repeated squaring, per
+	// Brown, F. "Random Number Generation with Arbitrary Stride." Transactions of the American Nuclear Society (1994)
+	uint64_t cur_multiplier = lcgMultiplier;
+	uint64_t cur_increment = (increment | 1);
+	uint64_t accumulated_multiplier = 1;
+	uint64_t accumulated_increment = 0;
+	while(num_values > 0)
+	{
+		if(num_values & 1)
+		{
+			accumulated_multiplier *= cur_multiplier;
+			accumulated_increment = accumulated_increment * cur_multiplier + cur_increment;
+		}
+		cur_increment = (cur_multiplier + 1) * cur_increment;
+		cur_multiplier *= cur_multiplier;
+		num_values >>= 1;
+	}
+
+	state = accumulated_multiplier * state + accumulated_increment;
 }
@@ -42,6 +42,14 @@ public:
 	//consumes random numbers from the stream to create a new RandomStream
 	RandomStream CreateOtherStreamViaRand();
 
+	//returns a RandomStream determined only by this stream's current state and index, without consuming
+	// any random numbers, so that independent streams can be created for any index in any order,
+	// such as one per concurrent task, and yield the same values regardless of which thread uses them
+	RandomStream CreateSubstream(uint64_t index) const;
+
+	//advances the stream as if num_values calls to RandUInt32 had been made, in time logarithmic in num_values
+	void Advance(uint64_t num_values);
+
 	//returns a value in the range [0.0,1.0) with 32 bits of randomness
 	inline double Rand()
 	{
@@ -56,7 +64,27 @@ public:
 	}
 
 	//returns a uint32_t random number
-	uint32_t RandUInt32();
+	inline uint32_t RandUInt32()
+	{
+		return PcgStep(state, increment);
+	}
+
+	//fills values with num_values numbers in the range [0.0,1.0), the same as calling RandFull for each
+	// but keeping the state local while generating
+	inline void FillRandFull(double *values, size_t num_values)
+	{
+		uint64_t cur_state = state;
+		for(size_t i = 0; i < num_values; i++)
+		{
+			uint64_t high = PcgStep(cur_state, increment);
+			uint64_t combined = (high << 32) | PcgStep(cur_state, increment);
+			values[i] = std::ldexp(static_cast<double>(combined & ((static_cast<uint64_t>(1) << 53) - 1)), -53);
+		}
+		state = cur_state;
+	}
+
+	//number of RandUInt32 values consumed by each call to RandFull, for use with Advance
+	static constexpr uint64_t numValuesPerRandFull = 2;
 
 	inline size_t RandSize(size_t max_size)
 	{
@@ -81,6 +109,25 @@ public:
 	static constexpr size_t randStateStringifiedSizeInBytes = (sizeof(int64_t) * 2 + 1);
 
 protected:
+	//multiplier of the underlying linear congruential generator
+	static constexpr uint64_t lcgMultiplier = 6364136223846793005ULL;
+
+	//advances cur_state by one step of the generator with increment and returns the permuted output
+	//based on this: www.pcg-random.org/download.html
+	static __forceinline uint32_t PcgStep(uint64_t &cur_state, uint64_t increment)
+	{
+		cur_state = cur_state * lcgMultiplier + (increment | 1);
+
+		//DXSM permutation: double xor shift multiply
+		uint32_t hi = static_cast<uint32_t>(cur_state >> 32);
+		uint32_t lo = static_cast<uint32_t>(cur_state | 1);
+		hi ^= hi >> 16;
+		uint32_t multiplier_32 = 747796405U;
+		hi *= multiplier_32;
+		hi ^= hi >> 24;
+		hi *= lo;
+		return hi;
+	}
 
 	//based on the published literature, burns through the minimum number of random numbers
 	// to make sure the subsequent stream is good
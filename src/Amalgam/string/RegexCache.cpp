@@ -0,0 +1,979 @@
+//project headers:
+#include "RegexCache.h"
+
+//system headers:
+#include <limits>
+
+namespace
+{
+	//maximum number of instructions before the pattern is left to std::regex, which bounds
+	// the memory and time of expanding counted repetition
+	constexpr size_t maxProgramSize = 10000;
+
+	constexpr uint32_t unboundedRepetition = std::numeric_limits<uint32_t>::max();
+
+	//same classification as std::regex_traits<char> in the classic locale
+	inline bool IsDigitByte(uint8_t c)
+	{
+		return c >= '0' && c <= '9';
+	}
+
+	inline bool IsWordByte(uint8_t c)
+	{
+		return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || IsDigitByte(c) || c == '_';
+	}
+
+	inline bool IsSpaceByte(uint8_t c)
+	{
+		return c == ' ' || (c >= '\t' && c <= '\r');
+	}
+
+	inline int HexDigitValue(char c)
+	{
+		if(c >= '0' && c <= '9')
+			return c - '0';
+		if(c >= 'a' && c <= 'f')
+			return c - 'a' + 10;
+		if(c >= 'A' && c <= 'F')
+			return c - 'A' + 10;
+		return -1;
+	}
+
+	//node of the parsed pattern
+	struct RegexNode
+	{
+		enum class Type
+		{
+			EMPTY,
+			BYTE,
+			ANY_BUT_NEWLINE,
+			CLASS,
+			CONCAT,
+			ALTERNATE,
+			REPEAT,
+			ASSERT_BEGIN,
+			ASSERT_END,
+			ASSERT_WORD_BOUNDARY,
+			ASSERT_NOT_WORD_BOUNDARY
+		};
+
+		Type type = Type::EMPTY;
+		uint8_t byte = 0;
+		std::bitset<256> characterClass;
+		uint32_t minRepeat = 0;
+		uint32_t maxRepeat = 0;
+		bool greedy = true;
+		std::vector<std::unique_ptr<RegexNode>> children;
+
+		//returns true if the node can match the empty string
+		bool IsNullable() const
+		{
+			switch(type)
+			{
+			case Type::BYTE:
+			case Type::ANY_BUT_NEWLINE:
+			case Type::CLASS:
+				return false;
+			case Type::CONCAT:
+				for(auto &child : children)
+				{
+					if(!child->IsNullable())
+						return false;
+				}
+				return true;
+			case Type::ALTERNATE:
+				for(auto &child : children)
+				{
+					if(child->IsNullable())
+						return true;
+				}
+				return false;
+			case Type::REPEAT:
+				return minRepeat == 0 || children[0]->IsNullable();
+			default:
+				return true;
+			}
+		}
+
+		//returns true if the node is an assertion, which cannot be quantified
+		bool IsAssertion() const
+		{
+			return type == Type::ASSERT_BEGIN || type == Type::ASSERT_END
+				|| type == Type::ASSERT_WORD_BOUNDARY || type == Type::ASSERT_NOT_WORD_BOUNDARY;
+		}
+	};
+
+	//recursive descent parser for the supported subset of ECMAScript regular expressions
+	//any construct outside of the subset, and any syntax error, causes parsing to fail so that
+	// std::regex can either handle the pattern or report it as invalid
+	class RegexSubsetParser
+	{
+	public:
+		RegexSubsetParser(std::string_view _pattern)
+			: pattern(_pattern), pos(0)
+		{}
+
+		std::unique_ptr<RegexNode> Parse()
+		{
+			auto node = ParseAlternation();
+			if(node == nullptr || pos != pattern.size())
+				return nullptr;
+			return node;
+		}
+
+	protected:
+		inline bool AtEnd() const
+		{
+			return pos >= pattern.size();
+		}
+
+		inline char Peek() const
+		{
+			return pattern[pos];
+		}
+
+		std::unique_ptr<RegexNode> ParseAlternation()
+		{
+			auto first = ParseConcatenation();
+			if(first == nullptr)
+				return nullptr;
+
+			if(AtEnd() || Peek() != '|')
+				return first;
+
+			auto alternation = std::make_unique<RegexNode>();
+			alternation->type = RegexNode::Type::ALTERNATE;
+			alternation->children.emplace_back(std::move(first));
+			while(!AtEnd() && Peek() == '|')
+			{
+				pos++;
+				auto next = ParseConcatenation();
+				if(next == nullptr)
+					return nullptr;
+				alternation->children.emplace_back(std::move(next));
+			}
+			return alternation;
+		}
+
+		std::unique_ptr<RegexNode> ParseConcatenation()
+		{
+			auto concat = std::make_unique<RegexNode>();
+			concat->type = RegexNode::Type::CONCAT;
+			while(!AtEnd() && Peek() != '|' && Peek() != ')')
+			{
+				auto term = ParseTerm();
+				if(term == nullptr)
+					return nullptr;
+				concat->children.emplace_back(std::move(term));
+			}
+			return concat;
+		}
+
+		std::unique_ptr<RegexNode> ParseTerm()
+		{
+			auto atom = ParseAtom();
+			if(atom == nullptr || AtEnd())
+				return atom;
+
+			uint32_t min_repeat = 0, max_repeat = 0;
+			char c = Peek();
+			if(c == '*')
+			{
+				max_repeat = unboundedRepetition;
+				pos++;
+			}
+			else if(c == '+')
+			{
+				min_repeat = 1;
+				max_repeat = unboundedRepetition;
+				pos++;
+			}
+			else if(c == '?')
+			{
+				max_repeat = 1;
+				pos++;
+			}
+			else if(c == '{')
+			{
+				pos++;
+				if(!ParseCount(min_repeat))
+					return nullptr;
+				max_repeat = min_repeat;
+				if(!AtEnd() && Peek() == ',')
+				{
+					pos++;
+					max_repeat = unboundedRepetition;
+					if(!AtEnd() && Peek() != '}' && !ParseCount(max_repeat))
+						return nullptr;
+				}
+				if(AtEnd() || Peek() != '}' || min_repeat > max_repeat)
+					return nullptr;
+				pos++;
+			}
+			else
+			{
+				return atom;
+			}
+
+			if(atom->IsAssertion())
+				return nullptr;
+
+			bool greedy = true;
+			if(!AtEnd() && Peek() == '?')
+			{
+				greedy = false;
+				pos++;
+			}
+
+			//disallow stacked quantifiers
+			if(!AtEnd() && (Peek() == '*' || Peek() == '+' || Peek() == '?' || Peek() == '{'))
+				return nullptr;
+
+			//a loop around something that can match empty has ECMAScript-specific semantics that
+			// differ from a simple automaton, so leave it to std::regex
+			if(max_repeat == unboundedRepetition && atom->IsNullable())
+				return nullptr;
+
+			auto repeat = std::make_unique<RegexNode>();
+			repeat->type = RegexNode::Type::REPEAT;
+			repeat->minRepeat = min_repeat;
+			repeat->maxRepeat = max_repeat;
+			repeat->greedy = greedy;
+			repeat->children.emplace_back(std::move(atom));
+			return repeat;
+		}
+
+		bool ParseCount(uint32_t &count)
+		{
+			size_t start = pos;
+			uint64_t value = 0;
+			while(!AtEnd() && IsDigitByte(static_cast<uint8_t>(Peek())))
+			{
+				value = value * 10 + (Peek() - '0');
+				if(value > maxProgramSize)
+					return false;
+				pos++;
+			}
+			count = static_cast<uint32_t>(value);
+			return pos > start;
+		}
+
+		std::unique_ptr<RegexNode> ParseAtom()
+		{
+			auto node = std::make_unique<RegexNode>();
+			char c = Peek();
+			switch(c)
+			{
+			case '(':
+			{
+				pos++;
+				if(!AtEnd() && Peek() == '?')
+				{
+					//only non-capturing groups are supported, not lookahead
+					if(pos + 1 >= pattern.size() || pattern[pos + 1] != ':')
+						return nullptr;
+					pos += 2;
+				}
+				auto group = ParseAlternation();
+				if(group == nullptr || AtEnd() || Peek() != ')')
+					return nullptr;
+				pos++;
+				return group;
+			}
+
+			case '[':
+				pos++;
+				if(!ParseClass(node->characterClass))
+					return nullptr;
+				node->type = RegexNode::Type::CLASS;
+				return node;
+
+			case '.':
+				pos++;
+				node->type = RegexNode::Type::ANY_BUT_NEWLINE;
+				return node;
+
+			case '^':
+				pos++;
+				node->type = RegexNode::Type::ASSERT_BEGIN;
+				return node;
+
+			case '$':
+				pos++;
+				node->type = RegexNode::Type::ASSERT_END;
+				return node;
+
+			case '\\':
+			{
+				pos++;
+				if(AtEnd())
+					return nullptr;
+
+				char e = Peek();
+				if(e == 'b' || e == 'B')
+				{
+					pos++;
+					node->type = (e == 'b' ? RegexNode::Type::ASSERT_WORD_BOUNDARY : RegexNode::Type::ASSERT_NOT_WORD_BOUNDARY);
+					return node;
+				}
+
+				bool is_class = false;
+				if(!ParseEscape(node->characterClass, node->byte, is_class))
+					return nullptr;
+				node->type = (is_class ? RegexNode::Type::CLASS : RegexNode::Type::BYTE);
+				return node;
+			}
+
+			case '*': case '+': case '?': case '{': case '}': case ']': case ')': case '|':
+				return nullptr;
+
+			default:
+				pos++;
+				node->type = RegexNode::Type::BYTE;
+				node->byte = static_cast<uint8_t>(c);
+				return node;
+			}
+		}
+
+		//parses the escape after the backslash, either setting byte or, if is_class is set to true, character_class
+		bool ParseEscape(std::bitset<256> &character_class, uint8_t &byte, bool &is_class)
+		{
+			char e = Peek();
+			pos++;
+			is_class = false;
+			switch(e)
+			{
+			case 'd': case 'D': case 'w': case 'W': case 's': case 'S':
+			{
+				is_class = true;
+				for(size_t i = 0; i < 256; i++)
+				{
+					uint8_t b = static_cast<uint8_t>(i);
+					bool in_class = (e == 'd' || e == 'D') ? IsDigitByte(b) : ((e == 'w' || e == 'W') ? IsWordByte(b) : IsSpaceByte(b));
+					if(e == 'D' || e == 'W' || e == 'S')
+						in_class = !in_class;
+					if(in_class)
+						character_class.set(i);
+				}
+				return true;
+			}
+
+			case 't': byte = '\t'; return true;
+			case 'n': byte = '\n'; return true;
+			case 'v': byte = '\v'; return true;
+			case 'f': byte = '\f'; return true;
+			case 'r': byte = '\r'; return true;
+
+			case '0':
+				//octal escapes and backreferences are left to std::regex
+				if(!AtEnd() && IsDigitByte(static_cast<uint8_t>(Peek())))
+					return false;
+				byte = 0;
+				return true;
+
+			case 'x':
+			{
+				if(pos + 2 > pattern.size())
+					return false;
+				int high = HexDigitValue(pattern[pos]);
+				int low = HexDigitValue(pattern[pos + 1]);
+				if(high < 0 || low < 0)
+					return false;
+				pos += 2;
+				byte = static_cast<uint8_t>(high * 16 + low);
+				return true;
+			}
+
+			default:
+				//other letters and digits, including backreferences, are left to std::regex
+				if(IsWordByte(static_cast<uint8_t>(e)))
+					return false;
+
+				byte = static_cast<uint8_t>(e);
+				return true;
+			}
+		}
+
+		//parses a bracketed character class after the opening bracket
+		bool ParseClass(std::bitset<256> &character_class)
+		{
+			bool negate = false;
+			if(!AtEnd() && Peek() == '^')
+			{
+				negate = true;
+				pos++;
+			}
+
+			//an empty class has special meaning, leave it to std::regex
+			if(AtEnd() || Peek() == ']')
+				return false;
+
+			while(!AtEnd() && Peek() != ']')
+			{
+				std::bitset<256> item_class;
+				uint8_t low = 0;
+				bool is_class = false;
+				if(!ParseClassAtom(item_class, low, is_class))
+					return false;
+
+				if(is_class)
+				{
+					character_class |= item_class;
+					continue;
+				}
+
+				//see if it's a range
+				if(pos + 1 < pattern.size() && Peek() == '-' && pattern[pos + 1] != ']')
+				{
+					pos++;
+					uint8_t high = 0;
+					if(!ParseClassAtom(item_class, high, is_class) || is_class)
+						return false;
+
+					//ranges of bytes beyond ascii depend on the signedness of char in std::regex
+					if(low > high || high >= 0x80)
+						return false;
+
+					for(size_t i = low; i <= high; i++)
+						character_class.set(i);
+				}
+				else
+				{
+					character_class.set(low);
+				}
+			}
+
+			if(AtEnd())
+				return false;
+			pos++;
+
+			if(negate)
+				character_class.flip();
+			return true;
+		}
+
+		bool ParseClassAtom(std::bitset<256> &character_class, uint8_t &byte, bool &is_class)
+		{
+			if(AtEnd())
+				return false;
+
+			char c = Peek();
+			//bracket expressions such as [:alpha:] are left to std::regex
+			if(c == '[')
+				return false;
+
+			if(c == '\\')
+			{
+				pos++;
+				//\b means backspace within a class, leave to std::regex
+				if(AtEnd() || Peek() == 'b' || Peek() == 'B')
+					return false;
+				return ParseEscape(character_class, byte, is_class);
+			}
+
+			pos++;
+			is_class = false;
+			byte = static_cast<uint8_t>(c);
+			return true;
+		}
+
+		std::string_view pattern;
+		size_t pos;
+	};
+
+	//generates automaton instructions from parsed nodes
+	class RegexProgramBuilder
+	{
+	public:
+		template<typename InstructionType, typename OpType>
+		static bool Emit(RegexNode *node, std::vector<InstructionType> &program,
+			std::vector<std::bitset<256>> &character_classes)
+		{
+			if(program.size() > maxProgramSize)
+				return false;
+
+			auto append = [&program](OpType op, uint8_t byte = 0, uint32_t x = 0, uint32_t y = 0)
+			{
+				program.push_back(InstructionType{ op, byte, x, y });
+				return static_cast<uint32_t>(program.size() - 1);
+			};
+
+			switch(node->type)
+			{
+			case RegexNode::Type::EMPTY:
+				return true;
+
+			case RegexNode::Type::BYTE:
+				append(OpType::MATCH_BYTE, node->byte);
+				return true;
+
+			case RegexNode::Type::ANY_BUT_NEWLINE:
+				append(OpType::MATCH_ANY_BUT_NEWLINE);
+				return true;
+
+			case RegexNode::Type::CLASS:
+				character_classes.push_back(node->characterClass);
+				append(OpType::MATCH_CLASS, 0, static_cast<uint32_t>(character_classes.size() - 1));
+				return true;
+
+			case RegexNode::Type::ASSERT_BEGIN:
+				append(OpType::ASSERT_BEGIN);
+				return true;
+
+			case RegexNode::Type::ASSERT_END:
+				append(OpType::ASSERT_END);
+				return true;
+
+			case RegexNode::Type::ASSERT_WORD_BOUNDARY:
+				append(OpType::ASSERT_WORD_BOUNDARY);
+				return true;
+
+			case RegexNode::Type::ASSERT_NOT_WORD_BOUNDARY:
+				append(OpType::ASSERT_NOT_WORD_BOUNDARY);
+				return true;
+
+			case RegexNode::Type::CONCAT:
+				for(auto &child : node->children)
+				{
+					if(!Emit<InstructionType, OpType>(child.get(), program, character_classes))
+						return false;
+				}
+				return true;
+
+			case RegexNode::Type::ALTERNATE:
+			{
+				//each alternative but the last is preceded by a split preferring it, and followed by a jump to the end
+				std::vector<uint32_t> jumps_to_end;
+				for(size_t i = 0; i < node->children.size(); i++)
+				{
+					uint32_t split = 0;
+					bool is_last = (i + 1 == node->children.size());
+					if(!is_last)
+						split = append(OpType::SPLIT, 0, static_cast<uint32_t>(program.size() + 1));
+
+					if(!Emit<InstructionType, OpType>(node->children[i].get(), program, character_classes))
+						return false;
+
+					if(!is_last)
+					{
+						jumps_to_end.push_back(append(OpType::JUMP));
+						program[split].y = static_cast<uint32_t>(program.size());
+					}
+				}
+
+				for(auto jump : jumps_to_end)
+					program[jump].x = static_cast<uint32_t>(program.size());
+				return true;
+			}
+
+			case RegexNode::Type::REPEAT:
+			{
+				RegexNode *child = node->children[0].get();
+				for(uint32_t i = 0; i < node->minRepeat; i++)
+				{
+					if(!Emit<InstructionType, OpType>(child, program, character_classes))
+						return false;
+				}
+
+				if(node->maxRepeat == unboundedRepetition)
+				{
+					uint32_t split = append(OpType::SPLIT);
+					if(!Emit<InstructionType, OpType>(child, program, character_classes))
+						return false;
+					append(OpType::JUMP, 0, split);
+					SetSplitTargets(program[split], split + 1, static_cast<uint32_t>(program.size()), node->greedy);
+					return true;
+				}
+
+				//each optional repetition may skip to the end
+				std::vector<uint32_t> splits;
+				for(uint32_t i = node->minRepeat; i < node->maxRepeat; i++)
+				{
+					uint32_t split = append(OpType::SPLIT);
+					splits.push_back(split);
+					if(!Emit<InstructionType, OpType>(child, program, character_classes))
+						return false;
+				}
+
+				for(auto split : splits)
+					SetSplitTargets(program[split], split + 1, static_cast<uint32_t>(program.size()), node->greedy);
+				return true;
+			}
+			}
+
+			return false;
+		}
+
+	protected:
+		template<typename InstructionType>
+		static inline void SetSplitTargets(InstructionType &split, uint32_t body, uint32_t skip, bool greedy)
+		{
+			split.x = greedy ? body : skip;
+			split.y = greedy ? skip : body;
+		}
+	};
+
+	//reusable per-thread buffers for simulating automata
+	struct AutomatonThreadList
+	{
+		//pairs of instruction index and the offset where the thread's match started
+		std::vector<std::pair<uint32_t, size_t>> threads;
+		//generation stamp per instruction to deduplicate threads
+		std::vector<size_t> onListGeneration;
+		size_t generation = 0;
+
+		inline void Reset(size_t program_size)
+		{
+			threads.clear();
+			if(onListGeneration.size() < program_size)
+				onListGeneration.resize(program_size, 0);
+			generation++;
+		}
+	};
+
+#if defined(MULTITHREAD_SUPPORT)
+	thread_local
+#endif
+	AutomatonThreadList currentThreads, nextThreads;
+
+#if defined(MULTITHREAD_SUPPORT)
+	thread_local
+#endif
+	std::vector<uint32_t> addThreadStack;
+}
+
+CompiledRegex::CompiledRegex(std::string_view pattern)
+	: patternString(pattern), valid(true), isLiteral(false)
+{
+	//detect literal patterns, which can be searched for directly
+	isLiteral = true;
+	for(char c : pattern)
+	{
+		switch(c)
+		{
+		case '\\': case '^': case '$': case '.': case '|': case '?': case '*': case '+':
+		case '(': case ')': case '[': case ']': case '{': case '}':
+			isLiteral = false;
+			break;
+		default:
+			break;
+		}
+
+		if(!isLiteral)
+			break;
+	}
+
+	if(isLiteral)
+		literal = patternString;
+
+	if(CompileLinear(pattern))
+		return;
+
+	isLiteral = false;
+	try
+	{
+		fallbackRegex = std::make_unique<std::regex>(patternString, std::regex::ECMAScript | std::regex::nosubs);
+	}
+	catch(...)
+	{
+		//backreferences are rejected without submatches, so try again with them
+		try
+		{
+			fallbackRegex = std::make_unique<std::regex>(patternString, std::regex::ECMAScript);
+		}
+		catch(...)
+		{
+			valid = false;
+		}
+	}
+}
+
+bool CompiledRegex::CompileLinear(std::string_view pattern)
+{
+	RegexSubsetParser parser(pattern);
+	auto root = parser.Parse();
+	if(root == nullptr)
+		return false;
+
+	if(!RegexProgramBuilder::Emit<Instruction, OpType>(root.get(), program, characterClasses)
+		|| program.size() >= maxProgramSize)
+	{
+		program.clear();
+		characterClasses.clear();
+		return false;
+	}
+
+	program.push_back(Instruction{ OpType::MATCH, 0, 0, 0 });
+	return true;
+}
+
+bool CompiledRegex::FullMatch(std::string_view s) const
+{
+	if(!valid)
+		return false;
+
+	if(isLiteral)
+		return s == literal;
+
+	if(IsLinear())
+	{
+		size_t match_start = 0, match_end = 0;
+		return RunAutomaton(s, 0, false, true, false, true, match_start, match_end);
+	}
+
+	return std::regex_match(s.data(), s.data() + s.size(), *fallbackRegex);
+}
+
+bool CompiledRegex::FindFirstMatch(std::string_view s, size_t &match_start, size_t &match_end) const
+{
+	if(!valid)
+		return false;
+
+	return Search(s, 0, false, false, false, match_start, match_end);
+}
+
+const std::regex *CompiledRegex::GetRegexWithSubmatches()
+{
+	if(!valid)
+		return nullptr;
+
+	std::call_once(regexWithSubmatchesOnce, [this]()
+		{
+			try
+			{
+				regexWithSubmatches = std::make_unique<std::regex>(patternString, std::regex::ECMAScript);
+			}
+			catch(...)
+			{
+				regexWithSubmatches = nullptr;
+			}
+		});
+
+	return regexWithSubmatches.get();
+}
+
+bool CompiledRegex::Search(std::string_view s, size_t start, bool not_null, bool continuous, bool prev_avail,
+	size_t &match_start, size_t &match_end) const
+{
+	if(isLiteral && !literal.empty())
+	{
+		size_t found = continuous ? (s.compare(start, literal.size(), literal) == 0 ? start : std::string_view::npos)
+			: s.find(literal, start);
+		if(found == std::string_view::npos)
+			return false;
+		match_start = found;
+		match_end = found + literal.size();
+		return true;
+	}
+
+	if(IsLinear())
+		return RunAutomaton(s, start, not_null, continuous, prev_avail, false, match_start, match_end);
+
+	auto flags = std::regex_constants::match_default;
+	if(not_null)
+		flags |= std::regex_constants::match_not_null;
+	if(continuous)
+		flags |= std::regex_constants::match_continuous;
+	if(prev_avail)
+		flags |= std::regex_constants::match_prev_avail;
+
+	std::cmatch match;
+	if(!std::regex_search(s.data() + start, s.data() + s.size(), match, *fallbackRegex, flags))
+		return false;
+
+	match_start = static_cast<size_t>(match[0].first - s.data());
+	match_end = static_cast<size_t>(match[0].second - s.data());
+	return true;
+}
+
+bool CompiledRegex::RunAutomaton(std::string_view s, size_t start, bool not_null, bool continuous, bool prev_avail, bool full_match,
+	size_t &match_start, size_t &match_end) const
+{
+	const size_t len = s.size();
+	const auto *data = reinterpret_cast<const uint8_t *>(s.data());
+
+	//follows all empty transitions from pc at pos in priority order, adding consuming and match instructions to list
+	auto add_thread = [this, data, len, start, prev_avail](AutomatonThreadList &list, uint32_t initial_pc, size_t pos, size_t thread_start)
+	{
+		addThreadStack.clear();
+		addThreadStack.push_back(initial_pc);
+		while(!addThreadStack.empty())
+		{
+			uint32_t pc = addThreadStack.back();
+			addThreadStack.pop_back();
+
+			if(list.onListGeneration[pc] == list.generation)
+				continue;
+			list.onListGeneration[pc] = list.generation;
+
+			const Instruction &inst = program[pc];
+			switch(inst.op)
+			{
+			case OpType::JUMP:
+				addThreadStack.push_back(inst.x);
+				break;
+
+			case OpType::SPLIT:
+				//push the lower priority target first so the higher priority one is followed first
+				addThreadStack.push_back(inst.y);
+				addThreadStack.push_back(inst.x);
+				break;
+
+			case OpType::ASSERT_BEGIN:
+				if(pos == start && !prev_avail)
+					addThreadStack.push_back(pc + 1);
+				break;
+
+			case OpType::ASSERT_END:
+				if(pos == len)
+					addThreadStack.push_back(pc + 1);
+				break;
+
+			case OpType::ASSERT_WORD_BOUNDARY:
+			case OpType::ASSERT_NOT_WORD_BOUNDARY:
+			{
+				bool left_is_word = (pos > 0 && (pos != start || prev_avail) && IsWordByte(data[pos - 1]));
+				bool right_is_word = (pos < len && IsWordByte(data[pos]));
+				bool is_boundary = (left_is_word != right_is_word);
+				if(is_boundary == (inst.op == OpType::ASSERT_WORD_BOUNDARY))
+					addThreadStack.push_back(pc + 1);
+				break;
+			}
+
+			default:
+				list.threads.emplace_back(pc, thread_start);
+				break;
+			}
+		}
+	};
+
+	AutomatonThreadList *cur_list = &currentThreads;
+	AutomatonThreadList *next_list = &nextThreads;
+	cur_list->Reset(program.size());
+
+	bool matched = false;
+	for(size_t pos = start; pos <= len; pos++)
+	{
+		//start a new lowest priority thread at this position if still searching
+		if(!matched && (pos == start || !continuous))
+			add_thread(*cur_list, 0, pos, pos);
+
+		if(cur_list->threads.empty())
+		{
+			if(matched || continuous)
+				break;
+
+			//clear the instructions visited at this position before trying the next
+			cur_list->Reset(program.size());
+			continue;
+		}
+
+		next_list->Reset(program.size());
+		for(auto [pc, thread_start] : cur_list->threads)
+		{
+			const Instruction &inst = program[pc];
+			bool advance = false;
+			bool accepted = false;
+			switch(inst.op)
+			{
+			case OpType::MATCH:
+				if(not_null && thread_start == pos)
+					break;
+				if(full_match && pos != len)
+					break;
+
+				accepted = true;
+				matched = true;
+				match_start = thread_start;
+				match_end = pos;
+				break;
+
+			case OpType::MATCH_BYTE:
+				advance = (pos < len && data[pos] == inst.byte);
+				break;
+
+			case OpType::MATCH_ANY_BUT_NEWLINE:
+				advance = (pos < len && data[pos] != '\n' && data[pos] != '\r');
+				break;
+
+			case OpType::MATCH_CLASS:
+				advance = (pos < len && characterClasses[inst.x].test(data[pos]));
+				break;
+
+			default:
+				break;
+			}
+
+			//a match cuts off all lower priority threads
+			if(accepted)
+				break;
+
+			if(advance)
+				add_thread(*next_list, pc + 1, pos + 1, thread_start);
+		}
+
+		std::swap(cur_list, next_list);
+		if(pos == len)
+			break;
+	}
+
+	return matched;
+}
+
+std::array<RegexCache::CacheEntry, RegexCache::maxCachedPatterns> RegexCache::cacheEntries;
+
+std::shared_ptr<CompiledRegex> RegexCache::GetCompiledRegex(std::string_view pattern)
+{
+	std::string key(pattern);
+
+	{
+	#if defined(MULTITHREAD_SUPPORT)
+		Concurrency::ReadLock lock(compiledRegexesMutex);
+	#endif
+		auto found = compiledRegexes.find(key);
+		if(found != end(compiledRegexes))
+		{
+			auto &entry = cacheEntries[found->second];
+			entry.referenced = true;
+			return entry.regex;
+		}
+	}
+
+	//compile outside of the lock, since it may be expensive
+	auto compiled = std::make_shared<CompiledRegex>(pattern);
+
+#if defined(MULTITHREAD_SUPPORT)
+	Concurrency::WriteLock lock(compiledRegexesMutex);
+#endif
+	//another thread may have cached it while compiling
+	auto found = compiledRegexes.find(key);
+	if(found != end(compiledRegexes))
+		return cacheEntries[found->second].regex;
+
+	size_t entry_index = numCacheEntries;
+	if(numCacheEntries < maxCachedPatterns)
+	{
+		numCacheEntries++;
+	}
+	else
+	{
+		//advance the hand past entries referenced since it last passed them, giving them another chance,
+		// which terminates because each entry passed is cleared
+		while(cacheEntries[clockHand].referenced)
+		{
+			cacheEntries[clockHand].referenced = false;
+			clockHand = (clockHand + 1) % maxCachedPatterns;
+		}
+
+		entry_index = clockHand;
+		clockHand = (clockHand + 1) % maxCachedPatterns;
+		compiledRegexes.erase(cacheEntries[entry_index].pattern);
+	}
+
+	auto &entry = cacheEntries[entry_index];
+	entry.pattern = key;
+	entry.regex = compiled;
+	entry.referenced = false;
+	compiledRegexes.emplace(std::move(key), entry_index);
+	return compiled;
+}
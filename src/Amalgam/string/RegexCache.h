@@ -0,0 +1,188 @@
+#pragma once
+
+//project headers:
+#include "HashMaps.h"
+
+#if defined(MULTITHREAD_SUPPORT)
+#include "Concurrency.h"
+#endif
+
+//system headers:
+#include <array>
+#include <atomic>
+#include <bitset>
+#include <memory>
+#include <mutex>
+#include <regex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+//a regular expression compiled once for repeated use across threads
+//patterns within the supported ECMAScript subset (literals, ., character classes, \d \w \s and their negations,
+// groups, non-capturing groups, alternation, greedy and lazy quantifiers including counted repetition, ^, $, \b, \B)
+// are compiled into an automaton that is simulated in time linear in the length of the input, so there is no
+// catastrophic backtracking; all other patterns, such as those with backreferences or lookahead, fall back to std::regex
+//matching is performed on bytes with the same semantics as std::regex using char and ECMAScript
+class CompiledRegex
+{
+public:
+	CompiledRegex(std::string_view pattern);
+
+	//returns true if the pattern is a valid regular expression
+	constexpr bool IsValid() const
+	{
+		return valid;
+	}
+
+	//returns true if the pattern is compiled to the linear time automaton
+	constexpr bool IsLinear() const
+	{
+		return !program.empty();
+	}
+
+	//returns true if the pattern matches all of s
+	bool FullMatch(std::string_view s) const;
+
+	//finds the first match in s, setting match_start and match_end to the offsets of the match
+	// returns false if no match is found
+	bool FindFirstMatch(std::string_view s, size_t &match_start, size_t &match_end) const;
+
+	//calls func(match_start, match_end) for each successive match in s, with the same semantics as
+	// std::regex_iterator including how empty matches are advanced past
+	//stops when func returns false
+	template<typename MatchFunction>
+	void ForEachMatch(std::string_view s, MatchFunction func) const
+	{
+		if(!valid)
+			return;
+
+		size_t match_start = 0, match_end = 0;
+		bool prev_avail = false;
+		bool found = Search(s, 0, false, false, prev_avail, match_start, match_end);
+		while(found)
+		{
+			if(!func(match_start, match_end))
+				return;
+
+			size_t start = match_end;
+			if(match_start == match_end)
+			{
+				if(start == s.size())
+					return;
+
+				//try for a nonempty match at the same position before advancing
+				if(Search(s, start, true, true, prev_avail, match_start, match_end))
+					continue;
+
+				start++;
+			}
+
+			prev_avail = true;
+			found = Search(s, start, false, false, prev_avail, match_start, match_end);
+		}
+	}
+
+	//returns a std::regex with submatches for replacing and retrieving submatches, compiling it on first use
+	//returns nullptr if the pattern is not valid
+	const std::regex *GetRegexWithSubmatches();
+
+protected:
+	//instructions of the automaton
+	enum class OpType : uint8_t
+	{
+		MATCH_BYTE,
+		MATCH_ANY_BUT_NEWLINE,
+		MATCH_CLASS,
+		SPLIT,
+		JUMP,
+		ASSERT_BEGIN,
+		ASSERT_END,
+		ASSERT_WORD_BOUNDARY,
+		ASSERT_NOT_WORD_BOUNDARY,
+		MATCH
+	};
+
+	struct Instruction
+	{
+		OpType op;
+		//the byte for MATCH_BYTE
+		uint8_t byte;
+		//index into characterClasses for MATCH_CLASS, first target for SPLIT and JUMP
+		uint32_t x;
+		//second, lower priority, target for SPLIT
+		uint32_t y;
+	};
+
+	//searches s starting at start using the automaton or fallback regex, with the semantics of the corresponding
+	// std::regex_constants::match_flag_type flags, setting match_start and match_end on success
+	bool Search(std::string_view s, size_t start, bool not_null, bool continuous, bool prev_avail,
+		size_t &match_start, size_t &match_end) const;
+
+	//simulates the automaton; if full_match is true, only matches ending at the end of s are accepted
+	bool RunAutomaton(std::string_view s, size_t start, bool not_null, bool continuous, bool prev_avail, bool full_match,
+		size_t &match_start, size_t &match_end) const;
+
+	//attempts to compile pattern into program, returns false if it is not within the supported subset
+	bool CompileLinear(std::string_view pattern);
+
+	//the original pattern
+	std::string patternString;
+
+	//true if the pattern is valid
+	bool valid;
+
+	//if the pattern is a literal string, then it is stored here and searched directly
+	bool isLiteral;
+	std::string literal;
+
+	//the automaton program, empty if the pattern is not supported
+	std::vector<Instruction> program;
+	std::vector<std::bitset<256>> characterClasses;
+
+	//fallback regex without submatches when the pattern is not supported by the automaton
+	std::unique_ptr<std::regex> fallbackRegex;
+
+	//regex with submatches, compiled on first use
+	std::unique_ptr<std::regex> regexWithSubmatches;
+	std::once_flag regexWithSubmatchesOnce;
+};
+
+//process-wide cache of compiled regular expressions keyed by pattern
+class RegexCache
+{
+public:
+	//returns the compiled regex for pattern, compiling and caching it if it has not been used recently
+	//the returned regex is never nullptr, but may not be valid
+	static std::shared_ptr<CompiledRegex> GetCompiledRegex(std::string_view pattern);
+
+protected:
+	//a cached pattern, marked as referenced whenever it is looked up
+	struct CacheEntry
+	{
+		std::string pattern;
+		std::shared_ptr<CompiledRegex> regex;
+	#if defined(MULTITHREAD_SUPPORT)
+		std::atomic<bool> referenced = false;
+	#else
+		bool referenced = false;
+	#endif
+	};
+
+	//maximum number of cached patterns, which bounds memory from dynamically generated patterns
+	static constexpr size_t maxCachedPatterns = 1024;
+
+	//once the cache is full, one entry is evicted per new pattern in clock order, skipping and clearing entries
+	// referenced since the hand last passed them, which approximates least recently used eviction
+	// without needing a write lock for lookups
+	static std::array<CacheEntry, maxCachedPatterns> cacheEntries;
+	static inline size_t numCacheEntries = 0;
+	static inline size_t clockHand = 0;
+
+	//index into cacheEntries of each cached pattern
+	static inline FastHashMap<std::string, size_t> compiledRegexes;
+
+#if defined(MULTITHREAD_SUPPORT)
+	static inline Concurrency::ReadWriteMutex compiledRegexesMutex;
+#endif
+};
@@ -525,6 +525,24 @@ public:
 		return in_use;
 	}
 
+	//returns the estimated number of bytes used by the string of id divided by the number of references to it,
+	// so that summing over every reference held by a container attributes to that container its share of the string memory
+	//inline strings are stored within the id itself and so return 0
+	static inline double GetEstimatedSizeInBytesPerReference(const StringID &id)
+	{
+		if(id == NOT_A_STRING_ID || id.IsInlineString())
+			return 0.0;
+
+		auto sd_ptr = id.GetPointer();
+		size_t ref_count = sd_ptr->refCount;
+		if(ref_count == 0)
+			return 0.0;
+
+		//the characters are stored both in the string data and as the key of stringToID
+		size_t string_size = sizeof(StringInternStringData) + sizeof(std::string) + 2 * sd_ptr->stringData.capacity();
+		return static_cast<double>(string_size) / ref_count;
+	}
+
 	//validates the string id, throwing an assert if it is not valid
 	inline void ValidateStringIdExistence(StringID sid)
 	{
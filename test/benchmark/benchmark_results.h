@@ -0,0 +1,113 @@
+#pragma once
+
+//Results shared by the benchmarks, written to and compared against json baselines in a common format
+//so that changes can be judged across runs and machines
+
+//project headers:
+#include "EvaluableNode.h"
+#include "EvaluableNodeManagement.h"
+#include "FileSupportJSON.h"
+
+//system headers:
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+//result of running a benchmark case
+struct BenchmarkResult
+{
+	std::string name;
+	double nsPerOp;
+	//nodes per op that were not freed immediately and are left for garbage collection
+	// negative if not measured
+	double nodesPerOp;
+};
+
+//writes results to the json file at path as an assoc of case name to measurements
+inline bool WriteResults(const std::string &path, std::vector<BenchmarkResult> &results)
+{
+	EvaluableNodeManager enm;
+	EvaluableNode *all_results = enm.AllocNode(ENT_ASSOC);
+	for(auto &result : results)
+	{
+		EvaluableNode *measurements = enm.AllocNode(ENT_ASSOC);
+		measurements->SetMappedChildNode("ns_per_op", enm.AllocNode(result.nsPerOp));
+		if(result.nodesPerOp >= 0.0)
+			measurements->SetMappedChildNode("nodes_per_op", enm.AllocNode(result.nodesPerOp));
+		all_results->SetMappedChildNode(result.name, measurements);
+	}
+
+	auto [json, valid] = EvaluableNodeJSONTranslation::EvaluableNodeToJson(all_results, true);
+	std::ofstream out(path);
+	if(!valid || !out.good())
+		return false;
+
+	out << json << std::endl;
+	return out.good();
+}
+
+//compares results against the json baseline at path, reporting every case that changed by more than threshold
+//returns the number of regressions, or -1 if the baseline could not be read
+inline int CompareResults(const std::string &path, std::vector<BenchmarkResult> &results, double threshold)
+{
+	std::ifstream in(path);
+	if(!in.good())
+		return -1;
+
+	std::stringstream buffer;
+	buffer << in.rdbuf();
+	std::string json = buffer.str();
+
+	EvaluableNodeManager enm;
+	EvaluableNode *baseline = EvaluableNodeJSONTranslation::JsonToEvaluableNode(&enm, json);
+	if(!EvaluableNode::IsAssociativeArray(baseline))
+		return -1;
+
+	int num_regressions = 0;
+	size_t num_compared = 0;
+	auto &baseline_mcn = baseline->GetMappedChildNodesReference();
+	std::printf("\n%-60s %12s %12s %8s %10s %10s\n", "comparison to baseline", "base ns/op", "ns/op", "ratio", "base nodes", "nodes");
+	for(auto &result : results)
+	{
+		auto found = baseline_mcn.find(string_intern_pool.GetIDFromString(result.name));
+		if(found == end(baseline_mcn) || !EvaluableNode::IsAssociativeArray(found->second))
+			continue;
+
+		num_compared++;
+		auto &measurements = found->second->GetMappedChildNodesReference();
+		auto get_measurement = [&measurements](const std::string &key)
+		{
+			auto found_measurement = measurements.find(string_intern_pool.GetIDFromString(key));
+			if(found_measurement == end(measurements))
+				return -1.0;
+			return EvaluableNode::ToNumber(found_measurement->second, -1.0);
+		};
+		double base_ns = get_measurement("ns_per_op");
+		double base_nodes = get_measurement("nodes_per_op");
+		bool nodes_measured = (base_nodes >= 0.0 && result.nodesPerOp >= 0.0);
+
+		double ratio = (base_ns > 0.0 ? result.nsPerOp / base_ns : 1.0);
+		const char *status = "";
+		if(ratio > 1.0 + threshold || (nodes_measured && result.nodesPerOp > base_nodes * (1.0 + threshold) + 0.5))
+		{
+			status = "REGRESSION";
+			num_regressions++;
+		}
+		else if(ratio < 1.0 - threshold)
+		{
+			status = "improved";
+		}
+		else //unchanged, only report differences
+		{
+			continue;
+		}
+
+		std::printf("%-60.60s %12.1f %12.1f %8.3f %10.1f %10.1f %s\n", result.name.c_str(),
+			base_ns, result.nsPerOp, ratio, base_nodes, result.nodesPerOp, status);
+	}
+
+	std::printf("%zu cases compared, %d regressions beyond %.0f%%\n", num_compared, num_regressions, 100 * threshold);
+	return num_regressions;
+}
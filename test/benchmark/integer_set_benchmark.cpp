@@ -0,0 +1,185 @@
+//Microbenchmarks for the integer set operations used when building and filtering queries
+//Each column is simulated as a map from value to the sorted set of entity indices with that value,
+// as SBFDSColumnData stores them, using several distributions of column cardinality
+#include "IntegerSet.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+//a simulated column: the indices of the entities with each distinct value, in value order
+struct SimulatedColumn
+{
+	std::string name;
+	std::vector<SortedIntegerSet> indicesWithValue;
+};
+
+//builds a column of num_entities where the value of each entity is drawn by value_of(entity_index)
+template<typename ValueFunction>
+static SimulatedColumn BuildColumn(std::string name, size_t num_entities, size_t num_values, ValueFunction value_of)
+{
+	SimulatedColumn column;
+	column.name = std::move(name);
+	column.indicesWithValue.resize(num_values);
+	for(size_t i = 0; i < num_entities; i++)
+		column.indicesWithValue[value_of(i)].InsertNewLargestInteger(i);
+
+	//remove values without entities
+	std::erase_if(column.indicesWithValue, [](SortedIntegerSet &sis) { return sis.size() == 0; });
+	return column;
+}
+
+//runs func repeatedly until at least min_seconds have elapsed and returns the mean time per call in microseconds
+template<typename Function>
+static double TimeMicroseconds(Function func, double min_seconds = 0.2)
+{
+	using clock = std::chrono::steady_clock;
+	size_t num_runs = 0;
+	auto start = clock::now();
+	double elapsed = 0.0;
+	do
+	{
+		func();
+		num_runs++;
+		elapsed = std::chrono::duration<double>(clock::now() - start).count();
+	} while(elapsed < min_seconds);
+
+	return 1e6 * elapsed / num_runs;
+}
+
+//prevents the optimizer from removing results
+static size_t checksum = 0;
+
+static void Report(const std::string &column_name, const char *operation, double microseconds)
+{
+	std::printf("%-28s %-36s %12.2f us\n", column_name.c_str(), operation, microseconds);
+}
+
+static void BenchmarkColumn(SimulatedColumn &column, size_t num_entities)
+{
+	auto &entries = column.indicesWithValue;
+	size_t num_values = entries.size();
+
+	//a between query over the middle tenth of the values, unioning into a bit array
+	Report(column.name, "union value range into bais", TimeMicroseconds([&]()
+		{
+			BitArrayIntegerSet out;
+			for(size_t v = num_values * 45 / 100; v < num_values * 55 / 100 + 1 && v < num_values; v++)
+				out.InsertInBatch(entries[v]);
+			checksum += out.size();
+		}));
+
+	//a between query over the middle tenth of the values, unioning sorted sets
+	Report(column.name, "union value range into sis", TimeMicroseconds([&]()
+		{
+			SortedIntegerSet out;
+			for(size_t v = num_values * 45 / 100; v < num_values * 55 / 100 + 1 && v < num_values; v++)
+				out.Union(entries[v]);
+			checksum += out.size();
+		}));
+
+	//the largest entry, as a prior filter, intersected with others of similar and smaller sizes
+	size_t largest = 0;
+	for(size_t v = 1; v < num_values; v++)
+	{
+		if(entries[v].size() > entries[largest].size())
+			largest = v;
+	}
+
+	std::mt19937_64 rng(0);
+	std::vector<size_t> other_values(64);
+	for(auto &v : other_values)
+		v = rng() % num_values;
+
+	Report(column.name, "intersect largest with others", TimeMicroseconds([&]()
+		{
+			for(auto v : other_values)
+			{
+				SortedIntegerSet result = entries[largest];
+				result.Intersect(entries[v]);
+				checksum += result.size();
+			}
+		}));
+
+	//a dense filter, such as the entities with any number, intersected with each value
+	BitArrayIntegerSet half;
+	for(size_t i = 0; i < num_entities; i += 2)
+		half.insert(i);
+
+	Report(column.name, "intersect others with bais", TimeMicroseconds([&]()
+		{
+			for(auto v : other_values)
+			{
+				SortedIntegerSet result = entries[v];
+				result.Intersect(half);
+				checksum += result.size();
+			}
+		}));
+
+	//conversion between forms, as EfficientIntegerSet does when density changes
+	Report(column.name, "convert largest sis to bais", TimeMicroseconds([&]()
+		{
+			BitArrayIntegerSet bais;
+			bais.InsertInBatch(entries[largest]);
+			checksum += bais.size();
+		}));
+
+	BitArrayIntegerSet largest_bais;
+	largest_bais.InsertInBatch(entries[largest]);
+	Report(column.name, "convert largest bais to sis", TimeMicroseconds([&]()
+		{
+			SortedIntegerSet sis;
+			sis.InsertNewSortedIntegers(largest_bais);
+			checksum += sis.size();
+		}));
+}
+
+int main(int argc, char **argv)
+{
+	size_t num_entities = 1000000;
+	if(argc > 1)
+		num_entities = std::stoull(argv[1]);
+
+	std::mt19937_64 rng(12345);
+	std::uniform_real_distribution<double> uniform(0.0, 1.0);
+
+	std::vector<SimulatedColumn> columns;
+
+	//continuous values, nearly every entity has its own value
+	columns.emplace_back(BuildColumn("unique", num_entities, num_entities,
+		[&](size_t) { return static_cast<size_t>(rng() % num_entities); }));
+
+	//a few categories with large sets of entities
+	columns.emplace_back(BuildColumn("10 categories", num_entities, 10,
+		[&](size_t) { return static_cast<size_t>(rng() % 10); }));
+
+	//moderate cardinality, such as an integer feature
+	columns.emplace_back(BuildColumn("1000 uniform values", num_entities, 1000,
+		[&](size_t) { return static_cast<size_t>(rng() % 1000); }));
+
+	//skewed cardinality, where a few values are very common and most are rare
+	size_t num_skewed_values = 10000;
+	columns.emplace_back(BuildColumn("10000 zipf-like values", num_entities, num_skewed_values,
+		[&](size_t)
+		{
+			double u = uniform(rng);
+			return std::min(num_skewed_values - 1, static_cast<size_t>(std::pow(static_cast<double>(num_skewed_values), u * u)) - 1);
+		}));
+
+	//values clustered by entity order, such as a time stamp
+	columns.emplace_back(BuildColumn("1000 clustered values", num_entities, 1000,
+		[&](size_t i) { return std::min<size_t>(999, i * 1000 / num_entities + rng() % 3); }));
+
+	std::printf("%zu entities\n", num_entities);
+	for(auto &column : columns)
+	{
+		std::printf("%s: %zu distinct values\n", column.name.c_str(), column.indicesWithValue.size());
+		BenchmarkColumn(column, num_entities);
+	}
+
+	std::printf("checksum %zu\n", checksum);
+	return 0;
+}
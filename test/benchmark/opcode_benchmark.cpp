@@ -0,0 +1,437 @@
+//Microbenchmarks for each opcode, generated from the metadata in OpcodeDetails
+//Each opcode's examples are run as benchmarks, and opcodes without side effects that do not require an entity
+// are also run on synthetic parameters generated from their parameter schemas at several sizes, where lists and
+// assocs have that many elements, strings are that many characters, and code parameters are trees with that many leaves
+//Times include the fixed cost of executing code on an entity, which is visible in the simplest cases,
+// but exclude any cleanup code and garbage collection between runs
+//Results can be written to a json baseline and later runs compared against it to flag regressions,
+// in which case the exit code is 1 if any case is slower or leaves more nodes than the threshold allows
+//
+//usage: amalgam-opcode-benchmark [--filter substring] [--sizes 10,100,1000] [--min-time seconds]
+//         [--examples-only] [--synthetic-only] [--json baseline_out.json] [--compare baseline.json] [--threshold fraction]
+#include "benchmark_results.h"
+#include "Entity.h"
+#include "EvaluableNode.h"
+#include "EvaluableNodeManagement.h"
+#include "OpcodeDetails.h"
+#include "Parser.h"
+
+#include <chrono>
+#include <cstdio>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+//a piece of code to run as a benchmark
+struct BenchmarkCase
+{
+	std::string name;
+	std::string code;
+	std::string cleanup;
+};
+
+//number of runs over which the nodes per op are averaged, skipping any runs that collected garbage
+constexpr size_t numNodeCountRuns = 64;
+
+//returns the string used for opcode t in code and reports
+static std::string OpcodeName(EvaluableNodeType t)
+{
+	return GetStringFromEvaluableNodeType(t, true);
+}
+
+//returns a string literal of length size
+static std::string SyntheticString(size_t size)
+{
+	std::string s = "\"";
+	for(size_t i = 0; i < size; i++)
+		s.push_back(static_cast<char>('a' + (i * 7) % 26));
+	s.push_back('"');
+	return s;
+}
+
+//returns a list literal of size numbers in a deterministic but unsorted order
+static std::string SyntheticNumberList(size_t size)
+{
+	std::string s = "[";
+	for(size_t i = 0; i < size; i++)
+	{
+		if(i > 0)
+			s.push_back(' ');
+		s.append(std::to_string((i * 7919) % size));
+	}
+	s.push_back(']');
+	return s;
+}
+
+//returns a list literal of size short strings
+static std::string SyntheticStringList(size_t size)
+{
+	std::string s = "[";
+	for(size_t i = 0; i < size; i++)
+	{
+		if(i > 0)
+			s.push_back(' ');
+		s.append("\"k" + std::to_string((i * 7919) % size) + "\"");
+	}
+	s.push_back(']');
+	return s;
+}
+
+//returns an assoc literal of size keys to numbers
+static std::string SyntheticAssoc(size_t size)
+{
+	std::string s = "{";
+	for(size_t i = 0; i < size; i++)
+	{
+		if(i > 0)
+			s.push_back(' ');
+		s.append("k" + std::to_string(i) + " " + std::to_string((i * 7919) % size));
+	}
+	s.push_back('}');
+	return s;
+}
+
+//returns a tree of nested lists with num_leaves numbers as leaves and a branching factor of 4,
+// so the depth of the tree grows with num_leaves
+static std::string SyntheticTree(size_t num_leaves)
+{
+	if(num_leaves <= 4)
+		return SyntheticNumberList(num_leaves);
+
+	std::string s = "[";
+	size_t remaining = num_leaves;
+	for(size_t i = 0; i < 4; i++)
+	{
+		size_t child_leaves = remaining / (4 - i);
+		remaining -= child_leaves;
+		if(i > 0)
+			s.push_back(' ');
+		s.append(SyntheticTree(child_leaves));
+	}
+	s.push_back(']');
+	return s;
+}
+
+//returns a literal of parameter type type with the given size along with a short description for the case name
+//returns an empty literal if the type cannot be synthesized without an entity, such as queries or entity ids
+static std::pair<std::string, std::string> SyntheticParameter(OpcodeDetails::DataType type, size_t size)
+{
+	using DataType = OpcodeDetails::DataType;
+	auto has_type = [type](DataType t) { return OpcodeDetails::AreDataTypesExactlyCompatible(type, t); };
+
+	//parameters that accept anything are treated as code
+	if((type & DataType::ANY_BASIC) == DataType::ANY_BASIC)
+		return { SyntheticTree(size), "tree[" + std::to_string(size) + "]" };
+
+	if(has_type(DataType::LIST_OF_NUMBERS) || has_type(DataType::LIST) || has_type(DataType::UNORDERED_LIST))
+		return { SyntheticNumberList(size), "list[" + std::to_string(size) + "]" };
+	if(has_type(DataType::LIST_OF_STRINGS))
+		return { SyntheticStringList(size), "strings[" + std::to_string(size) + "]" };
+	if(has_type(DataType::ASSOC) || has_type(DataType::ASSOC_OF_NUMBERS))
+		return { SyntheticAssoc(size), "assoc[" + std::to_string(size) + "]" };
+	if(has_type(DataType::STRING))
+		return { SyntheticString(size), "string[" + std::to_string(size) + "]" };
+	//keep numbers small, since they are often counts or indices
+	if(has_type(DataType::NUMBER) || has_type(DataType::WALK_PATH))
+		return { "3", "number" };
+	if(has_type(DataType::BOOL))
+		return { ".true", "bool" };
+	if(has_type(DataType::NULL_TYPE))
+		return { ".null", "null" };
+
+	return { "", "" };
+}
+
+//returns true if opcode t can be run on synthetic parameters without an entity, external resources,
+// or the possibility of not terminating
+static bool CanSynthesizeOpcode(EvaluableNodeType t)
+{
+	if(IsEvaluableNodeTypeTerminalNode(t) || t == ENT_LIST || t == ENT_ASSOC)
+		return false;
+
+	auto &details = _opcode_details[t];
+	if(details.hasSideEffects || details.requiresEntity || details.retrievesData || details.isQuery
+			|| details.permissions != ExecutionPermissions::Permission::NONE)
+		return false;
+
+	//control flow takes code that may loop or return rather than values
+	if(details.opcodeGroup == "Control Flow")
+		return false;
+
+	auto structure = details.parameters.childNodeStructure;
+	return structure != OpcodeDetails::ChildNodeStructureType::ASSOCIATIVE;
+}
+
+//appends the synthetic cases for opcode t at each of sizes to cases
+static void AddSyntheticCases(EvaluableNodeType t, const std::vector<size_t> &sizes, std::vector<BenchmarkCase> &cases)
+{
+	if(!CanSynthesizeOpcode(t))
+		return;
+
+	auto &details = _opcode_details[t];
+	bool paired = (details.parameters.childNodeStructure == OpcodeDetails::ChildNodeStructureType::PAIRED
+		|| details.parameters.childNodeStructure == OpcodeDetails::ChildNodeStructureType::ONE_POSITION_THEN_PAIRED);
+
+	//use each required parameter once, and repeat the last group so that repeating opcodes have at least two
+	std::vector<const OpcodeDetails::ParameterDetails *> parameters;
+	auto &groups = details.parameters.groups;
+	for(size_t i = 0; i < groups.size(); i++)
+	{
+		auto &group = groups[i];
+		size_t num_repeats = 1;
+		if(group.isRepeating && parameters.size() < 2)
+			num_repeats = 2 - parameters.size();
+		else if(group.parameter1.optional)
+			continue;
+
+		for(size_t r = 0; r < num_repeats; r++)
+		{
+			parameters.push_back(&group.parameter1);
+			if(paired && !group.parameter2.name.empty())
+				parameters.push_back(&group.parameter2);
+		}
+	}
+
+	std::string opcode_name = OpcodeName(t);
+	std::string previous_code;
+	for(size_t size : sizes)
+	{
+		std::string code = "(" + opcode_name;
+		std::string name = opcode_name;
+		for(auto parameter : parameters)
+		{
+			auto [literal, description] = SyntheticParameter(parameter->type, size);
+			if(literal.empty())
+				return;
+
+			code += " " + literal;
+			name += " " + description;
+		}
+		code += ")";
+
+		//parameters that do not scale produce the same code for every size
+		if(code == previous_code)
+			continue;
+		previous_code = code;
+
+		cases.push_back(BenchmarkCase{ name, code, "" });
+	}
+}
+
+//appends a case for each of the examples of opcode t to cases
+static void AddExampleCases(EvaluableNodeType t, std::vector<BenchmarkCase> &cases)
+{
+	auto &details = _opcode_details[t];
+	if(details.permissions != ExecutionPermissions::Permission::NONE)
+		return;
+
+	std::string opcode_name = OpcodeName(t);
+	for(size_t i = 0; i < details.examples.size(); i++)
+	{
+		auto &example = details.examples[i];
+		cases.push_back(BenchmarkCase{ opcode_name + " example " + std::to_string(i + 1),
+			std::string(example.example), std::string(example.cleanup) });
+	}
+}
+
+//runs code once on entity if not nullptr, freeing the result and running cleanup_code if not nullptr
+static void ExecuteCase(Entity *entity, EvaluableNode *code, EvaluableNode *cleanup_code)
+{
+	if(code != nullptr)
+	{
+		auto result = entity->ExecuteOnEntity(code, nullptr);
+		entity->evaluableNodeManager.FreeNodeTreeIfPossible(result);
+	}
+
+	if(cleanup_code != nullptr)
+	{
+		auto cleanup_result = entity->ExecuteOnEntity(cleanup_code, nullptr);
+		entity->evaluableNodeManager.FreeNodeTreeIfPossible(cleanup_result);
+	}
+
+	entity->CollectGarbageWithEntityWriteReference();
+}
+
+//runs benchmark_case until at least min_seconds have elapsed
+//returns the result, or an empty optional if the code could not be parsed
+static std::optional<BenchmarkResult> RunCase(BenchmarkCase &benchmark_case, double min_seconds)
+{
+	Entity *entity = new Entity();
+	auto &enm = entity->evaluableNodeManager;
+
+	auto [code, warnings, char_with_error, code_complete] = Parser::Parse(benchmark_case.code, &enm);
+	if(code == nullptr || warnings.size() > 0)
+	{
+		delete entity;
+		return std::nullopt;
+	}
+
+	EvaluableNode *cleanup_code = nullptr;
+	if(!benchmark_case.cleanup.empty())
+		cleanup_code = std::get<0>(Parser::Parse(benchmark_case.cleanup, &enm));
+
+	//keep the code and cleanup referenced by the entity's root so that they are not garbage collected
+	EvaluableNode *root = enm.AllocNode(ENT_LIST);
+	root->AppendOrderedChildNode(code);
+	if(cleanup_code != nullptr)
+		root->AppendOrderedChildNode(cleanup_code);
+	entity->SetRoot(EvaluableNodeReference(root, true), true);
+
+	//warm up caches and allocate memory the code will reuse
+	ExecuteCase(entity, code, cleanup_code);
+
+	//count the nodes that are not freed immediately and are left for garbage collection
+	//nodes are taken from the manager in blocks for each thread's local allocation buffer,
+	// so the count is averaged over several runs without collecting garbage
+	entity->ReclaimResources(false, true, false);
+	size_t total_nodes = 0;
+	size_t num_counted_runs = 0;
+	for(size_t i = 0; i < numNodeCountRuns; i++)
+	{
+		size_t nodes_before = enm.GetNumberOfUsedNodes();
+		auto result = entity->ExecuteOnEntity(code, nullptr);
+		enm.FreeNodeTreeIfPossible(result);
+		size_t nodes_after = enm.GetNumberOfUsedNodes();
+		//if garbage was collected during execution, the count is not meaningful for this run
+		if(nodes_after >= nodes_before)
+		{
+			total_nodes += nodes_after - nodes_before;
+			num_counted_runs++;
+		}
+
+		if(cleanup_code != nullptr)
+		{
+			auto cleanup_result = entity->ExecuteOnEntity(cleanup_code, nullptr);
+			enm.FreeNodeTreeIfPossible(cleanup_result);
+		}
+	}
+	entity->ReclaimResources(false, true, false);
+
+	//time each run individually so that cleanup and garbage collection are excluded from every case alike
+	using clock = std::chrono::steady_clock;
+	size_t num_runs = 0;
+	double elapsed = 0.0;
+	auto total_start = clock::now();
+	do
+	{
+		auto start = clock::now();
+		auto run_result = entity->ExecuteOnEntity(code, nullptr);
+		enm.FreeNodeTreeIfPossible(run_result);
+		elapsed += std::chrono::duration<double>(clock::now() - start).count();
+		num_runs++;
+
+		ExecuteCase(entity, nullptr, cleanup_code);
+	} while(std::chrono::duration<double>(clock::now() - total_start).count() < min_seconds);
+
+	delete entity;
+
+	double nodes_per_op = 0.0;
+	if(num_counted_runs > 0)
+		nodes_per_op = static_cast<double>(total_nodes) / num_counted_runs;
+
+	return BenchmarkResult{ benchmark_case.name, 1e9 * elapsed / num_runs, nodes_per_op };
+}
+
+//parses a comma separated list of sizes
+static std::vector<size_t> ParseSizes(const std::string &s)
+{
+	std::vector<size_t> sizes;
+	std::stringstream stream(s);
+	std::string size;
+	while(std::getline(stream, size, ','))
+	{
+		if(!size.empty())
+			sizes.push_back(std::stoull(size));
+	}
+	return sizes;
+}
+
+int main(int argc, char **argv)
+{
+	std::string filter;
+	std::vector<size_t> sizes = { 10, 100, 1000 };
+	double min_seconds = 0.1;
+	bool run_examples = true;
+	bool run_synthetic = true;
+	std::string json_out;
+	std::string compare_path;
+	double threshold = 0.1;
+
+	for(int i = 1; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		bool has_value = (i + 1 < argc);
+		if(arg == "--filter" && has_value)
+			filter = argv[++i];
+		else if(arg == "--sizes" && has_value)
+			sizes = ParseSizes(argv[++i]);
+		else if(arg == "--min-time" && has_value)
+			min_seconds = std::stod(argv[++i]);
+		else if(arg == "--examples-only")
+			run_synthetic = false;
+		else if(arg == "--synthetic-only")
+			run_examples = false;
+		else if(arg == "--json" && has_value)
+			json_out = argv[++i];
+		else if(arg == "--compare" && has_value)
+			compare_path = argv[++i];
+		else if(arg == "--threshold" && has_value)
+			threshold = std::stod(argv[++i]);
+		else
+		{
+			std::fprintf(stderr, "unknown or incomplete argument: %s\n", arg.c_str());
+			return 2;
+		}
+	}
+
+	std::vector<BenchmarkCase> cases;
+	for(size_t opcode_index = 0; opcode_index < NUM_VALID_ENT_OPCODES; opcode_index++)
+	{
+		auto t = static_cast<EvaluableNodeType>(opcode_index);
+		if(run_examples)
+			AddExampleCases(t, cases);
+		if(run_synthetic)
+			AddSyntheticCases(t, sizes, cases);
+	}
+
+	std::vector<BenchmarkResult> results;
+	std::printf("%-60s %14s %12s\n", "case", "ns/op", "nodes/op");
+	for(auto &benchmark_case : cases)
+	{
+		if(!filter.empty() && benchmark_case.name.find(filter) == std::string::npos)
+			continue;
+
+		auto result = RunCase(benchmark_case, min_seconds);
+		if(!result)
+		{
+			std::fprintf(stderr, "could not parse %s\n", benchmark_case.name.c_str());
+			continue;
+		}
+
+		std::printf("%-60.60s %14.1f %12.1f\n", result->name.c_str(), result->nsPerOp, result->nodesPerOp);
+		std::fflush(stdout);
+		results.push_back(*result);
+	}
+
+	if(!json_out.empty() && !WriteResults(json_out, results))
+	{
+		std::fprintf(stderr, "could not write %s\n", json_out.c_str());
+		return 2;
+	}
+
+	if(!compare_path.empty())
+	{
+		int num_regressions = CompareResults(compare_path, results, threshold);
+		if(num_regressions < 0)
+		{
+			std::fprintf(stderr, "could not read baseline %s\n", compare_path.c_str());
+			return 2;
+		}
+
+		if(num_regressions > 0)
+			return 1;
+	}
+
+	return 0;
+}
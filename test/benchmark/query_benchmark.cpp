@@ -0,0 +1,620 @@
+//Benchmarks for the entity query engine (SBFDS) on synthetic datasets
+//A container entity is filled with contained entities whose features are generated deterministically from the seed,
+// with controllable feature types, null rate, duplicate rate, and cluster structure, then nearest, within distance,
+// conviction, distance contribution, and clustering queries are timed at each of the thread counts
+//Feature types are given as a string with one character per feature: c for continuous, n for nominal numbers,
+// y for cyclic, and s for nominal strings; values of clustered features are drawn near the center of a randomly
+// selected cluster, otherwise uniformly
+//Case names include the dataset parameters so that results from different datasets are not compared;
+// results can be written to a json baseline and later runs compared against it to flag regressions,
+// in which case the exit code is 1 if any case is slower than the threshold allows
+//
+//usage: amalgam-query-benchmark [--rows 10000] [--types ccnnyyss] [--null-rate fraction] [--duplicate-rate fraction]
+//         [--clusters count] [--k count] [--threads 1,2,4] [--filter substring] [--min-time seconds] [--seed string]
+//         [--json baseline_out.json] [--compare baseline.json] [--threshold fraction]
+#include "benchmark_results.h"
+#include "Concurrency.h"
+#include "Entity.h"
+#include "EvaluableNode.h"
+#include "EvaluableNodeManagement.h"
+#include "Parser.h"
+#include "RandomStream.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+//the kinds of features that can be generated
+enum class FeatureType
+{
+	CONTINUOUS,
+	NOMINAL,
+	CYCLIC,
+	STRING
+};
+
+//number of distinct values for nominal number features
+constexpr size_t numNominalValues = 10;
+//number of distinct values for nominal string features
+constexpr size_t numStringValues = 100;
+//range of cyclic features
+constexpr double cycleRange = 360.0;
+//spread of clustered values about their cluster's center
+constexpr double continuousSpread = 0.05;
+constexpr double cyclicSpread = 15.0;
+//probability that a clustered nominal value is the center's value
+constexpr double nominalClusterProbability = 0.8;
+
+//number of distinct query points cycled through when timing queries
+constexpr size_t numQueryPoints = 64;
+//number of entities computed per conviction and distance contribution query
+constexpr size_t numEntitiesPerComputeQuery = 16;
+
+//parameters of a synthetic dataset
+struct DatasetParameters
+{
+	size_t numRows = 10000;
+	std::vector<FeatureType> featureTypes;
+	double nullRate = 0.0;
+	double duplicateRate = 0.0;
+	size_t numClusters = 0;
+	std::string seed = "query benchmark";
+};
+
+//a feature value, where strings are stored by their index into the string values
+//null values are stored as NaN
+using SyntheticRow = std::vector<double>;
+
+//generates rows and query points for a dataset
+class SyntheticDatasetGenerator
+{
+public:
+	SyntheticDatasetGenerator(DatasetParameters &_params)
+		: params(_params), randomStream(_params.seed)
+	{
+		for(size_t i = 0; i < params.numClusters; i++)
+		{
+			SyntheticRow center;
+			for(auto feature_type : params.featureTypes)
+				center.push_back(UniformValue(feature_type));
+			clusterCenters.emplace_back(std::move(center));
+		}
+	}
+
+	//returns a new row, which may duplicate one of the previous_rows
+	SyntheticRow GenerateRow(std::vector<SyntheticRow> &previous_rows)
+	{
+		if(previous_rows.size() > 0 && randomStream.Rand() < params.duplicateRate)
+			return previous_rows[randomStream.RandSize(previous_rows.size())];
+
+		SyntheticRow *center = nullptr;
+		if(clusterCenters.size() > 0)
+			center = &clusterCenters[randomStream.RandSize(clusterCenters.size())];
+
+		SyntheticRow row;
+		row.reserve(params.featureTypes.size());
+		for(size_t i = 0; i < params.featureTypes.size(); i++)
+		{
+			if(randomStream.Rand() < params.nullRate)
+				row.push_back(std::numeric_limits<double>::quiet_NaN());
+			else if(center == nullptr)
+				row.push_back(UniformValue(params.featureTypes[i]));
+			else
+				row.push_back(ClusteredValue(params.featureTypes[i], (*center)[i]));
+		}
+		return row;
+	}
+
+protected:
+	//returns a value from a standard normal distribution
+	double NormalValue()
+	{
+		double u1 = randomStream.RandFull();
+		double u2 = randomStream.RandFull();
+		return std::sqrt(-2.0 * std::log(1.0 - u1)) * std::cos(2.0 * 3.141592653589793 * u2);
+	}
+
+	//returns a value of feature_type chosen uniformly
+	double UniformValue(FeatureType feature_type)
+	{
+		switch(feature_type)
+		{
+		case FeatureType::CONTINUOUS:
+			return randomStream.RandFull();
+		case FeatureType::NOMINAL:
+			return static_cast<double>(randomStream.RandSize(numNominalValues));
+		case FeatureType::CYCLIC:
+			return cycleRange * randomStream.RandFull();
+		case FeatureType::STRING:
+		default:
+			return static_cast<double>(randomStream.RandSize(numStringValues));
+		}
+	}
+
+	//returns a value of feature_type near center
+	double ClusteredValue(FeatureType feature_type, double center)
+	{
+		switch(feature_type)
+		{
+		case FeatureType::CONTINUOUS:
+			return center + continuousSpread * NormalValue();
+		case FeatureType::CYCLIC:
+		{
+			double value = std::fmod(center + cyclicSpread * NormalValue(), cycleRange);
+			return (value < 0.0 ? value + cycleRange : value);
+		}
+		case FeatureType::NOMINAL:
+		case FeatureType::STRING:
+		default:
+			if(randomStream.Rand() < nominalClusterProbability)
+				return center;
+			return UniformValue(feature_type);
+		}
+	}
+
+	DatasetParameters &params;
+	RandomStream randomStream;
+	std::vector<SyntheticRow> clusterCenters;
+};
+
+//returns the label of feature i
+static std::string FeatureLabel(size_t i)
+{
+	return "f" + std::to_string(i);
+}
+
+//returns the string value with index
+static std::string StringValue(size_t index)
+{
+	return "token" + std::to_string(index);
+}
+
+//returns the id of the contained entity for row i
+static std::string EntityId(size_t i)
+{
+	return "e" + std::to_string(i);
+}
+
+//returns code for a number
+static std::string NumberLiteral(double value)
+{
+	char buffer[32];
+	std::snprintf(buffer, sizeof(buffer), "%.17g", value);
+	return buffer;
+}
+
+//returns code for the value of a feature of feature_type
+static std::string ValueLiteral(FeatureType feature_type, double value)
+{
+	if(std::isnan(value))
+		return ".null";
+	if(feature_type == FeatureType::STRING)
+		return "\"" + StringValue(static_cast<size_t>(value)) + "\"";
+	return NumberLiteral(value);
+}
+
+//parses feature types from one character per feature, returns false if any are invalid
+static bool ParseFeatureTypes(const std::string &s, std::vector<FeatureType> &feature_types)
+{
+	feature_types.clear();
+	for(char c : s)
+	{
+		switch(c)
+		{
+		case 'c':	feature_types.push_back(FeatureType::CONTINUOUS);	break;
+		case 'n':	feature_types.push_back(FeatureType::NOMINAL);		break;
+		case 'y':	feature_types.push_back(FeatureType::CYCLIC);		break;
+		case 's':	feature_types.push_back(FeatureType::STRING);		break;
+		default:
+			return false;
+		}
+	}
+	return !feature_types.empty();
+}
+
+//returns a short description of the dataset used as the prefix of case names
+static std::string DatasetDescription(DatasetParameters &params, const std::string &types)
+{
+	std::string description = "r" + std::to_string(params.numRows) + " " + types;
+	char rates[64];
+	std::snprintf(rates, sizeof(rates), " null%g dup%g", params.nullRate, params.duplicateRate);
+	description += rates;
+	description += " cl" + std::to_string(params.numClusters);
+	return description;
+}
+
+//creates a container entity with one contained entity per generated row,
+// filling in query_points with additional rows
+static Entity *CreateContainer(DatasetParameters &params, std::vector<SyntheticRow> &query_points)
+{
+	SyntheticDatasetGenerator generator(params);
+	std::vector<SyntheticRow> rows;
+	rows.reserve(params.numRows);
+	for(size_t i = 0; i < params.numRows; i++)
+		rows.emplace_back(generator.GenerateRow(rows));
+
+	//query points are new rows that may duplicate existing ones
+	for(size_t i = 0; i < numQueryPoints; i++)
+		query_points.emplace_back(generator.GenerateRow(rows));
+
+	std::vector<StringInternPool::StringID> label_sids;
+	for(size_t i = 0; i < params.featureTypes.size(); i++)
+		label_sids.push_back(string_intern_pool.CreateStringReference(FeatureLabel(i)));
+
+	Entity *container = new Entity();
+	for(size_t row_index = 0; row_index < rows.size(); row_index++)
+	{
+		Entity *entity = new Entity();
+		auto &enm = entity->evaluableNodeManager;
+		EvaluableNode *root = enm.AllocNode(ENT_ASSOC);
+		root->ReserveMappedChildNodes(label_sids.size());
+		for(size_t i = 0; i < label_sids.size(); i++)
+		{
+			double value = rows[row_index][i];
+			EvaluableNode *value_node = nullptr;
+			if(!std::isnan(value))
+			{
+				if(params.featureTypes[i] == FeatureType::STRING)
+					value_node = enm.AllocNode(StringValue(static_cast<size_t>(value)));
+				else
+					value_node = enm.AllocNode(value);
+			}
+			root->SetMappedChildNode(label_sids[i], value_node);
+		}
+		entity->SetRoot(EvaluableNodeReference(root, true), true);
+		container->AddContainedEntity(entity, EntityId(row_index));
+	}
+
+	for(auto label_sid : label_sids)
+		string_intern_pool.DestroyStringReference(label_sid);
+
+	return container;
+}
+
+//code for the parameters common to all of the queries for a dataset
+struct QueryParameters
+{
+	std::string labels;
+	std::string attributes;
+	std::string deviations;
+	std::string k;
+};
+
+//builds the labels, attributes, and deviations for the features of params
+static QueryParameters BuildQueryParameters(DatasetParameters &params, size_t k)
+{
+	QueryParameters qp;
+	qp.k = std::to_string(k);
+	qp.labels = "[";
+	qp.attributes = "{";
+	qp.deviations = "{";
+	for(size_t i = 0; i < params.featureTypes.size(); i++)
+	{
+		std::string label = FeatureLabel(i);
+		qp.labels += " \"" + label + "\"";
+		qp.attributes += " " + label + " ";
+		switch(params.featureTypes[i])
+		{
+		case FeatureType::CONTINUOUS:
+			qp.attributes += "{difference_type \"continuous\" data_type \"number\"}";
+			qp.deviations += " " + label + " " + NumberLiteral(continuousSpread);
+			break;
+		case FeatureType::NOMINAL:
+			qp.attributes += "{difference_type \"nominal\" data_type \"number\" nominal_count " + std::to_string(numNominalValues) + "}";
+			break;
+		case FeatureType::CYCLIC:
+			qp.attributes += "{difference_type \"continuous\" data_type \"number\" cycle_range " + NumberLiteral(cycleRange) + "}";
+			qp.deviations += " " + label + " " + NumberLiteral(cyclicSpread);
+			break;
+		case FeatureType::STRING:
+			qp.attributes += "{difference_type \"nominal\" data_type \"string\" nominal_count " + std::to_string(numStringValues) + "}";
+			break;
+		}
+	}
+	qp.labels += "]";
+	qp.attributes += "}";
+	qp.deviations += "}";
+	return qp;
+}
+
+//returns code for the query opcode with first_param, the labels, third_param, and then the common parameters,
+// using surprisal as the distance transform
+static std::string QueryCode(const std::string &opcode, const std::string &first_param,
+	const std::string &third_param, QueryParameters &qp)
+{
+	return "(compute_on_contained_entities (" + opcode + " " + first_param + " " + qp.labels + " " + third_param
+		+ " 1 .null " + qp.attributes + " " + qp.deviations + " .null -1 .null \"query benchmark\"))";
+}
+
+//a query to time, where each op executes one of the codes in turn
+struct QueryCase
+{
+	std::string name;
+	std::vector<std::string> codes;
+};
+
+//returns the median distance from the query points to their kth nearest entity, so that within distance
+// queries find about k entities
+static double CalibrateWithinDistance(Entity *container, std::vector<std::string> &points, QueryParameters &qp)
+{
+	auto &enm = container->evaluableNodeManager;
+	std::vector<double> distances;
+	for(auto &point : points)
+	{
+		std::string code_string = "(compute_on_contained_entities (query_nearest_generalized_distance " + qp.k + " "
+			+ qp.labels + " " + point + " 1 .null " + qp.attributes + " " + qp.deviations
+			+ " .null -1 .null \"query benchmark\" .null .null .true))";
+		EvaluableNode *code = std::get<0>(Parser::Parse(code_string, &enm));
+		auto result = container->ExecuteOnEntity(code, nullptr);
+		if(result != nullptr && result->GetOrderedChildNodes().size() >= 2)
+		{
+			auto &result_distances = result->GetOrderedChildNodes()[1]->GetOrderedChildNodes();
+			if(result_distances.size() > 0)
+				distances.push_back(EvaluableNode::ToNumber(result_distances.back()));
+		}
+		enm.FreeNodeTreeIfPossible(result);
+		enm.FreeNodeTree(code);
+	}
+
+	if(distances.empty())
+		return 1.0;
+
+	std::sort(begin(distances), end(distances));
+	return distances[distances.size() / 2];
+}
+
+//builds the cases for each of the query types
+static std::vector<QueryCase> BuildQueryCases(Entity *container, DatasetParameters &params,
+	std::vector<SyntheticRow> &query_points, size_t k)
+{
+	QueryParameters qp = BuildQueryParameters(params, k);
+
+	std::vector<std::string> points;
+	for(auto &query_point : query_points)
+	{
+		std::string point = "[";
+		for(size_t i = 0; i < params.featureTypes.size(); i++)
+			point += " " + ValueLiteral(params.featureTypes[i], query_point[i]);
+		point += "]";
+		points.emplace_back(std::move(point));
+	}
+
+	//batches of entities to compute convictions and distance contributions for, spread across the dataset
+	std::vector<std::string> id_batches;
+	size_t num_batches = std::max<size_t>(1, std::min(numQueryPoints, params.numRows / numEntitiesPerComputeQuery));
+	for(size_t batch = 0; batch < num_batches; batch++)
+	{
+		std::string ids = "[";
+		for(size_t i = 0; i < numEntitiesPerComputeQuery && i < params.numRows; i++)
+			ids += " \"" + EntityId((batch + i * num_batches) % params.numRows) + "\"";
+		ids += "]";
+		id_batches.emplace_back(std::move(ids));
+	}
+
+	std::vector<QueryCase> cases;
+
+	QueryCase nearest{ "nearest k" + qp.k, {} };
+	for(auto &point : points)
+		nearest.codes.push_back(QueryCode("query_nearest_generalized_distance", qp.k, point, qp));
+	cases.emplace_back(std::move(nearest));
+
+	std::string within_distance = NumberLiteral(CalibrateWithinDistance(container, points, qp));
+	QueryCase within{ "within distance of about k" + qp.k, {} };
+	for(auto &point : points)
+		within.codes.push_back(QueryCode("query_within_generalized_distance", within_distance, point, qp));
+	cases.emplace_back(std::move(within));
+
+	std::string batch_size = std::to_string(std::min(numEntitiesPerComputeQuery, params.numRows));
+	QueryCase convictions{ "convictions of " + batch_size + " k" + qp.k, {} };
+	QueryCase contributions{ "distance contributions of " + batch_size + " k" + qp.k, {} };
+	for(auto &ids : id_batches)
+	{
+		convictions.codes.push_back(QueryCode("query_entity_convictions", qp.k, ids, qp));
+		contributions.codes.push_back(QueryCode("query_entity_distance_contributions", qp.k, ids, qp));
+	}
+	cases.emplace_back(std::move(convictions));
+	cases.emplace_back(std::move(contributions));
+
+	std::string min_cluster_weight = std::to_string(std::max<size_t>(2, params.numRows / 100));
+	QueryCase clusters{ "clusters k" + qp.k, {} };
+	clusters.codes.push_back(QueryCode("query_entity_clusters", qp.k, min_cluster_weight, qp));
+	cases.emplace_back(std::move(clusters));
+
+	return cases;
+}
+
+//runs query_case on container until at least min_seconds have elapsed
+//returns the result, or an empty optional if the code could not be parsed
+static std::optional<BenchmarkResult> RunQueryCase(Entity *container, QueryCase &query_case,
+	const std::string &name, double min_seconds)
+{
+	auto &enm = container->evaluableNodeManager;
+
+	//keep the codes referenced by the container's root so that they are not garbage collected
+	EvaluableNode *root = enm.AllocNode(ENT_LIST);
+	for(auto &code_string : query_case.codes)
+	{
+		auto [code, warnings, char_with_error, code_complete] = Parser::Parse(code_string, &enm);
+		if(code == nullptr || warnings.size() > 0)
+			return std::nullopt;
+		root->AppendOrderedChildNode(code);
+	}
+	container->SetRoot(EvaluableNodeReference(root, true), true);
+	auto &codes = root->GetOrderedChildNodesReference();
+
+	auto execute = [container, &enm](EvaluableNode *code)
+	{
+		auto result = container->ExecuteOnEntity(code, nullptr);
+		enm.FreeNodeTreeIfPossible(result);
+	};
+
+	//warm up the query caches
+	execute(codes[0]);
+	container->CollectGarbageWithEntityWriteReference();
+
+	using clock = std::chrono::steady_clock;
+	size_t num_runs = 0;
+	double elapsed = 0.0;
+	auto start = clock::now();
+	do
+	{
+		execute(codes[num_runs % codes.size()]);
+		num_runs++;
+		container->CollectGarbageWithEntityWriteReference();
+		elapsed = std::chrono::duration<double>(clock::now() - start).count();
+	} while(elapsed < min_seconds);
+
+	return BenchmarkResult{ name, 1e9 * elapsed / num_runs, -1.0 };
+}
+
+//parses a comma separated list of counts
+static std::vector<size_t> ParseCounts(const std::string &s)
+{
+	std::vector<size_t> counts;
+	std::stringstream stream(s);
+	std::string count;
+	while(std::getline(stream, count, ','))
+	{
+		if(!count.empty())
+			counts.push_back(std::stoull(count));
+	}
+	return counts;
+}
+
+int main(int argc, char **argv)
+{
+	DatasetParameters params;
+	std::string types = "ccnnyyss";
+	size_t k = 10;
+	std::string filter;
+	double min_seconds = 0.5;
+	std::string json_out;
+	std::string compare_path;
+	double threshold = 0.1;
+
+	std::vector<size_t> thread_counts = { 1 };
+#if defined(MULTITHREAD_SUPPORT) || defined(_OPENMP)
+	size_t hardware_threads = std::thread::hardware_concurrency();
+	if(hardware_threads > 1)
+		thread_counts.push_back(hardware_threads);
+#endif
+
+	for(int i = 1; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		bool has_value = (i + 1 < argc);
+		if(arg == "--rows" && has_value)
+			params.numRows = std::stoull(argv[++i]);
+		else if(arg == "--types" && has_value)
+			types = argv[++i];
+		else if(arg == "--null-rate" && has_value)
+			params.nullRate = std::stod(argv[++i]);
+		else if(arg == "--duplicate-rate" && has_value)
+			params.duplicateRate = std::stod(argv[++i]);
+		else if(arg == "--clusters" && has_value)
+			params.numClusters = std::stoull(argv[++i]);
+		else if(arg == "--k" && has_value)
+			k = std::max<size_t>(1, std::stoull(argv[++i]));
+		else if(arg == "--threads" && has_value)
+			thread_counts = ParseCounts(argv[++i]);
+		else if(arg == "--filter" && has_value)
+			filter = argv[++i];
+		else if(arg == "--min-time" && has_value)
+			min_seconds = std::stod(argv[++i]);
+		else if(arg == "--seed" && has_value)
+			params.seed = argv[++i];
+		else if(arg == "--json" && has_value)
+			json_out = argv[++i];
+		else if(arg == "--compare" && has_value)
+			compare_path = argv[++i];
+		else if(arg == "--threshold" && has_value)
+			threshold = std::stod(argv[++i]);
+		else
+		{
+			std::fprintf(stderr, "unknown or incomplete argument: %s\n", arg.c_str());
+			return 2;
+		}
+	}
+
+	if(!ParseFeatureTypes(types, params.featureTypes))
+	{
+		std::fprintf(stderr, "invalid feature types: %s\n", types.c_str());
+		return 2;
+	}
+
+	if(params.numRows == 0 || thread_counts.empty())
+	{
+		std::fprintf(stderr, "rows and thread counts must be specified\n");
+		return 2;
+	}
+
+	std::string dataset_description = DatasetDescription(params, types);
+	std::printf("dataset %s\n", dataset_description.c_str());
+
+	auto creation_start = std::chrono::steady_clock::now();
+	std::vector<SyntheticRow> query_points;
+	Entity *container = CreateContainer(params, query_points);
+	auto cases = BuildQueryCases(container, params, query_points, k);
+	std::printf("created and calibrated in %.3f s\n\n",
+		std::chrono::duration<double>(std::chrono::steady_clock::now() - creation_start).count());
+
+	std::vector<BenchmarkResult> results;
+	std::printf("%-100s %14s\n", "case", "ns/op");
+	for(size_t num_threads : thread_counts)
+	{
+	#if defined(MULTITHREAD_SUPPORT) || defined(_OPENMP)
+		Concurrency::SetMaxNumThreads(num_threads);
+	#else
+		if(num_threads != 1)
+			continue;
+	#endif
+
+		for(auto &query_case : cases)
+		{
+			std::string name = dataset_description + " " + query_case.name + " t" + std::to_string(num_threads);
+			if(!filter.empty() && name.find(filter) == std::string::npos)
+				continue;
+
+			auto result = RunQueryCase(container, query_case, name, min_seconds);
+			if(!result)
+			{
+				std::fprintf(stderr, "could not parse %s\n", name.c_str());
+				continue;
+			}
+
+			std::printf("%-100.100s %14.1f\n", result->name.c_str(), result->nsPerOp);
+			std::fflush(stdout);
+			results.push_back(*result);
+		}
+	}
+
+	delete container;
+
+	if(!json_out.empty() && !WriteResults(json_out, results))
+	{
+		std::fprintf(stderr, "could not write %s\n", json_out.c_str());
+		return 2;
+	}
+
+	if(!compare_path.empty())
+	{
+		int num_regressions = CompareResults(compare_path, results, threshold);
+		if(num_regressions < 0)
+		{
+			std::fprintf(stderr, "could not read baseline %s\n", compare_path.c_str());
+			return 2;
+		}
+
+		if(num_regressions > 0)
+			return 1;
+	}
+
+	return 0;
+}
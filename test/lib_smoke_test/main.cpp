@@ -4,13 +4,29 @@
 
 //project headers:
 #include "Amalgam.h"
+#include "adaptive_compact_hash_map_test.h"
+#include "binary_packing_test.h"
+#include "BinaryPacking.h"
 #include "clustering_test.h"
+#include "csv_test.h"
+#include "datetime_format_test.h"
+#include "evaluable_node_manager_test.h"
+#include "integer_set_test.h"
+#include "random_stream_test.h"
+#include "regex_cache_test.h"
+#include "sbfds_column_data_test.h"
+#include "tree_commonality_test.h"
+#include "unnamed_entity_id_test.h"
+#include "weighted_sampling_test.h"
 
 //system headers:
+#include <algorithm>
 #include <cctype>
 #include <functional>
+#include <chrono>
 #include <iostream>
 #include <string>
+#include <thread>
 
 // A wrapper around a C string that DeleteString() on exit.
 class ApiString
@@ -570,6 +586,240 @@ static void RoundTripCamlToMemory(TestResult &test_result)
 	}
 }
 
+// Stores the entity specified by entity_handle to memory as file_type with json_file_params and returns the bytes.
+static std::string StoreEntityToMemoryString(std::string &entity_handle, std::string &file_type, std::string json_file_params)
+{
+	void *data = nullptr;
+	size_t len = 0;
+	StoreEntityToMemory(entity_handle.data(), &data, &len, file_type.data(), false, json_file_params.data(), nullptr, 0);
+	if(data == nullptr)
+		return std::string();
+
+	char *cdata = reinterpret_cast<char *>(data);
+	std::string stored(cdata, cdata + len);
+	DeleteString(cdata);
+	return stored;
+}
+
+static void StoreCamlWithAndWithoutChunking(TestResult &test_result)
+{
+	// Enough contained entities that a parallel store unparses them in several tasks.
+	std::string amlg("{ get_value \"hello\" }");
+	LoadEntityStatus status = LoadEntityFromMemory(handle.data(), amlg.data(), amlg.size(), amlgSuffix.data(), false, empty.data(), empty.data(), empty.data(), nullptr, 0);
+	test_result.Require("LoadEntityFromMemory", status.loaded);
+	if(!test_result)
+		return;
+
+	LoadedEntity loaded_entity(handle);
+	std::string create_children("(map (lambda (create_entities {value (current_value 1)})) (range 1 300))");
+	ApiString created(EvalOnEntity(handle.data(), create_children.data()));
+
+	// The flattened code that both caml stores compress.
+	std::string code = StoreEntityToMemoryString(handle, amlgSuffix,
+		"{\"flatten\":true,\"pretty_print\":false,\"sort_keys\":false,\"include_rand_seeds\":true,\"transactional\":true,\"escape_contained_resource_names\":false}");
+	test_result.Require("flattened code stored", code.size() > 0);
+
+	// Without parallel_create, the payload is exactly what the serial path compresses, after the original header.
+	std::string serial = StoreEntityToMemoryString(handle, camlSuffix, "");
+	auto [expected_payload, huffman_tree] = CompressString(code);
+	delete huffman_tree;
+	test_result.Check("serial caml magic number", serial.substr(0, 4), "caml");
+	test_result.Require("serial caml payload identical to CompressString",
+		serial.size() > 16 && BinaryData(begin(serial) + 16, end(serial)) == expected_payload);
+
+	// With parallel_create, the chunked payload has a versioned header and loads to the same entity.
+	std::string parallel = StoreEntityToMemoryString(handle, camlSuffix, "{\"parallel_create\":true}");
+	test_result.Check("parallel caml magic number", parallel.substr(0, 4), "camv");
+
+	std::string count_children("(size (contained_entities))");
+	for(std::string *stored : { &serial, &parallel })
+	{
+		status = LoadEntityFromMemory(handle2.data(), stored->data(), stored->size(), camlSuffix.data(), false, empty.data(), empty.data(), empty.data(), nullptr, 0);
+		test_result.Require("LoadEntityFromMemory caml", status.loaded);
+		if(!test_result)
+			return;
+
+		LoadedEntity loaded_entity2(handle2);
+		ApiString num_children(EvalOnEntity(handle2.data(), count_children.data()));
+		test_result.Check("contained entities loaded from caml", num_children, "300");
+	}
+}
+
+static void QueryNearestWithTiesConcurrently(TestResult &test_result)
+{
+	// Enough contained entities that the remaining distances are resolved in several blocks, with many tied distances.
+	std::string amlg("{ get_value \"hello\" }");
+	LoadEntityStatus status = LoadEntityFromMemory(handle.data(), amlg.data(), amlg.size(), amlgSuffix.data(), false, empty.data(), empty.data(), empty.data(), nullptr, 0);
+	test_result.Require("LoadEntityFromMemory", status.loaded);
+	if(!test_result)
+		return;
+
+	LoadedEntity loaded_entity(handle);
+	std::string create_children("(map (lambda (create_entities {x (mod (current_value 1) 7)})) (range 1 40000))");
+	ApiString created(EvalOnEntity(handle.data(), create_children.data()));
+
+	// Queries on a single feature don't start from the previous nearest neighbors, so each query starts from the same state.
+	std::string query("(compute_on_contained_entities (query_nearest_generalized_distance 20 [\"x\"] [3.2] 1"
+		" .null .null .null .null .null .null \"fixed rand seed\" .null .null .true))");
+
+	size_t max_num_threads = GetMaxNumThreads();
+	ApiString first(EvalOnEntity(handle.data(), query.data()));
+
+	SetMaxNumThreads(1);
+	ApiString serial(EvalOnEntity(handle.data(), query.data()));
+	SetMaxNumThreads(4);
+	ApiString concurrent(EvalOnEntity(handle.data(), query.data()));
+	SetMaxNumThreads(max_num_threads);
+
+	test_result.Require("query results", static_cast<std::string>(serial).size() > 2);
+	test_result.Check("query with the same seed", serial, first);
+	test_result.Check("query resolved concurrently", concurrent, serial);
+}
+
+static void CloneFrozenEntity(TestResult &test_result)
+{
+	std::string amlg("{ data [1 2 3] nested {a [4 5]} }");
+	LoadEntityStatus status = LoadEntityFromMemory(handle.data(), amlg.data(), amlg.size(), amlgSuffix.data(), false, empty.data(), empty.data(), empty.data(), nullptr, 0);
+	test_result.Require("LoadEntityFromMemory", status.loaded);
+	if(!test_result)
+		return;
+
+	std::string handle3("handle3");
+	std::string get_data("(retrieve_from_entity \"data\")");
+	std::string get_nested("(retrieve_from_entity \"nested\")");
+	std::string get_child("(retrieve_from_entity \"child\" \"value\")");
+	{
+		LoadedEntity loaded_entity(handle);
+		std::string create_child("(create_entities \"child\" {value [6 7]})");
+		ApiString created(EvalOnEntity(handle.data(), create_child.data()));
+
+		test_result.Require("FreezeEntityCode", FreezeEntityCode(handle.data()));
+		test_result.Require("CloneEntity", CloneEntity(handle.data(), handle2.data(), empty.data(), empty.data(), false, empty.data(), empty.data(), empty.data()));
+		if(!test_result)
+			return;
+		LoadedEntity loaded_clone(handle2);
+
+		// Changing the clone, including its contained entity, leaves the frozen source unchanged.
+		std::string change_clone("(seq (accum_to_entities {data [4]}) (assign_to_entities {nested {a [0]}}) (assign_to_entities \"child\" {value [8]}))");
+		ApiString changed_clone(EvalOnEntity(handle2.data(), change_clone.data()));
+		test_result.Check("EvalOnEntity clone data", ApiString(EvalOnEntity(handle2.data(), get_data.data())), "[1,2,3,4]");
+		test_result.Check("EvalOnEntity clone nested", ApiString(EvalOnEntity(handle2.data(), get_nested.data())), "{\"a\":[0]}");
+		test_result.Check("EvalOnEntity clone child", ApiString(EvalOnEntity(handle2.data(), get_child.data())), "[8]");
+		test_result.Check("EvalOnEntity source data", ApiString(EvalOnEntity(handle.data(), get_data.data())), "[1,2,3]");
+		test_result.Check("EvalOnEntity source nested", ApiString(EvalOnEntity(handle.data(), get_nested.data())), "{\"a\":[4,5]}");
+		test_result.Check("EvalOnEntity source child", ApiString(EvalOnEntity(handle.data(), get_child.data())), "[6,7]");
+
+		// Changing the source leaves a new clone unchanged, and a clone of a clone shares the same code.
+		test_result.Require("CloneEntity clone", CloneEntity(handle2.data(), handle3.data(), empty.data(), empty.data(), false, empty.data(), empty.data(), empty.data()));
+		std::string change_source("(seq (accum_to_entities {data [5]}) (assign_to_entities \"child\" {value [9]}))");
+		ApiString changed_source(EvalOnEntity(handle.data(), change_source.data()));
+		test_result.Check("EvalOnEntity changed source data", ApiString(EvalOnEntity(handle.data(), get_data.data())), "[1,2,3,5]");
+		test_result.Check("EvalOnEntity changed source child", ApiString(EvalOnEntity(handle.data(), get_child.data())), "[9]");
+		test_result.Check("EvalOnEntity clone data after source change", ApiString(EvalOnEntity(handle2.data(), get_data.data())), "[1,2,3,4]");
+		test_result.Check("EvalOnEntity clone child after source change", ApiString(EvalOnEntity(handle2.data(), get_child.data())), "[8]");
+	}
+
+	// The clone of the clone outlives the entity whose code was frozen.
+	LoadedEntity loaded_clone_of_clone(handle3);
+	test_result.Check("EvalOnEntity clone of clone data", ApiString(EvalOnEntity(handle3.data(), get_data.data())), "[1,2,3,4]");
+	test_result.Check("EvalOnEntity clone of clone nested", ApiString(EvalOnEntity(handle3.data(), get_nested.data())), "{\"a\":[0]}");
+	test_result.Check("EvalOnEntity clone of clone child", ApiString(EvalOnEntity(handle3.data(), get_child.data())), "[8]");
+
+	std::string missing_handle("missing");
+	test_result.Require("FreezeEntityCode missing", !FreezeEntityCode(missing_handle.data()));
+}
+
+// Returns the estimated bytes of nodes in use by the entity, including garbage, from GetEntityMemoryUsage.
+static size_t GetEntityNodesUsed(std::string &entity_handle)
+{
+	std::string usage = ApiString(GetEntityMemoryUsage(entity_handle.data()));
+	std::string key("\"nodes_used\":");
+	size_t position = usage.find(key);
+	if(position == std::string::npos)
+		return 0;
+	return std::stoull(usage.substr(position + key.size()));
+}
+
+static void BackgroundGarbageCollection(TestResult &test_result)
+{
+	LoadEntityStatus status = LoadEntity(handle.data(), filename.data(), empty.data(), false, empty.data(), empty.data(), empty.data(), nullptr, 0);
+	test_result.Require("LoadEntity", status.loaded);
+	if(test_result)
+	{
+		LoadedEntity loaded_entity(handle);
+		ExecuteEntity(handle.data(), initialize.data());
+
+		// Only multithreaded libraries support background collection.
+		bool background = SetBackgroundGarbageCollection(handle.data(), 1);
+
+		// Alternate between bursts that leave garbage behind and idle gaps where it may be collected.
+		std::string big_value("[");
+		for(int i = 0; i < 1000; i++)
+			big_value += std::to_string(i) + ",";
+		big_value += "0]";
+		std::string value_label("!value");
+		for(int i = 0; i < 5; i++)
+		{
+			SetJSONToLabel(handle.data(), value_label.data(), big_value.data());
+			ExecuteEntity(handle.data(), initialize.data());
+			ApiString incr(ExecuteEntityJsonPtr(handle.data(), increment.data(), empty.data()));
+			test_result.Check("ExecuteEntityJsonPtr increment", incr, "1");
+			std::this_thread::sleep_for(std::chrono::milliseconds(20));
+		}
+
+		// Replacing a large value leaves it as garbage, which must be freed once the entity is idle.
+		if(background)
+		{
+			size_t nodes_used_before = GetEntityNodesUsed(handle);
+			SetJSONToLabel(handle.data(), value_label.data(), big_value.data());
+			size_t nodes_used_with_value = GetEntityNodesUsed(handle);
+			test_result.Require("allocate nodes for a large value", nodes_used_with_value > nodes_used_before);
+			ExecuteEntity(handle.data(), initialize.data());
+			ApiString incr(ExecuteEntityJsonPtr(handle.data(), increment.data(), empty.data()));
+			test_result.Check("ExecuteEntityJsonPtr increment", incr, "1");
+
+			size_t value_size = nodes_used_with_value - nodes_used_before;
+			bool garbage_freed = false;
+			for(int i = 0; i < 500 && !garbage_freed; i++)
+			{
+				std::this_thread::sleep_for(std::chrono::milliseconds(10));
+				garbage_freed = (GetEntityNodesUsed(handle) < nodes_used_before + value_size / 2);
+			}
+			test_result.Require("free garbage while idle", garbage_freed);
+		}
+
+		SetBackgroundGarbageCollection(handle.data(), 0);
+		ApiString get(ExecuteEntityJsonPtr(handle.data(), get_value.data(), empty.data()));
+		test_result.Check("ExecuteEntityJsonPtr get_value", get, "1");
+	}
+}
+
+static void MemorySoftLimit(TestResult &test_result)
+{
+	LoadEntityStatus status = LoadEntity(handle.data(), filename.data(), empty.data(), false, empty.data(), empty.data(), empty.data(), nullptr, 0);
+	test_result.Require("LoadEntity", status.loaded);
+	if(test_result)
+	{
+		LoadedEntity loaded_entity(handle);
+		ExecuteEntity(handle.data(), initialize.data());
+
+		std::string usage = ApiString(GetEntityMemoryUsage(handle.data()));
+		test_result.Require("GetEntityMemoryUsage total", usage.find("\"total\":") != std::string::npos);
+
+		// A limit below any possible usage reclaims as much as it can on every check without losing data.
+		test_result.Require("SetEntityMemorySoftLimit", SetEntityMemorySoftLimit(handle.data(), 1, 0));
+		ApiString incr(ExecuteEntityJsonPtr(handle.data(), increment.data(), empty.data()));
+		test_result.Check("ExecuteEntityJsonPtr increment", incr, "1");
+
+		test_result.Require("SetEntityMemorySoftLimit remove", SetEntityMemorySoftLimit(handle.data(), 0, 0));
+		ApiString get(ExecuteEntityJsonPtr(handle.data(), get_value.data(), empty.data()));
+		test_result.Check("ExecuteEntityJsonPtr get_value", get, "1");
+	}
+
+	std::string missing_handle("missing");
+	test_result.Require("SetEntityMemorySoftLimit missing", !SetEntityMemorySoftLimit(missing_handle.data(), 1, 0));
+}
+
 int main(int argc, char *argv[])
 {
 	bool verbose = false;
@@ -614,9 +864,50 @@ int main(int argc, char *argv[])
 	suite.Run("StoreSubEntityToMemory", StoreSubEntityToMemory);
 	suite.Run("RoundTripCamlToMemory", RoundTripCamlToMemory);
 	suite.Run("ClusterTwoBlobs", ClusterTwoBlobs);
+	suite.Run("StoreCamlWithAndWithoutChunking", StoreCamlWithAndWithoutChunking);
+	suite.Run("QueryNearestWithTiesConcurrently", QueryNearestWithTiesConcurrently);
+	suite.Run("CloneFrozenEntity", CloneFrozenEntity);
+	suite.Run("BackgroundGarbageCollection", BackgroundGarbageCollection);
+	suite.Run("MemorySoftLimit", MemorySoftLimit);
 	suite.Run("ClusteringAlgorithm", [](TestResult &test_result) {
 		test_result.Require("clustering algorithm unit tests pass", RunClusteringUnitTests() == 0);
 	});
+	suite.Run("BinaryPacking", [](TestResult &test_result) {
+		test_result.Require("binary packing unit tests pass", RunBinaryPackingUnitTests() == 0);
+	});
+	suite.Run("AdaptiveCompactHashMap", [](TestResult &test_result) {
+		test_result.Require("adaptive compact hash map unit tests pass", RunAdaptiveCompactHashMapUnitTests() == 0);
+	});
+	suite.Run("EvaluableNodeManager", [](TestResult &test_result) {
+		test_result.Require("evaluable node manager unit tests pass", RunEvaluableNodeManagerUnitTests() == 0);
+	});
+	suite.Run("RegexCache", [](TestResult &test_result) {
+		test_result.Require("regex cache unit tests pass", RunRegexCacheUnitTests() == 0);
+	});
+	suite.Run("TreeCommonality", [](TestResult &test_result) {
+		test_result.Require("tree commonality unit tests pass", RunTreeCommonalityUnitTests() == 0);
+	});
+	suite.Run("IntegerSet", [](TestResult &test_result) {
+		test_result.Require("integer set unit tests pass", RunIntegerSetUnitTests() == 0);
+	});
+	suite.Run("CSV", [](TestResult &test_result) {
+		test_result.Require("csv unit tests pass", RunCSVUnitTests() == 0);
+	});
+	suite.Run("DateTimeFormat", [](TestResult &test_result) {
+		test_result.Require("date time format unit tests pass", RunDateTimeFormatUnitTests() == 0);
+	});
+	suite.Run("RandomStream", [](TestResult &test_result) {
+		test_result.Require("random stream unit tests pass", RunRandomStreamUnitTests() == 0);
+	});
+	suite.Run("SBFDSColumnData", [](TestResult &test_result) {
+		test_result.Require("sbfds column data unit tests pass", RunSBFDSColumnDataUnitTests() == 0);
+	});
+	suite.Run("WeightedSampling", [](TestResult &test_result) {
+		test_result.Require("weighted sampling unit tests pass", RunWeightedSamplingUnitTests() == 0);
+	});
+	suite.Run("UnnamedEntityId", [](TestResult &test_result) {
+		test_result.Require("unnamed entity id unit tests pass", RunUnnamedEntityIdUnitTests() == 0);
+	});
 
 	return suite ? 0 : 1;
 }
@@ -0,0 +1,289 @@
+//Unit tests for AdaptiveCompactHashMap
+#include "adaptive_compact_hash_map_test.h"
+#include "HashMaps.h"
+
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+static int g_failures = 0;
+static int g_checks = 0;
+
+#define CHECK(cond) do { \
+	++g_checks; \
+	if(!(cond)) { ++g_failures; \
+		std::cerr << "FAIL " << __FILE__ << ":" << __LINE__ << ": " #cond << std::endl; } \
+	} while(0)
+
+//small threshold so that tests cross it quickly
+static constexpr size_t maxLinearSize = 4;
+using FourEntryMap = AdaptiveCompactHashMap<uint64_t, int, maxLinearSize>;
+using KeyValues = std::vector<std::pair<uint64_t, int>>;
+
+//Entries in iteration order.
+template<typename MapType>
+static KeyValues EntriesOf(const MapType &m)
+{
+	KeyValues entries;
+	for(auto &[key, value] : m)
+		entries.emplace_back(key, value);
+	return entries;
+}
+
+//True if m holds exactly the entries of reference, visiting each once, and finds each of them.
+template<typename MapType>
+static bool SameContents(const MapType &m, const std::map<uint64_t, int> &reference)
+{
+	if(m.size() != reference.size() || m.empty() != reference.empty())
+		return false;
+
+	KeyValues entries = EntriesOf(m);
+	std::map<uint64_t, int> visited(begin(entries), end(entries));
+	if(entries.size() != reference.size() || visited != reference)
+		return false;
+
+	for(auto &[key, value] : reference)
+	{
+		auto found = m.find(key);
+		if(found == m.end() || found->second != value || !m.contains(key) || m.count(key) != 1)
+			return false;
+	}
+	return true;
+}
+
+static void TestLinearOrder()
+{
+	FourEntryMap m;
+	CHECK(m.empty());
+	CHECK(m.begin() == m.end());
+
+	m.emplace(30, 3);
+	m.emplace(10, 1);
+	m[20] = 2;
+	CHECK(m.size() == 3);
+
+	// Existing keys are not replaced by emplace, but are by operator[].
+	CHECK(!m.emplace(10, 100).second);
+	m[30] = 33;
+
+#ifndef USE_STL_HASH_MAPS
+	// While linear, entries are iterated in insertion order and erasure keeps the order of the rest.
+	CHECK((EntriesOf(m) == KeyValues{ {30, 33}, {10, 1}, {20, 2} }));
+	CHECK(m.erase(10) == 1);
+	CHECK((EntriesOf(m) == KeyValues{ {30, 33}, {20, 2} }));
+	m.emplace(10, 11);
+	CHECK((EntriesOf(m) == KeyValues{ {30, 33}, {20, 2}, {10, 11} }));
+
+	// Erasing by iterator returns the next entry in order.
+	auto next = m.erase(m.find(30));
+	CHECK(next != m.end() && next->first == 20);
+	CHECK((EntriesOf(m) == KeyValues{ {20, 2}, {10, 11} }));
+#else
+	CHECK(m.erase(10) == 1);
+	m.emplace(10, 11);
+	m.erase(m.find(30));
+#endif
+	CHECK(SameContents(m, { {20, 2}, {10, 11} }));
+	CHECK(m.erase(12345) == 0);
+
+	CHECK(m.at(20) == 2);
+	bool threw = false;
+	try
+	{
+		m.at(12345);
+	}
+	catch(std::out_of_range &)
+	{
+		threw = true;
+	}
+	CHECK(threw);
+}
+
+static void TestSwitchToHashMap()
+{
+	FourEntryMap m;
+	std::map<uint64_t, int> reference;
+
+	// Filling to exactly the threshold stays linear and in order.
+	for(uint64_t i = 0; i < maxLinearSize; i++)
+	{
+		m.emplace(100 - i, static_cast<int>(i));
+		reference.emplace(100 - i, static_cast<int>(i));
+	}
+	CHECK(SameContents(m, reference));
+#ifndef USE_STL_HASH_MAPS
+	KeyValues in_order = EntriesOf(m);
+	for(size_t i = 0; i < in_order.size(); i++)
+		CHECK(in_order[i].first == 100 - i);
+#endif
+
+	// One more entry switches to a hash map, keeping every entry.
+	auto [inserted, was_inserted] = m.emplace(1, -1);
+	CHECK(was_inserted && inserted->first == 1 && inserted->second == -1);
+	reference.emplace(1, -1);
+	CHECK(SameContents(m, reference));
+
+	// A hash map stays one when shrunk below the threshold, until it is cleared.
+	for(uint64_t i = 0; i < maxLinearSize; i++)
+	{
+		m.erase(100 - i);
+		reference.erase(100 - i);
+	}
+	CHECK(SameContents(m, reference));
+
+	m.clear();
+	CHECK(m.empty());
+	CHECK(m.begin() == m.end());
+	m.emplace(7, 7);
+	m.emplace(5, 5);
+#ifndef USE_STL_HASH_MAPS
+	CHECK((EntriesOf(m) == KeyValues{ {7, 7}, {5, 5} }));
+#endif
+
+	// Reserving beyond the threshold switches up front.
+	FourEntryMap reserved;
+	reserved.emplace(3, 3);
+	reserved.reserve(maxLinearSize + 10);
+	for(uint64_t i = 0; i < maxLinearSize + 10; i++)
+		reserved.emplace(i, static_cast<int>(i));
+	std::map<uint64_t, int> reserved_reference;
+	for(uint64_t i = 0; i < maxLinearSize + 10; i++)
+		reserved_reference.emplace(i, static_cast<int>(i));
+	CHECK(SameContents(reserved, reserved_reference));
+
+	// Erasing everything by iterator visits every entry in either representation.
+	for(FourEntryMap *to_erase : { &m, &reserved })
+	{
+		size_t num_entries = to_erase->size();
+		size_t num_erased = 0;
+		for(auto it = to_erase->begin(); it != to_erase->end(); num_erased++)
+			it = to_erase->erase(it);
+		CHECK(num_erased == num_entries);
+		CHECK(to_erase->empty());
+	}
+}
+
+static void TestCopyMoveAndCompare()
+{
+	FourEntryMap linear;
+	linear.emplace(1, 1);
+	linear.emplace(2, 2);
+
+	FourEntryMap hashed;
+	for(uint64_t i = 0; i <= maxLinearSize; i++)
+		hashed.emplace(i + 10, static_cast<int>(i));
+
+	// Copies in each direction between representations.
+	FourEntryMap copy(linear);
+	CHECK(copy == linear);
+	copy = hashed;
+	CHECK(copy == hashed);
+	CHECK(copy != linear);
+	copy = linear;
+	CHECK(copy == linear);
+	CHECK((EntriesOf(copy) == EntriesOf(linear)));
+
+	// Equality does not depend on order or representation.
+	FourEntryMap reversed;
+	reversed.emplace(2, 2);
+	reversed.emplace(1, 1);
+	CHECK(reversed == linear);
+	FourEntryMap promoted_then_shrunk(hashed);
+	for(uint64_t i = 0; i <= maxLinearSize; i++)
+		promoted_then_shrunk.erase(i + 10);
+	promoted_then_shrunk.emplace(1, 1);
+	promoted_then_shrunk.emplace(2, 2);
+	CHECK(promoted_then_shrunk == linear);
+	reversed[1] = 5;
+	CHECK(reversed != linear);
+
+	// Moves and swaps take the storage with them.
+	FourEntryMap moved(std::move(copy));
+	CHECK(moved == linear);
+	CHECK(copy.empty());
+	moved.swap(hashed);
+	CHECK(moved.size() == maxLinearSize + 1);
+	CHECK(hashed == linear);
+	hashed = std::move(moved);
+	CHECK(hashed.size() == maxLinearSize + 1);
+}
+
+//Applies random operations to both maps, checking contents against std::map after each and
+//insertion order while the map is small.
+static void TestRandomOperations()
+{
+	std::mt19937_64 gen(12345);
+	for(int trial = 0; trial < 200; trial++)
+	{
+		AdaptiveCompactHashMap<uint64_t, int> m;
+		std::map<uint64_t, int> reference;
+		//insertion order of keys in reference, for as long as m has never held more than 16 entries
+		std::vector<uint64_t> order;
+		[[maybe_unused]] bool has_been_large = false;
+
+		//few distinct keys so that finds, overwrites, and erasures often hit
+		std::uniform_int_distribution<uint64_t> key_dist(0, 24);
+		for(int op = 0; op < 200; op++)
+		{
+			uint64_t key = key_dist(gen);
+			int value = static_cast<int>(gen() % 1000);
+			switch(gen() % 6)
+			{
+			case 0: case 1:
+				if(m.emplace(key, value).second)
+					order.push_back(key);
+				reference.emplace(key, value);
+				break;
+			case 2:
+				if(!m.contains(key))
+					order.push_back(key);
+				m[key] = value;
+				reference[key] = value;
+				break;
+			case 3: case 4:
+				m.erase(key);
+				reference.erase(key);
+				std::erase(order, key);
+				break;
+			default:
+				if(gen() % 20 == 0)
+				{
+					m.clear();
+					reference.clear();
+					order.clear();
+					has_been_large = false;
+				}
+				break;
+			}
+
+			if(m.size() > 16)
+				has_been_large = true;
+
+			CHECK(SameContents(m, reference));
+		#ifndef USE_STL_HASH_MAPS
+			if(!has_been_large)
+			{
+				std::vector<uint64_t> keys;
+				for(auto &[k, v] : m)
+					keys.push_back(k);
+				CHECK(keys == order);
+			}
+		#endif
+		}
+	}
+}
+
+int RunAdaptiveCompactHashMapUnitTests()
+{
+	TestLinearOrder();
+	TestSwitchToHashMap();
+	TestCopyMoveAndCompare();
+	TestRandomOperations();
+
+	std::cout << (g_checks - g_failures) << "/" << g_checks << " checks passed" << std::endl;
+	return g_failures == 0 ? 0 : 1;
+}
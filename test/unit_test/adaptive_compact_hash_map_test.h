@@ -0,0 +1,7 @@
+#pragma once
+
+//Runs the tests for AdaptiveCompactHashMap, covering iteration order and the switch from linear
+//storage to a hash map, against std::map.  Compiled into the lib_smoke_test driver like the
+//clustering tests.  Prints any failures and a summary line; returns the number of failed checks
+//(0 on success).
+int RunAdaptiveCompactHashMapUnitTests();
@@ -0,0 +1,230 @@
+//Round-trip tests for caml payload compression
+#include "binary_packing_test.h"
+#include "BinaryPacking.h"
+#include "FileSupportCAML.h"
+
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+static int g_failures = 0;
+static int g_checks = 0;
+
+#define CHECK(cond) do { \
+	++g_checks; \
+	if(!(cond)) { ++g_failures; \
+		std::cerr << "FAIL " << __FILE__ << ":" << __LINE__ << ": " #cond << std::endl; } \
+	} while(0)
+
+//Text with a handful of common bytes and a long tail of rare ones, so that some codes are
+//longer than the decoding table and take the tree walk fallback.
+static std::string SkewedText(size_t size, unsigned seed)
+{
+	std::mt19937 gen(seed);
+	std::geometric_distribution<int> dist(0.35);
+	std::string s;
+	s.reserve(size);
+	for(size_t i = 0; i < size; i++)
+		s.push_back(static_cast<char>(dist(gen) % 256));
+	return s;
+}
+
+//Compresses s in chunks ending at chunk_ends and checks that the payload decodes back to s.
+static bool RoundTripsInChunks(std::string &s, std::vector<size_t> chunk_ends, bool run_concurrently)
+{
+	auto [payload, huffman_tree] = CompressStringInChunks(s, chunk_ends, run_concurrently);
+	std::unique_ptr<HuffmanTree<uint8_t>> tree_owner(huffman_tree);
+	return FileSupportCAML::DecompressPayload(payload, FileSupportCAML::PAYLOAD_VERSION_CHUNKED, run_concurrently) == s;
+}
+
+//Appends index in the variable length encoding used by chunk indices.
+static void AppendCompactIndex(BinaryData &bd, size_t index)
+{
+	while(index >= 0x80)
+	{
+		bd.push_back(static_cast<uint8_t>((index & 0x7F) | 0x80));
+		index >>= 7;
+	}
+	bd.push_back(static_cast<uint8_t>(index));
+}
+
+static void TestChunkEnds()
+{
+	// Fixed size chunks always end at total_size, even when it is a multiple of the chunk size.
+	CHECK((GetCompressionChunkEnds(10, 4) == std::vector<size_t>{4, 8, 10}));
+	CHECK((GetCompressionChunkEnds(8, 4) == std::vector<size_t>{4, 8}));
+	CHECK((GetCompressionChunkEnds(3, 4) == std::vector<size_t>{3}));
+	CHECK((GetCompressionChunkEnds(0, 4) == std::vector<size_t>{0}));
+	CHECK((GetCompressionChunkEnds(10, 0) == std::vector<size_t>{10}));
+
+	// Split offsets are only used once a chunk has reached the target size.
+	std::vector<size_t> split_offsets = {1, 2, 5, 6, 9, 12};
+	CHECK((GetCompressionChunkEnds(12, 4, &split_offsets) == std::vector<size_t>{5, 9, 12}));
+	CHECK((GetCompressionChunkEnds(12, 100, &split_offsets) == std::vector<size_t>{12}));
+}
+
+static void TestChunkedRoundTrip()
+{
+	for(size_t size : {0, 1, 2, 7, 8, 9, 255, 256, 4099})
+	{
+		std::string s = SkewedText(size, static_cast<unsigned>(size));
+		for(size_t chunk_size : {0, 1, 3, 8, 64, 4096})
+		{
+			CHECK(RoundTripsInChunks(s, GetCompressionChunkEnds(s.size(), chunk_size), false));
+			CHECK(RoundTripsInChunks(s, GetCompressionChunkEnds(s.size(), chunk_size), true));
+		}
+	}
+
+	// Chunks of uneven lengths, including empty ones, as produced from split offsets.
+	std::string s = SkewedText(1000, 7);
+	CHECK(RoundTripsInChunks(s, {0, 0, 1, 500, 500, 999, 1000}, true));
+
+	// Only one distinct byte value.
+	std::string repeated(5000, 'x');
+	CHECK(RoundTripsInChunks(repeated, GetCompressionChunkEnds(repeated.size(), 16), true));
+
+	// Every byte value, so that the payload uses the whole frequency table.
+	std::string all_bytes;
+	for(int i = 0; i < 256 * 3; i++)
+		all_bytes.push_back(static_cast<char>(i % 256));
+	CHECK(RoundTripsInChunks(all_bytes, GetCompressionChunkEnds(all_bytes.size(), 100), true));
+}
+
+static void TestAppendedBlocks()
+{
+	// Blocks appended after the chunks, as a persistent write listener does, decode after the chunks.
+	std::string s = SkewedText(3000, 11);
+	std::vector<size_t> chunk_ends = GetCompressionChunkEnds(s.size(), 512);
+	auto [payload, huffman_tree] = CompressStringInChunks(s, chunk_ends, false);
+	std::unique_ptr<HuffmanTree<uint8_t>> tree_owner(huffman_tree);
+
+	std::string expected = s;
+	for(unsigned i = 0; i < 3; i++)
+	{
+		std::string appended = SkewedText(100 + i, 20 + i);
+		BinaryData block = CompressStringToAppend(appended, huffman_tree);
+		payload.insert(end(payload), begin(block), end(block));
+		expected += appended;
+	}
+
+	CHECK(FileSupportCAML::DecompressPayload(payload, FileSupportCAML::PAYLOAD_VERSION_CHUNKED, false) == expected);
+	CHECK(FileSupportCAML::DecompressPayload(payload, FileSupportCAML::PAYLOAD_VERSION_CHUNKED, true) == expected);
+}
+
+static void TestCorruptChunkIndex()
+{
+	// A payload of one empty chunk ends with the chunk count, the uncompressed and compressed sizes,
+	// and the one byte encoded chunk.
+	std::string empty;
+	std::vector<size_t> chunk_ends = {0};
+	auto [payload, huffman_tree] = CompressStringInChunks(empty, chunk_ends, false);
+	std::unique_ptr<HuffmanTree<uint8_t>> tree_owner(huffman_tree);
+	CHECK(payload.size() > 4);
+	CHECK((BinaryData(end(payload) - 4, end(payload)) == BinaryData{1, 0, 1, 0}));
+	CHECK(ChunkedCompressedData(payload).IsValid());
+
+	BinaryData index_start(begin(payload), end(payload) - 4);
+
+	// Uncompressed sizes larger than the chunk could possibly decode to are rejected rather than allocated.
+	for(size_t uncompressed_size : {static_cast<size_t>(9), static_cast<size_t>(1) << 40, std::numeric_limits<size_t>::max()})
+	{
+		BinaryData corrupt = index_start;
+		AppendCompactIndex(corrupt, 1);
+		AppendCompactIndex(corrupt, uncompressed_size);
+		AppendCompactIndex(corrupt, 1);
+		corrupt.push_back(0);
+		CHECK(!ChunkedCompressedData(corrupt).IsValid());
+		CHECK(FileSupportCAML::DecompressPayload(corrupt, FileSupportCAML::PAYLOAD_VERSION_CHUNKED, true).empty());
+	}
+
+	// Compressed sizes past the end of the data are rejected.
+	BinaryData truncated = index_start;
+	AppendCompactIndex(truncated, 1);
+	AppendCompactIndex(truncated, 0);
+	AppendCompactIndex(truncated, 2);
+	truncated.push_back(0);
+	CHECK(!ChunkedCompressedData(truncated).IsValid());
+
+	// More chunks than the index could hold are rejected.
+	BinaryData too_many_chunks = index_start;
+	AppendCompactIndex(too_many_chunks, static_cast<size_t>(1) << 40);
+	CHECK(!ChunkedCompressedData(too_many_chunks).IsValid());
+}
+
+//Writes a caml header for payload_version and reads it back, returning whether it was accepted.
+static bool HeaderRoundTrips(uint32_t payload_version, std::string &header, uint32_t &read_payload_version)
+{
+	std::ostringstream outs;
+	if(!FileSupportCAML::WriteHeader(outs, payload_version))
+		return false;
+	header = outs.str();
+
+	std::istringstream ins(header);
+	size_t header_size = 0;
+	read_payload_version = FileSupportCAML::LATEST_PAYLOAD_VERSION + 1;
+	auto [error_message, version, success] = FileSupportCAML::ReadHeader(ins, header_size, read_payload_version);
+	return success && header_size == header.size();
+}
+
+static void TestHeaderPayloadVersion()
+{
+	// Block stream payloads keep the original header, so earlier versions can read them.
+	std::string header;
+	uint32_t read_payload_version = 0;
+	CHECK(HeaderRoundTrips(FileSupportCAML::PAYLOAD_VERSION_BLOCKS, header, read_payload_version));
+	CHECK(read_payload_version == FileSupportCAML::PAYLOAD_VERSION_BLOCKS);
+	CHECK(header.size() == 16);
+	CHECK(header.substr(0, 4) == "caml");
+
+	// Chunked payloads have a different magic number, so earlier versions reject them, followed by the payload version.
+	CHECK(HeaderRoundTrips(FileSupportCAML::PAYLOAD_VERSION_CHUNKED, header, read_payload_version));
+	CHECK(read_payload_version == FileSupportCAML::PAYLOAD_VERSION_CHUNKED);
+	CHECK(header.size() == 20);
+	CHECK(header.substr(0, 4) != "caml");
+
+	// Payload versions newer than this reader are refused.
+	CHECK(!HeaderRoundTrips(FileSupportCAML::LATEST_PAYLOAD_VERSION + 1, header, read_payload_version));
+
+	// A versioned header cut off before its payload version is refused.
+	CHECK(HeaderRoundTrips(FileSupportCAML::PAYLOAD_VERSION_CHUNKED, header, read_payload_version));
+	std::istringstream truncated(header.substr(0, 18));
+	size_t header_size = 0;
+	auto [error_message, version, success] = FileSupportCAML::ReadHeader(truncated, header_size, read_payload_version);
+	CHECK(!success);
+}
+
+static void TestBlockStreamPayload()
+{
+	// Payloads from CompressString, as written by earlier versions, are still decoded.
+	for(size_t size : {1, 100, 5000})
+	{
+		std::string s = SkewedText(size, 31);
+		auto [payload, huffman_tree] = CompressString(s);
+		std::unique_ptr<HuffmanTree<uint8_t>> tree_owner(huffman_tree);
+		CHECK(FileSupportCAML::DecompressPayload(payload, FileSupportCAML::PAYLOAD_VERSION_BLOCKS) == s);
+		CHECK(DecompressString(payload) == s);
+
+		// Block stream payloads are compressed exactly as the serial path does, whatever the split offsets.
+		std::vector<size_t> split_offsets = {0, size / 2, size};
+		auto [block_payload, block_huffman_tree] = FileSupportCAML::CompressPayload(s,
+			FileSupportCAML::PAYLOAD_VERSION_BLOCKS, &split_offsets, true);
+		std::unique_ptr<HuffmanTree<uint8_t>> block_tree_owner(block_huffman_tree);
+		CHECK(block_payload == payload);
+	}
+}
+
+int RunBinaryPackingUnitTests()
+{
+	TestChunkEnds();
+	TestChunkedRoundTrip();
+	TestAppendedBlocks();
+	TestCorruptChunkIndex();
+	TestHeaderPayloadVersion();
+	TestBlockStreamPayload();
+
+	std::cout << (g_checks - g_failures) << "/" << g_checks << " checks passed" << std::endl;
+	return g_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,6 @@
+#pragma once
+
+//Runs the round-trip tests for caml payload compression, including chunked payloads and appended
+//blocks.  Compiled into the lib_smoke_test driver like the clustering tests.  Prints any failures
+//and a summary line; returns the number of failed checks (0 on success).
+int RunBinaryPackingUnitTests();
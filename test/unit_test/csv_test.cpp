@@ -0,0 +1,253 @@
+//Unit tests for loading csv files
+#include "csv_test.h"
+#include "Entity.h"
+#include "EvaluableNodeManagement.h"
+#include "FileSupportCSV.h"
+#include "Parser.h"
+
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+static int g_failures = 0;
+static int g_checks = 0;
+
+#define CHECK(cond) do { \
+	++g_checks; \
+	if(!(cond)) { ++g_failures; \
+		std::cerr << "FAIL " << __FILE__ << ":" << __LINE__ << ": " #cond << std::endl; } \
+	} while(0)
+
+//parses data one character at a time into a list of rows the way the csv loader always has,
+// as the reference for the output of FileSupportCSV::Load
+//the only difference is that a closing quote at the very end of data ends the field rather than
+// reading past the end of data, which used to append a stray null character to the field
+static EvaluableNode *ReferenceParseCSV(const std::string &data, EvaluableNodeManager *enm)
+{
+	size_t file_size = data.size();
+	EvaluableNode *data_top_node = enm->AllocNode(ENT_LIST);
+	size_t cur_position = 0;
+	while(cur_position < file_size)
+	{
+		EvaluableNode *cur_row = enm->AllocNode(ENT_LIST);
+		auto &cur_row_ocn = cur_row->GetOrderedChildNodesReference();
+		data_top_node->GetOrderedChildNodesReference().push_back(cur_row);
+
+		std::string value;
+		while(cur_position < file_size)
+		{
+			size_t end_position = cur_position;
+			bool end_of_row = false;
+			value.clear();
+
+			while(end_position < file_size)
+			{
+				if(data[end_position] == '"')
+				{
+					cur_position++;
+					end_position++;
+					while(end_position < file_size)
+					{
+						if(data[end_position] != '"')
+						{
+							value.push_back(data[end_position]);
+							end_position++;
+							continue;
+						}
+
+						if(end_position + 1 < file_size && data[end_position + 1] == '"')
+						{
+							value.push_back('"');
+							end_position += 2;
+							continue;
+						}
+
+						end_position++;
+						break;
+					}
+					cur_position = end_position;
+					if(end_position >= file_size)
+						break;
+				}
+
+				if(data[end_position] == ',')
+					break;
+
+				if(data[end_position] == '\n' || data[end_position] == '\r')
+				{
+					end_of_row = true;
+					break;
+				}
+
+				end_position++;
+			}
+
+			value.append(std::string(&data[cur_position], &data[end_position]));
+
+			if(end_position + 1 < file_size && data[end_position] == '\r' && data[end_position + 1] == '\n')
+				end_position++;
+			end_position++;
+
+			EvaluableNode *element = nullptr;
+			if(value.size() > 0)
+			{
+				auto [float_value, success] = Platform_StringToNumber(value);
+				if(success)
+					element = enm->AllocNode(float_value);
+				else
+					element = enm->AllocNode(ENT_STRING, value);
+			}
+			cur_row_ocn.push_back(element);
+
+			cur_position = end_position;
+			if(end_of_row)
+				break;
+		}
+	}
+
+	return data_top_node;
+}
+
+//returns a random field, which may be empty, a number, plain text, or quoted text containing
+// delimiters, newlines, and escaped quotes
+static std::string RandomField(std::mt19937_64 &gen)
+{
+	static const std::vector<std::string> fields = {
+		"", "0", "1", "-2.5", "3e4", "0x10", " 7", "1.", ".5", "nan", "inf", "abc", "a b", "x1",
+		"\"\"", "\"12\"", "\"a,b\"", "\"line\nbreak\"", "\"crlf\r\nbreak\"", "\"say \"\"hi\"\"\"", "\"\"\"\"",
+		"\"unicode \xC3\xA9\"", "\xE2\x82\xAC"
+	};
+	return fields[gen() % fields.size()];
+}
+
+//returns random csv data with num_rows rows of varying lengths
+static std::string RandomCSV(std::mt19937_64 &gen, size_t num_rows)
+{
+	std::string data;
+	if(gen() % 4 == 0)
+		data += "\xEF\xBB\xBF";
+
+	std::string newline = (gen() % 2 == 0 ? "\n" : "\r\n");
+	for(size_t row = 0; row < num_rows; row++)
+	{
+		size_t num_fields = 1 + gen() % 6;
+		for(size_t i = 0; i < num_fields; i++)
+		{
+			if(i > 0)
+				data += ',';
+			data += RandomField(gen);
+		}
+
+		//omit the final newline sometimes
+		if(row + 1 < num_rows || gen() % 2 == 0)
+			data += newline;
+	}
+	return data;
+}
+
+//writes data to path
+static void WriteFile(const std::string &path, const std::string &data)
+{
+	std::ofstream out(path, std::ios::out | std::ios::binary);
+	out.write(data.data(), data.size());
+}
+
+//loads data with FileSupportCSV::Load and checks that the unparsed result is identical to that of the reference parser
+static void CheckLoadMatchesReference(const std::string &path, const std::string &data)
+{
+	WriteFile(path, data);
+
+	EvaluableNodeManager enm;
+	EntityExternalInterface::LoadEntityStatus status;
+	EvaluableNode *loaded = FileSupportCSV::Load(path, &enm, status);
+	CHECK(status.loaded);
+
+	std::string data_without_bom = data;
+	StringManipulation::RemoveBOMFromUTF8String(data_without_bom);
+	EvaluableNode *expected = ReferenceParseCSV(data_without_bom, &enm);
+
+	std::string loaded_string = Parser::Unparse(loaded, false);
+	std::string expected_string = Parser::Unparse(expected, false);
+	CHECK(loaded_string == expected_string);
+	if(loaded_string != expected_string && data.size() < 1000)
+		std::cerr << "  data: " << data << "\n  loaded: " << loaded_string << "\n  expected: " << expected_string << std::endl;
+}
+
+static void TestLoadUnchanged(const std::string &path)
+{
+	// Edge cases.
+	for(std::string data : { "", "\n", "\n\n", "a", "a,", ",", ",,\n,", "\"\"", "\"a\nb\"\n", "1,2\r\n3,4\r\n",
+		"1,2\r3,4", "\"a\"\"b\",c", "\xEF\xBB\xBF" "x,1\n", "a\n\nb\n" })
+		CheckLoadMatchesReference(path, data);
+
+	std::mt19937_64 gen(12345);
+	for(int trial = 0; trial < 200; trial++)
+		CheckLoadMatchesReference(path, RandomCSV(gen, gen() % 30));
+
+	// Large enough to be split into several chunks, with quoted newlines spanning the split points.
+	CheckLoadMatchesReference(path, RandomCSV(gen, 200000));
+}
+
+static void TestRowsAsEntities(const std::string &path)
+{
+	WriteFile(path,
+		"id,size,name,,note\n"
+		"1,2.5,a,ignored,\n"
+		"2,,\"b,c\",ignored,x\n"
+		"3,7,4,ignored,\"12\"\n"
+		"4,8\n");
+
+	Entity container;
+	container.SetRandomState("seed", false);
+	EntityExternalInterface::LoadEntityStatus status;
+	FileSupportCSV::LoadRowsAsContainedEntities(path, &container, status);
+	CHECK(status.loaded);
+
+	auto &contained = container.GetContainedEntities();
+	CHECK(contained.size() == 4);
+	if(contained.size() != 4)
+		return;
+
+	// Columns with only numbers are numbers, the rest are strings, empty or missing values are null,
+	// and the column without a label is skipped.
+	std::vector<std::string> expected_roots = {
+		R"({id 1 name "a" note .null size 2.5})",
+		R"({id 2 name "b,c" note "x" size .null})",
+		R"({id 3 name "4" note "12" size 7})",
+		R"({id 4 name .null note .null size 8})"
+	};
+
+	for(size_t i = 0; i < contained.size(); i++)
+	{
+		std::string root = Parser::Unparse(contained[i]->GetRoot(), false, true, true);
+		CHECK(root == expected_roots[i]);
+		if(root != expected_roots[i])
+			std::cerr << "  root " << i << ": " << root << std::endl;
+	}
+
+	// The rows get distinct random states.
+	CHECK(contained[0]->GetRandomState() != contained[1]->GetRandomState());
+
+	// A missing file fails to load.
+	Entity missing_container;
+	EntityExternalInterface::LoadEntityStatus missing_status;
+	FileSupportCSV::LoadRowsAsContainedEntities(path + ".missing", &missing_container, missing_status);
+	CHECK(!missing_status.loaded);
+	CHECK(missing_container.GetContainedEntities().size() == 0);
+}
+
+int RunCSVUnitTests()
+{
+	std::string path = (std::filesystem::temp_directory_path() / "amalgam_csv_test.csv").string();
+
+	TestLoadUnchanged(path);
+	TestRowsAsEntities(path);
+
+	std::filesystem::remove(path);
+
+	std::cout << (g_checks - g_failures) << "/" << g_checks << " checks passed" << std::endl;
+	return g_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,7 @@
+#pragma once
+
+//Runs the tests for loading csv files, comparing the output of load against a straightforward
+//sequential parser and checking rows loaded as contained entities.  Compiled into the lib_smoke_test
+//driver like the clustering tests.  Prints any failures and a summary line; returns the number of
+//failed checks (0 on success).
+int RunCSVUnitTests();
@@ -0,0 +1,197 @@
+//Unit tests for parsing and formatting dates
+#include "datetime_format_test.h"
+#include "DateTimeFormat.h"
+
+#include "date/date.h"
+#include "date/tz.h"
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+static int g_failures = 0;
+static int g_checks = 0;
+
+#define CHECK(cond) do { \
+	++g_checks; \
+	if(!(cond)) { ++g_failures; \
+		std::cerr << "FAIL " << __FILE__ << ":" << __LINE__ << ": " #cond << std::endl; } \
+	} while(0)
+
+//returns the time zone for timezone, where an empty string is the current time zone
+static const date::time_zone *ReferenceTimeZone(const std::string &timezone)
+{
+	if(timezone.empty())
+		return date::current_zone();
+	return date::locate_zone(timezone);
+}
+
+//parses datetime_str with date::parse the way the conversion always has, as the reference for
+// GetNumSecondsSinceEpochFromDateTimeString without a locale
+//format must only contain valid specifiers
+static double ReferenceParse(const std::string &datetime_str, const std::string &format, const std::string &timezone)
+{
+	bool has_time_offset = (format.find("%z") != std::string::npos);
+	bool is_month_and_year_only = (format == "%Y-%m" || format == "%m/%Y");
+
+	std::chrono::system_clock::time_point dt;
+	std::string in_date_timezone;
+	std::istringstream in(datetime_str);
+	if(is_month_and_year_only)
+	{
+		date::year_month ym{ date::year{ 1970 }, date::January };
+		in >> date::parse(format, ym, in_date_timezone);
+		dt = date::sys_days{ ym / 1 };
+	}
+	else
+	{
+		in >> date::parse(format, dt, in_date_timezone);
+	}
+
+	std::string zone_name = timezone;
+	if(!in_date_timezone.empty())
+		zone_name = in_date_timezone;
+	else if(has_time_offset)
+		zone_name = "UTC";
+
+	auto zoned_datetime = date::make_zoned(ReferenceTimeZone(zone_name), dt);
+	int64_t diff = std::chrono::duration_cast<std::chrono::seconds>(zoned_datetime.get_sys_time().time_since_epoch()).count()
+		- std::chrono::duration_cast<std::chrono::seconds>(zoned_datetime.get_local_time().time_since_epoch()).count();
+	dt += std::chrono::seconds(diff);
+
+	return std::chrono::duration_cast<std::chrono::microseconds>(dt.time_since_epoch()).count() / 1000000.0;
+}
+
+//formats seconds_since_epoch with date::format the way the conversion always has, as the reference for
+// GetDateTimeStringFromNumSecondsSinceEpoch without a locale
+//format must only contain valid specifiers
+static std::string ReferenceFormat(double seconds_since_epoch, const std::string &format, const std::string &timezone)
+{
+	bool has_time_offset = (format.find("%z") != std::string::npos);
+	const date::time_zone *tz = ReferenceTimeZone(timezone.empty() && has_time_offset ? std::string("UTC") : timezone);
+
+	auto datetime = std::chrono::system_clock::time_point(std::chrono::duration_cast<std::chrono::microseconds>(
+		std::chrono::duration<double>(seconds_since_epoch)));
+
+	std::ostringstream out;
+	try
+	{
+		if(seconds_since_epoch != static_cast<int64_t>(seconds_since_epoch))
+			out << date::format(format, date::make_zoned(tz, datetime));
+		else
+			out << date::format(format, date::make_zoned(tz, std::chrono::floor<std::chrono::seconds>(datetime)));
+	}
+	catch(...)
+	{
+	}
+	return out.str();
+}
+
+//returns true if a and b are the same number, or both are nan
+static bool SameNumber(double a, double b)
+{
+	return a == b || (std::isnan(a) && std::isnan(b));
+}
+
+static const std::vector<std::string> timezones = { "UTC", "America/New_York", "Asia/Kolkata", "Australia/Lord_Howe" };
+
+//checks that s parses to the same value as with the date library
+static void CheckParse(const std::string &s, const std::string &format, const std::string &timezone)
+{
+	double value = GetNumSecondsSinceEpochFromDateTimeString(s, format, "", timezone);
+	double expected = ReferenceParse(s, format, timezone);
+	CHECK(SameNumber(value, expected));
+	if(!SameNumber(value, expected))
+		std::cerr << "  parse \"" << s << "\" with \"" << format << "\" in " << timezone
+			<< ": " << value << " expected " << expected << std::endl;
+}
+
+//checks that seconds_since_epoch formats to the same string as with the date library
+static void CheckFormat(double seconds_since_epoch, const std::string &format, const std::string &timezone)
+{
+	std::string value = GetDateTimeStringFromNumSecondsSinceEpoch(seconds_since_epoch, format, "", timezone);
+	std::string expected = ReferenceFormat(seconds_since_epoch, format, timezone);
+	CHECK(value == expected);
+	if(value != expected)
+		std::cerr << "  format " << seconds_since_epoch << " with \"" << format << "\" in " << timezone
+			<< ": \"" << value << "\" expected \"" << expected << "\"" << std::endl;
+}
+
+static void TestParse()
+{
+	std::vector<std::string> formats = { "%Y-%m-%d", "%Y-%m-%dT%H:%M:%S", "%F %T", "%F %R", "%Y%m%d%H%M%S",
+		"%d/%m/%Y %H:%M", "%Y-%m-%d %H:%M:%S%z", "%FT%T %z", "%Y-%m", "%m/%Y", "%Y %% %m %d", "%Y-%m-%d  %H" };
+
+	//strings for each format, both valid and invalid
+	std::vector<std::string> strings = {
+		"2020-01-02", "2020-1-2", "2020-13-02", "2020-02-30", "2020-02-29", "2019-02-29", "0000-01-01", "9999-12-31",
+		"2020-01-02T03:04:05", "2020-01-02T03:04:05.123456", "2020-01-02T03:04:60", "2020-01-02T24:00:00",
+		"2020-01-02T23:60:00", "2020-01-02T3:4:5", "2020-01-02 03:04:05", "2020-01-02 03:04", "20200102030405",
+		"02/01/2020 03:04", "2/1/2020 3:04", "2020-01-02 03:04:05+0130", "2020-01-02 03:04:05-0500",
+		"2020-01-02 03:04:05 +0130", "2020-01-02 03:04:05+01", "2020-01-02 03:04:05+1", "2020-01-02 03:04:05+013",
+		"2020-01-02 03:04:05 0130", "2020-01-02T03:04:05 -0930", "2020-01", "01/2020", "13/2020", "2020 % 01 02",
+		"2020 01 02", "2020-01-02 03", "2020-01-02 \t 03", "2020-01-0203", "", " 2020-01-02", "2020-01-02 ",
+		"x2020-01-02", "2020-0a-02", "-2020-01-02", "+2020-01-02", "12020-01-02", "2020-01-02T03:04:05.5Z"
+	};
+
+	for(auto &format : formats)
+	{
+		for(auto &timezone : timezones)
+		{
+			for(auto &s : strings)
+				CheckParse(s, format, timezone);
+		}
+	}
+
+	// Strings formatted from random dates by the date library parse back the same way.
+	std::mt19937_64 gen(12345);
+	std::uniform_int_distribution<int64_t> seconds_dist(-2'000'000'000'000LL / 1000, 253'402'300'799LL);
+	for(int trial = 0; trial < 2000; trial++)
+	{
+		auto &format = formats[gen() % formats.size()];
+		auto &timezone = timezones[gen() % timezones.size()];
+		double seconds = static_cast<double>(seconds_dist(gen));
+		std::string s = ReferenceFormat(seconds, format, timezone);
+		CheckParse(s, format, timezone);
+	}
+}
+
+static void TestFormat()
+{
+	std::vector<std::string> formats = { "%Y-%m-%d", "%FT%T", "%F %R", "%D %T", "%e %b %Y", "%A %B %d %y %C",
+		"%a %h %j %u %w", "%I:%M:%S %p", "%Y-%m-%d %H:%M:%S%z", "%F %T %Z", "%Y%n%m%t%d", "%% %Y", "%Y-%m-%d %H:%M:%S" };
+
+	std::vector<double> values = { 0, 1, -1, 86399, 86400, 951782400, 1583020800, 1577923200.5, -0.25,
+		253402300799, 253402300800, -62167219200, -62167219201, 1e15, -1e15, 1234567890.123456 };
+
+	std::mt19937_64 gen(12345);
+	std::uniform_int_distribution<int64_t> seconds_dist(-62'167'219'200LL, 253'402'300'799LL);
+	for(int i = 0; i < 500; i++)
+		values.push_back(static_cast<double>(seconds_dist(gen)));
+
+	for(auto &format : formats)
+	{
+		for(auto &timezone : timezones)
+		{
+			for(double value : values)
+				CheckFormat(value, format, timezone);
+		}
+	}
+
+	// Non-finite values are formatted as the epoch.
+	CHECK(GetDateTimeStringFromNumSecondsSinceEpoch(std::nan(""), "%F", "", "UTC") == "1970-01-01");
+	CHECK(GetDateTimeStringFromNumSecondsSinceEpoch(INFINITY, "%F", "", "UTC") == "1970-01-01");
+}
+
+int RunDateTimeFormatUnitTests()
+{
+	TestParse();
+	TestFormat();
+
+	std::cout << (g_checks - g_failures) << "/" << g_checks << " checks passed" << std::endl;
+	return g_failures == 0 ? 0 : 1;
+}
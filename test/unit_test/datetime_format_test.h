@@ -0,0 +1,6 @@
+#pragma once
+
+//Runs the tests for parsing and formatting dates, comparing the results against the date library
+//used directly.  Compiled into the lib_smoke_test driver like the clustering tests.  Prints any
+//failures and a summary line; returns the number of failed checks (0 on success).
+int RunDateTimeFormatUnitTests();
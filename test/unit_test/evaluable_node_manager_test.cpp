@@ -0,0 +1,125 @@
+//Unit tests for EvaluableNodeManager node allocation
+#include "evaluable_node_manager_test.h"
+#include "EvaluableNodeManagement.h"
+
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+static int g_failures = 0;
+static int g_checks = 0;
+
+#define CHECK(cond) do { \
+	++g_checks; \
+	if(!(cond)) { ++g_failures; \
+		std::cerr << "FAIL " << __FILE__ << ":" << __LINE__ << ": " #cond << std::endl; } \
+	} while(0)
+
+//Checks that every node in allocated is distinct, in use by enm, and still holds the number it was
+//given, which is its index in allocated.
+static void CheckAllocatedNodes(EvaluableNodeManager &enm, const std::vector<EvaluableNode *> &allocated)
+{
+	std::unordered_set<EvaluableNode *> distinct(begin(allocated), end(allocated));
+	CHECK(distinct.size() == allocated.size());
+	CHECK(distinct.count(nullptr) == 0);
+	CHECK(enm.GetNumberOfUsedNodes() >= allocated.size());
+
+	size_t num_in_use = 0;
+	for(EvaluableNode *n : enm.GetUsedNodes())
+	{
+		if(distinct.count(n) > 0)
+			num_in_use++;
+	}
+	CHECK(num_in_use == allocated.size());
+
+	size_t num_wrong_values = 0;
+	for(size_t i = 0; i < allocated.size(); i++)
+	{
+		if(allocated[i] == nullptr || allocated[i]->GetType() != ENT_NUMBER
+				|| allocated[i]->GetNumberValueReference() != static_cast<double>(i))
+			num_wrong_values++;
+	}
+	CHECK(num_wrong_values == 0);
+}
+
+static void TestSequentialAllocation()
+{
+	EvaluableNodeManager enm;
+	std::vector<EvaluableNode *> allocated(10000);
+	for(size_t i = 0; i < 5000; i++)
+		allocated[i] = enm.AllocNode(static_cast<double>(i));
+
+	enm.AllocNodes(allocated.data() + 5000, 5000, [](EvaluableNode *n, size_t index)
+		{
+			n->InitializeType(static_cast<double>(5000 + index));
+		});
+
+	CheckAllocatedNodes(enm, allocated);
+}
+
+//Many threads allocate at once from a new manager, so that several of them claim blocks past the end of
+// the node list before any of them grows it.
+static void TestConcurrentAllocation()
+{
+#ifdef MULTITHREAD_SUPPORT
+	const size_t num_threads = 16;
+	const size_t nodes_per_thread = 4000;
+
+	for(int round = 0; round < 20; round++)
+	{
+		EvaluableNodeManager enm;
+		std::vector<EvaluableNode *> allocated(num_threads * nodes_per_thread, nullptr);
+		std::atomic<size_t> num_ready = 0;
+
+		std::vector<std::thread> threads;
+		for(size_t t = 0; t < num_threads; t++)
+		{
+			threads.emplace_back([&, t]()
+				{
+					num_ready++;
+					while(num_ready < num_threads)
+						std::this_thread::yield();
+
+					EvaluableNode **dest = allocated.data() + t * nodes_per_thread;
+					size_t first_index = t * nodes_per_thread;
+
+					//alternate between single node and bulk allocations, which grow the node list differently
+					for(size_t i = 0; i < nodes_per_thread; )
+					{
+						if((i / 100) % 2 == 0)
+						{
+							dest[i] = enm.AllocNode(static_cast<double>(first_index + i));
+							i++;
+						}
+						else
+						{
+							size_t num_nodes = std::min<size_t>(100, nodes_per_thread - i);
+							enm.AllocNodes(dest + i, num_nodes, [first_index, i](EvaluableNode *n, size_t index)
+								{
+									n->InitializeType(static_cast<double>(first_index + i + index));
+								});
+							i += num_nodes;
+						}
+					}
+				});
+		}
+
+		for(auto &thread : threads)
+			thread.join();
+
+		CheckAllocatedNodes(enm, allocated);
+	}
+#endif
+}
+
+int RunEvaluableNodeManagerUnitTests()
+{
+	TestSequentialAllocation();
+	TestConcurrentAllocation();
+
+	std::cout << (g_checks - g_failures) << "/" << g_checks << " checks passed" << std::endl;
+	return g_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,6 @@
+#pragma once
+
+//Runs the tests for EvaluableNodeManager node allocation, including concurrent allocation
+//from many threads.  Compiled into the lib_smoke_test driver like the clustering tests.
+//Prints any failures and a summary line; returns the number of failed checks (0 on success).
+int RunEvaluableNodeManagerUnitTests();
@@ -0,0 +1,393 @@
+//Unit tests for the integer sets
+#include "integer_set_test.h"
+#include "IntegerSet.h"
+
+#include <algorithm>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <set>
+#include <vector>
+
+static int g_failures = 0;
+static int g_checks = 0;
+
+#define CHECK(cond) do { \
+	++g_checks; \
+	if(!(cond)) { ++g_failures; \
+		std::cerr << "FAIL " << __FILE__ << ":" << __LINE__ << ": " #cond << std::endl; } \
+	} while(0)
+
+//BitArrayIntegerSet with access to its buckets to check that summaryBits is maintained.
+class CheckedBitArrayIntegerSet : public BitArrayIntegerSet
+{
+public:
+	//returns true if summaryBits has a bit set for exactly the nonzero buckets, and no bits past the last bucket
+	bool SummaryBitsMatchBuckets()
+	{
+		if(summaryBits.size() != GetNumSummaryWords(bitBucket.size()))
+			return false;
+
+		for(size_t word = 0; word < summaryBits.size(); word++)
+		{
+			for(size_t bit = 0; bit < numBitsPerBucket; bit++)
+			{
+				size_t bucket = word * numBitsPerBucket + bit;
+				bool summary_bit = ((summaryBits[word] >> bit) & 1) != 0;
+				bool nonempty = (bucket < bitBucket.size() && bitBucket[bucket] != 0);
+				if(summary_bit != nonempty)
+					return false;
+			}
+		}
+		return true;
+	}
+};
+
+//Checks that bais holds exactly the elements of reference, that every way of visiting the elements agrees,
+// and that summaryBits matches the buckets.
+static void CheckSet(CheckedBitArrayIntegerSet &bais, const std::set<size_t> &reference)
+{
+	CHECK(bais.SummaryBitsMatchBuckets());
+	CHECK(bais.size() == reference.size());
+	CHECK(bais.GetEndInteger() == (reference.empty() ? 0 : *reference.rbegin() + 1));
+
+	std::vector<size_t> expected(begin(reference), end(reference));
+
+	std::vector<size_t> iterated;
+	for(auto id : bais)
+		iterated.push_back(id);
+	CHECK(iterated == expected);
+
+	std::vector<size_t> iterated_over;
+	bais.IterateOver([&iterated_over](size_t id) { iterated_over.push_back(id); });
+	CHECK(iterated_over == expected);
+
+	if(!expected.empty())
+	{
+		CHECK(bais.GetNthElement(0) == expected.front());
+		CHECK(bais.GetNthElement(expected.size() - 1) == expected.back());
+		CHECK(bais.GetNthElement(expected.size() / 2) == expected[expected.size() / 2]);
+	}
+
+	//probe around each element as well as past the end
+	size_t num_wrong_contains = 0;
+	for(size_t id : expected)
+	{
+		if(!bais.contains(id) || bais.contains(id + 1) != (reference.count(id + 1) > 0))
+			num_wrong_contains++;
+	}
+	if(bais.contains(bais.GetEndInteger() + 1000))
+		num_wrong_contains++;
+	CHECK(num_wrong_contains == 0);
+}
+
+//random ids clustered so that some buckets are dense, some sparse, and many empty, spanning several summary words
+static std::vector<size_t> RandomIds(std::mt19937_64 &gen, size_t num_ids, size_t max_id)
+{
+	std::vector<size_t> ids;
+	std::uniform_int_distribution<size_t> id_dist(0, max_id);
+	while(ids.size() < num_ids)
+	{
+		size_t start = id_dist(gen);
+		size_t run_length = 1 + gen() % 80;
+		for(size_t i = 0; i < run_length && ids.size() < num_ids; i++)
+			ids.push_back(start + i * (1 + gen() % 3));
+	}
+	return ids;
+}
+
+static void TestInsertEraseClear()
+{
+	CheckedBitArrayIntegerSet bais;
+	std::set<size_t> reference;
+	CheckSet(bais, reference);
+
+	// Ids at bucket and summary word boundaries.
+	for(size_t id : { 0, 63, 64, 4095, 4096, 4097, 64 * 64 * 3 + 5 })
+	{
+		bais.insert(id);
+		reference.insert(id);
+		CheckSet(bais, reference);
+	}
+
+	// Erasing the last element of a bucket clears its summary bit, and erasing the largest trims the storage.
+	for(size_t id : { 63, 4096, 64 * 64 * 3 + 5, 12345 })
+	{
+		bais.erase(id);
+		reference.erase(id);
+		CheckSet(bais, reference);
+	}
+
+	// Erasing without trimming keeps the storage, but the summary must still be correct.
+	bais.erase(4097, false);
+	reference.erase(4097);
+	CheckSet(bais, reference);
+
+	bais.clear();
+	reference.clear();
+	CheckSet(bais, reference);
+
+	// Reuse after clearing.
+	std::mt19937_64 gen(12345);
+	for(size_t id : RandomIds(gen, 2000, 50000))
+	{
+		bais.insert(id);
+		reference.insert(id);
+	}
+	CheckSet(bais, reference);
+
+	std::vector<size_t> to_erase = RandomIds(gen, 1500, 50000);
+	for(size_t i = 0; i < to_erase.size(); i++)
+	{
+		bais.erase(to_erase[i], i % 2 == 0);
+		reference.erase(to_erase[i]);
+	}
+	CheckSet(bais, reference);
+
+	// Erasing everything leaves an empty set with no nonempty buckets.
+	std::vector<size_t> all(begin(reference), end(reference));
+	for(size_t id : all)
+		bais.erase(id);
+	reference.clear();
+	CheckSet(bais, reference);
+}
+
+static void TestResize()
+{
+	// Growing without filling adds empty buckets.
+	CheckedBitArrayIntegerSet bais;
+	bais.insert(3);
+	bais.resize(64 * 100);
+	CheckSet(bais, { 3 });
+
+	// Growing with filling marks every new bucket as nonempty.
+	CheckedBitArrayIntegerSet filled;
+	filled.insert(3);
+	filled.resize(64 * 70, true);
+	filled.UpdateNumElements();
+	std::set<size_t> filled_reference = { 3 };
+	for(size_t id = 64; id < 64 * 70; id++)
+		filled_reference.insert(id);
+	CheckSet(filled, filled_reference);
+
+	// Shrinking within a summary word and across summary words clears the summary bits of the removed buckets.
+	for(size_t new_size : { 64 * 65 + 1, 64 * 64, 64 * 10, 1 })
+	{
+		filled.resize(new_size);
+		filled.UpdateNumElements();
+		size_t new_end = ((new_size - 1) / 64 + 1) * 64;
+		filled_reference.erase(filled_reference.lower_bound(new_end), end(filled_reference));
+		CheckSet(filled, filled_reference);
+	}
+}
+
+static void TestSetOperations()
+{
+	std::mt19937_64 gen(12345);
+	for(int trial = 0; trial < 50; trial++)
+	{
+		size_t max_id = (trial % 2 == 0) ? 3000 : 100000;
+		std::vector<size_t> ids_a = RandomIds(gen, gen() % 2000, max_id);
+		std::vector<size_t> ids_b = RandomIds(gen, gen() % 2000, max_id);
+		std::set<size_t> ref_a(begin(ids_a), end(ids_a));
+		std::set<size_t> ref_b(begin(ids_b), end(ids_b));
+
+		CheckedBitArrayIntegerSet a;
+		CheckedBitArrayIntegerSet b;
+		for(size_t id : ids_a)
+			a.insert(id);
+		for(size_t id : ids_b)
+			b.insert(id);
+		SortedIntegerSet sis_b(ref_b);
+		//refer to b as its base class so the BitArrayIntegerSet overloads are chosen over the generic collection ones
+		BitArrayIntegerSet &b_base = b;
+
+		std::set<size_t> ref_union = ref_a;
+		ref_union.insert(begin(ref_b), end(ref_b));
+		std::set<size_t> ref_intersection;
+		std::set<size_t> ref_difference;
+		for(size_t id : ref_a)
+			(ref_b.count(id) > 0 ? ref_intersection : ref_difference).insert(id);
+
+		CheckedBitArrayIntegerSet result;
+		result = a;
+		result.Union(b);
+		CheckSet(result, ref_union);
+
+		result = a;
+		result.InsertInBatch(sis_b);
+		CheckSet(result, ref_union);
+
+		result = a;
+		result.Intersect(b);
+		CheckSet(result, ref_intersection);
+
+		result = a;
+		result.Intersect(sis_b);
+		CheckSet(result, ref_intersection);
+
+		std::vector<size_t> intersected;
+		BitArrayIntegerSet::IterateOverIntersection(a, b, [&intersected](size_t id) { intersected.push_back(id); });
+		CHECK(intersected == std::vector<size_t>(begin(ref_intersection), end(ref_intersection)));
+
+		result = a;
+		result.erase(b_base);
+		CheckSet(result, ref_difference);
+
+		result = a;
+		result.EraseInBatch(b_base);
+		result.UpdateNumElements();
+		CheckSet(result, ref_difference);
+
+		result = a;
+		result.EraseInBatch(sis_b);
+		CheckSet(result, ref_difference);
+
+		result = a;
+		result.erase(sis_b);
+		CheckSet(result, ref_difference);
+	}
+
+	// Operations with an empty set.
+	CheckedBitArrayIntegerSet empty;
+	CheckedBitArrayIntegerSet some;
+	some.insert(5);
+	some.insert(700);
+	CheckedBitArrayIntegerSet result;
+	result = some;
+	result.Intersect(empty);
+	CheckSet(result, {});
+	result = empty;
+	result.Union(some);
+	CheckSet(result, { 5, 700 });
+	BitArrayIntegerSet &some_base = some;
+	result.erase(some_base);
+	CheckSet(result, {});
+}
+
+//returns the intersection of a and b computed by IntersectSortedIntegers, both into a separate buffer and in place into a copy of a,
+// checking that both agree with std::set_intersection
+static void CheckIntersectSortedIntegers(const std::vector<size_t> &a, const std::vector<size_t> &b)
+{
+	std::vector<size_t> expected;
+	std::set_intersection(begin(a), end(a), begin(b), end(b), std::back_inserter(expected));
+
+	std::vector<size_t> out(std::min(a.size(), b.size()) + 1);
+	size_t num_out = SortedIntegerSet::IntersectSortedIntegers(a.data(), a.size(), b.data(), b.size(), out.data());
+	out.resize(num_out);
+	CHECK(out == expected);
+
+	//in place, the way SortedIntegerSet::Intersect calls it
+	std::vector<size_t> in_place = a;
+	num_out = SortedIntegerSet::IntersectSortedIntegers(in_place.data(), in_place.size(), b.data(), b.size(), in_place.data());
+	in_place.resize(num_out);
+	CHECK(in_place == expected);
+
+	//the result does not depend on which array is first
+	out.assign(std::min(a.size(), b.size()) + 1, 0);
+	num_out = SortedIntegerSet::IntersectSortedIntegers(b.data(), b.size(), a.data(), a.size(), out.data());
+	out.resize(num_out);
+	CHECK(out == expected);
+}
+
+//returns num_ids sorted unique ids drawn from [0, max_id]
+static std::vector<size_t> RandomSortedIds(std::mt19937_64 &gen, size_t num_ids, size_t max_id)
+{
+	std::set<size_t> ids;
+	std::uniform_int_distribution<size_t> id_dist(0, max_id);
+	num_ids = std::min(num_ids, max_id + 1);
+	while(ids.size() < num_ids)
+		ids.insert(id_dist(gen));
+	return std::vector<size_t>(begin(ids), end(ids));
+}
+
+static void TestIntersectSortedIntegers()
+{
+	// Empty inputs.
+	CheckIntersectSortedIntegers({}, {});
+	CheckIntersectSortedIntegers({}, { 1, 2, 3 });
+	CheckIntersectSortedIntegers({ 1, 2, 3 }, {});
+
+	// Disjoint ranges, touching ranges, and identical arrays.
+	CheckIntersectSortedIntegers({ 1, 2, 3, 4, 5 }, { 6, 7, 8, 9, 10 });
+	CheckIntersectSortedIntegers({ 1, 2, 3, 4, 5 }, { 5, 6, 7, 8, 9 });
+	std::vector<size_t> range(100);
+	for(size_t i = 0; i < range.size(); i++)
+		range[i] = i * 3;
+	CheckIntersectSortedIntegers(range, range);
+
+	// Lengths around the block size of 4, including ones that are not multiples of 4 or 8,
+	// with matches in the last partial blocks.
+	for(size_t a_size = 1; a_size <= 19; a_size++)
+	{
+		for(size_t b_size = 1; b_size <= 19; b_size++)
+		{
+			std::vector<size_t> a(a_size);
+			std::vector<size_t> b(b_size);
+			for(size_t i = 0; i < a_size; i++)
+				a[i] = i * 2;
+			for(size_t i = 0; i < b_size; i++)
+				b[i] = i * 3;
+			CheckIntersectSortedIntegers(a, b);
+
+			//all of the smaller one matches
+			for(size_t i = 0; i < b_size; i++)
+				b[i] = i;
+			CheckIntersectSortedIntegers(a, b);
+		}
+	}
+
+	std::mt19937_64 gen(12345);
+
+	// Similar sizes, which merge, with dense and sparse overlap.
+	for(int trial = 0; trial < 500; trial++)
+	{
+		size_t max_id = (trial % 2 == 0) ? 200 : 100000;
+		CheckIntersectSortedIntegers(RandomSortedIds(gen, gen() % 150, max_id), RandomSortedIds(gen, gen() % 150, max_id));
+	}
+
+	// Skewed sizes on either side of the galloping ratio.
+	for(int trial = 0; trial < 200; trial++)
+	{
+		size_t small_size = 1 + gen() % 20;
+		size_t ratio = (trial % 3 == 0) ? SortedIntegerSet::gallopingSizeRatio - 1 : SortedIntegerSet::gallopingSizeRatio + trial % 5;
+		size_t max_id = small_size * ratio * ((trial % 4 == 0) ? 1 : 5);
+		std::vector<size_t> small_ids = RandomSortedIds(gen, small_size, max_id);
+		std::vector<size_t> large_ids = RandomSortedIds(gen, small_size * ratio, max_id);
+		CheckIntersectSortedIntegers(small_ids, large_ids);
+
+		//include elements before and after the range of the other
+		if(small_ids.front() != 0)
+			small_ids.insert(begin(small_ids), 0);
+		small_ids.push_back(max_id + 10);
+		CheckIntersectSortedIntegers(small_ids, large_ids);
+	}
+
+	// A single element against a large array.
+	std::vector<size_t> large_ids = RandomSortedIds(gen, 5000, 20000);
+	CheckIntersectSortedIntegers({ large_ids[0] }, large_ids);
+	CheckIntersectSortedIntegers({ large_ids[2500] }, large_ids);
+	CheckIntersectSortedIntegers({ large_ids.back() }, large_ids);
+	CheckIntersectSortedIntegers({ large_ids.back() + 1 }, large_ids);
+
+	// SortedIntegerSet::Intersect uses the same function in place.
+	std::vector<size_t> ids_a = RandomSortedIds(gen, 1000, 5000);
+	std::vector<size_t> ids_b = RandomSortedIds(gen, 700, 5000);
+	SortedIntegerSet sis_a(ids_a);
+	SortedIntegerSet sis_b(ids_b);
+	sis_a.Intersect(sis_b);
+	std::vector<size_t> expected;
+	std::set_intersection(begin(ids_a), end(ids_a), begin(ids_b), end(ids_b), std::back_inserter(expected));
+	CHECK(sis_a.GetIntegerVector() == expected);
+}
+
+int RunIntegerSetUnitTests()
+{
+	TestInsertEraseClear();
+	TestResize();
+	TestSetOperations();
+	TestIntersectSortedIntegers();
+
+	std::cout << (g_checks - g_failures) << "/" << g_checks << " checks passed" << std::endl;
+	return g_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,6 @@
+#pragma once
+
+//Runs the tests for the integer sets, checking their contents and internal summaries against
+//std::set after each operation, and the intersection of sorted integers against
+//std::set_intersection.  Compiled into the lib_smoke_test driver like the clustering tests.  Prints any failures and a summary line; returns the number of failed checks (0 on success).
+int RunIntegerSetUnitTests();
@@ -0,0 +1,141 @@
+//Unit tests for RandomStream
+#include "random_stream_test.h"
+#include "RandomStream.h"
+
+#include <cstdint>
+#include <iostream>
+#include <set>
+#include <string>
+#include <vector>
+
+static int g_failures = 0;
+static int g_checks = 0;
+
+#define CHECK(cond) do { \
+	++g_checks; \
+	if(!(cond)) { ++g_failures; \
+		std::cerr << "FAIL " << __FILE__ << ":" << __LINE__ << ": " #cond << std::endl; } \
+	} while(0)
+
+static const std::vector<std::string> seeds = { "", "0", "12345", "a much longer seed string for the stream" };
+
+//returns the next num_values values of stream
+static std::vector<uint32_t> NextValues(RandomStream &stream, size_t num_values)
+{
+	std::vector<uint32_t> values;
+	for(size_t i = 0; i < num_values; i++)
+		values.push_back(stream.RandUInt32());
+	return values;
+}
+
+//Advance(n) must leave the stream where n calls to RandUInt32 would.
+static void TestAdvance()
+{
+	std::vector<uint64_t> counts = { 0, 1, 2, 3, 7, 8, 63, 64, 65, 1000, 12345, 100000 };
+	for(auto &seed : seeds)
+	{
+		for(uint64_t count : counts)
+		{
+			RandomStream stepped(seed);
+			for(uint64_t i = 0; i < count; i++)
+				stepped.RandUInt32();
+
+			RandomStream advanced(seed);
+			advanced.Advance(count);
+
+			CHECK(advanced.GetState() == stepped.GetState());
+			CHECK(NextValues(advanced, 16) == NextValues(stepped, 16));
+		}
+
+		// Advancing in pieces is the same as advancing all at once.
+		RandomStream whole(seed);
+		whole.Advance(1000);
+		RandomStream pieces(seed);
+		pieces.Advance(1);
+		pieces.Advance(499);
+		pieces.Advance(500);
+		CHECK(whole.GetState() == pieces.GetState());
+
+		// Skipping RandFull values uses numValuesPerRandFull values each.
+		RandomStream full(seed);
+		for(int i = 0; i < 10; i++)
+			full.RandFull();
+		RandomStream skipped(seed);
+		skipped.Advance(10 * RandomStream::numValuesPerRandFull);
+		CHECK(full.GetState() == skipped.GetState());
+		CHECK(full.RandFull() == skipped.RandFull());
+
+		// FillRandFull yields the same values as calling RandFull for each.
+		RandomStream filled(seed);
+		RandomStream called(seed);
+		std::vector<double> values(33);
+		filled.FillRandFull(values.data(), values.size());
+		bool same_values = true;
+		for(double value : values)
+			same_values = same_values && (value == called.RandFull());
+		CHECK(same_values);
+		CHECK(filled.GetState() == called.GetState());
+	}
+}
+
+//CreateSubstream must depend only on the parent's state and the index, must not consume from the parent,
+// and must yield sequences that differ from the parent and from other indices.
+static void TestCreateSubstream()
+{
+	for(auto &seed : seeds)
+	{
+		RandomStream parent(seed);
+		parent.RandUInt32();
+		std::string parent_state = parent.GetState();
+
+		RandomStream parent_copy(parent);
+		std::vector<uint32_t> parent_values = NextValues(parent_copy, 16);
+
+		std::set<std::vector<uint32_t>> distinct_values;
+		for(uint64_t index : { 0ULL, 1ULL, 2ULL, 3ULL, 1000ULL, 0xFFFFFFFFULL, 0xFFFFFFFFFFFFFFFFULL })
+		{
+			RandomStream first = parent.CreateSubstream(index);
+			RandomStream second = parent.CreateSubstream(index);
+			RandomStream from_copy = RandomStream(parent_state).CreateSubstream(index);
+
+			std::vector<uint32_t> first_values = NextValues(first, 16);
+			CHECK(first_values == NextValues(second, 16));
+			CHECK(first_values == NextValues(from_copy, 16));
+			CHECK(first_values != parent_values);
+			distinct_values.insert(first_values);
+		}
+
+		// Creating substreams must not change the parent.
+		CHECK(parent.GetState() == parent_state);
+
+		// Every index yields its own sequence.
+		CHECK(distinct_values.size() == 7);
+
+		// Substreams of a parent in a different state are different.
+		RandomStream advanced_parent(parent);
+		advanced_parent.RandUInt32();
+		RandomStream substream = parent.CreateSubstream(0);
+		RandomStream advanced_substream = advanced_parent.CreateSubstream(0);
+		CHECK(NextValues(substream, 16) != NextValues(advanced_substream, 16));
+	}
+
+	// Many nearby indices do not collide on their first values.
+	RandomStream parent("collisions");
+	std::set<uint64_t> first_pairs;
+	for(uint64_t index = 0; index < 4096; index++)
+	{
+		RandomStream substream = parent.CreateSubstream(index);
+		uint64_t high = substream.RandUInt32();
+		first_pairs.insert((high << 32) | substream.RandUInt32());
+	}
+	CHECK(first_pairs.size() == 4096);
+}
+
+int RunRandomStreamUnitTests()
+{
+	TestAdvance();
+	TestCreateSubstream();
+
+	std::cout << (g_checks - g_failures) << "/" << g_checks << " checks passed" << std::endl;
+	return g_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,6 @@
+#pragma once
+
+//Runs the tests for jumping ahead in and deriving substreams from RandomStream, checking them against
+//stepping the stream one value at a time.  Compiled into the lib_smoke_test driver like the clustering
+//tests.  Prints any failures and a summary line; returns the number of failed checks (0 on success).
+int RunRandomStreamUnitTests();
@@ -0,0 +1,227 @@
+//Tests for the regular expression cache and its linear time matcher
+#include "regex_cache_test.h"
+#include "RegexCache.h"
+
+#include <functional>
+#include <iostream>
+#include <random>
+#include <regex>
+#include <string>
+#include <utility>
+#include <vector>
+
+static int g_failures = 0;
+static int g_checks = 0;
+
+#define CHECK(cond) do { \
+	++g_checks; \
+	if(!(cond)) { ++g_failures; \
+		std::cerr << "FAIL " << __FILE__ << ":" << __LINE__ << ": " #cond << std::endl; } \
+	} while(0)
+
+//Like CHECK, but reports the pattern and input that disagree.
+#define CHECK_MATCH(cond, pattern, input) do { \
+	++g_checks; \
+	if(!(cond)) { ++g_failures; \
+		std::cerr << "FAIL " << __FILE__ << ":" << __LINE__ << ": " #cond \
+			<< " pattern \"" << (pattern) << "\" input \"" << (input) << "\"" << std::endl; } \
+	} while(0)
+
+using Spans = std::vector<std::pair<size_t, size_t>>;
+
+static Spans StdRegexSpans(const std::regex &re, const std::string &s)
+{
+	Spans spans;
+	for(auto it = std::sregex_iterator(begin(s), end(s), re); it != std::sregex_iterator(); ++it)
+		spans.emplace_back(it->position(0), it->position(0) + it->length(0));
+	return spans;
+}
+
+static Spans CompiledRegexSpans(CompiledRegex &cr, const std::string &s)
+{
+	Spans spans;
+	cr.ForEachMatch(s, [&spans](size_t match_start, size_t match_end)
+		{
+			spans.emplace_back(match_start, match_end);
+			return true;
+		});
+	return spans;
+}
+
+//Checks full matches, first matches, and all successive matches of pattern on each input against std::regex.
+static void CheckAgainstStdRegex(const std::string &pattern, const std::vector<std::string> &inputs)
+{
+	CompiledRegex cr(pattern);
+
+	std::regex re;
+	try
+	{
+		re = std::regex(pattern, std::regex::ECMAScript);
+	}
+	catch(std::regex_error &)
+	{
+		CHECK_MATCH(!cr.IsValid(), pattern, "");
+		return;
+	}
+	CHECK_MATCH(cr.IsValid(), pattern, "");
+
+	for(auto &s : inputs)
+	{
+		try
+		{
+			CHECK_MATCH(cr.FullMatch(s) == std::regex_match(s, re), pattern, s);
+
+			std::smatch m;
+			bool std_found = std::regex_search(s, m, re);
+			size_t match_start = 0, match_end = 0;
+			bool found = cr.FindFirstMatch(s, match_start, match_end);
+			CHECK_MATCH(found == std_found, pattern, s);
+			if(found && std_found)
+				CHECK_MATCH(match_start == static_cast<size_t>(m.position(0))
+					&& match_end == static_cast<size_t>(m.position(0) + m.length(0)), pattern, s);
+
+			CHECK_MATCH(CompiledRegexSpans(cr, s) == StdRegexSpans(re, s), pattern, s);
+		}
+		catch(std::regex_error &)
+		{
+			//std::regex ran out of stack or complexity budget, so there is nothing to compare against
+		}
+	}
+}
+
+static void TestFixedPatterns()
+{
+	std::vector<std::string> inputs = {"", "a", "ab", "aab", "abc abc", "a1b22c333", "  x_y\nz ", "foo.bar", "baaaab"};
+	for(const char *pattern : {"a", "ab", "a*", "a+?", "a{2}", "a{1,}", "a{0,2}?", "[ab]+", "[^ab\\s]", "\\d+", "\\W",
+		"\\bab", "\\Ba", "^a", "c$", "(a|b)*c", "(?:ab|a)b", ".", ".*", "x|", "", "foo\\.bar", "(a*)*b", "(a|ab)(c|bcd)"})
+	{
+		CheckAgainstStdRegex(pattern, inputs);
+	}
+
+	// Supported patterns use the automaton, while backreferences and lookahead fall back to std::regex.
+	CHECK(CompiledRegex("(a|b)+\\d{2,3}").IsLinear());
+	CHECK(!CompiledRegex("(a)\\1").IsLinear());
+	CHECK(!CompiledRegex("a(?=b)").IsLinear());
+	CheckAgainstStdRegex("(a)\\1", inputs);
+	CheckAgainstStdRegex("a(?=b)", inputs);
+}
+
+static void TestInvalidPatterns()
+{
+	for(const char *pattern : {"(", "a)", "[a", "[b-a]", "a{2,1}", "*a", "\\", "(?<a)"})
+	{
+		CompiledRegex cr(pattern);
+		CHECK_MATCH(!cr.IsValid(), pattern, "");
+		size_t match_start = 0, match_end = 0;
+		CHECK_MATCH(!cr.FindFirstMatch("aaa", match_start, match_end), pattern, "aaa");
+		CHECK_MATCH(!cr.FullMatch("a"), pattern, "a");
+		CHECK_MATCH(cr.GetRegexWithSubmatches() == nullptr, pattern, "");
+
+		// Invalid patterns are cached like any other so they are not recompiled.
+		auto cached = RegexCache::GetCompiledRegex(pattern);
+		CHECK_MATCH(cached != nullptr && !cached->IsValid(), pattern, "");
+	}
+}
+
+static void TestRandomPatterns()
+{
+	//pieces of patterns that combine into both supported and unsupported expressions
+	static const std::vector<std::string> atoms = {"a", "b", "1", " ", ".", "[ab]", "[^a]", "[a-c1]", "\\d", "\\w", "\\s", "\\W"};
+	static const std::vector<std::string> quantifiers = {"", "", "", "*", "+", "?", "*?", "+?", "??", "{2}", "{1,2}", "{0,}?"};
+	//groups only get bounded quantifiers, since nested unbounded ones make std::regex backtrack exponentially
+	static const std::vector<std::string> group_quantifiers = {"", "", "?", "??", "{2}", "{1,2}", "{0,2}?"};
+	static const std::vector<std::string> anchors = {"^", "$", "\\b", "\\B"};
+
+	std::mt19937 gen(12345);
+	auto pick = [&gen](const std::vector<std::string> &v) -> const std::string &
+	{
+		return v[std::uniform_int_distribution<size_t>(0, v.size() - 1)(gen)];
+	};
+	auto chance = [&gen](int percent) { return std::uniform_int_distribution<int>(0, 99)(gen) < percent; };
+
+	//builds an expression of up to depth levels of groups and alternation
+	std::function<std::string(int)> make_expression = [&](int depth)
+	{
+		std::string expression;
+		size_t num_terms = std::uniform_int_distribution<size_t>(1, 4)(gen);
+		for(size_t i = 0; i < num_terms; i++)
+		{
+			if(chance(10))
+				expression += pick(anchors);
+			else if(depth > 0 && chance(25))
+				expression += (chance(50) ? "(" : "(?:") + make_expression(depth - 1) + ")" + pick(group_quantifiers);
+			else
+				expression += pick(atoms) + pick(quantifiers);
+		}
+		if(chance(20))
+			expression += "|" + make_expression(depth - 1);
+		return expression;
+	};
+
+	std::string input_alphabet = "ab1 _\n";
+	for(int i = 0; i < 5000; i++)
+	{
+		std::string pattern = make_expression(2);
+
+		std::vector<std::string> inputs;
+		for(int j = 0; j < 8; j++)
+		{
+			std::string s;
+			size_t len = std::uniform_int_distribution<size_t>(0, 12)(gen);
+			for(size_t k = 0; k < len; k++)
+				s.push_back(input_alphabet[std::uniform_int_distribution<size_t>(0, input_alphabet.size() - 1)(gen)]);
+			inputs.push_back(s);
+		}
+
+		CheckAgainstStdRegex(pattern, inputs);
+	}
+}
+
+static void TestCache()
+{
+	// Repeated lookups of the same pattern return the same compiled regex.
+	auto first = RegexCache::GetCompiledRegex("cache_test_(a|b)+");
+	auto second = RegexCache::GetCompiledRegex(std::string("cache_test_(a|b)+"));
+	CHECK(first == second);
+	CHECK(first->IsValid());
+
+	// Distinct patterns get distinct entries.
+	CHECK(RegexCache::GetCompiledRegex("cache_test_(a|c)+") != first);
+
+	// Cycling through many more patterns than the cache holds evicts patterns that aren't used again,
+	// but keeps patterns that are used throughout, and regexes already handed out stay usable.
+	auto hot = RegexCache::GetCompiledRegex("cache_test_hot_(a|b)+");
+	bool hot_kept = true;
+	std::shared_ptr<CompiledRegex> last_fill;
+	for(size_t i = 0; i < 8192; i++)
+	{
+		last_fill = RegexCache::GetCompiledRegex("cache_test_fill_" + std::to_string(i));
+		hot_kept = hot_kept && (RegexCache::GetCompiledRegex("cache_test_hot_(a|b)+") == hot);
+	}
+	CHECK(hot_kept);
+
+	auto after_eviction = RegexCache::GetCompiledRegex("cache_test_(a|b)+");
+	CHECK(after_eviction != first);
+	CHECK(after_eviction == RegexCache::GetCompiledRegex("cache_test_(a|b)+"));
+	CHECK(first->FullMatch("cache_test_abba"));
+	CHECK(after_eviction->FullMatch("cache_test_abba"));
+
+	// The most recently added pattern is still cached, since only one entry is evicted per new pattern.
+	CHECK(RegexCache::GetCompiledRegex("cache_test_fill_8191") == last_fill);
+
+	// The regex with submatches is compiled once and reused.
+	const std::regex *with_submatches = first->GetRegexWithSubmatches();
+	CHECK(with_submatches != nullptr);
+	CHECK(with_submatches == first->GetRegexWithSubmatches());
+}
+
+int RunRegexCacheUnitTests()
+{
+	TestFixedPatterns();
+	TestInvalidPatterns();
+	TestRandomPatterns();
+	TestCache();
+
+	std::cout << (g_checks - g_failures) << "/" << g_checks << " checks passed" << std::endl;
+	return g_failures == 0 ? 0 : 1;
+}
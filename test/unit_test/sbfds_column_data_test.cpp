@@ -0,0 +1,155 @@
+//Unit tests for SBFDSColumnData
+#include "sbfds_column_data_test.h"
+#include "SBFDSColumnData.h"
+
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+
+static int g_failures = 0;
+static int g_checks = 0;
+
+#define CHECK(cond) do { \
+	++g_checks; \
+	if(!(cond)) { ++g_failures; \
+		std::cerr << "FAIL " << __FILE__ << ":" << __LINE__ << ": " #cond << std::endl; } \
+	} while(0)
+
+template<typename IntegerSetType>
+static std::vector<size_t> ToVector(IntegerSetType &set)
+{
+	std::vector<size_t> values;
+	for(size_t value : set)
+		values.push_back(value);
+	return values;
+}
+
+//checks that every index has the same value and that the columns have the same value entries
+static void CheckColumnsMatch(SBFDSColumnData &expected, SBFDSColumnData &actual, size_t num_indices)
+{
+	for(size_t index = 0; index < num_indices; index++)
+	{
+		auto value_type = expected.GetIndexValueType(index);
+		CHECK(actual.GetIndexValueType(index) == value_type);
+		if(value_type == ENIVT_NUMBER)
+			CHECK(actual.valueEntries[index].number == expected.valueEntries[index].number);
+		else if(value_type == ENIVT_STRING_ID)
+			CHECK(actual.valueEntries[index].stringID == expected.valueEntries[index].stringID);
+	}
+
+	CHECK(ToVector(actual.numberIndices) == ToVector(expected.numberIndices));
+	CHECK(ToVector(actual.stringIdIndices) == ToVector(expected.stringIdIndices));
+	CHECK(ToVector(actual.nullIndices) == ToVector(expected.nullIndices));
+	CHECK(ToVector(actual.invalidIndices) == ToVector(expected.invalidIndices));
+	CHECK(ToVector(actual.trueBoolIndices) == ToVector(expected.trueBoolIndices));
+	CHECK(ToVector(actual.falseBoolIndices) == ToVector(expected.falseBoolIndices));
+
+	CHECK(actual.sortedNumberValueEntries.size() == expected.sortedNumberValueEntries.size());
+	for(auto &[number, value_entry] : expected.sortedNumberValueEntries)
+	{
+		auto found = actual.sortedNumberValueEntries.find(number);
+		CHECK(found != end(actual.sortedNumberValueEntries));
+		if(found != end(actual.sortedNumberValueEntries))
+			CHECK(ToVector(found->second.indicesWithValue) == ToVector(value_entry.indicesWithValue));
+	}
+
+	CHECK(actual.stringIdValueEntries.size() == expected.stringIdValueEntries.size());
+	for(auto &[sid, value_entry] : expected.stringIdValueEntries)
+	{
+		auto found = actual.stringIdValueEntries.find(sid);
+		CHECK(found != end(actual.stringIdValueEntries));
+		if(found != end(actual.stringIdValueEntries))
+			CHECK(ToVector(found->second->indicesWithValue) == ToVector(value_entry->indicesWithValue));
+	}
+
+	CHECK(actual.longestStringLength == expected.longestStringLength);
+	CHECK(actual.indexWithLongestString == expected.indexWithLongestString);
+}
+
+static void TestInsertAllMatchesInsertEach()
+{
+	std::vector<std::string> strings = { "bb", "a", "zz", "bb", "yy", "a", "aa" };
+	std::vector<StringInternPool::StringID> sids;
+	for(auto &str : strings)
+		sids.push_back(string_intern_pool.CreateStringReference(str));
+
+	//numbers and strings with duplicates interleaved with missing values, nulls, and bools,
+	// where several different strings have the longest length
+	std::vector<EvaluableNodeImmediateValueWithType> values;
+	for(size_t i = 0; i < 200; i++)
+	{
+		switch(i % 9)
+		{
+		case 0:
+			values.emplace_back(static_cast<double>((i * 7) % 13));
+			break;
+		case 1:
+			values.emplace_back(sids[(i / 9) % sids.size()]);
+			break;
+		case 2:
+			values.emplace_back(EvaluableNodeImmediateValue(), ENIVT_NOT_EXIST);
+			break;
+		case 3:
+			values.emplace_back(-2.5);
+			break;
+		case 4:
+			values.emplace_back();
+			break;
+		case 5:
+			values.emplace_back(i % 2 == 0);
+			break;
+		case 6:
+			values.emplace_back(sids[(i * 3) % sids.size()]);
+			break;
+		case 7:
+			values.emplace_back(static_cast<double>(i) / 4);
+			break;
+		default:
+			values.emplace_back(EvaluableNodeImmediateValue(), ENIVT_NOT_EXIST);
+			break;
+		}
+	}
+
+	for(bool run_concurrently : { false, true })
+	{
+		SBFDSColumnData each(string_intern_pool.emptyStringId);
+		for(size_t index = 0; index < values.size(); index++)
+			each.InsertIndexValue(values[index].nodeType, values[index].nodeValue, index);
+
+		SBFDSColumnData all(string_intern_pool.emptyStringId);
+		auto values_copy = values;
+		all.InsertAllIndexValues(values_copy, run_concurrently);
+
+		CheckColumnsMatch(each, all, values.size());
+	}
+
+	for(auto sid : sids)
+		string_intern_pool.DestroyStringReference(sid);
+}
+
+static void TestInsertAllWithNaN()
+{
+	std::vector<EvaluableNodeImmediateValueWithType> values;
+	values.emplace_back(1.0);
+	values.emplace_back(EvaluableNodeImmediateValue(std::numeric_limits<double>::quiet_NaN()), ENIVT_NUMBER);
+	values.emplace_back(1.0);
+	values.emplace_back(EvaluableNodeImmediateValue(std::numeric_limits<double>::quiet_NaN()), ENIVT_NUMBER);
+
+	//nan is stored as null rather than grouped with the numbers
+	SBFDSColumnData column(string_intern_pool.emptyStringId);
+	column.InsertAllIndexValues(values, false);
+	CHECK(column.GetIndexValueType(1) == ENIVT_NULL);
+	CHECK(column.GetIndexValueType(3) == ENIVT_NULL);
+	CHECK(ToVector(column.numberIndices) == std::vector<size_t>({ 0, 2 }));
+	CHECK(column.sortedNumberValueEntries.size() == 1);
+}
+
+int RunSBFDSColumnDataUnitTests()
+{
+	TestInsertAllMatchesInsertEach();
+	TestInsertAllWithNaN();
+
+	std::cout << (g_checks - g_failures) << "/" << g_checks << " checks passed" << std::endl;
+	return g_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,6 @@
+#pragma once
+
+//Runs the tests for building SBFDSColumnData from all values at once, checking the result against
+//inserting each value by index.  Compiled into the lib_smoke_test driver like the clustering tests.
+//Prints any failures and a summary line; returns the number of failed checks (0 on success).
+int RunSBFDSColumnDataUnitTests();
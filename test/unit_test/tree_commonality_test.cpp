@@ -0,0 +1,247 @@
+//Unit tests for EvaluableNodeTreeManipulation::NumberOfSharedNodes
+#include "tree_commonality_test.h"
+#include "EvaluableNodeTreeManipulation.h"
+#include "Parser.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+static int g_failures = 0;
+static int g_checks = 0;
+
+#define CHECK(cond) do { \
+	++g_checks; \
+	if(!(cond)) { ++g_failures; \
+		std::cerr << "FAIL " << __FILE__ << ":" << __LINE__ << ": " #cond << std::endl; } \
+	} while(0)
+
+//Like CHECK, but reports the code of the trees being compared.
+#define CHECK_TREES(cond, code1, code2) do { \
+	++g_checks; \
+	if(!(cond)) { ++g_failures; \
+		std::cerr << "FAIL " << __FILE__ << ":" << __LINE__ << ": " #cond \
+			<< " comparing " << (code1) << " to " << (code2) << std::endl; } \
+	} while(0)
+
+static EvaluableNode *ParseTree(EvaluableNodeManager &enm, const std::string &code)
+{
+	return std::get<0>(Parser::Parse(code, &enm));
+}
+
+//Counts the shared nodes without the structural hash shortcuts by comparing every pair of nodes
+static double SharedNodesWithoutShortcuts(EvaluableNode *tree1, EvaluableNode *tree2,
+	bool types_must_match, bool nominal_numbers, bool recursive_matching)
+{
+	MergeMetricResultsParams mmrp;
+	mmrp.typesMustMatch = types_must_match;
+	mmrp.nominalNumbers = nominal_numbers;
+	mmrp.nominalStrings = true;
+	mmrp.recursiveMatching = recursive_matching;
+	mmrp.matchIdenticalSubtrees = false;
+	mmrp.checked = nullptr;
+	return EvaluableNodeTreeManipulation::NumberOfSharedNodes(tree1, tree2, mmrp).commonality;
+}
+
+static double SharedNodes(EvaluableNode *tree1, EvaluableNode *tree2,
+	bool types_must_match = true, bool nominal_numbers = true, bool recursive_matching = true)
+{
+	return EvaluableNodeTreeManipulation::NumberOfSharedNodes(tree1, tree2,
+		types_must_match, nominal_numbers, true, recursive_matching).commonality;
+}
+
+static bool AreClose(double a, double b)
+{
+	return std::abs(a - b) <= 1e-9 * std::max(1.0, std::abs(a));
+}
+
+//Generates code for random trees, reusing previously generated subtrees often so that pairs of trees
+// have identical subtrees at different positions, as leading and trailing child nodes, and among unordered child nodes.
+class RandomTreeCode
+{
+public:
+	RandomTreeCode(uint64_t seed)
+		: gen(seed)
+	{}
+
+	std::string Generate(int depth)
+	{
+		if(!subtrees.empty() && Chance(30))
+			return subtrees[Uniform(subtrees.size())];
+
+		std::string code;
+		if(depth <= 0 || Chance(30))
+		{
+			static const std::vector<std::string> leaves = { "1", "2", "3", "4.5", "\"a\"", "\"b\"", ".null", ".true", "x" };
+			code = leaves[Uniform(leaves.size())];
+		}
+		else
+		{
+			size_t num_children = Uniform(5);
+			switch(Uniform(4))
+			{
+			case 0:
+				code = "[" + GenerateChildren(depth, num_children) + "]";
+				break;
+			case 1:
+				code = "(unordered_list " + GenerateChildren(depth, num_children) + ")";
+				break;
+			case 2:
+				code = "(seq " + GenerateChildren(depth, num_children) + ")";
+				break;
+			default:
+			{
+				static const std::vector<std::string> keys = { "a", "b", "c", "d" };
+				code = "{";
+				for(auto &key : keys)
+				{
+					if(Chance(50))
+						code += key + " " + Generate(depth - 1) + " ";
+				}
+				code += "}";
+				break;
+			}
+			}
+		}
+
+		subtrees.push_back(code);
+		return code;
+	}
+
+protected:
+	std::string GenerateChildren(int depth, size_t num_children)
+	{
+		std::string code;
+		for(size_t i = 0; i < num_children; i++)
+			code += Generate(depth - 1) + " ";
+		return code;
+	}
+
+	size_t Uniform(size_t n)
+	{
+		return std::uniform_int_distribution<size_t>(0, n - 1)(gen);
+	}
+
+	bool Chance(int percent)
+	{
+		return Uniform(100) < static_cast<size_t>(percent);
+	}
+
+	std::mt19937_64 gen;
+	std::vector<std::string> subtrees;
+};
+
+//The structural hash shortcuts yield the same counts as the full comparison.
+static void TestMatchesFullComparison()
+{
+	EvaluableNodeManager enm;
+	RandomTreeCode random_code(12345);
+	for(int i = 0; i < 300; i++)
+	{
+		std::string code1 = random_code.Generate(4);
+		std::string code2 = random_code.Generate(4);
+		//wrap both in a list with identical leading and trailing child nodes around them half of the time
+		if(i % 2 == 0)
+		{
+			std::string leading = random_code.Generate(2);
+			std::string trailing = random_code.Generate(2);
+			code1 = "[" + leading + " " + code1 + " " + trailing + "]";
+			code2 = "[" + leading + " " + code2 + " " + trailing + "]";
+		}
+
+		EvaluableNode *tree1 = ParseTree(enm, code1);
+		EvaluableNode *tree2 = ParseTree(enm, code2);
+		for(bool types_must_match : { true, false })
+		{
+			for(bool nominal_numbers : { true, false })
+			{
+				for(bool recursive_matching : { true, false })
+				{
+					double shared = SharedNodes(tree1, tree2, types_must_match, nominal_numbers, recursive_matching);
+					double expected = SharedNodesWithoutShortcuts(tree1, tree2, types_must_match, nominal_numbers, recursive_matching);
+					CHECK_TREES(AreClose(shared, expected), code1, code2);
+				}
+			}
+		}
+
+		// Each tree shares all of its nodes with itself and with a copy of itself.
+		double size1 = static_cast<double>(EvaluableNode::GetDeepSize(tree1));
+		CHECK_TREES(AreClose(SharedNodes(tree1, tree1), size1), code1, code1);
+		CHECK_TREES(AreClose(SharedNodes(tree1, ParseTree(enm, code1)), size1), code1, code1);
+	}
+}
+
+static void TestIdenticalChildNodes()
+{
+	EvaluableNodeManager enm;
+
+	// Identical leading and trailing child nodes are matched and the rest are aligned between them.
+	EvaluableNode *tree1 = ParseTree(enm, "[[1 2] {a 3} 4 \"x\" [5 6]]");
+	EvaluableNode *tree2 = ParseTree(enm, "[[1 2] {a 3} \"y\" 7 [5 6]]");
+	CHECK(AreClose(SharedNodes(tree1, tree2, true, true, false), SharedNodesWithoutShortcuts(tree1, tree2, true, true, false)));
+	CHECK(SharedNodes(tree1, tree2) >= 1 + 3 + 2 + 3);
+
+	// Identical unordered child nodes are paired regardless of their positions.
+	tree1 = ParseTree(enm, "(unordered_list [1 2] {a 3} 4 [1 2])");
+	tree2 = ParseTree(enm, "(unordered_list 4 [1 2] [1 2] {a 3})");
+	CHECK(AreClose(SharedNodes(tree1, tree2), 10));
+	CHECK(AreClose(SharedNodes(tree1, tree2, true, true, false), SharedNodesWithoutShortcuts(tree1, tree2, true, true, false)));
+
+	// Labels and comments are not part of the structure, so labeled trees still match completely.
+	tree1 = ParseTree(enm, "[#a 1 ;comment\n 2 [3]]");
+	tree2 = ParseTree(enm, "[1 2 #b [3]]");
+	CHECK(AreClose(SharedNodes(tree1, tree2, true, true, false), SharedNodesWithoutShortcuts(tree1, tree2, true, true, false)));
+
+	// Null child nodes match like any other node.
+	tree1 = ParseTree(enm, "[.null [.null 1]]");
+	tree2 = ParseTree(enm, "[.null [.null 1]]");
+	CHECK(AreClose(SharedNodes(tree1, tree2), 5));
+}
+
+//Trees flagged as needing cycle checks count each pair of shared nodes once, and trees with cycles still terminate.
+static void TestSharedNodesAndCycles()
+{
+	EvaluableNodeManager enm;
+
+	std::string subtree_code = "[1 [2 3] {a 4}]";
+	EvaluableNode *subtree = ParseTree(enm, subtree_code);
+	EvaluableNode *with_shared_nodes = enm.AllocNode(ENT_LIST);
+	with_shared_nodes->AppendOrderedChildNode(subtree);
+	with_shared_nodes->AppendOrderedChildNode(subtree);
+	with_shared_nodes->SetNeedCycleCheck(true);
+
+	//compared with itself, the shared subtree is only counted once, but compared with separate copies,
+	// it matches each copy
+	EvaluableNode *copied = ParseTree(enm, "[" + subtree_code + " " + subtree_code + "]");
+	double shared_size = static_cast<double>(EvaluableNode::GetDeepSize(with_shared_nodes));
+	double copied_size = static_cast<double>(EvaluableNode::GetDeepSize(copied));
+	CHECK(shared_size < copied_size);
+	CHECK(AreClose(SharedNodes(with_shared_nodes, with_shared_nodes), shared_size));
+	CHECK(AreClose(SharedNodes(with_shared_nodes, copied), copied_size));
+	CHECK(AreClose(SharedNodes(copied, with_shared_nodes), copied_size));
+
+	EvaluableNode *with_cycle = ParseTree(enm, "[1 2 [3]]");
+	with_cycle->AppendOrderedChildNode(with_cycle);
+	with_cycle->SetNeedCycleCheck(true);
+	EvaluableNode *other_with_cycle = ParseTree(enm, "[1 2 [3]]");
+	other_with_cycle->AppendOrderedChildNode(other_with_cycle);
+	other_with_cycle->SetNeedCycleCheck(true);
+
+	double shared = SharedNodes(with_cycle, other_with_cycle);
+	CHECK(shared >= 4);
+	CHECK(AreClose(shared, SharedNodes(other_with_cycle, with_cycle)));
+	CHECK(SharedNodes(with_cycle, copied) >= 1);
+}
+
+int RunTreeCommonalityUnitTests()
+{
+	TestMatchesFullComparison();
+	TestIdenticalChildNodes();
+	TestSharedNodesAndCycles();
+
+	std::cout << (g_checks - g_failures) << "/" << g_checks << " checks passed" << std::endl;
+	return g_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,7 @@
+#pragma once
+
+//Runs the tests for counting the nodes shared between two trees, checking the structural hash
+//matching against the full comparison it shortcuts.  Compiled into the lib_smoke_test driver
+//like the clustering tests.  Prints any failures and a summary line; returns the number of failed
+//checks (0 on success).
+int RunTreeCommonalityUnitTests();
@@ -0,0 +1,102 @@
+//Unit tests for the ids of unnamed contained entities
+#include "unnamed_entity_id_test.h"
+#include "Entity.h"
+
+#include <iostream>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+static int g_failures = 0;
+static int g_checks = 0;
+
+#define CHECK(cond) do { \
+	++g_checks; \
+	if(!(cond)) { ++g_failures; \
+		std::cerr << "FAIL " << __FILE__ << ":" << __LINE__ << ": " #cond << std::endl; } \
+	} while(0)
+
+//length of compact ids, an underscore followed by 6 base 62 digits
+constexpr size_t compactIdLength = 7;
+
+//length of full length ids, an underscore followed by 11 base 62 digits
+constexpr size_t fullIdLength = 12;
+
+static StringInternPool::StringID AddUnnamedEntity(Entity &container)
+{
+	return container.AddContainedEntity(new Entity(), StringInternPool::NOT_A_STRING_ID);
+}
+
+static void CheckIsCompactId(StringInternPool::StringID id_sid)
+{
+	std::string id = string_intern_pool.GetStringFromID(id_sid);
+	CHECK(id.size() == compactIdLength);
+	CHECK(id.size() > 0 && id[0] == '_');
+#ifndef DISABLE_SHORT_STRING_INLINING
+	CHECK(id_sid.IsInlineString());
+#endif
+}
+
+static void TestIdsAreUniqueAndCompact()
+{
+	Entity container;
+	container.SetRandomState("seed", false);
+
+	std::unordered_set<std::string> ids;
+	for(size_t i = 0; i < 2000; i++)
+	{
+		StringInternPool::StringID id_sid = AddUnnamedEntity(container);
+		CheckIsCompactId(id_sid);
+		ids.insert(string_intern_pool.GetStringFromID(id_sid));
+	}
+
+	CHECK(ids.size() == 2000);
+	CHECK(container.GetContainedEntities().size() == 2000);
+	for(auto &id : ids)
+		CHECK(container.GetContainedEntity(string_intern_pool.GetIDFromString(id)) != nullptr);
+}
+
+static void TestFallbackToFullLengthIds()
+{
+	//with the same random state, the first 4 unnamed entities of one container have the ids
+	// that the first 4 attempts at an id in the other container will generate
+	Entity candidate_container;
+	candidate_container.SetRandomState("collision seed", false);
+	std::vector<std::string> candidate_ids;
+	for(size_t i = 0; i < 4; i++)
+		candidate_ids.emplace_back(string_intern_pool.GetStringFromID(AddUnnamedEntity(candidate_container)));
+
+	//naming entities does not draw from the random stream, so taking all of the candidate ids
+	// causes the first 4 attempts to collide
+	Entity container;
+	container.SetRandomState("collision seed", false);
+	for(auto &id : candidate_ids)
+		CHECK(container.AddContainedEntity(new Entity(), id) != StringInternPool::NOT_A_STRING_ID);
+
+	StringInternPool::StringID id_sid = AddUnnamedEntity(container);
+	std::string id = string_intern_pool.GetStringFromID(id_sid);
+	CHECK(id.size() == fullIdLength);
+	CHECK(id.size() > 0 && id[0] == '_');
+	CHECK(!id_sid.IsInlineString());
+	for(auto &candidate_id : candidate_ids)
+		CHECK(id != candidate_id);
+	CHECK(container.GetContainedEntities().size() == candidate_ids.size() + 1);
+
+	//the next entity starts over with compact ids
+	StringInternPool::StringID next_id_sid = AddUnnamedEntity(container);
+	CheckIsCompactId(next_id_sid);
+
+	std::unordered_set<std::string> ids(begin(candidate_ids), end(candidate_ids));
+	ids.insert(id);
+	ids.insert(string_intern_pool.GetStringFromID(next_id_sid));
+	CHECK(ids.size() == candidate_ids.size() + 2);
+}
+
+int RunUnnamedEntityIdUnitTests()
+{
+	TestIdsAreUniqueAndCompact();
+	TestFallbackToFullLengthIds();
+
+	std::cout << (g_checks - g_failures) << "/" << g_checks << " checks passed" << std::endl;
+	return g_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,7 @@
+#pragma once
+
+//Runs the tests for the ids generated for unnamed contained entities, checking that they are unique, compact
+//while there are few collisions, and fall back to full length ids after repeated collisions.
+//Compiled into the lib_smoke_test driver like the clustering tests.
+//Prints any failures and a summary line; returns the number of failed checks (0 on success).
+int RunUnnamedEntityIdUnitTests();
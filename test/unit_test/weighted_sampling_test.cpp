@@ -0,0 +1,165 @@
+//Unit tests for weighted sampling of entities via EntityQueryCaches
+#include "weighted_sampling_test.h"
+#include "Entity.h"
+#include "EntityQueries.h"
+#include "EntityQueryCaches.h"
+#include "Parser.h"
+
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+
+static int g_failures = 0;
+static int g_checks = 0;
+
+#define CHECK(cond) do { \
+	++g_checks; \
+	if(!(cond)) { ++g_failures; \
+		std::cerr << "FAIL " << __FILE__ << ":" << __LINE__ << ": " #cond << std::endl; } \
+	} while(0)
+
+//samples num_to_sample ids of entities contained by container weighted by weight_label
+//if filter_ids is not empty, only entities with those ids are sampled from, as when query_sample follows another query
+static std::vector<std::string> SampleIds(Entity &container, const std::string &weight_label, size_t num_to_sample,
+	const std::string &seed, bool use_weighted_sampling_cache, const std::vector<std::string> &filter_ids = {})
+{
+	EntityQueryCondition cond;
+	cond.queryType = ENT_QUERY_SAMPLE;
+	cond.singleLabel = string_intern_pool.GetIDFromString(weight_label);
+	cond.maxToRetrieve = num_to_sample;
+	cond.hasRandomStream = true;
+	cond.randomStream = RandomStream(seed);
+
+	BitArrayIntegerSet matching_entities;
+	for(auto &id : filter_ids)
+		matching_entities.insert(container.GetContainedEntityIndex(string_intern_pool.GetIDFromString(id)));
+
+	std::vector<size_t> entity_indices_sampled;
+	container.GetQueryCaches()->GetMatchingEntitiesViaSamplingWithReplacement(&cond, matching_entities, entity_indices_sampled,
+		filter_ids.empty(), true, use_weighted_sampling_cache);
+
+	auto &contained = container.GetContainedEntities();
+	std::vector<std::string> ids;
+	for(size_t entity_index : entity_indices_sampled)
+		ids.emplace_back(contained[entity_index]->GetId());
+	return ids;
+}
+
+//checks that sampling via the cache gives the same entities as gathering the weights for each query,
+// both for few samples, which are found via binary search, and for many, which use an alias table
+static void CheckCachedMatchesUncached(Entity &container, const std::string &seed)
+{
+	for(size_t num_to_sample : { 1, 5, 50 })
+	{
+		auto uncached = SampleIds(container, "weight", num_to_sample, seed, false);
+		auto cached = SampleIds(container, "weight", num_to_sample, seed, true);
+		CHECK(uncached.size() == num_to_sample);
+		CHECK(cached == uncached);
+	}
+}
+
+static void SetWeight(Entity &container, const std::string &id, const std::string &weight)
+{
+	Entity *entity = container.GetContainedEntity(string_intern_pool.GetIDFromString(id));
+	auto &enm = entity->evaluableNodeManager;
+	EvaluableNodeReference new_label_values(std::get<0>(Parser::Parse("{weight " + weight + "}", &enm)), true);
+	auto [any_success, all_success] = entity->SetValuesAtLabels(new_label_values, false, nullptr, nullptr, true);
+	CHECK(all_success);
+}
+
+static void AddEntity(Entity &container, const std::string &id, const std::string &weight)
+{
+	std::string code = "{weight " + weight + "}";
+	container.AddContainedEntity(new Entity(code, id), id);
+}
+
+static bool AllIdsAre(const std::vector<std::string> &ids, const std::string &id)
+{
+	for(auto &sampled_id : ids)
+	{
+		if(sampled_id != id)
+			return false;
+	}
+	return !ids.empty();
+}
+
+static void TestSamplesMatchUncached()
+{
+	Entity container;
+	container.SetRandomState("seed", false);
+	for(size_t i = 0; i < 20; i++)
+		AddEntity(container, "e" + std::to_string(i), std::to_string((i % 7) * 0.5 + 0.25));
+	//entities without a number weight are never sampled
+	AddEntity(container, "no_weight", "\"heavy\"");
+	container.CreateQueryCaches();
+
+	CheckCachedMatchesUncached(container, "first seed");
+	CheckCachedMatchesUncached(container, "second seed");
+
+	auto all_ids = SampleIds(container, "weight", 200, "all seed", true);
+	for(auto &id : all_ids)
+		CHECK(id != "no_weight");
+
+	//when every entity is matching, rejection sampling never rejects, so the samples are still the same
+	std::vector<std::string> every_id;
+	for(size_t i = 0; i < 20; i++)
+		every_id.emplace_back("e" + std::to_string(i));
+	CHECK(SampleIds(container, "weight", 5, "filter seed", true, every_id)
+		== SampleIds(container, "weight", 5, "filter seed", false, every_id));
+
+	//when only some entities are matching, rejection sampling consumes the random stream differently,
+	// so only check that the samples are among those matching
+	std::vector<std::string> some_ids = { "e1", "e2", "e5", "e8", "e13", "e16" };
+	for(bool use_cache : { true, false })
+	{
+		auto sampled = SampleIds(container, "weight", 30, "filter seed", use_cache, some_ids);
+		CHECK(sampled.size() == 30);
+		for(auto &id : sampled)
+			CHECK(std::find(begin(some_ids), end(some_ids), id) != end(some_ids));
+	}
+}
+
+static void TestCacheFollowsEntityChanges()
+{
+	//all of the weight is on one entity at a time, so a stale cache would sample the wrong entity
+	Entity container;
+	container.SetRandomState("seed", false);
+	for(size_t i = 0; i < 10; i++)
+		AddEntity(container, "e" + std::to_string(i), i == 3 ? "1" : "0");
+	container.CreateQueryCaches();
+
+	CHECK(AllIdsAre(SampleIds(container, "weight", 5, "seed", true), "e3"));
+	CHECK(AllIdsAre(SampleIds(container, "weight", 50, "seed", true), "e3"));
+
+	//label updates
+	SetWeight(container, "e3", "0");
+	SetWeight(container, "e7", "2");
+	CHECK(AllIdsAre(SampleIds(container, "weight", 5, "seed", true), "e7"));
+	CHECK(AllIdsAre(SampleIds(container, "weight", 50, "seed", true), "e7"));
+	CheckCachedMatchesUncached(container, "seed");
+
+	//adding an entity
+	AddEntity(container, "added", "2");
+	auto sampled = SampleIds(container, "weight", 50, "seed", true);
+	CHECK(std::find(begin(sampled), end(sampled), "added") != end(sampled));
+	CheckCachedMatchesUncached(container, "seed");
+
+	//removing an entity, which also moves the last entity into the index of the removed one
+	StringInternPool::StringID e7_sid = string_intern_pool.GetIDFromString("e7");
+	Entity *e7 = container.GetContainedEntity(e7_sid);
+	container.RemoveContainedEntity(e7_sid);
+	delete e7;
+	CHECK(AllIdsAre(SampleIds(container, "weight", 5, "seed", true), "added"));
+	CHECK(AllIdsAre(SampleIds(container, "weight", 50, "seed", true), "added"));
+	CheckCachedMatchesUncached(container, "seed");
+}
+
+int RunWeightedSamplingUnitTests()
+{
+	TestSamplesMatchUncached();
+	TestCacheFollowsEntityChanges();
+
+	std::cout << (g_checks - g_failures) << "/" << g_checks << " checks passed" << std::endl;
+	return g_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,7 @@
+#pragma once
+
+//Runs the tests for sampling contained entities weighted by a label via the query caches, checking the
+//cached samples against gathering the weights for each query and that the cache follows changes to the entities.
+//Compiled into the lib_smoke_test driver like the clustering tests.
+//Prints any failures and a summary line; returns the number of failed checks (0 on success).
+int RunWeightedSamplingUnitTests();